@@ -0,0 +1,357 @@
+/*
+ * csi2tool.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Produces and checks MIPI CSI-2 RAW10 byte streams (src/proto/Csi2.h).
+ *
+ *   csi2tool gen [-w 640] [-h 480] [-n frames] [-t line] [-s] [-l] out.bin
+ *       Test pattern frames. -t ends every other frame's FE after that line,
+ *       -s sends the cut lines in the next frame (the truncated-VTS failure
+ *       of OV5640.h), -l adds line start/end packets.
+ *
+ *   csi2tool check [-w 640] [-h 480] [-v] in.bin
+ *       Parses a stream, lists the frames with errors (all with -v) and the
+ *       totals. Reads in 4 MiB pieces, so the file may be any size.
+ *
+ *   csi2tool selftest [-w 640] [-h 480]
+ *       Round trip through generator and parser, clean and with every fault
+ *       injected, checking pixels and error classification.
+ *
+ *   csi2tool bench [-m MiB]
+ *       CRC-16 throughput of the nibble, slice-by-8 and carry-less multiply
+ *       paths, and whether they agree.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <vector>
+
+#include "proto/Csi2.h"
+#include "util/Crc16.h"
+
+using namespace digilent;
+
+namespace {
+
+using clk = std::chrono::steady_clock;
+
+double seconds(clk::time_point t0)
+{
+	return std::chrono::duration<double>(clk::now() - t0).count();
+}
+
+void pattern(std::vector<uint16_t>& px, uint32_t width, uint32_t height, uint32_t frame)
+{
+	for (uint32_t y = 0; y < height; ++y)
+		for (uint32_t x = 0; x < width; ++x)
+			px[(size_t)y * width + x] = (uint16_t)((x * 7 + y * 3 + frame * 11) & 0x3FF);
+}
+
+void printErrors(uint32_t e)
+{
+	static char const* const names[] = { "ecc-corrected", "ecc", "crc", "short", "long",
+			"line-size", "no-fs", "no-fe", "frame-no", "data-type" };
+	for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+		if (e & (1u << i))
+			printf(" %s", names[i]);
+}
+
+int gen(uint32_t width, uint32_t height, uint32_t frames, Csi2::inject_t const& inj,
+		bool line_sync, char const* path)
+{
+	FILE* f = fopen(path, "wb");
+	if (!f)
+	{
+		perror(path);
+		return 1;
+	}
+	Csi2::Generator g(width, height, 0, line_sync);
+	std::vector<uint16_t> px((size_t)width * height);
+	std::vector<uint8_t> out(g.maxFrameBytes());
+	uint64_t total = 0;
+	for (uint32_t i = 0; i < frames; ++i)
+	{
+		pattern(px, width, height, i);
+		//Truncation every other frame, so the spill lands in a full frame
+		size_t const n = g.frame(px.data(), out.data(), i % 2 ? Csi2::inject_t() : inj);
+		if (fwrite(out.data(), 1, n, f) != n)
+		{
+			perror(path);
+			fclose(f);
+			return 1;
+		}
+		total += n;
+	}
+	fclose(f);
+	printf("%u frames %ux%u, %llu bytes\n", frames, width, height, (unsigned long long)total);
+	return 0;
+}
+
+struct check_ctx_t
+{
+	bool verbose;
+};
+
+void onCheckedFrame(void* ctx, Csi2::frame_info_t const& fi, uint16_t const*)
+{
+	check_ctx_t const& c = *static_cast<check_ctx_t*>(ctx);
+	if (!c.verbose && !(fi.errors & ~(uint32_t)Csi2::ERR_ECC_CORRECTED))
+		return;
+	printf("frame %5u: %4u lines, ecc %u/%u, crc %u,", fi.frame_no, fi.lines,
+			fi.ecc_corrected, fi.ecc_errors, fi.crc_errors);
+	printErrors(fi.errors);
+	printf("\n");
+}
+
+int check(uint32_t width, uint32_t height, bool verbose, char const* path)
+{
+	FILE* f = fopen(path, "rb");
+	if (!f)
+	{
+		perror(path);
+		return 1;
+	}
+	check_ctx_t ctx = {verbose};
+	Csi2::Parser p(width, height, &onCheckedFrame, &ctx);
+	std::vector<uint8_t> buf(4 << 20);
+	clk::time_point const t0 = clk::now();
+	size_t n;
+	while ((n = fread(buf.data(), 1, buf.size(), f)) > 0)
+		p.feed(buf.data(), n);
+	p.finish();
+	double const s = seconds(t0);
+	fclose(f);
+
+	Csi2::stats_t const& st = p.stats();
+	printf("%llu bytes, %llu packets, %u frames (%u bad), ecc %u corrected %u failed, crc %u, "
+			"%llu bytes skipped, %.2f GB/s\n",
+			(unsigned long long)st.bytes, (unsigned long long)st.packets, st.frames, st.bad_frames,
+			st.ecc_corrected, st.ecc_errors, st.crc_errors, (unsigned long long)st.skipped,
+			s > 0 ? st.bytes / s / 1e9 : 0.0);
+	return st.bad_frames ? 1 : 0;
+}
+
+struct collect_t
+{
+	std::vector<Csi2::frame_info_t> frames;
+	std::vector<uint16_t> const* expect;
+	uint32_t pixel_errors;
+};
+
+void onCollectedFrame(void* ctx, Csi2::frame_info_t const& fi, uint16_t const* px)
+{
+	collect_t& c = *static_cast<collect_t*>(ctx);
+	c.frames.push_back(fi);
+	if (!(fi.errors & ~(uint32_t)Csi2::ERR_ECC_CORRECTED) && c.expect && memcmp(px, c.expect->data(), c.expect->size() * 2))
+		++c.pixel_errors;
+}
+
+/*!
+ * \brief Generates frames with the given faults on the first, parses the
+ * stream fed in odd-sized pieces and returns the frames received.
+ */
+collect_t roundTrip(uint32_t width, uint32_t height, uint32_t frames, Csi2::inject_t const& inj)
+{
+	Csi2::Generator g(width, height);
+	std::vector<uint16_t> px((size_t)width * height);
+	std::vector<uint16_t> rx(px.size());
+	std::vector<uint8_t> out(g.maxFrameBytes());
+	collect_t c = {{}, &px, 0};
+	Csi2::Parser p(width, height, &onCollectedFrame, &c, rx.data());
+	pattern(px, width, height, 0);
+	for (uint32_t i = 0; i < frames; ++i)
+	{
+		size_t const n = g.frame(px.data(), out.data(), i ? Csi2::inject_t() : inj);
+		for (size_t off = 0; off < n; off += 997)
+			p.feed(out.data() + off, n - off < 997 ? n - off : 997);
+	}
+	p.finish();
+	return c;
+}
+
+int expect(char const* name, bool ok)
+{
+	printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+int selftest(uint32_t width, uint32_t height)
+{
+	int failures = 0;
+	Csi2::header_t h;
+	uint8_t hdr[4];
+
+	Csi2::put_header({0, Csi2::DT_RAW10, (uint16_t)Csi2::raw10_line_bytes(width)}, hdr);
+	bool single = true;
+	for (int bit = 0; bit < 30; ++bit)
+	{
+		uint8_t bad[4];
+		memcpy(bad, hdr, 4);
+		bad[bit / 8] ^= 1 << (bit % 8);
+		single &= Csi2::get_header(bad, h) == Csi2::ECC_CORRECTED && h.dt == Csi2::DT_RAW10 &&
+				h.wc == Csi2::raw10_line_bytes(width);
+	}
+	failures += expect("header ECC corrects every single bit", single);
+	bool dbl = true;
+	for (int a = 0; a < 24; ++a)
+	{
+		for (int b = a + 1; b < 24; ++b)
+		{
+			uint8_t bad[4];
+			memcpy(bad, hdr, 4);
+			bad[a / 8] ^= 1 << (a % 8);
+			bad[b / 8] ^= 1 << (b % 8);
+			dbl &= Csi2::get_header(bad, h) == Csi2::ECC_UNCORRECTABLE;
+		}
+	}
+	failures += expect("header ECC detects double data bit errors", dbl);
+
+	collect_t c = roundTrip(width, height, 3, Csi2::inject_t());
+	failures += expect("clean frames round trip", c.frames.size() == 3 && !c.pixel_errors &&
+			!c.frames[0].errors && !c.frames[1].errors && !c.frames[2].errors && c.frames[2].frame_no == 3);
+
+	Csi2::inject_t inj = Csi2::inject_t();
+	inj.truncate_at = height * 5 / 6 + 1;
+	inj.spill = true;
+	c = roundTrip(width, height, 2, inj);
+	failures += expect("truncated VTS: short frame, then long frame",
+			c.frames.size() == 2 && c.frames[0].lines == inj.truncate_at && c.frames[0].errors == Csi2::ERR_SHORT &&
+			c.frames[1].lines == 2 * height - inj.truncate_at && c.frames[1].errors == Csi2::ERR_LONG);
+
+	inj = Csi2::inject_t();
+	inj.ecc_line = 5;
+	inj.ecc_bits = 1 << 13;
+	c = roundTrip(width, height, 1, inj);
+	failures += expect("single header bit error corrected", c.frames.size() == 1 && !c.pixel_errors &&
+			c.frames[0].errors == Csi2::ERR_ECC_CORRECTED && c.frames[0].lines == height);
+
+	inj.ecc_bits = 1 << 2 | 1 << 9;
+	c = roundTrip(width, height, 2, inj);
+	failures += expect("double header bit error detected, resynced",
+			c.frames.size() == 2 && (c.frames[0].errors & Csi2::ERR_ECC) && !c.frames[1].errors);
+
+	inj = Csi2::inject_t();
+	inj.crc_line = height;
+	c = roundTrip(width, height, 1, inj);
+	failures += expect("payload CRC error detected", c.frames.size() == 1 &&
+			c.frames[0].errors == Csi2::ERR_CRC && c.frames[0].crc_errors == 1);
+
+	uint8_t const check_string[] = "123456789";
+	failures += expect("CRC-16 check value 0x6F91", crc16(check_string, 9) == 0x6F91 &&
+			crc16_slice8(check_string, 9) == 0x6F91 && crc16_fast(check_string, 9) == 0x6F91);
+	std::vector<uint8_t> buf(4096 + 15);
+	for (size_t i = 0; i < buf.size(); ++i)
+		buf[i] = (uint8_t)(i * 131 + (i >> 7));
+	bool agree = true;
+	for (size_t len = 0; len <= 4096; len += len < 300 ? 1 : 97)
+		for (size_t off = 0; off < 16; off += 5)
+			agree &= crc16_fast(&buf[off], len, (uint16_t)len) == crc16(&buf[off], len, (uint16_t)len) &&
+					crc16_slice8(&buf[off], len, (uint16_t)len) == crc16(&buf[off], len, (uint16_t)len);
+	failures += expect("CRC-16 paths agree on all lengths", agree);
+	return failures ? 1 : 0;
+}
+
+int bench(size_t mib)
+{
+	std::vector<uint8_t> buf(mib << 20);
+	uint32_t x = 1;
+	for (uint8_t& b : buf)
+	{
+		x = x * 1664525 + 1013904223;
+		b = x >> 24;
+	}
+	typedef uint16_t (*crc_fn)(uint8_t const*, size_t, uint16_t);
+	struct path_t { char const* name; crc_fn fn; bool available; };
+	path_t const paths[] = {
+		{"nibble", &crc16, true},
+		{"slice-by-8", &crc16_slice8, true},
+#if CRC16_CLMUL
+		{"clmul", &crc16_clmul, __builtin_cpu_supports("pclmul") != 0},
+#endif
+	};
+	uint16_t const ref = crc16_slice8(buf.data(), buf.size(), 0xFFFF);
+	int failures = 0;
+	for (path_t const& p : paths)
+	{
+		if (!p.available)
+		{
+			printf("%-12s not supported by this CPU\n", p.name);
+			continue;
+		}
+		clk::time_point const t0 = clk::now();
+		uint16_t const crc = p.fn(buf.data(), buf.size(), 0xFFFF);
+		double const s = seconds(t0);
+		printf("%-12s %8.3f GB/s  0x%04x %s\n", p.name, buf.size() / s / 1e9, crc, crc == ref ? "" : "MISMATCH");
+		failures += crc != ref;
+	}
+	return failures ? 1 : 0;
+}
+
+void usage(char const* argv0)
+{
+	fprintf(stderr, "usage: %s gen [-w W] [-h H] [-n frames] [-t line] [-s] [-l] out.bin\n"
+			"       %s check [-w W] [-h H] [-v] in.bin\n"
+			"       %s selftest [-w W] [-h H]\n"
+			"       %s bench [-m MiB]\n", argv0, argv0, argv0, argv0);
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		usage(argv[0]);
+		return 2;
+	}
+	char const* const cmd = argv[1];
+	uint32_t width = 640, height = 480, frames = 8;
+	size_t mib = 256;
+	bool line_sync = false, verbose = false;
+	Csi2::inject_t inj = Csi2::inject_t();
+	int opt;
+	optind = 2;
+	while ((opt = getopt(argc, argv, "w:h:n:t:slvm:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'w': width = strtoul(optarg, NULL, 0); break;
+		case 'h': height = strtoul(optarg, NULL, 0); break;
+		case 'n': frames = strtoul(optarg, NULL, 0); break;
+		case 't': inj.truncate_at = strtoul(optarg, NULL, 0); break;
+		case 's': inj.spill = true; break;
+		case 'l': line_sync = true; break;
+		case 'v': verbose = true; break;
+		case 'm': mib = strtoul(optarg, NULL, 0); break;
+		default:
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	char const* const path = optind < argc ? argv[optind] : NULL;
+
+	try
+	{
+		if (!strcmp(cmd, "gen") && path)
+			return gen(width, height, frames, inj, line_sync, path);
+		if (!strcmp(cmd, "check") && path)
+			return check(width, height, verbose, path);
+		if (!strcmp(cmd, "selftest"))
+			return selftest(width, height);
+		if (!strcmp(cmd, "bench"))
+			return bench(mib);
+	}
+	catch (std::exception const& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	usage(argv[0]);
+	return 2;
+}
@@ -0,0 +1,193 @@
+/*
+ * logdecode.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Decodes a raw dump of the deferred log ring (src/util/Log.h) using the
+ * firmware ELF to resolve format strings and %s arguments.
+ *
+ *   g++ -std=gnu++17 -O2 -o logdecode logdecode.cc
+ *   logdecode app.elf log.bin
+ *
+ * The dump is the memory image of digilent::Log::ring, e.g. from xsct:
+ *   mrd -bin -file log.bin [symbol address] 3080
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <elf.h>
+
+namespace {
+
+// Target-side (32-bit ARM) layout of Log::entry_t and Log::ring_t
+struct entry32_t
+{
+	uint32_t seq;
+	uint32_t fmt;
+	uint64_t ticks;
+	uint8_t level;
+	uint8_t nargs;
+	uint16_t reserved;
+	uint32_t args[6];
+};
+struct ring32_t
+{
+	uint32_t magic, size, entry_size, ticks_per_us, head, tail, dropped, reserved;
+};
+static_assert(sizeof(entry32_t) == 48, "must match the ARM layout");
+
+std::vector<uint8_t> load(char const* path)
+{
+	FILE* f = fopen(path, "rb");
+	if (!f)
+	{
+		perror(path);
+		exit(1);
+	}
+	std::vector<uint8_t> data;
+	uint8_t buf[65536];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		data.insert(data.end(), buf, buf + n);
+	fclose(f);
+	return data;
+}
+
+/*!
+ * Loaded sections of a 32-bit ELF, for reading strings by target address.
+ */
+class Elf
+{
+public:
+	explicit Elf(char const* path) : data_(load(path))
+	{
+		if (data_.size() < sizeof(Elf32_Ehdr) || memcmp(data_.data(), ELFMAG, SELFMAG) ||
+			data_[EI_CLASS] != ELFCLASS32)
+		{
+			fprintf(stderr, "%s: not a 32-bit ELF\n", path);
+			exit(1);
+		}
+		Elf32_Ehdr const* eh = reinterpret_cast<Elf32_Ehdr const*>(data_.data());
+		for (unsigned i = 0; i < eh->e_shnum; ++i)
+		{
+			Elf32_Shdr const* sh = reinterpret_cast<Elf32_Shdr const*>(
+					data_.data() + eh->e_shoff + i * eh->e_shentsize);
+			if ((sh->sh_flags & SHF_ALLOC) && sh->sh_type == SHT_PROGBITS)
+				sections_.push_back(*sh);
+		}
+	}
+
+	char const* string(uint32_t addr) const
+	{
+		for (Elf32_Shdr const& sh : sections_)
+		{
+			if (addr >= sh.sh_addr && addr < sh.sh_addr + sh.sh_size)
+				return reinterpret_cast<char const*>(data_.data() + sh.sh_offset + (addr - sh.sh_addr));
+		}
+		return NULL;
+	}
+
+private:
+	std::vector<uint8_t> data_;
+	std::vector<Elf32_Shdr> sections_;
+};
+
+//! printf for one entry, with %s arguments looked up in the ELF
+std::string format(Elf const& elf, char const* fmt, entry32_t const& e)
+{
+	std::string out;
+	unsigned arg = 0;
+	char buf[256];
+	for (char const* p = fmt; *p; ++p)
+	{
+		if (*p != '%')
+		{
+			out += *p;
+			continue;
+		}
+		char const* start = p++;
+		while (*p && strchr("-+ #0123456789.l", *p)) ++p;
+		if (!*p) break;
+		if (*p == '%')
+		{
+			out += '%';
+			continue;
+		}
+		std::string spec(start, p - start);
+		//Arguments are 32-bit on the target, drop length modifiers
+		spec.erase(std::remove(spec.begin(), spec.end(), 'l'), spec.end());
+		spec += *p;
+		uint32_t const v = arg < e.nargs ? e.args[arg] : 0;
+		++arg;
+		if (*p == 's')
+		{
+			char const* s = elf.string(v);
+			snprintf(buf, sizeof(buf), spec.c_str(), s ? s : "(?)");
+		}
+		else
+		{
+			snprintf(buf, sizeof(buf), spec.c_str(), v);
+		}
+		out += buf;
+	}
+	return out;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: logdecode <app.elf> <log.bin>\n");
+		return 1;
+	}
+	Elf const elf(argv[1]);
+	std::vector<uint8_t> const dump = load(argv[2]);
+	if (dump.size() < sizeof(ring32_t))
+	{
+		fprintf(stderr, "dump too short\n");
+		return 1;
+	}
+	ring32_t hdr;
+	memcpy(&hdr, dump.data(), sizeof(hdr));
+	if (hdr.magic != 0x31474F4C || hdr.entry_size != sizeof(entry32_t) ||
+		dump.size() < sizeof(hdr) + (size_t)hdr.size * hdr.entry_size || !hdr.ticks_per_us)
+	{
+		fprintf(stderr, "not a log ring dump (magic %08x, entry size %u)\n", hdr.magic, hdr.entry_size);
+		return 1;
+	}
+
+	static char const* const levels[] = {"DBG", "INF", "WRN", "ERR"};
+	//Everything still in the ring, including entries already drained on the UART
+	uint32_t const first = hdr.head >= hdr.size ? hdr.head - hdr.size : 0;
+	for (uint32_t idx = first; idx != hdr.head; ++idx)
+	{
+		entry32_t e;
+		memcpy(&e, dump.data() + sizeof(hdr) + (idx % hdr.size) * sizeof(e), sizeof(e));
+		if (e.seq != idx + 1)
+		{
+			printf("[entry %u incomplete]\n", idx);
+			continue;
+		}
+		if (idx == hdr.tail)
+			printf("---- not yet drained ----\n");
+		uint64_t const us = e.ticks / hdr.ticks_per_us;
+		char const* fmt = elf.string(e.fmt);
+		std::string line = fmt ? format(elf, fmt, e) : "(unknown format string)\n";
+		while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+			line.pop_back();
+		printf("[%5u.%06u %s] %s\n", (unsigned)(us / 1000000), (unsigned)(us % 1000000),
+				levels[e.level & 3], line.c_str());
+	}
+	if (hdr.dropped)
+		printf("[%u entries dropped]\n", hdr.dropped);
+	return 0;
+}
@@ -0,0 +1,410 @@
+/*
+ * regtool.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host side of the binary register protocol (src/proto/RegProtocol.h).
+ *
+ *   g++ -std=gnu++17 -O2 -I../src -o regtool regtool.cc
+ *
+ *   regtool -d /dev/ttyUSB1 ping
+ *   regtool -d /dev/ttyUSB1 rr 300a 300b
+ *   regtool -d /dev/ttyUSB1 wr 503d 80 [addr val ...]
+ *   regtool -d /dev/ttyUSB1 dump 3000 6fff [out.txt]
+ *   regtool -d /dev/ttyUSB1 upload table.txt      (lines of "addr val", hex)
+ *   regtool -d /dev/ttyUSB1 mr 43c20000 [addr ...]
+ *   regtool -d /dev/ttyUSB1 mw 43c20000 1 [addr val ...]
+ *   regtool -d /dev/ttyUSB1 mdump 43000000 40
+ *
+ *   regtool serve-sim
+ *       Serves the protocol on a pseudo terminal over simulated registers and
+ *       prints the pty path, for testing the tool and protocol end to end.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "proto/RegProtocol.h"
+
+using namespace digilent;
+
+namespace {
+
+int open_port(char const* path)
+{
+	int fd = open(path, O_RDWR | O_NOCTTY);
+	if (fd < 0)
+	{
+		perror(path);
+		exit(1);
+	}
+	termios tio;
+	if (tcgetattr(fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, B115200);
+		cfsetospeed(&tio, B115200);
+		tio.c_cflag |= CLOCAL | CREAD;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+void write_all(int fd, uint8_t const* buf, size_t len)
+{
+	while (len)
+	{
+		ssize_t n = write(fd, buf, len);
+		if (n < 0)
+		{
+			if (errno == EINTR) continue;
+			perror("write");
+			exit(1);
+		}
+		buf += n;
+		len -= n;
+	}
+}
+
+/*!
+ * Collects 0x00-delimited frames from a byte stream, skipping text between them.
+ */
+class FrameReader
+{
+public:
+	explicit FrameReader(int fd) : fd_(fd) {}
+
+	//! Next non-empty frame, false on timeout
+	bool next(std::vector<uint8_t>& frame, int timeout_ms)
+	{
+		frame.clear();
+		bool in_frame = false;
+		for (;;)
+		{
+			uint8_t c;
+			if (!get(c, timeout_ms))
+				return false;
+			if (c != 0)
+			{
+				if (in_frame) frame.push_back(c);
+				continue;
+			}
+			if (in_frame && !frame.empty())
+				return true;
+			in_frame = true;
+			frame.clear();
+		}
+	}
+
+private:
+	bool get(uint8_t& c, int timeout_ms)
+	{
+		if (pos_ == len_)
+		{
+			fd_set rd;
+			FD_ZERO(&rd);
+			FD_SET(fd_, &rd);
+			timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+			if (select(fd_ + 1, &rd, NULL, NULL, &tv) <= 0)
+				return false;
+			ssize_t n = read(fd_, buf_, sizeof(buf_));
+			if (n <= 0)
+				return false;
+			pos_ = 0;
+			len_ = n;
+		}
+		c = buf_[pos_++];
+		return true;
+	}
+
+	int fd_;
+	uint8_t buf_[4096];
+	size_t pos_ = 0, len_ = 0;
+};
+
+class Client
+{
+public:
+	explicit Client(int fd) : fd_(fd), rd_(fd) {}
+
+	/*!
+	 * Sends one request and waits for its response. Returns the status, with
+	 * the response payload in rsp.
+	 */
+	int request(uint8_t op, std::vector<uint8_t> const& payload, std::vector<uint8_t>& rsp)
+	{
+		std::vector<uint8_t> frame(payload.size() + 4);
+		frame[0] = ++seq_;
+		frame[1] = op;
+		memcpy(frame.data() + 2, payload.data(), payload.size());
+		size_t const len = RegProto::seal(frame.data(), payload.size() + 2);
+
+		std::vector<uint8_t> wire(Cobs::max_encoded(len) + 2);
+		wire[0] = 0;
+		size_t const w = Cobs::encode(frame.data(), len, wire.data() + 1);
+		wire[w + 1] = 0;
+		write_all(fd_, wire.data(), w + 2);
+		bytes_ += w + 2;
+
+		std::vector<uint8_t> in;
+		while (rd_.next(in, 3000))
+		{
+			bytes_ += in.size() + 2;
+			size_t n = Cobs::decode(in.data(), in.size(), in.data());
+			n = RegProto::unseal(in.data(), n);
+			if (n < 3 || in[0] != seq_ || in[1] != op)
+				continue; //Stale or corrupt, keep waiting for ours
+			rsp.assign(in.begin() + 3, in.begin() + n);
+			return in[2];
+		}
+		fprintf(stderr, "timeout waiting for response to op 0x%02x\n", op);
+		exit(2);
+	}
+
+	size_t bytes() const { return bytes_; }
+
+private:
+	int fd_;
+	FrameReader rd_;
+	uint8_t seq_ = 0;
+	size_t bytes_ = 0;
+};
+
+char const* status_str(int st)
+{
+	switch (st)
+	{
+	case RegProto::ST_OK: return "ok";
+	case RegProto::ST_ERR_CRC: return "CRC error";
+	case RegProto::ST_ERR_LENGTH: return "bad length";
+	case RegProto::ST_ERR_OP: return "unknown op";
+	case RegProto::ST_ERR_ADDR: return "address outside register windows";
+	case RegProto::ST_ERR_BUS: return "I2C error";
+	default: return "?";
+	}
+}
+
+void check(int st)
+{
+	if (st != RegProto::ST_OK)
+	{
+		fprintf(stderr, "error: %s\n", status_str(st));
+		exit(3);
+	}
+}
+
+uint32_t hex(char const* s) { return strtoul(s, NULL, 16); }
+
+void push16(std::vector<uint8_t>& v, uint16_t x) { v.push_back(x); v.push_back(x >> 8); }
+void push32(std::vector<uint8_t>& v, uint32_t x) { push16(v, x); push16(v, x >> 16); }
+
+double elapsed_s(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int cmd_dump(Client& cl, uint16_t first, uint16_t last, FILE* out)
+{
+	auto const t0 = std::chrono::steady_clock::now();
+	std::vector<uint8_t> rsp;
+	for (uint32_t addr = first; addr <= last; addr += RegProto::payload_max)
+	{
+		uint32_t const count = last - addr + 1 < RegProto::payload_max ? last - addr + 1 : RegProto::payload_max;
+		std::vector<uint8_t> req;
+		push16(req, addr);
+		push16(req, count);
+		check(cl.request(RegProto::OP_I2C_READ_BLOCK, req, rsp));
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if ((addr + i) % 16 == 0 || i == 0) fprintf(out, "%s%04x:", i || addr != first ? "\n" : "", addr + i);
+			fprintf(out, " %02x", rsp[i]);
+		}
+	}
+	fprintf(out, "\n");
+	fprintf(stderr, "%u registers in %.2f s, %zu bytes on the wire\n",
+			last - first + 1, elapsed_s(t0), cl.bytes());
+	return 0;
+}
+
+int cmd_upload(Client& cl, char const* path)
+{
+	FILE* f = fopen(path, "r");
+	if (!f)
+	{
+		perror(path);
+		return 1;
+	}
+	auto const t0 = std::chrono::steady_clock::now();
+	std::vector<uint8_t> req, rsp;
+	unsigned addr, val, total = 0;
+	char line[128];
+	while (fgets(line, sizeof(line), f))
+	{
+		if (sscanf(line, "%x %x", &addr, &val) != 2)
+			continue;
+		req.push_back(addr); req.push_back(addr >> 8); req.push_back(val);
+		++total;
+		if (req.size() + 3 > RegProto::payload_max)
+		{
+			check(cl.request(RegProto::OP_I2C_WRITE, req, rsp));
+			req.clear();
+		}
+	}
+	if (!req.empty())
+		check(cl.request(RegProto::OP_I2C_WRITE, req, rsp));
+	fclose(f);
+	fprintf(stderr, "%u registers written in %.2f s\n", total, elapsed_s(t0));
+	return 0;
+}
+
+/*!
+ * Simulated registers for serve-sim: 64 KiB of sensor registers with the
+ * OV5640 chip ID, and sparse MMIO below a single window.
+ */
+class SimTarget : public RegProto::RegTarget
+{
+public:
+	SimTarget() : regs_(0x10000, 0)
+	{
+		regs_[0x300A] = 0x56;
+		regs_[0x300B] = 0x40;
+	}
+	virtual bool i2cRead(uint16_t addr, uint8_t* buf, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			buf[i] = regs_[(addr + i) & 0xFFFF];
+		return true;
+	}
+	virtual bool i2cWrite(uint16_t addr, uint8_t val)
+	{
+		regs_[addr] = val;
+		return true;
+	}
+	virtual bool mmioAllowed(uint32_t addr) { return !(addr & 3) && addr >= 0x40000000 && addr < 0x80000000; }
+	virtual uint32_t mmioRead(uint32_t addr) { return mmio_[addr]; }
+	virtual void mmioWrite(uint32_t addr, uint32_t val) { mmio_[addr] = val; }
+
+private:
+	std::vector<uint8_t> regs_;
+	std::map<uint32_t, uint32_t> mmio_;
+};
+
+void sim_write(void* ctx, uint8_t const* buf, size_t len)
+{
+	write_all(*static_cast<int*>(ctx), buf, len);
+}
+
+int serve_sim()
+{
+	int fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (fd < 0 || grantpt(fd) || unlockpt(fd))
+	{
+		perror("posix_openpt");
+		return 1;
+	}
+	termios tio;
+	tcgetattr(fd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(fd, TCSANOW, &tio);
+	printf("%s\n", ptsname(fd));
+	fflush(stdout);
+
+	SimTarget tgt;
+	RegProto::Server server(tgt, &sim_write, &fd);
+	FrameReader rd(fd);
+	std::vector<uint8_t> frame;
+	for (;;)
+	{
+		if (rd.next(frame, 60000))
+			server.process(frame.data(), frame.size());
+	}
+}
+
+void usage()
+{
+	fprintf(stderr,
+		"usage: regtool -d <tty> ping | rr <addr>... | wr <addr> <val>... | dump <first> <last> [file]\n"
+		"                        | upload <file> | mr <addr>... | mw <addr> <val>... | mdump <addr> <count>\n"
+		"       regtool serve-sim\n");
+	exit(1);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc >= 2 && !strcmp(argv[1], "serve-sim"))
+		return serve_sim();
+	if (argc < 4 || strcmp(argv[1], "-d"))
+		usage();
+
+	Client cl(open_port(argv[2]));
+	char const* cmd = argv[3];
+	char** args = argv + 4;
+	int const nargs = argc - 4;
+	std::vector<uint8_t> req, rsp;
+
+	if (!strcmp(cmd, "ping"))
+	{
+		auto const t0 = std::chrono::steady_clock::now();
+		check(cl.request(RegProto::OP_PING, req, rsp));
+		printf("protocol v%u, payload max %u, %.1f ms\n", rsp[0], RegProto::get16(&rsp[1]), elapsed_s(t0) * 1000);
+	}
+	else if (!strcmp(cmd, "rr") && nargs > 0)
+	{
+		for (int i = 0; i < nargs; ++i) push16(req, hex(args[i]));
+		check(cl.request(RegProto::OP_I2C_READ, req, rsp));
+		for (int i = 0; i < nargs; ++i) printf("0x%04x = 0x%02x\n", hex(args[i]), rsp[i]);
+	}
+	else if (!strcmp(cmd, "wr") && nargs > 0 && nargs % 2 == 0)
+	{
+		for (int i = 0; i < nargs; i += 2) { push16(req, hex(args[i])); req.push_back(hex(args[i + 1])); }
+		check(cl.request(RegProto::OP_I2C_WRITE, req, rsp));
+	}
+	else if (!strcmp(cmd, "dump") && nargs >= 2)
+	{
+		FILE* out = nargs > 2 ? fopen(args[2], "w") : stdout;
+		if (!out) { perror(args[2]); return 1; }
+		return cmd_dump(cl, hex(args[0]), hex(args[1]), out);
+	}
+	else if (!strcmp(cmd, "upload") && nargs == 1)
+	{
+		return cmd_upload(cl, args[0]);
+	}
+	else if (!strcmp(cmd, "mr") && nargs > 0)
+	{
+		for (int i = 0; i < nargs; ++i) push32(req, hex(args[i]));
+		check(cl.request(RegProto::OP_MMIO_READ, req, rsp));
+		for (int i = 0; i < nargs; ++i) printf("0x%08x = 0x%08x\n", hex(args[i]), RegProto::get32(&rsp[4 * i]));
+	}
+	else if (!strcmp(cmd, "mw") && nargs > 0 && nargs % 2 == 0)
+	{
+		for (int i = 0; i < nargs; ++i) push32(req, hex(args[i]));
+		check(cl.request(RegProto::OP_MMIO_WRITE, req, rsp));
+	}
+	else if (!strcmp(cmd, "mdump") && nargs == 2)
+	{
+		uint32_t const addr = hex(args[0]);
+		push32(req, addr);
+		push16(req, hex(args[1]));
+		check(cl.request(RegProto::OP_MMIO_READ_BLOCK, req, rsp));
+		for (size_t i = 0; i < rsp.size() / 4; ++i)
+			printf("0x%08x = 0x%08x\n", addr + 4 * (unsigned)i, RegProto::get32(&rsp[4 * i]));
+	}
+	else
+	{
+		usage();
+	}
+	return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * selftest.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Checks of the firmware's pure modules, the ones that touch no hardware,
+ * against known values.
+ *
+ *   selftest [section...]
+ *
+ *   mmcm   MMCM::solve() for the baseline pixel clocks, register packing
+ *          and an unreachable frequency
+ *   ring   RingBuffer full, wrap-around and drop count
+ *   line   LineParser line endings, erase, overlong input and splitting
+ *   sweep  TimingSweep::bisect() against a threshold: result, granularity
+ *          and number of tries
+ *
+ * With no section given, all run. Exits non-zero on a failed check.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cli/LineParser.h"
+#include "hdmi/MMCM.h"
+#include "pipeline/TimingSweep.h"
+#include "util/RingBuffer.h"
+
+using namespace digilent;
+
+namespace {
+
+int expect(char const* name, bool ok)
+{
+	printf("%-52s %s\n", name, ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+//One pixel clock x5 from the 100 MHz video_dynclk reference
+int mmcmRow(char const* name, uint32_t pclk_Hz, uint8_t div, uint16_t mul_x8, uint16_t out_x8)
+{
+	MMCM::limits_t const lim;
+	MMCM::setting_t const s = MMCM::solve(100000000, 5 * pclk_Hz);
+	bool const ok = s.valid && s.div == div && s.mul_x8 == mul_x8 && s.out_x8 == out_x8 &&
+			s.vco_Hz >= lim.vco_min_Hz && s.vco_Hz <= lim.vco_max_Hz &&
+			s.error_ppm >= -50 && s.error_ppm <= 50;
+	if (!ok)
+		printf("  got valid %d D %u M %u/8 O0 %u/8 VCO %u Hz, %d ppm\n", s.valid, s.div, s.mul_x8, s.out_x8,
+				s.vco_Hz, s.error_ppm);
+	return expect(name, ok);
+}
+
+int mmcm()
+{
+	int failures = 0;
+	failures += mmcmRow("MMCM 148.5 MHz x5: D 5 M 37.125 O0 1", 148500000, 5, 297, 8);
+	failures += mmcmRow("MMCM 74.25 MHz x5: D 4 M 37.125 O0 2.5", 74250000, 4, 297, 20);
+	failures += mmcmRow("MMCM 25.2 MHz x5: D 2 M 23.625 O0 9.375", 25200000, 2, 189, 75);
+
+	//Both fractional parts in thousandths: 625 and 375
+	MMCM::setting_t const s = MMCM::solve(100000000, 5 * 25200000);
+	failures += expect("MMCM 25.2 MHz x5 config 0 = 0x02711702", MMCM::reg_config0(s) == 0x02711702);
+	failures += expect("MMCM 25.2 MHz x5 config 2 = 0x00017709", MMCM::reg_config2(s) == 0x00017709);
+
+	failures += expect("MMCM above the output limit is invalid", !MMCM::solve(100000000, 810000000).valid);
+	failures += expect("MMCM without a reference is invalid", !MMCM::solve(0, 742500000).valid);
+	return failures;
+}
+
+int ring()
+{
+	int failures = 0;
+	RingBuffer<uint32_t, 4> r;
+	bool pushed = true;
+	for (uint32_t i = 0; i < 4; ++i)
+		pushed &= r.push(i);
+	failures += expect("ring takes capacity elements", pushed && r.size() == 4);
+	failures += expect("ring refuses a push when full", !r.push(99) && !r.push(99) && r.size() == 4);
+	failures += expect("ring counts refused pushes as dropped", r.dropped() == 2);
+
+	//Drain half and refill: indices run past N and wrap
+	uint32_t v = 0;
+	bool order = true;
+	for (uint32_t i = 0; i < 2; ++i)
+		order &= r.pop(v) && v == i;
+	for (uint32_t i = 4; i < 6; ++i)
+		order &= r.push(i);
+	for (uint32_t i = 2; i < 6; ++i)
+		order &= r.pop(v) && v == i;
+	failures += expect("ring keeps FIFO order across the wrap", order);
+	failures += expect("ring pop on empty fails", r.empty() && !r.pop(v));
+	failures += expect("ring drop count unchanged by pops", r.dropped() == 2);
+	return failures;
+}
+
+char last_line[64];
+
+//Feeds text, returning the number of EV_LINE events. line() is only valid
+//until the next feed(), so the last line is copied to last_line.
+template <size_t N>
+int feedLines(LineParser<N>& p, char const* text, int* erased = nullptr)
+{
+	int lines = 0;
+	last_line[0] = '\0';
+	for (; *text; ++text)
+	{
+		typename LineParser<N>::Event const e = p.feed(*text);
+		if (e == LineParser<N>::EV_LINE)
+		{
+			++lines;
+			snprintf(last_line, sizeof(last_line), "%s", p.line());
+		}
+		else if (e == LineParser<N>::EV_ERASE && erased)
+			++*erased;
+	}
+	return lines;
+}
+
+int line()
+{
+	int failures = 0;
+	{
+		LineParser<32> p;
+		failures += expect("line ends on CR", feedLines(p, "res 3\r") == 1 && !strcmp(last_line, "res 3"));
+		failures += expect("line ends on LF", feedLines(p, "res 4\n") == 1 && !strcmp(last_line, "res 4"));
+		failures += expect("line ends once on CR LF", feedLines(p, "res 5\r\n") == 1 && !strcmp(last_line, "res 5"));
+		failures += expect("line LF after CR LF is an empty line", feedLines(p, "\n") == 1 && !last_line[0]);
+	}
+	{
+		LineParser<32> p;
+		int erased = 0;
+		bool const none = p.feed('\b') == LineParser<32>::EV_NONE && p.feed(127) == LineParser<32>::EV_NONE;
+		failures += expect("line backspace at column 0 does nothing", none && !p.length());
+		feedLines(p, "abx\b\bc\r", &erased);
+		failures += expect("line backspace erases", erased == 2 && !strcmp(last_line, "ac"));
+	}
+	{
+		LineParser<8> p;
+		bool const line = feedLines(p, "0123456789\r") == 1;
+		failures += expect("line keeps N-1 characters of an overlong line", line && !strcmp(last_line, "0123456"));
+		failures += expect("line ignores control characters", feedLines(p, "a\tb\x1b\r") == 1 && !strcmp(last_line, "ab"));
+	}
+	{
+		char text[] = "  reg  0x3008 0x42 ";
+		char* argv[4];
+		int const argc = LineParser<32>::split(text, argv, 4);
+		failures += expect("line split on runs of spaces", argc == 3 && !strcmp(argv[0], "reg") &&
+				!strcmp(argv[1], "0x3008") && !strcmp(argv[2], "0x42"));
+		char more[] = "a b c d";
+		failures += expect("line split stops at max words", LineParser<32>::split(more, argv, 2) == 2 &&
+				!strcmp(argv[0], "a") && !strcmp(argv[1], "b"));
+		char blank[] = "   ";
+		failures += expect("line split of blanks has no words", LineParser<32>::split(blank, argv, 4) == 0);
+	}
+	return failures;
+}
+
+/*
+ * One bisection against a sensor that is stable from threshold up. The
+ * result must be stable, within step of the threshold, and found in at most
+ * the floor try plus ceil(log2(range / step)) halvings.
+ */
+int bisectRow(char const* name, int32_t floor, int32_t nominal, uint16_t step, int32_t threshold,
+		int32_t expected = -1)
+{
+	int tries = 0;
+	int32_t const got = TimingSweep::bisect(floor, nominal, step, [&](int32_t v) {
+		++tries;
+		return v >= threshold;
+	});
+	int32_t const range = nominal > floor ? nominal - floor : 0;
+	int32_t const grain = step ? step : 1;
+	int max_tries = range ? 1 : 0;
+	for (int32_t r = grain; r < range; r *= 2)
+		++max_tries;
+	bool ok = tries <= max_tries;
+	if (expected >= 0)
+		ok = ok && got == expected;
+	else
+		ok = ok && got >= threshold && got - threshold < grain;
+	if (!ok)
+		printf("  got %d after %d tries, at most %d expected\n", got, tries, max_tries);
+	return expect(name, ok);
+}
+
+int sweep()
+{
+	int failures = 0;
+	//720p at 60 fps: VTS 750 nominal, floor 720 + 4
+	failures += bisectRow("sweep stable floor is taken in one try", 724, 750, 16, 700, 724);
+	failures += bisectRow("sweep only nominal stable returns nominal", 724, 750, 16, 750, 750);
+	failures += bisectRow("sweep VTS threshold within 16 lines", 724, 1000, 16, 901);
+	failures += bisectRow("sweep HTS threshold within 32 clocks", 1280, 1892, 32, 1433);
+	failures += bisectRow("sweep step 0 resolves to 1", 1000, 1100, 0, 1037, 1037);
+	failures += bisectRow("sweep threshold just above the floor", 724, 1000, 16, 725);
+	failures += bisectRow("sweep floor at nominal tries nothing", 750, 750, 16, 0, 750);
+	return failures;
+}
+
+struct section_t
+{
+	char const* name;
+	int (*run)();
+};
+
+section_t const sections[] = {
+	{"mmcm", &mmcm},
+	{"ring", &ring},
+	{"line", &line},
+	{"sweep", &sweep},
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	int failures = 0;
+	for (section_t const& s : sections)
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; ++i)
+			selected |= !strcmp(argv[i], s.name);
+		if (selected)
+			failures += s.run();
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,329 @@
+/*
+ * Ov5640Sim.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OV5640SIM_H_
+#define OV5640SIM_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Sim.h"
+
+#include "ov5640/I2C_Client.h"
+#include "ov5640/OV5640.h"
+
+namespace digilent {
+namespace Sim {
+
+/*!
+ * \brief OV5640 register map behind an I2C_Client, for the firmware's OV5640
+ * class to talk to. Models what the bring-up and mode change depend on: power
+ * (no power, every transfer NACKs), the chip ID, software reset (0x3008[7],
+ * back to defaults at once), software power down (0x3008[6]), the
+ * sequential register pointer, group hold on group 0 (0x3212), launched at
+ * the next frame start while streaming, and the output size and timing
+ * registers. The liquid lens answers on its own address and
+ * keeps the last byte written.
+ *
+ * With a focus target set the scene is a stripe pattern whose contrast
+ * falls off with the difference between the target's power and the lens's,
+ * a bent curve of the code that shifts with the lens temperature.
+ *
+ * The image level is mid-grey while the sensor's AEC/AGC run; with manual
+ * exposure (0x3503) it follows exposure x gain against a scene brightness,
+ * and the average luma register (0x56A1) reads it back. Colour is neutral
+ * while the sensor's AWB runs; with manual AWB gains (0x3406) each channel
+ * is the scene illuminant times its gain.
+ *
+ * The frame rate is derived from the PLL, HTS and VTS registers through a
+ * pixel clock table learned from the firmware's mode tables (calibrate()),
+ * so HTS/VTS changes move it the way they would on the sensor.
+ */
+class Ov5640Sim : public I2C_Client
+{
+public:
+	static uint8_t const dev_address = 0x78 >> 1;
+	static uint8_t const lens_address = 0x46 >> 1;
+
+	Ov5640Sim()
+	{
+		defaults();
+		calibrate();
+	}
+
+	void setPower(bool on)
+	{
+		if (on && !powered_)
+			defaults();
+		powered_ = on;
+	}
+	bool powered() const { return powered_; }
+
+	void read(uint8_t addr, uint8_t* buf, size_t count) override
+	{
+		i2cTransfer(count, true);
+		ack(addr);
+		for (size_t i = 0; i < count; ++i)
+		{
+			buf[i] = addr == lens_address ? lens_ : ptr_ == 0x56a1 ? level() : regs_[ptr_];
+			if (addr != lens_address)
+				ptr_ = (uint16_t)(ptr_ + 1);
+		}
+	}
+
+	void write(uint8_t addr, uint8_t const* buf, size_t count) override
+	{
+		i2cTransfer(count, false);
+		ack(addr);
+		if (addr == lens_address)
+		{
+			if (count)
+				lens_ = buf[count - 1];
+			return;
+		}
+		if (count < 2)
+			return;
+		ptr_ = (uint16_t)((buf[0] << 8) | buf[1]);
+		for (size_t i = 2; i < count; ++i)
+		{
+			store(ptr_, buf[i]);
+			ptr_ = (uint16_t)(ptr_ + 1);
+		}
+	}
+
+	//! \brief Start of a frame: a launched group takes effect
+	void frameStart()
+	{
+		if (group_launched_)
+			launch();
+	}
+
+	uint8_t reg(uint16_t addr) const { return regs_[addr]; }
+	uint8_t lens() const { return lens_; }
+
+	//! \brief Powered and out of software power down
+	bool streaming() const { return powered_ && !(regs_[0x3008] & 0x40); }
+	//! \brief Pre-ISP colour bar pattern enabled
+	bool testPattern() const { return regs_[OV5640_cfg::OV5640_REG_PRE_ISP_TEST_SET1] & 0x80; }
+	uint16_t width() const { return reg16(0x3808) & 0x0FFF; }
+	uint16_t height() const { return reg16(0x380a) & 0x07FF; }
+	uint16_t hts() const { return reg16(0x380c) & 0x1FFF; }
+	uint16_t vts() const { return reg16(0x380e); }
+
+	//! \brief Exposure x gain, in 1/16 lines times 1/16 gain, that gives mid-grey
+	void setScene(uint32_t scene) { scene_ = scene ? scene : 1; }
+	//! \brief Illuminant colour in 1/1024, what a grey scene gives at unity AWB gains
+	void setIlluminant(uint16_t r, uint16_t g, uint16_t b) { illum_[0] = r; illum_[1] = g; illum_[2] = b; }
+	//! \brief Pixel level of R, G, B, neutral under the sensor's own AWB
+	void rgb(uint8_t out[3]) const
+	{
+		uint8_t const l = level();
+		for (int c = 0; c < 3; ++c)
+		{
+			if (!(regs_[0x3406] & 0x01))
+			{
+				out[c] = l;
+				continue;
+			}
+			uint32_t const gain = reg16(0x3400 + 2 * c) & 0x0FFF;
+			uint64_t const v = (uint64_t)l * illum_[c] * gain >> 20;
+			out[c] = v > 0xFF ? 0xFF : (uint8_t)v;
+		}
+	}
+	//! \brief Target distance as power in milli-dioptres, 0 for infinity, -1 for a flat scene
+	void setFocusTarget(int32_t mdpt) { target_mdpt_ = mdpt; }
+	void setLensTemp(int16_t temp_c) { lens_temp_ = temp_c; }
+	//! \brief Lens power for a code at the lens temperature
+	int32_t lensPower(uint8_t code) const
+	{
+		return -2000 + 40 * code + code * code / 8 + lens_tc * (lens_temp_ - 25);
+	}
+	//! \brief Code whose power is nearest the target's
+	uint8_t focusCode() const
+	{
+		uint8_t best = 0;
+		for (int c = 1; c <= 0xFF; ++c)
+			if (abs(lensPower((uint8_t)c) - target_mdpt_) < abs(lensPower(best) - target_mdpt_))
+				best = (uint8_t)c;
+		return best;
+	}
+	//! \brief Peak to peak stripe amplitude, 0 for a flat scene
+	uint8_t contrast() const
+	{
+		if (target_mdpt_ < 0)
+			return 0;
+		int32_t const e = abs(lensPower(lens_) - target_mdpt_);
+		return (uint8_t)(96 * 400 / (400 + e));
+	}
+	//! \brief Lens drift per degree the model uses
+	static int16_t const lens_tc = -30;
+
+	//! \brief Pixel level, mid-grey under the sensor's own AEC/AGC
+	uint8_t level() const
+	{
+		if ((regs_[0x3503] & 0x03) != 0x03)
+			return 0x80;
+		uint32_t const lines_x16 = ((uint32_t)(regs_[0x3500] & 0x0F) << 16) | (regs_[0x3501] << 8) | regs_[0x3502];
+		uint32_t const gain_x16 = ((regs_[0x350a] & 0x03) << 8) | regs_[0x350b];
+		uint64_t const v = (uint64_t)lines_x16 * gain_x16 * 0x80 / scene_;
+		return v > 0xFF ? 0xFF : (uint8_t)v;
+	}
+
+	//! \brief Frame period for the current PLL and timing registers
+	uint64_t framePeriodNs() const
+	{
+		uint64_t const pclk = pclkHz();
+		uint64_t const pixels = (uint64_t)hts() * vts();
+		if (!pclk || !pixels)
+			return 1000000000ull / 30;
+		return pixels * 1000000000ull / pclk;
+	}
+
+private:
+	using pll_t = struct { uint8_t r3035, r3036, r3037, r3108; uint16_t width, height; uint64_t pclk_Hz; };
+	static size_t const pll_max = OV5640_cfg::MODE_END;
+
+	void ack(uint8_t addr)
+	{
+		if (!powered_ || (addr != dev_address && addr != lens_address))
+		{
+			++stats.i2c_nacks;
+			throw TransmitError("Slave NACK");
+		}
+	}
+
+	void store(uint16_t addr, uint8_t value)
+	{
+		if (addr == 0x3212)
+		{
+			//[7:4] 0 hold start, 1 hold end, A quick launch; [3:0] group
+			switch (value & 0xF0)
+			{
+			case 0x00:
+				if (group_launched_)
+					launch();
+				group_held_ = true;
+				group_count_ = 0;
+				break;
+			case 0x10: group_held_ = false; break;
+			case 0xA0:
+				group_launched_ = true;
+				if (!streaming())
+					launch();
+				break;
+			default: break;
+			}
+			regs_[addr] = value;
+			return;
+		}
+		if (group_held_)
+		{
+			if (group_count_ < SIZEOF_ARRAY(group_))
+				group_[group_count_++] = {addr, value};
+			return;
+		}
+		apply(addr, value);
+	}
+
+	void launch()
+	{
+		for (size_t i = 0; i < group_count_; ++i)
+			apply(group_[i].addr, group_[i].data);
+		group_count_ = 0;
+		group_launched_ = false;
+	}
+
+	void apply(uint16_t addr, uint8_t value)
+	{
+		if (addr == 0x3008 && (value & 0x80))
+		{
+			defaults();	//Software reset, self-clearing
+			return;
+		}
+		regs_[addr] = value;
+	}
+
+	void defaults()
+	{
+		memset(regs_, 0, sizeof(regs_));
+		regs_[0x300A] = 0x56;
+		regs_[0x300B] = 0x40;
+		regs_[0x3008] = 0x02;
+		regs_[0x3103] = 0x11;
+		regs_[0x3035] = 0x11;
+		regs_[0x3036] = 0x69;
+		regs_[0x3037] = 0x03;
+		regs_[0x3108] = 0x16;
+		//2592x1944, HTS 2844, VTS 1968
+		regs_[0x3808] = 0x0A; regs_[0x3809] = 0x20;
+		regs_[0x380a] = 0x07; regs_[0x380b] = 0x98;
+		regs_[0x380c] = 0x0B; regs_[0x380d] = 0x1C;
+		regs_[0x380e] = 0x07; regs_[0x380f] = 0xB0;
+		ptr_ = 0;
+		group_held_ = false;
+		group_launched_ = false;
+		group_count_ = 0;
+	}
+
+	/*
+	 * Replays every mode table on a scratch map and records the pixel clock
+	 * mode_info implies for the PLL setting and output size it leaves behind.
+	 */
+	void calibrate()
+	{
+		for (int m = 0; m < OV5640_cfg::MODE_END && pll_count_ < pll_max; ++m)
+		{
+			for (size_t i = 0; i < OV5640_cfg::modes[m].cfg_size; ++i)
+				regs_[OV5640_cfg::modes[m].cfg[i].addr] = OV5640_cfg::modes[m].cfg[i].data;
+			OV5640_cfg::mode_info_t const& mi = OV5640_cfg::mode_info[m];
+			pll_[pll_count_++] = {regs_[0x3035], regs_[0x3036], regs_[0x3037], regs_[0x3108],
+					width(), height(), (uint64_t)mi.hts * mi.vts * mi.fps};
+		}
+		defaults();
+	}
+
+	//! \brief Exact PLL and size match first, then PLL only
+	uint64_t pclkHz() const
+	{
+		pll_t const* pll_only = nullptr;
+		for (size_t i = 0; i < pll_count_; ++i)
+		{
+			pll_t const& p = pll_[i];
+			if (p.r3035 != regs_[0x3035] || p.r3036 != regs_[0x3036] ||
+					p.r3037 != regs_[0x3037] || p.r3108 != regs_[0x3108])
+				continue;
+			if (p.width == width() && p.height == height())
+				return p.pclk_Hz;
+			if (!pll_only)
+				pll_only = &p;
+		}
+		return pll_only ? pll_only->pclk_Hz : 0;
+	}
+
+	uint16_t reg16(uint16_t addr) const { return (uint16_t)((regs_[addr] << 8) | regs_[addr + 1]); }
+
+private:
+	uint8_t regs_[0x10000];
+	uint32_t scene_ = 1000 * 16 * 16;
+	uint16_t illum_[3] = {0x400, 0x400, 0x400};
+	uint16_t ptr_ = 0;
+	uint8_t lens_ = 0;
+	int32_t target_mdpt_ = -1;
+	int16_t lens_temp_ = 25;
+	bool powered_ = false;
+	bool group_held_ = false;
+	bool group_launched_ = false;	// applied at the next frame start
+	OV5640_cfg::config_word_t group_[16];	// group 0 holds 64 bytes
+	size_t group_count_ = 0;
+	pll_t pll_[pll_max] = {};
+	size_t pll_count_ = 0;
+};
+
+} /* namespace Sim */
+} /* namespace digilent */
+
+#endif /* OV5640SIM_H_ */
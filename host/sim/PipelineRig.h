@@ -0,0 +1,241 @@
+/*
+ * PipelineRig.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef PIPELINERIG_H_
+#define PIPELINERIG_H_
+
+#include <stdint.h>
+
+#include "Sim.h"
+#include "Ov5640Sim.h"
+#include "VdmaModel.h"
+
+#include "ov5640/AXI_VDMA.h"
+#include "ov5640/OV5640.h"
+#include "ov5640/PS_GPIO.h"
+#include "ov5640/PS_IIC.h"
+#include "ov5640/ScuGicInterruptController.h"
+#include "hdmi/VideoOutput.h"
+#include "pipeline/Bandwidth.h"
+#include "pipeline/FrameMonitor.h"
+#include "pipeline/FrameView.h"
+#include "pipeline/ModeChange.h"
+#include "pipeline/PipelineController.h"
+#include "pipeline/AutoExposure.h"
+#include "pipeline/StillCapture.h"
+#include "pipeline/WhiteBalance.h"
+
+#include "xparameters.h"
+#include "xcsi_hw.h"
+
+namespace digilent {
+namespace Sim {
+
+/*!
+ * \brief The firmware's video pipeline, built as main() builds it, on top of
+ * the register models: the sensor model on the camera I2C bus and powered
+ * from the camera enable GPIO, the VDMA, CSI-2 RX and clock wizard models
+ * at their base addresses, and DDR frame stores backed by host memory.
+ * Everything else (VTC, gamma) is plain registers.
+ *
+ * S2MM frames arrive at the rate the sensor model's PLL and timing
+ * registers give, while the sensor streams and the CSI-2 core is enabled.
+ * They carry the colour bars while the sensor's test pattern is on and
+ * the sensor model's exposure level and colour otherwise, with its focus
+ * stripes when a focus target is set. Every S2MM frame boundary is a
+ * frame start on the sensor, and the CSI-2 RX sees the FE of the frame
+ * stored and the FS of the next one as short packets; there are no frame
+ * starts while S2MM is stopped. MM2S runs at the refresh rate of the
+ * output timing.
+ *
+ * The simulation state is global, so there is one rig per process.
+ */
+class PipelineRig
+{
+public:
+	typedef AXI_VDMA<ScuGicInterruptController> Vdma;
+	typedef PipelineController<Vdma> Pipe;
+	typedef CsiFrameMonitor<ScuGicInterruptController> CsiMon;
+	typedef StillCapturer<Vdma, CsiMon> Still;
+	typedef FrameSampler<Vdma> Sampler;
+	typedef AutoExposure<Vdma> Ae;
+	typedef AutoWhiteBalance<Vdma> Awb;
+
+	static uintptr_t const mem_base = XPAR_DDR_MEM_BASEADDR + 0x0A000000;
+	static size_t const mem_size = 52 << 20;	// three 1080p RGB frame stores, the still store and its scratch
+	static uint32_t const cam_en_pin = 54;	// EMIO pin PS_GPIO drives
+
+	//! \brief Cold boot: constructs and initialises every driver
+	explicit PipelineRig(uint32_t i2c_Hz = 100000) :
+		vdma_model_(3),
+		csi_model_(XPAR_FABRIC_MIPI_CSI2_RX_SUBSYST_0_CSIRXSS_CSI_IRQ_INTR),
+		attached_(attach()),
+		irpt_ctl(XPAR_PS7_SCUGIC_0_DEVICE_ID),
+		gpio(XPAR_PS7_GPIO_0_DEVICE_ID, irpt_ctl, XPAR_PS7_GPIO_0_INTR),
+		iic(XPAR_PS7_I2C_0_DEVICE_ID, irpt_ctl, XPAR_PS7_I2C_0_INTR, i2c_Hz),
+		cam(iic, gpio),
+		vdma(XPAR_AXIVDMA_0_DEVICE_ID, mem_base, irpt_ctl,
+				XPAR_FABRIC_AXI_VDMA_0_MM2S_INTROUT_INTR, XPAR_FABRIC_AXI_VDMA_0_S2MM_INTROUT_INTR),
+		vid(XPAR_VTC_0_DEVICE_ID, XPAR_VIDEO_DYNCLK_DEVICE_ID),
+		pipeline(vdma, cam, vid, XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR, XPAR_AXI_GAMMACORRECTION_0_BASEADDR),
+		monitor(XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR, irpt_ctl, XPAR_FABRIC_MIPI_CSI2_RX_SUBSYST_0_CSIRXSS_CSI_IRQ_INTR),
+		still(cam, vdma, monitor, mem_base + StillCapture::store_offset, mem_base + StillCapture::scratch_offset),
+		sampler(vdma),
+		ae(cam, sampler, OV5640_cfg::MODE_480P_640_480_15FPS),
+		awb(cam, sampler)
+	{
+	}
+
+	//! \brief The firmware's mode change, with MM2S running at the new refresh; the plan executed
+	Pipeline::plan_t modeChange(Resolution res, OV5640_cfg::mode_t mode)
+	{
+		if (timing_t const* t = find_timing(res))
+			vdma_model_.setFramePeriod(XAXIVDMA_READ, 1000000000000ull / refresh_mHz(*t));
+		return pipeline_mode_change(pipeline, monitor, vdma, cam, vid, res, mode, budget);
+	}
+
+	/*!
+	 * \brief Only the reconfiguration of pipeline_mode_change(): admission
+	 * and PipelineController::apply(), without the status dump and self-test.
+	 * With cold set every stage restarts, as after power-up.
+	 */
+	Pipeline::transition_t const& transition(Resolution res, OV5640_cfg::mode_t mode, bool cold = false)
+	{
+		Pipeline::target_t tgt = {res, mode, OV5640_cfg::awb_t::AWB_ADVANCED, 3};
+		if (Bandwidth::admit(tgt, vdma.writeBytesPerPixel(), budget) == Bandwidth::REJECTED)
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		if (timing_t const* t = find_timing(tgt.res))
+			vdma_model_.setFramePeriod(XAXIVDMA_READ, 1000000000000ull / refresh_mHz(*t));
+		return cold ? pipeline.restart(tgt) : pipeline.apply(tgt);
+	}
+
+	//! \brief First output resolution with the sensor mode's frame size
+	static Resolution outputFor(OV5640_cfg::mode_t mode)
+	{
+		OV5640_cfg::mode_info_t const& m = OV5640_cfg::mode_info[mode];
+		for (timing_t const& t : timing)
+			if (t.h_active == m.width && t.v_active == m.height)
+				return t.res;
+		return Resolution::R1920_1080_60_PP;
+	}
+
+	bool hasMemory() const { return has_memory_; }
+	uint32_t s2mmFrames() const { return vdma_model_.frames(XAXIVDMA_WRITE); }
+	uint32_t mm2sFrames() const { return vdma_model_.frames(XAXIVDMA_READ); }
+	//! \brief Camera enable writes and power-off periods seen so far
+	uint32_t gpioWrites() const { return gpio_writes_; }
+	uint32_t powerCycles() const { return power_cycles_; }
+
+private:
+	bool attach()
+	{
+		has_memory_ = mapMemory(mem_base, mem_size);
+		map(XPAR_AXIVDMA_0_BASEADDR, 0x10000, vdma_model_);
+		map(XPAR_VIDEO_DYNCLK_BASEADDR, 0x10000, clk_wiz_model_);
+		map(XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR, 0x1000, csi_model_);
+		setI2cBus(&sensor);
+		onGpio(&powerHook, this);
+		vdma_model_.setSource(&render, this);
+		vdma_model_.setFramePeriod(XAXIVDMA_WRITE, sensor.framePeriodNs());
+		vdma_model_.setPeriodSource(&framePeriod, this);
+		vdma_model_.setFrameHook(&frameBoundary, this);
+		return true;
+	}
+
+	static void powerHook(void* ctx, uint32_t pin, uint32_t value)
+	{
+		PipelineRig& rig = *static_cast<PipelineRig*>(ctx);
+		if (pin != cam_en_pin)
+			return;
+		++rig.gpio_writes_;
+		if (rig.sensor.powered() && !value)
+			++rig.power_cycles_;
+		rig.sensor.setPower(value);
+	}
+
+	//Each S2MM frame takes as long as the sensor is set up for when it starts
+	static uint64_t framePeriod(void* ctx)
+	{
+		return static_cast<PipelineRig*>(ctx)->sensor.framePeriodNs();
+	}
+
+	static void frameBoundary(void* ctx, bool ended)
+	{
+		PipelineRig& rig = *static_cast<PipelineRig*>(ctx);
+		if (ended)
+			rig.csi_model_.shortPacket(FrameMonitor::DT_FE, 0);
+		rig.sensor.frameStart();
+		if (rig.sensor.streaming())
+			rig.csi_model_.shortPacket(FrameMonitor::DT_FS, 0);
+	}
+
+	static uint8_t stripe(uint8_t level, int d)
+	{
+		int const v = level + d;
+		return (uint8_t)(v < 0 ? 0 : v > 0xFF ? 0xFF : v);
+	}
+
+	static bool render(void* ctx, uint8_t* dst, uint32_t hsize, uint32_t vsize, uint32_t stride)
+	{
+		PipelineRig& rig = *static_cast<PipelineRig*>(ctx);
+		if (!rig.sensor.streaming() ||
+				!(peek(XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR + XCSI_CCR_OFFSET) & XCSI_CCR_COREENB_MASK))
+			return false;
+		if (!dst)
+			return true;
+		uint32_t const bpp = 3;
+		uint32_t const width = hsize / bpp;
+		bool const bars = rig.sensor.testPattern();
+		uint8_t level[3];
+		rig.sensor.rgb(level);
+		int const amp = rig.sensor.contrast() / 2;
+		for (uint32_t y = 0; y < vsize; ++y)
+		{
+			uint8_t* p = dst + (size_t)y * stride;
+			for (uint32_t x = 0; x < width; ++x, p += bpp)
+			{
+				uint8_t const* c = ColorBar::bars[x * ColorBar::bar_count / width];
+				int const d = (x & 2) ? amp : -amp;
+				p[frame_view_t::OFFSET_R] = bars ? (c[0] ? 0xFF : 0) : stripe(level[0], d);
+				p[frame_view_t::OFFSET_G] = bars ? (c[1] ? 0xFF : 0) : stripe(level[1], d);
+				p[frame_view_t::OFFSET_B] = bars ? (c[2] ? 0xFF : 0) : stripe(level[2], d);
+			}
+		}
+		return true;
+	}
+
+public:
+	Ov5640Sim sensor;
+	Bandwidth::budget_t budget;
+
+private:
+	VdmaModel vdma_model_;
+	CsiRxModel csi_model_;
+	ClkWizModel clk_wiz_model_;
+	bool has_memory_ = false;
+	uint32_t gpio_writes_ = 0;
+	uint32_t power_cycles_ = 0;
+	bool const attached_;
+
+public:
+	ScuGicInterruptController irpt_ctl;
+	PS_GPIO<ScuGicInterruptController> gpio;
+	PS_IIC<ScuGicInterruptController> iic;
+	OV5640 cam;
+	Vdma vdma;
+	VideoOutput vid;
+	Pipe pipeline;
+	CsiMon monitor;
+	Still still;
+	Sampler sampler;
+	Ae ae;
+	Awb awb;
+};
+
+} /* namespace Sim */
+} /* namespace digilent */
+
+#endif /* PIPELINERIG_H_ */
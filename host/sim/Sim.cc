@@ -0,0 +1,240 @@
+/*
+ * Sim.cc
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Sim.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "xil_io.h"
+#include "xil_printf.h"
+#include "xil_cache.h"
+#include "xil_exception.h"
+#include "xtime_l.h"
+
+namespace digilent {
+namespace Sim {
+
+model_t model = {150, 60, 20, 100000};
+stats_t stats = {};
+
+namespace {
+	struct region_t { uintptr_t base; uint32_t size; Device* dev; };
+	std::vector<region_t> regions;
+	std::unordered_map<uintptr_t, uint32_t> plain;	// unmapped registers
+	uintptr_t mem_base = 0;
+	size_t mem_size = 0;
+	uint64_t clock_ns = 0;
+	I2C_Client* i2c_bus = nullptr;
+	GpioHook gpio_hook = nullptr;
+	void* gpio_ctx = nullptr;
+	MmioHook mmio_hook = nullptr;
+	void* mmio_ctx = nullptr;
+	bool echo_on = true;
+
+	region_t const* find(uintptr_t addr)
+	{
+		for (region_t const& r : regions)
+			if (addr >= r.base && addr - r.base < r.size)
+				return &r;
+		return nullptr;
+	}
+
+	uint32_t load(uintptr_t addr)
+	{
+		if (uint8_t* p = memory(addr, 4))
+		{
+			uint32_t v;
+			memcpy(&v, p, 4);
+			return v;
+		}
+		if (region_t const* r = find(addr))
+			return r->dev->read((uint32_t)(addr - r->base));
+		auto it = plain.find(addr);
+		return it == plain.end() ? 0 : it->second;
+	}
+
+	void store(uintptr_t addr, uint32_t value)
+	{
+		if (uint8_t* p = memory(addr, 4))
+			memcpy(p, &value, 4);
+		else if (region_t const* r = find(addr))
+			r->dev->write((uint32_t)(addr - r->base), value);
+		else
+			plain[addr] = value;
+	}
+}
+
+uint64_t now_ns() { return clock_ns; }
+void advance(uint64_t ns) { clock_ns += ns; }
+
+void i2cTransfer(size_t count, bool read)
+{
+	//Start, address + ACK, 9 bits per data byte, stop
+	uint64_t const bits = 1 + 9 * (1 + (uint64_t)count) + 1;
+	uint64_t const ns = bits * 1000000000ull / (model.i2c_Hz ? model.i2c_Hz : 1);
+	++stats.i2c_transfers;
+	if (read)
+		stats.i2c_bytes_rd += count;
+	else
+		stats.i2c_bytes_wr += count;
+	stats.i2c_ns += ns;
+	advance(ns);
+}
+
+void map(uintptr_t base, uint32_t size, Device& dev)
+{
+	regions.push_back({base, size, &dev});
+}
+
+uint32_t peek(uintptr_t addr)
+{
+	return load(addr);
+}
+
+bool mapMemory(uintptr_t base, size_t size)
+{
+	void* p = mmap(reinterpret_cast<void*>(base), size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if (p == MAP_FAILED)
+		return false;
+	if (reinterpret_cast<uintptr_t>(p) != base)
+	{
+		munmap(p, size);	//Kernel without MAP_FIXED_NOREPLACE treats it as a hint
+		return false;
+	}
+	mem_base = base;
+	mem_size = size;
+	return true;
+}
+
+uint8_t* memory(uintptr_t addr, size_t len)
+{
+	if (!mem_size || addr < mem_base || addr - mem_base + len > mem_size)
+		return nullptr;
+	return reinterpret_cast<uint8_t*>(addr);
+}
+
+void setI2cBus(I2C_Client* bus) { i2c_bus = bus; }
+I2C_Client* i2cBus() { return i2c_bus; }
+
+void onGpio(GpioHook hook, void* ctx)
+{
+	gpio_hook = hook;
+	gpio_ctx = ctx;
+}
+
+void gpio(uint32_t pin, uint32_t value)
+{
+	if (gpio_hook)
+		gpio_hook(gpio_ctx, pin, value);
+}
+
+void onMmio(MmioHook hook, void* ctx)
+{
+	mmio_hook = hook;
+	mmio_ctx = ctx;
+}
+
+void setEcho(bool on) { echo_on = on; }
+bool echo() { return echo_on; }
+
+void reset()
+{
+	regions.clear();
+	plain.clear();
+	if (mem_size)
+		munmap(reinterpret_cast<void*>(mem_base), mem_size);
+	mem_base = 0;
+	mem_size = 0;
+	clock_ns = 0;
+	stats = {};
+	i2c_bus = nullptr;
+	gpio_hook = nullptr;
+	gpio_ctx = nullptr;
+	mmio_hook = nullptr;
+	mmio_ctx = nullptr;
+	setCard(false);
+}
+
+} /* namespace Sim */
+} /* namespace digilent */
+
+using namespace digilent;
+
+u32 Xil_In32(UINTPTR addr)
+{
+	uint64_t const t0 = Sim::now_ns();
+	++Sim::stats.mmio_reads;
+	Sim::stats.mmio_ns += Sim::model.mmio_read_ns;
+	Sim::advance(Sim::model.mmio_read_ns);
+	u32 const value = Sim::peek(addr);
+	if (Sim::mmio_hook)
+		Sim::mmio_hook(Sim::mmio_ctx, t0, addr, value, false);
+	return value;
+}
+
+void Xil_Out32(UINTPTR addr, u32 value)
+{
+	uint64_t const t0 = Sim::now_ns();
+	++Sim::stats.mmio_writes;
+	Sim::stats.mmio_ns += Sim::model.mmio_write_ns;
+	Sim::advance(Sim::model.mmio_write_ns);
+	Sim::store(addr, value);
+	if (Sim::mmio_hook)
+		Sim::mmio_hook(Sim::mmio_ctx, t0, addr, value, true);
+}
+
+u8 Xil_In8(UINTPTR addr)
+{
+	return (u8)(Xil_In32(addr & ~(UINTPTR)3) >> (8 * (addr & 3)));
+}
+
+void Xil_Out8(UINTPTR addr, u8 value)
+{
+	UINTPTR const word = addr & ~(UINTPTR)3;
+	unsigned const shift = 8 * (addr & 3);
+	u32 const v = Sim::peek(word);
+	Xil_Out32(word, (v & ~(0xFFu << shift)) | ((u32)value << shift));
+}
+
+void XTime_GetTime(XTime* t)
+{
+	Sim::advance(Sim::model.timer_read_ns);
+	*t = (XTime)((unsigned __int128)Sim::now_ns() * COUNTS_PER_SECOND / 1000000000u);
+}
+
+extern "C" void xil_printf(const char* fmt, ...)
+{
+	if (!Sim::echo())
+		return;
+	va_list ap;
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+}
+
+extern "C" void outbyte(char c)
+{
+	if (Sim::echo())
+		putchar(c);
+}
+
+void Xil_DCacheInvalidateRange(INTPTR, u32) {}
+void Xil_DCacheFlushRange(INTPTR, u32) {}
+void Xil_DCacheEnable() {}
+void Xil_DCacheDisable() {}
+void Xil_ICacheEnable() {}
+void Xil_ICacheDisable() {}
+
+void Xil_ExceptionRegisterHandler(u32, Xil_ExceptionHandler, void*) {}
+void Xil_ExceptionEnable() {}
+void Xil_ExceptionDisable() {}
@@ -0,0 +1,126 @@
+/*
+ * Sim.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Register-level simulation backend for running firmware code on the host.
+ * The stand-in BSP headers in host/sim/bsp replace the Xilinx ones; their
+ * functions (bsp.cc) drive the same registers the real drivers do, through
+ * Xil_In32/Xil_Out32, which dispatch to the device models mapped here.
+ * Unmapped addresses behave as plain registers.
+ *
+ * Time is simulated. It advances only by modelled costs: each MMIO access,
+ * each I2C transfer on the sensor model, and each XTime_GetTime() call, so
+ * firmware polling loops and timeouts terminate and the reported bus time
+ * is deterministic.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace digilent {
+
+class I2C_Client;
+
+namespace Sim {
+	struct model_t
+	{
+		uint32_t mmio_read_ns;		// AXI GP0 round trip into the PL
+		uint32_t mmio_write_ns;		// posted write
+		uint32_t timer_read_ns;		// XTime_GetTime()
+		uint32_t i2c_Hz;			// SCL rate
+	};
+	extern model_t model;
+
+	struct stats_t
+	{
+		uint64_t mmio_reads, mmio_writes;
+		uint64_t mmio_ns;
+		uint64_t i2c_transfers;		// one address phase each
+		uint64_t i2c_bytes_wr, i2c_bytes_rd;	// data bytes, address bytes excluded
+		uint64_t i2c_nacks;
+		uint64_t i2c_ns;
+	};
+	extern stats_t stats;
+
+	uint64_t now_ns();
+	void advance(uint64_t ns);
+
+	/*!
+	 * \brief Accounts one I2C transfer of count data bytes: start, address,
+	 * data with ACK bits, stop.
+	 */
+	void i2cTransfer(size_t count, bool read);
+
+	class Device
+	{
+	public:
+		virtual uint32_t read(uint32_t offset) = 0;
+		virtual void write(uint32_t offset, uint32_t value) = 0;
+		virtual ~Device() = default;
+	};
+
+	//! \brief Routes [base, base + size) to dev, offsets relative to base
+	void map(uintptr_t base, uint32_t size, Device& dev);
+	//! \brief Register value without counting or timing an access
+	uint32_t peek(uintptr_t addr);
+
+	/*!
+	 * \brief Backs [base, base + size) of the target address space with host
+	 * memory at the same address, so frame stores can be dereferenced. Fails
+	 * if the range is taken in this process.
+	 */
+	bool mapMemory(uintptr_t base, size_t size);
+	//! \brief Host pointer for a target range inside mapped memory, or NULL
+	uint8_t* memory(uintptr_t addr, size_t len);
+
+	//! \brief Device answering XIicPs transfers
+	void setI2cBus(I2C_Client* bus);
+	I2C_Client* i2cBus();
+
+	/*!
+	 * \brief Raises a shared peripheral interrupt at the GIC. Its handler runs
+	 * at once if it is enabled, otherwise as soon as it is.
+	 */
+	void interrupt(uint32_t id);
+
+	/*!
+	 * \brief Inserts an empty SD card for the FatFs calls, or takes it out;
+	 * without one they fail with FR_NOT_READY. Files live in host memory.
+	 */
+	void setCard(bool inserted);
+	//! \brief Host pointer to a file on the card and its length, NULL if there is none
+	uint8_t* cardFile(char const* path, size_t& len);
+	//! \brief Creates or replaces a file on the card
+	void cardWrite(char const* path, uint8_t const* data, size_t len);
+
+	typedef void (*GpioHook)(void* ctx, uint32_t pin, uint32_t value);
+	//! \brief Called on every XGpioPs_WritePin
+	void onGpio(GpioHook hook, void* ctx);
+	void gpio(uint32_t pin, uint32_t value);
+
+	typedef void (*MmioHook)(void* ctx, uint64_t t_ns, uintptr_t addr, uint32_t value, bool write);
+	/*!
+	 * \brief Called after every Xil_In32/Xil_Out32 (and the byte accesses
+	 * built on them) with the simulated time the access started
+	 */
+	void onMmio(MmioHook hook, void* ctx);
+
+	//! \brief Console output of xil_printf, on by default
+	void setEcho(bool on);
+	bool echo();
+
+	/*!
+	 * \brief Drops every mapping, hook, the mapped memory and the card, and restarts the
+	 * clock and statistics at zero. The model settings are kept. Devices
+	 * using the old state must be gone.
+	 */
+	void reset();
+}
+
+} /* namespace digilent */
+
+#endif /* SIM_H_ */
@@ -0,0 +1,336 @@
+/*
+ * VdmaModel.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VDMAMODEL_H_
+#define VDMAMODEL_H_
+
+#include <stdint.h>
+
+#include "Sim.h"
+
+#include "xaxivdma.h"
+#include "xcsi_hw.h"
+
+namespace digilent {
+namespace Sim {
+
+/*!
+ * \brief AXI VDMA register model (PG020 register map, direct mode). A running
+ * channel completes a frame every frame period and moves on to the next
+ * frame store, or stays on its PARKPTR reference when not circular. S2MM
+ * frames are only completed when the frame source delivers one, which it
+ * writes into the frame store memory. The frame hook sees every S2MM frame
+ * boundary, the channel starting included, before the next frame's period
+ * is asked for.
+ */
+class VdmaModel : public Device
+{
+public:
+	//! \brief Fills a frame store, false if no frame is coming in
+	typedef bool (*FrameSource)(void* ctx, uint8_t* dst, uint32_t hsize, uint32_t vsize, uint32_t stride);
+
+	explicit VdmaModel(uint8_t frame_stores) :
+		stores_(frame_stores)
+	{
+	}
+
+	void setSource(FrameSource src, void* ctx)
+	{
+		src_ = src;
+		src_ctx_ = ctx;
+	}
+
+	//! \brief Called at each S2MM frame boundary, ended set if a frame was just stored
+	typedef void (*FrameHook)(void* ctx, bool ended);
+	void setFrameHook(FrameHook hook, void* ctx)
+	{
+		frame_hook_ = hook;
+		frame_ctx_ = ctx;
+	}
+
+	//! \brief Frame period of a channel, 0 stops frames
+	void setFramePeriod(uint16_t direction, uint64_t ns)
+	{
+		chan(direction).period_ns = ns;
+	}
+
+	//! \brief S2MM frame period asked for at the start of every frame instead
+	typedef uint64_t (*PeriodSource)(void* ctx);
+	void setPeriodSource(PeriodSource src, void* ctx)
+	{
+		period_src_ = src;
+		period_ctx_ = ctx;
+	}
+
+	uint32_t frames(uint16_t direction) const
+	{
+		return chan_[direction == XAXIVDMA_WRITE].frames;
+	}
+
+	uint32_t read(uint32_t offset) override
+	{
+		update(chan_[0]);
+		update(chan_[1]);
+		if (offset == XAXIVDMA_PARKPTR_OFFSET)
+			return park_ | ((uint32_t)chan_[0].store << XAXIVDMA_READSTR_SHIFT) |
+					((uint32_t)chan_[1].store << XAXIVDMA_WRTSTR_SHIFT);
+		int const ch = offset >= XAXIVDMA_S2MM_ADDR_OFFSET ||
+				(offset >= XAXIVDMA_RX_OFFSET && offset < XAXIVDMA_MM2S_ADDR_OFFSET);
+		chan_t& c = chan_[ch];
+		uint32_t const reg = regOffset(ch, offset);
+		switch (reg)
+		{
+		case XAXIVDMA_CR_OFFSET: return c.cr;
+		case XAXIVDMA_SR_OFFSET: return c.sr | (c.cr & XAXIVDMA_CR_RUNSTOP_MASK ? 0 : XAXIVDMA_SR_HALTED_MASK);
+		default: return c.regs[(reg / 4) % reg_count];
+		}
+	}
+
+	void write(uint32_t offset, uint32_t value) override
+	{
+		if (offset == XAXIVDMA_PARKPTR_OFFSET)
+		{
+			update(chan_[0]);
+			update(chan_[1]);
+			park_ = value & (XAXIVDMA_PARKPTR_READREF_MASK | XAXIVDMA_PARKPTR_WRTREF_MASK);
+			return;
+		}
+		int const ch = offset >= XAXIVDMA_S2MM_ADDR_OFFSET ||
+				(offset >= XAXIVDMA_RX_OFFSET && offset < XAXIVDMA_MM2S_ADDR_OFFSET);
+		chan_t& c = chan_[ch];
+		update(c);
+		uint32_t const reg = regOffset(ch, offset);
+		switch (reg)
+		{
+		case XAXIVDMA_CR_OFFSET:
+			if (value & XAXIVDMA_CR_RESET_MASK)
+			{
+				reset(c);	//Completes at once, the reset bit reads back as 0
+				park_ = 0;
+				return;
+			}
+			if ((value & ~c.cr) & XAXIVDMA_CR_RUNSTOP_MASK)
+			{
+				boundary(c, false);
+				c.next_ns = now_ns() + period(c);
+			}
+			c.cr = value;
+			return;
+		case XAXIVDMA_SR_OFFSET:
+			c.sr &= ~(value & (XAXIVDMA_SR_ERR_ALL_MASK | XAXIVDMA_IXR_ALL_MASK));
+			return;
+		default:
+			c.regs[(reg / 4) % reg_count] = value;
+			return;
+		}
+	}
+
+private:
+	static uint32_t const reg_count = 0x80;
+	// Channel registers re-based: 0x00 CR, 0x04 SR, 0x100 + address block offset
+	static uint32_t const addr_block = 0x100;
+
+	struct chan_t
+	{
+		uint32_t cr, sr;
+		uint32_t regs[reg_count];
+		uint8_t store;
+		uint64_t next_ns, period_ns;
+		uint32_t frames;
+	};
+
+	static uint32_t regOffset(int ch, uint32_t offset)
+	{
+		uint32_t const ablk = ch ? XAXIVDMA_S2MM_ADDR_OFFSET : XAXIVDMA_MM2S_ADDR_OFFSET;
+		if (offset >= ablk)
+			return addr_block + offset - ablk;
+		return offset - (ch ? XAXIVDMA_RX_OFFSET : XAXIVDMA_TX_OFFSET);
+	}
+
+	uint32_t reg(chan_t const& c, uint32_t ablk_offset) const
+	{
+		return c.regs[((addr_block + ablk_offset) / 4) % reg_count];
+	}
+
+	chan_t& chan(uint16_t direction) { return chan_[direction == XAXIVDMA_WRITE]; }
+
+	void reset(chan_t& c)
+	{
+		uint64_t const period = c.period_ns;
+		uint32_t const frames = c.frames;
+		c = {};
+		c.period_ns = period;
+		c.frames = frames;
+	}
+
+	void update(chan_t& c)
+	{
+		if (!(c.cr & XAXIVDMA_CR_RUNSTOP_MASK) || !c.period_ns)
+			return;
+		while (now_ns() >= c.next_ns)
+		{
+			bool const ended = &c != &chan_[1] || capture(c);
+			boundary(c, ended);
+			c.next_ns += period(c);
+			if (!ended)
+				continue;
+			++c.frames;
+			if (c.cr & XAXIVDMA_CR_TAIL_EN_MASK)
+				c.store = (c.store + 1) % (stores_ ? stores_ : 1);
+			else if (&c == &chan_[0])
+				c.store = park_ & XAXIVDMA_PARKPTR_READREF_MASK;
+			else
+				c.store = (park_ & XAXIVDMA_PARKPTR_WRTREF_MASK) >> XAXIVDMA_WRTREF_SHIFT;
+		}
+	}
+
+	void boundary(chan_t& c, bool ended)
+	{
+		if (&c == &chan_[1] && frame_hook_)
+			frame_hook_(frame_ctx_, ended);
+	}
+
+	uint64_t period(chan_t& c)
+	{
+		if (&c == &chan_[1] && period_src_)
+			c.period_ns = period_src_(period_ctx_);
+		return c.period_ns;
+	}
+
+	bool capture(chan_t& c)
+	{
+		if (!src_)
+			return false;
+		uint32_t const vsize = reg(c, XAXIVDMA_VSIZE_OFFSET);
+		uint32_t const hsize = reg(c, XAXIVDMA_HSIZE_OFFSET);
+		uint32_t const stride = reg(c, XAXIVDMA_STRD_FRMDLY_OFFSET) & 0xFFFF;
+		uint32_t const addr = reg(c, XAXIVDMA_START_ADDR_OFFSET + 4 * c.store);
+		return src_(src_ctx_, memory(addr, (size_t)stride * vsize), hsize, vsize, stride);
+	}
+
+private:
+	uint8_t const stores_;
+	chan_t chan_[2] = {};	// MM2S, S2MM
+	uint32_t park_ = 0;		// PARKPTR frame references
+	FrameSource src_ = nullptr;
+	void* src_ctx_ = nullptr;
+	PeriodSource period_src_ = nullptr;
+	void* period_ctx_ = nullptr;
+	FrameHook frame_hook_ = nullptr;
+	void* frame_ctx_ = nullptr;
+};
+
+/*!
+ * \brief MIPI CSI-2 RX controller (PG232 register map). Plain registers but
+ * for the interrupt status, write 1 to clear, and the short packet FIFO,
+ * which shortPacket() fills while the core is enabled and SPKTR reads
+ * drain. Status bits enabled in IER go to the GIC when GIER is set.
+ */
+class CsiRxModel : public Device
+{
+public:
+	explicit CsiRxModel(uint32_t irq_id) : irq_id_(irq_id) {}
+
+	void shortPacket(uint8_t dt, uint16_t data)
+	{
+		if (!(regs_[XCSI_CCR_OFFSET / 4] & XCSI_CCR_COREENB_MASK))
+			return;
+		if (count_ == fifo_depth)
+		{
+			raise(XCSI_ISR_SPFIFOF_MASK);
+			return;
+		}
+		fifo_[(head_ + count_++) % fifo_depth] = (dt & XCSI_SPKTR_DT_MASK) | ((uint32_t)data << XCSI_SPKTR_DATA_SHIFT);
+		raise(XCSI_ISR_SPFIFONE_MASK);
+	}
+
+	uint32_t read(uint32_t offset) override
+	{
+		switch (offset)
+		{
+		case XCSI_ISR_OFFSET:
+			return isr_;
+		case XCSI_CSR_OFFSET:
+			return (regs_[offset / 4] & ~(XCSI_CSR_SPFIFONE_MASK | XCSI_CSR_SPFIFOFULL_MASK)) |
+					(count_ ? XCSI_CSR_SPFIFONE_MASK : 0) | (count_ == fifo_depth ? XCSI_CSR_SPFIFOFULL_MASK : 0);
+		case XCSI_SPKTR_OFFSET:
+		{
+			if (!count_)
+				return 0;
+			uint32_t const v = fifo_[head_];
+			head_ = (head_ + 1) % fifo_depth;
+			--count_;
+			return v;
+		}
+		default:
+			return regs_[(offset / 4) % reg_count];
+		}
+	}
+
+	void write(uint32_t offset, uint32_t value) override
+	{
+		if (offset == XCSI_ISR_OFFSET)
+		{
+			isr_ &= ~value;
+			return;
+		}
+		if (offset == XCSI_CCR_OFFSET && (value & XCSI_CCR_SOFTRESET_MASK))
+		{
+			isr_ = 0;
+			count_ = 0;
+		}
+		regs_[(offset / 4) % reg_count] = value;
+	}
+
+private:
+	static uint32_t const reg_count = 0x40;
+	static uint32_t const fifo_depth = 32;
+
+	void raise(uint32_t mask)
+	{
+		isr_ |= mask;
+		if ((regs_[XCSI_GIER_OFFSET / 4] & XCSI_GIER_GIE_MASK) && (isr_ & regs_[XCSI_IER_OFFSET / 4]))
+			interrupt(irq_id_);
+	}
+
+	uint32_t const irq_id_;
+	uint32_t regs_[reg_count] = {};
+	uint32_t isr_ = 0;
+	uint32_t fifo_[fifo_depth] = {};
+	uint32_t head_ = 0, count_ = 0;
+};
+
+//! \brief Clock wizard: loses lock for lock_ns after a reconfiguration load
+class ClkWizModel : public Device
+{
+public:
+	explicit ClkWizModel(uint64_t lock_ns = 100000) : lock_ns_(lock_ns) {}
+
+	uint32_t read(uint32_t offset) override
+	{
+		if (offset == 0x4)
+			return now_ns() >= locked_at_ ? 1 : 0;
+		return regs_[(offset / 4) % reg_count];
+	}
+
+	void write(uint32_t offset, uint32_t value) override
+	{
+		if (offset == 0x25C && (value & 0x1))
+			locked_at_ = now_ns() + lock_ns_;
+		regs_[(offset / 4) % reg_count] = value;
+	}
+
+private:
+	static uint32_t const reg_count = 0x100;
+	uint64_t const lock_ns_;
+	uint64_t locked_at_ = 0;
+	uint32_t regs_[reg_count] = {};
+};
+
+} /* namespace Sim */
+} /* namespace digilent */
+
+#endif /* VDMAMODEL_H_ */
@@ -0,0 +1,831 @@
+/*
+ * bsp.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Stand-in implementations of the standalone BSP drivers the firmware uses.
+ * Register accesses follow the real drivers closely enough that the MMIO
+ * counts are representative; the device behind them is whatever is mapped
+ * with Sim::map(), plain registers otherwise. I2C transfers go to the
+ * client set with Sim::setI2cBus() and complete synchronously.
+ */
+
+#include "Sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ov5640/I2C_Client.h"
+
+#include "xparameters.h"
+#include "xil_io.h"
+#include "xaxivdma.h"
+#include "xvtc.h"
+#include "xclk_wiz.h"
+#include "xiicps.h"
+#include "xgpiops.h"
+#include "xscugic.h"
+#include "xscutimer.h"
+#include "xuartps_hw.h"
+#include "ff.h"
+
+using namespace digilent;
+
+/*
+ * AXI VDMA
+ */
+namespace {
+	XAxiVdma_Config vdma_cfg = {XPAR_AXIVDMA_0_DEVICE_ID, XPAR_AXIVDMA_0_BASEADDR, 3, 1, 1, 3, 3};
+
+	XAxiVdma_Channel* vdmaChannel(XAxiVdma* inst, u16 direction)
+	{
+		return direction == XAXIVDMA_READ ? &inst->ReadChannel : &inst->WriteChannel;
+	}
+
+	void vdmaSetCr(XAxiVdma_Channel* chan, u32 set, u32 clear)
+	{
+		u32 const cr = Xil_In32(chan->ChanBase + XAXIVDMA_CR_OFFSET);
+		Xil_Out32(chan->ChanBase + XAXIVDMA_CR_OFFSET, (cr & ~clear) | set);
+	}
+
+	void vdmaIntr(XAxiVdma* inst, XAxiVdma_Channel* chan, XAxiVdma_ChannelCallBack& cb)
+	{
+		u32 const sr = Xil_In32(chan->ChanBase + XAXIVDMA_SR_OFFSET);
+		u32 const pending = sr & XAXIVDMA_IXR_ALL_MASK;
+		Xil_Out32(chan->ChanBase + XAXIVDMA_SR_OFFSET, pending);
+		if ((pending & XAXIVDMA_IXR_ERROR_MASK) && cb.ErrCallBack)
+			cb.ErrCallBack(cb.ErrRef, sr & XAXIVDMA_SR_ERR_ALL_MASK);
+		if ((pending & XAXIVDMA_IXR_COMPLETION_MASK) && cb.CompletionCallBack)
+			cb.CompletionCallBack(cb.CompletionRef, pending & XAXIVDMA_IXR_COMPLETION_MASK);
+		(void)inst;
+	}
+}
+
+XAxiVdma_Config* XAxiVdma_LookupConfig(u16 id)
+{
+	return id == vdma_cfg.DeviceId ? &vdma_cfg : NULL;
+}
+
+int XAxiVdma_CfgInitialize(XAxiVdma* inst, XAxiVdma_Config* cfg, UINTPTR base)
+{
+	*inst = {};
+	inst->BaseAddr = base;
+	inst->MaxNumFrames = cfg->MaxFrameStoreNum;
+	inst->HasMm2S = cfg->HasMm2s;
+	inst->HasS2Mm = cfg->HasS2Mm;
+	XAxiVdma_Channel* const chans[] = {&inst->ReadChannel, &inst->WriteChannel};
+	for (int i = 0; i < 2; ++i)
+	{
+		XAxiVdma_Channel* const c = chans[i];
+		c->IsRead = i == 0;
+		c->direction = i == 0 ? XAXIVDMA_READ : XAXIVDMA_WRITE;
+		c->InstanceBase = base;
+		c->ChanBase = base + (i == 0 ? XAXIVDMA_TX_OFFSET : XAXIVDMA_RX_OFFSET);
+		c->StartAddrBase = base + (i == 0 ? XAXIVDMA_MM2S_ADDR_OFFSET : XAXIVDMA_S2MM_ADDR_OFFSET) +
+				XAXIVDMA_START_ADDR_OFFSET;
+		c->StreamWidth = i == 0 ? cfg->Mm2SStreamWidth : cfg->S2MmStreamWidth;
+		c->NumFrames = cfg->MaxFrameStoreNum;
+		XAxiVdma_ChannelReset(c);
+		int polls = 1000;
+		while (polls-- && XAxiVdma_ChannelResetNotDone(c)) ;
+		if (polls < 0)
+			return XST_FAILURE;
+		c->IsValid = 1;
+	}
+	inst->IsReady = 1;
+	return XST_SUCCESS;
+}
+
+int XAxiVdma_SetCallBack(XAxiVdma* inst, u32 type, void* func, void* ref, u16 direction)
+{
+	XAxiVdma_ChannelCallBack& cb = direction == XAXIVDMA_READ ? inst->ReadCallBack : inst->WriteCallBack;
+	if (type == XAXIVDMA_HANDLER_GENERAL)
+	{
+		cb.CompletionCallBack = reinterpret_cast<XAxiVdma_CallBack>(func);
+		cb.CompletionRef = ref;
+	}
+	else if (type == XAXIVDMA_HANDLER_ERROR)
+	{
+		cb.ErrCallBack = reinterpret_cast<XAxiVdma_ErrorCallBack>(func);
+		cb.ErrRef = ref;
+	}
+	else
+		return XST_FAILURE;
+	return XST_SUCCESS;
+}
+
+void XAxiVdma_ReadIntrHandler(void* inst)
+{
+	XAxiVdma* const v = static_cast<XAxiVdma*>(inst);
+	vdmaIntr(v, &v->ReadChannel, v->ReadCallBack);
+}
+
+void XAxiVdma_WriteIntrHandler(void* inst)
+{
+	XAxiVdma* const v = static_cast<XAxiVdma*>(inst);
+	vdmaIntr(v, &v->WriteChannel, v->WriteCallBack);
+}
+
+void XAxiVdma_ChannelReset(XAxiVdma_Channel* chan)
+{
+	Xil_Out32(chan->ChanBase + XAXIVDMA_CR_OFFSET, XAXIVDMA_CR_RESET_MASK);
+}
+
+int XAxiVdma_ChannelResetNotDone(XAxiVdma_Channel* chan)
+{
+	return Xil_In32(chan->ChanBase + XAXIVDMA_CR_OFFSET) & XAXIVDMA_CR_RESET_MASK;
+}
+
+int XAxiVdma_ChannelIsRunning(XAxiVdma_Channel* chan)
+{
+	return !(Xil_In32(chan->ChanBase + XAXIVDMA_SR_OFFSET) & XAXIVDMA_SR_HALTED_MASK);
+}
+
+void XAxiVdma_ChannelStop(XAxiVdma_Channel* chan)
+{
+	vdmaSetCr(chan, 0, XAXIVDMA_CR_RUNSTOP_MASK);
+}
+
+int XAxiVdma_DmaConfig(XAxiVdma* inst, u16 direction, XAxiVdma_DmaSetup* setup)
+{
+	XAxiVdma_Channel* const chan = vdmaChannel(inst, direction);
+	if (!chan->IsValid)
+		return XST_FAILURE;
+	u32 set = 0;
+	if (setup->EnableCircularBuf) set |= XAXIVDMA_CR_TAIL_EN_MASK;
+	if (setup->EnableSync) set |= XAXIVDMA_CR_SYNC_EN_MASK;
+	if (setup->EnableFrameCounter) set |= XAXIVDMA_CR_FRMCNT_EN_MASK;
+	vdmaSetCr(chan, set, XAXIVDMA_CR_TAIL_EN_MASK | XAXIVDMA_CR_SYNC_EN_MASK | XAXIVDMA_CR_FRMCNT_EN_MASK);
+	UINTPTR const ablk = chan->StartAddrBase - XAXIVDMA_START_ADDR_OFFSET;
+	Xil_Out32(ablk + XAXIVDMA_HSIZE_OFFSET, setup->HoriSizeInput);
+	Xil_Out32(ablk + XAXIVDMA_STRD_FRMDLY_OFFSET, (setup->FrameDelay << 24) | (setup->Stride & 0xFFFF));
+	chan->Vsize = setup->VertSizeInput;	//Written by DmaStart, which starts the channel
+	return XST_SUCCESS;
+}
+
+int XAxiVdma_DmaSetBufferAddr(XAxiVdma* inst, u16 direction, UINTPTR* addrs)
+{
+	XAxiVdma_Channel* const chan = vdmaChannel(inst, direction);
+	if (!chan->IsValid)
+		return XST_FAILURE;
+	for (int i = 0; i < chan->NumFrames; ++i)
+		Xil_Out32(chan->StartAddrBase + 4 * i, addrs[i]);
+	return XST_SUCCESS;
+}
+
+int XAxiVdma_DmaStart(XAxiVdma* inst, u16 direction)
+{
+	XAxiVdma_Channel* const chan = vdmaChannel(inst, direction);
+	if (!chan->IsValid)
+		return XST_FAILURE;
+	vdmaSetCr(chan, XAXIVDMA_CR_RUNSTOP_MASK, 0);
+	Xil_Out32(chan->StartAddrBase - XAXIVDMA_START_ADDR_OFFSET + XAXIVDMA_VSIZE_OFFSET, chan->Vsize);
+	return XST_SUCCESS;
+}
+
+void XAxiVdma_DmaStop(XAxiVdma* inst, u16 direction)
+{
+	XAxiVdma_ChannelStop(vdmaChannel(inst, direction));
+}
+
+int XAxiVdma_ClearChannelErrors(XAxiVdma_Channel* chan, u32 mask)
+{
+	Xil_Out32(chan->ChanBase + XAXIVDMA_SR_OFFSET, mask & XAXIVDMA_SR_ERR_ALL_MASK);
+	return XST_SUCCESS;
+}
+
+int XAxiVdma_ClearDmaChannelErrors(XAxiVdma* inst, u16 direction, u32 mask)
+{
+	return XAxiVdma_ClearChannelErrors(vdmaChannel(inst, direction), mask);
+}
+
+int XAxiVdma_MaskS2MMErrIntr(XAxiVdma* inst, u32 mask, u16 direction)
+{
+	if (direction != XAXIVDMA_WRITE)
+		return XST_FAILURE;
+	Xil_Out32(inst->WriteChannel.ChanBase + XAXIVDMA_S2MM_IRQ_MASK_OFFSET, mask & XAXIVDMA_S2MM_IRQ_ERR_ALL_MASK);
+	return XST_SUCCESS;
+}
+
+void XAxiVdma_IntrEnable(XAxiVdma* inst, u32 mask, u16 direction)
+{
+	vdmaSetCr(vdmaChannel(inst, direction), mask & XAXIVDMA_IXR_ALL_MASK, 0);
+}
+
+void XAxiVdma_IntrDisable(XAxiVdma* inst, u32 mask, u16 direction)
+{
+	vdmaSetCr(vdmaChannel(inst, direction), 0, mask & XAXIVDMA_IXR_ALL_MASK);
+}
+
+u32 XAxiVdma_IntrGetPending(XAxiVdma* inst, u16 direction)
+{
+	return Xil_In32(vdmaChannel(inst, direction)->ChanBase + XAXIVDMA_SR_OFFSET) & XAXIVDMA_IXR_ALL_MASK;
+}
+
+void XAxiVdma_IntrClear(XAxiVdma* inst, u32 mask, u16 direction)
+{
+	Xil_Out32(vdmaChannel(inst, direction)->ChanBase + XAXIVDMA_SR_OFFSET, mask & XAXIVDMA_IXR_ALL_MASK);
+}
+
+int XAxiVdma_CurrFrameStore(XAxiVdma* inst, u16 direction)
+{
+	u32 const park = Xil_In32(inst->BaseAddr + XAXIVDMA_PARKPTR_OFFSET);
+	if (direction == XAXIVDMA_READ)
+		return (park & XAXIVDMA_PARKPTR_READSTR_MASK) >> XAXIVDMA_READSTR_SHIFT;
+	return (park & XAXIVDMA_PARKPTR_WRTSTR_MASK) >> XAXIVDMA_WRTSTR_SHIFT;
+}
+
+int XAxiVdma_StartParking(XAxiVdma* inst, int frame_index, u16 direction)
+{
+	XAxiVdma_Channel* const chan = vdmaChannel(inst, direction);
+	if (!chan->IsValid || frame_index < 0 || frame_index >= chan->NumFrames)
+		return XST_FAILURE;
+	u32 park = Xil_In32(inst->BaseAddr + XAXIVDMA_PARKPTR_OFFSET);
+	if (direction == XAXIVDMA_READ)
+		park = (park & ~XAXIVDMA_PARKPTR_READREF_MASK) | (u32)frame_index;
+	else
+		park = (park & ~XAXIVDMA_PARKPTR_WRTREF_MASK) | ((u32)frame_index << XAXIVDMA_WRTREF_SHIFT);
+	Xil_Out32(inst->BaseAddr + XAXIVDMA_PARKPTR_OFFSET, park & (XAXIVDMA_PARKPTR_READREF_MASK | XAXIVDMA_PARKPTR_WRTREF_MASK));
+	vdmaSetCr(chan, 0, XAXIVDMA_CR_TAIL_EN_MASK);
+	return XST_SUCCESS;
+}
+
+void XAxiVdma_StopParking(XAxiVdma* inst, u16 direction)
+{
+	vdmaSetCr(vdmaChannel(inst, direction), XAXIVDMA_CR_TAIL_EN_MASK, 0);
+}
+
+u32 XAxiVdma_GetStatus(XAxiVdma* inst, u16 direction)
+{
+	return Xil_In32(vdmaChannel(inst, direction)->ChanBase + XAXIVDMA_SR_OFFSET);
+}
+
+/*
+ * Video timing controller
+ */
+namespace {
+	XVtc_Config vtc_cfg = {XPAR_VTC_0_DEVICE_ID, XPAR_VTC_0_BASEADDR};
+
+	void vtcSetCtl(XVtc* inst, u32 set, u32 clear)
+	{
+		u32 const ctl = Xil_In32(inst->Config.BaseAddress + XVTC_CTL_OFFSET);
+		Xil_Out32(inst->Config.BaseAddress + XVTC_CTL_OFFSET, (ctl & ~clear) | set);
+	}
+}
+
+XVtc_Config* XVtc_LookupConfig(u16 id)
+{
+	return id == vtc_cfg.DeviceId ? &vtc_cfg : NULL;
+}
+
+int XVtc_CfgInitialize(XVtc* inst, XVtc_Config* cfg, UINTPTR base)
+{
+	inst->Config = *cfg;
+	inst->Config.BaseAddress = base;
+	inst->IsReady = 1;
+	return XST_SUCCESS;
+}
+
+void XVtc_Reset(XVtc* inst)
+{
+	Xil_Out32(inst->Config.BaseAddress + XVTC_CTL_OFFSET, XVTC_CTL_RESET_MASK);
+	Xil_Out32(inst->Config.BaseAddress + XVTC_CTL_OFFSET, 0);
+}
+
+void XVtc_SetGeneratorTiming(XVtc* inst, XVtc_Timing* t)
+{
+	UINTPTR const b = inst->Config.BaseAddress;
+	u32 const h_total = t->HActiveVideo + t->HFrontPorch + t->HSyncWidth + t->HBackPorch;
+	u32 const v_total = t->VActiveVideo + t->V0FrontPorch + t->V0SyncWidth + t->V0BackPorch;
+	u32 const hs_start = t->HActiveVideo + t->HFrontPorch;
+	u32 const vs_start = t->VActiveVideo + t->V0FrontPorch - 1;
+	Xil_Out32(b + XVTC_GASIZE_OFFSET, t->HActiveVideo | ((u32)t->VActiveVideo << 16));
+	Xil_Out32(b + XVTC_GHSIZE_OFFSET, h_total);
+	Xil_Out32(b + XVTC_GVSIZE_OFFSET, v_total | (v_total << 16));
+	Xil_Out32(b + XVTC_GHSYNC_OFFSET, hs_start | ((hs_start + t->HSyncWidth) << 16));
+	Xil_Out32(b + XVTC_GVBHOFF_OFFSET, t->HActiveVideo | ((u32)t->HActiveVideo << 16));
+	Xil_Out32(b + XVTC_GVSYNC_OFFSET, vs_start | ((vs_start + t->V0SyncWidth) << 16));
+	Xil_Out32(b + XVTC_GVSHOFF_OFFSET, hs_start | (hs_start << 16));
+	Xil_Out32(b + XVTC_GPOL_OFFSET, (t->HSyncPolarity ? 0x8 : 0) | (t->VSyncPolarity ? 0x4 : 0) | 0x3);
+}
+
+void XVtc_RegUpdateEnable(XVtc* inst)
+{
+	vtcSetCtl(inst, XVTC_CTL_RU_MASK, 0);
+}
+
+void XVtc_EnableGenerator(XVtc* inst)
+{
+	vtcSetCtl(inst, XVTC_CTL_GE_MASK | XVTC_CTL_SW_MASK, 0);
+}
+
+void XVtc_DisableGenerator(XVtc* inst)
+{
+	vtcSetCtl(inst, 0, XVTC_CTL_GE_MASK);
+}
+
+/*
+ * Clocking wizard
+ */
+namespace {
+	XClk_Wiz_Config clk_wiz_cfg = {XPAR_VIDEO_DYNCLK_DEVICE_ID, XPAR_VIDEO_DYNCLK_BASEADDR};
+}
+
+XClk_Wiz_Config* XClk_Wiz_LookupConfig(u16 id)
+{
+	return id == clk_wiz_cfg.DeviceId ? &clk_wiz_cfg : NULL;
+}
+
+int XClk_Wiz_CfgInitialize(XClk_Wiz* inst, XClk_Wiz_Config* cfg, UINTPTR base)
+{
+	inst->Config = *cfg;
+	inst->Config.BaseAddr = base;
+	inst->IsReady = 1;
+	return XST_SUCCESS;
+}
+
+/*
+ * PS I2C. The controller registers are written as the driver would (FIFO
+ * one byte per access) so they show up in the MMIO counts.
+ */
+namespace {
+	XIicPs_Config iic_cfg = {XPAR_PS7_I2C_0_DEVICE_ID, XPAR_PS7_I2C_0_BASEADDR, 111111115};
+	u32 const iic_cr = 0x00, iic_addr = 0x08, iic_data = 0x0C, iic_isr = 0x10, iic_size = 0x14;
+
+	//Status events are delivered from here, so that a handler starting the
+	//next transfer does not recurse once per message of a batch
+	struct { XIicPs* inst; u32 event; bool pending, delivering; } iic_irq = {};
+
+	void iicComplete(XIicPs* inst, u32 event)
+	{
+		Xil_In32(inst->Config.BaseAddress + iic_isr);
+		Xil_Out32(inst->Config.BaseAddress + iic_isr, 0x2FF);
+		iic_irq.inst = inst;
+		iic_irq.event = event;
+		iic_irq.pending = true;
+		if (iic_irq.delivering)
+			return;
+		iic_irq.delivering = true;
+		while (iic_irq.pending)
+		{
+			iic_irq.pending = false;
+			if (iic_irq.inst->StatusHandler)
+				iic_irq.inst->StatusHandler(iic_irq.inst->CallBackRef, iic_irq.event);
+		}
+		iic_irq.delivering = false;
+	}
+}
+
+XIicPs_Config* XIicPs_LookupConfig(u16 id)
+{
+	return id == iic_cfg.DeviceId ? &iic_cfg : NULL;
+}
+
+s32 XIicPs_CfgInitialize(XIicPs* inst, XIicPs_Config* cfg, UINTPTR base)
+{
+	*inst = {};
+	inst->Config = *cfg;
+	inst->Config.BaseAddress = base;
+	inst->IsReady = 1;
+	return XST_SUCCESS;
+}
+
+s32 XIicPs_SelfTest(XIicPs*)
+{
+	return XST_SUCCESS;
+}
+
+s32 XIicPs_SetSClk(XIicPs* inst, u32 rate_Hz)
+{
+	if (!rate_Hz || rate_Hz > 400000)
+		return XST_FAILURE;
+	Xil_Out32(inst->Config.BaseAddress + iic_cr, 0x0000000E);
+	Sim::model.i2c_Hz = rate_Hz;
+	return XST_SUCCESS;
+}
+
+void XIicPs_MasterInterruptHandler(XIicPs*)
+{
+}
+
+void XIicPs_SetStatusHandler(XIicPs* inst, void* ref, XIicPs_IntrHandler handler)
+{
+	inst->StatusHandler = handler;
+	inst->CallBackRef = ref;
+}
+
+void XIicPs_MasterSend(XIicPs* inst, u8* buf, s32 count, u16 addr)
+{
+	UINTPTR const b = inst->Config.BaseAddress;
+	Xil_Out32(b + iic_cr, 0x0000004E);
+	for (s32 i = 0; i < count; ++i)
+		Xil_Out32(b + iic_data, buf[i]);
+	Xil_Out32(b + iic_addr, addr);
+	u32 event = XIICPS_EVENT_COMPLETE_SEND;
+	try
+	{
+		if (!Sim::i2cBus())
+			throw I2C_Client::TransmitError("No device");
+		Sim::i2cBus()->write((uint8_t)addr, buf, count);
+	}
+	catch (I2C_Client::TransmitError const&)
+	{
+		event = XIICPS_EVENT_NACK;
+	}
+	iicComplete(inst, event);
+}
+
+void XIicPs_MasterRecv(XIicPs* inst, u8* buf, s32 count, u16 addr)
+{
+	UINTPTR const b = inst->Config.BaseAddress;
+	Xil_Out32(b + iic_cr, 0x0000005F);
+	Xil_Out32(b + iic_size, count);
+	Xil_Out32(b + iic_addr, addr);
+	u32 event = XIICPS_EVENT_COMPLETE_RECV;
+	try
+	{
+		if (!Sim::i2cBus())
+			throw I2C_Client::TransmitError("No device");
+		Sim::i2cBus()->read((uint8_t)addr, buf, count);
+		for (s32 i = 0; i < count; ++i)
+			Xil_In32(b + iic_data);
+	}
+	catch (I2C_Client::TransmitError const&)
+	{
+		event = XIICPS_EVENT_NACK;
+	}
+	iicComplete(inst, event);
+}
+
+s32 XIicPs_BusIsBusy(XIicPs*)
+{
+	return 0;
+}
+
+s32 XIicPs_SetOptions(XIicPs* inst, u32 options)
+{
+	inst->Options |= options;
+	return XST_SUCCESS;
+}
+
+s32 XIicPs_ClearOptions(XIicPs* inst, u32 options)
+{
+	inst->Options &= ~options;
+	return XST_SUCCESS;
+}
+
+/*
+ * PS GPIO: MIO banks 0-1 (54 pins), EMIO banks 2-3
+ */
+namespace {
+	XGpioPs_Config gpio_cfg = {XPAR_PS7_GPIO_0_DEVICE_ID, XPAR_PS7_GPIO_0_BASEADDR};
+	u32 const gpio_data_ro = 0x60, gpio_dirm = 0x204, gpio_oen = 0x208;
+
+	void gpioBank(u32 pin, u32& bank, u32& bit)
+	{
+		if (pin < 32) { bank = 0; bit = pin; }
+		else if (pin < 54) { bank = 1; bit = pin - 32; }
+		else if (pin < 86) { bank = 2; bit = pin - 54; }
+		else { bank = 3; bit = pin - 86; }
+	}
+
+	void gpioSetBit(XGpioPs* inst, u32 reg, u32 pin, u32 value)
+	{
+		u32 bank, bit;
+		gpioBank(pin, bank, bit);
+		UINTPTR const a = inst->GpioConfig.BaseAddr + bank * 0x40 + reg;
+		u32 const v = Xil_In32(a);
+		Xil_Out32(a, value ? v | (1u << bit) : v & ~(1u << bit));
+	}
+}
+
+XGpioPs_Config* XGpioPs_LookupConfig(u16 id)
+{
+	return id == gpio_cfg.DeviceId ? &gpio_cfg : NULL;
+}
+
+s32 XGpioPs_CfgInitialize(XGpioPs* inst, const XGpioPs_Config* cfg, UINTPTR base)
+{
+	*inst = {};
+	inst->GpioConfig = *cfg;
+	inst->GpioConfig.BaseAddr = base;
+	inst->IsReady = 1;
+	return XST_SUCCESS;
+}
+
+s32 XGpioPs_SelfTest(XGpioPs*)
+{
+	return XST_SUCCESS;
+}
+
+void XGpioPs_SetOutputEnablePin(XGpioPs* inst, u32 pin, u32 enable)
+{
+	gpioSetBit(inst, gpio_oen, pin, enable);
+}
+
+void XGpioPs_SetDirectionPin(XGpioPs* inst, u32 pin, u32 direction)
+{
+	gpioSetBit(inst, gpio_dirm, pin, direction);
+}
+
+void XGpioPs_WritePin(XGpioPs* inst, u32 pin, u32 value)
+{
+	if (pin >= XGPIOPS_MAX_PINS)
+		return;
+	u32 bank, bit;
+	gpioBank(pin, bank, bit);
+	//MASK_DATA_LSW/MSW: upper half masks, lower half data
+	UINTPTR const a = inst->GpioConfig.BaseAddr + bank * 8 + (bit > 15 ? 4 : 0);
+	Xil_Out32(a, (~(1u << (bit % 16)) << 16) | ((value & 1) << (bit % 16)));
+	inst->Out[pin] = value & 1;
+	Sim::gpio(pin, value & 1);
+}
+
+u32 XGpioPs_ReadPin(XGpioPs* inst, u32 pin)
+{
+	if (pin >= XGPIOPS_MAX_PINS)
+		return 0;
+	u32 bank, bit;
+	gpioBank(pin, bank, bit);
+	Xil_In32(inst->GpioConfig.BaseAddr + gpio_data_ro + bank * 4);
+	return inst->Out[pin];
+}
+
+/*
+ * GIC. Interrupts raised by the models (Sim::interrupt()) and software-
+ * generated ones run their handler synchronously; one raised while disabled
+ * stays pending until it is enabled.
+ */
+namespace {
+	XScuGic_Config gic_cfg = {XPAR_PS7_SCUGIC_0_DEVICE_ID, 0xF8F00100, 0xF8F01000};
+	XScuGic* gic_inst = nullptr;
+	bool gic_pending[XSCUGIC_MAX_NUM_INTR_INPUTS];
+
+	void gicDeliver(XScuGic* inst, u32 id)
+	{
+		gic_pending[id] = !inst->Enabled[id];
+		if (inst->Enabled[id] && inst->Table[id].Handler)
+			inst->Table[id].Handler(inst->Table[id].CallBackRef);
+	}
+}
+
+void Sim::interrupt(uint32_t id)
+{
+	if (gic_inst && id < XSCUGIC_MAX_NUM_INTR_INPUTS)
+		gicDeliver(gic_inst, id);
+}
+
+XScuGic_Config* XScuGic_LookupConfig(u16 id)
+{
+	return id == gic_cfg.DeviceId ? &gic_cfg : NULL;
+}
+
+s32 XScuGic_CfgInitialize(XScuGic* inst, XScuGic_Config* cfg, u32)
+{
+	*inst = {};
+	inst->Config = cfg;
+	inst->IsReady = 1;
+	gic_inst = inst;
+	memset(gic_pending, 0, sizeof(gic_pending));
+	return XST_SUCCESS;
+}
+
+s32 XScuGic_SelfTest(XScuGic*)
+{
+	return XST_SUCCESS;
+}
+
+s32 XScuGic_Connect(XScuGic* inst, u32 id, Xil_InterruptHandler handler, void* ref)
+{
+	if (id >= XSCUGIC_MAX_NUM_INTR_INPUTS || !handler)
+		return XST_FAILURE;
+	inst->Table[id] = {handler, ref};
+	return XST_SUCCESS;
+}
+
+void XScuGic_Disconnect(XScuGic* inst, u32 id)
+{
+	if (id < XSCUGIC_MAX_NUM_INTR_INPUTS)
+		inst->Table[id] = {};
+}
+
+void XScuGic_Enable(XScuGic* inst, u32 id)
+{
+	if (id >= XSCUGIC_MAX_NUM_INTR_INPUTS)
+		return;
+	Xil_Out32(inst->Config->DistBaseAddress + 0x100 + (id / 32) * 4, 1u << (id % 32));	// ISER
+	inst->Enabled[id] = 1;
+	if (gic_pending[id])
+		gicDeliver(inst, id);
+}
+
+void XScuGic_Disable(XScuGic* inst, u32 id)
+{
+	if (id >= XSCUGIC_MAX_NUM_INTR_INPUTS)
+		return;
+	Xil_Out32(inst->Config->DistBaseAddress + 0x180 + (id / 32) * 4, 1u << (id % 32));	// ICER
+	inst->Enabled[id] = 0;
+}
+
+void XScuGic_InterruptHandler(XScuGic*)
+{
+}
+
+s32 XScuGic_SoftwareIntr(XScuGic* inst, u32 id, u32 cpu_mask)
+{
+	if (id > 15)
+		return XST_FAILURE;
+	Xil_Out32(inst->Config->DistBaseAddress + 0xF00, (cpu_mask << 16) | id);	// SGIR
+	if (inst->Enabled[id] && inst->Table[id].Handler)
+		inst->Table[id].Handler(inst->Table[id].CallBackRef);
+	return XST_SUCCESS;
+}
+
+void XScuGic_SetPriorityTriggerType(XScuGic*, u32, u8, u8)
+{
+}
+
+/*
+ * SCU private timer: configured but never expires
+ */
+namespace {
+	XScuTimer_Config timer_cfg = {XPAR_XSCUTIMER_0_DEVICE_ID, 0xF8F00600};
+}
+
+XScuTimer_Config* XScuTimer_LookupConfig(u16 id)
+{
+	return id == timer_cfg.DeviceId ? &timer_cfg : NULL;
+}
+
+s32 XScuTimer_CfgInitialize(XScuTimer* inst, XScuTimer_Config* cfg, u32 base)
+{
+	*inst = {};
+	inst->Config = *cfg;
+	inst->Config.BaseAddr = base;
+	inst->IsReady = 1;
+	return XST_SUCCESS;
+}
+
+s32 XScuTimer_SelfTest(XScuTimer*) { return XST_SUCCESS; }
+void XScuTimer_Start(XScuTimer* inst) { inst->IsStarted = 1; }
+void XScuTimer_Stop(XScuTimer* inst) { inst->IsStarted = 0; }
+void XScuTimer_LoadTimer(XScuTimer* inst, u32 value) { inst->Load = value; }
+void XScuTimer_EnableAutoReload(XScuTimer*) {}
+void XScuTimer_EnableInterrupt(XScuTimer*) {}
+void XScuTimer_DisableInterrupt(XScuTimer*) {}
+void XScuTimer_ClearInterruptStatus(XScuTimer*) {}
+u32 XScuTimer_GetCounterValue(XScuTimer* inst) { return inst->Load; }
+
+/*
+ * UART: console output only
+ */
+void XUartPs_SendByte(u32, u8 data)
+{
+	if (Sim::echo())
+		putchar(data);
+}
+
+u8 XUartPs_RecvByte(u32)
+{
+	return 0;
+}
+
+/*
+ * FatFs: an in-memory card while one is inserted (Sim::setCard()), files
+ * by path. Writes land at once, so f_sync() has nothing left to do.
+ */
+namespace {
+	typedef std::vector<uint8_t> file_t;
+	bool card_in = false;
+	std::map<std::string, file_t> card_files;
+}
+
+void Sim::setCard(bool inserted)
+{
+	card_in = inserted;
+	card_files.clear();
+}
+
+uint8_t* Sim::cardFile(char const* path, size_t& len)
+{
+	auto const it = card_files.find(path);
+	if (it == card_files.end())
+		return NULL;
+	len = it->second.size();
+	return it->second.data();
+}
+
+void Sim::cardWrite(char const* path, uint8_t const* data, size_t len)
+{
+	card_files[path].assign(data, data + len);
+}
+
+FRESULT f_mount(FATFS*, const TCHAR*, BYTE)
+{
+	return card_in ? FR_OK : FR_NOT_READY;
+}
+
+FRESULT f_open(FIL* fp, const TCHAR* path, BYTE mode)
+{
+	if (!card_in)
+		return FR_NOT_READY;
+	auto it = card_files.find(path);
+	if (it == card_files.end())
+	{
+		if (!(mode & (FA_CREATE_NEW | FA_CREATE_ALWAYS | FA_OPEN_ALWAYS)))
+			return FR_NO_FILE;
+		it = card_files.emplace(path, file_t()).first;
+	}
+	else if (mode & FA_CREATE_NEW)
+	{
+		return FR_EXIST;
+	}
+	else if (mode & FA_CREATE_ALWAYS)
+	{
+		it->second.clear();
+	}
+	fp->file = &it->second;
+	fp->flag = mode;
+	fp->fptr = 0;
+	return FR_OK;
+}
+
+FRESULT f_close(FIL* fp)
+{
+	fp->file = NULL;
+	return FR_OK;
+}
+
+FRESULT f_read(FIL* fp, void* buf, UINT btr, UINT* br)
+{
+	*br = 0;
+	if (!card_in || !fp->file)
+		return FR_NOT_READY;
+	if (!(fp->flag & FA_READ))
+		return FR_DENIED;
+	file_t const& f = *static_cast<file_t*>(fp->file);
+	if (fp->fptr < f.size())
+	{
+		*br = (UINT)std::min<size_t>(btr, f.size() - fp->fptr);
+		memcpy(buf, f.data() + fp->fptr, *br);
+		fp->fptr += *br;
+	}
+	return FR_OK;
+}
+
+FRESULT f_write(FIL* fp, const void* buf, UINT btw, UINT* bw)
+{
+	*bw = 0;
+	if (!card_in || !fp->file)
+		return FR_NOT_READY;
+	if (!(fp->flag & FA_WRITE))
+		return FR_DENIED;
+	file_t& f = *static_cast<file_t*>(fp->file);
+	if (f.size() < fp->fptr + btw)
+		f.resize(fp->fptr + btw);
+	memcpy(f.data() + fp->fptr, buf, btw);
+	fp->fptr += btw;
+	*bw = btw;
+	return FR_OK;
+}
+
+FRESULT f_sync(FIL* fp)
+{
+	return card_in && fp->file ? FR_OK : FR_NOT_READY;
+}
+
+FRESULT f_lseek(FIL* fp, FSIZE_t ofs)
+{
+	if (!card_in || !fp->file)
+		return FR_NOT_READY;
+	fp->fptr = ofs;
+	return FR_OK;
+}
+
+FRESULT f_unlink(const TCHAR* path)
+{
+	if (!card_in)
+		return FR_NOT_READY;
+	return card_files.erase(path) ? FR_OK : FR_NO_FILE;
+}
+
+FRESULT f_rename(const TCHAR* from, const TCHAR* to)
+{
+	if (!card_in)
+		return FR_NOT_READY;
+	auto const it = card_files.find(from);
+	if (it == card_files.end())
+		return FR_NO_FILE;
+	if (card_files.count(to))
+		return FR_EXIST;
+	file_t f;
+	f.swap(it->second);
+	card_files.erase(it);
+	card_files[to].swap(f);
+	return FR_OK;
+}
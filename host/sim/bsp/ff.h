@@ -0,0 +1,38 @@
+/*
+ * ff.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+
+typedef unsigned int UINT;
+typedef unsigned char BYTE;
+typedef char TCHAR;
+typedef u32 DWORD;
+typedef u32 FSIZE_t;
+typedef enum { FR_OK = 0, FR_DISK_ERR, FR_INT_ERR, FR_NOT_READY, FR_NO_FILE, FR_NO_PATH,
+	FR_INVALID_NAME, FR_DENIED, FR_EXIST } FRESULT;
+typedef struct { int dummy; } FATFS;
+typedef struct { void* file; BYTE flag; FSIZE_t fptr; } FIL;
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_OPEN_EXISTING 0x00
+#define FA_CREATE_NEW 0x04
+#define FA_CREATE_ALWAYS 0x08
+#define FA_OPEN_ALWAYS 0x10
+// Without a card (Sim::setCard()) every call fails with FR_NOT_READY
+FRESULT f_mount(FATFS*, const TCHAR*, BYTE);
+FRESULT f_open(FIL*, const TCHAR*, BYTE);
+FRESULT f_close(FIL*);
+FRESULT f_read(FIL*, void*, UINT, UINT*);
+FRESULT f_write(FIL*, const void*, UINT, UINT*);
+FRESULT f_sync(FIL*);
+FRESULT f_lseek(FIL*, FSIZE_t);
+FRESULT f_unlink(const TCHAR*);
+FRESULT f_rename(const TCHAR*, const TCHAR*);
@@ -0,0 +1,156 @@
+/*
+ * xaxivdma.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xil_io.h"
+
+#define XAXIVDMA_MAX_FRAMESTORE 32
+#define XAXIVDMA_READ 1
+#define XAXIVDMA_WRITE 2
+#define XAXIVDMA_HANDLER_GENERAL 1
+#define XAXIVDMA_HANDLER_ERROR 2
+
+#define XAXIVDMA_TX_OFFSET 0x00			// MM2S channel registers
+#define XAXIVDMA_RX_OFFSET 0x30			// S2MM channel registers
+#define XAXIVDMA_CR_OFFSET 0x00
+#define XAXIVDMA_SR_OFFSET 0x04
+#define XAXIVDMA_S2MM_IRQ_MASK_OFFSET 0x0C	// from the S2MM channel base
+#define XAXIVDMA_PARKPTR_OFFSET 0x28
+#define XAXIVDMA_MM2S_ADDR_OFFSET 0x50
+#define XAXIVDMA_S2MM_ADDR_OFFSET 0xA0
+#define XAXIVDMA_VSIZE_OFFSET 0x00		// from the channel address block
+#define XAXIVDMA_HSIZE_OFFSET 0x04
+#define XAXIVDMA_STRD_FRMDLY_OFFSET 0x08
+#define XAXIVDMA_START_ADDR_OFFSET 0x0C
+
+#define XAXIVDMA_CR_RUNSTOP_MASK 0x00000001
+#define XAXIVDMA_CR_TAIL_EN_MASK 0x00000002
+#define XAXIVDMA_CR_RESET_MASK 0x00000004
+#define XAXIVDMA_CR_SYNC_EN_MASK 0x00000008
+#define XAXIVDMA_CR_FRMCNT_EN_MASK 0x00000010
+#define XAXIVDMA_SR_HALTED_MASK 0x00000001
+#define XAXIVDMA_SR_IDLE_MASK 0x00000002
+#define XAXIVDMA_SR_ERR_INTERNAL_MASK 0x00000010
+#define XAXIVDMA_SR_ERR_SLAVE_MASK 0x00000020
+#define XAXIVDMA_SR_ERR_DECODE_MASK 0x00000040
+#define XAXIVDMA_SR_ERR_FSZ_LESS_MASK 0x00000080
+#define XAXIVDMA_SR_ERR_LSZ_LESS_MASK 0x00000100
+#define XAXIVDMA_SR_ERR_SG_SLV_MASK 0x00000200
+#define XAXIVDMA_SR_ERR_SG_DEC_MASK 0x00000400
+#define XAXIVDMA_SR_ERR_FSZ_MORE_MASK 0x00000800
+#define XAXIVDMA_SR_ERR_ALL_MASK 0x00000FF0
+#define XAXIVDMA_IXR_FRMCNT_MASK 0x00001000
+#define XAXIVDMA_IXR_DELAYCNT_MASK 0x00002000
+#define XAXIVDMA_IXR_ERROR_MASK 0x00004000
+#define XAXIVDMA_IXR_COMPLETION_MASK 0x00003000
+#define XAXIVDMA_IXR_ALL_MASK 0x00007000
+#define XAXIVDMA_S2MM_IRQ_ERR_ALL_MASK 0x0000000F
+#define XAXIVDMA_PARKPTR_READREF_MASK 0x0000001F
+#define XAXIVDMA_PARKPTR_WRTREF_MASK 0x00001F00
+#define XAXIVDMA_WRTREF_SHIFT 8
+#define XAXIVDMA_PARKPTR_READSTR_MASK 0x001F0000
+#define XAXIVDMA_READSTR_SHIFT 16
+#define XAXIVDMA_PARKPTR_WRTSTR_MASK 0x1F000000
+#define XAXIVDMA_WRTSTR_SHIFT 24
+
+typedef struct
+{
+	u16 DeviceId;
+	UINTPTR BaseAddress;
+	u16 MaxFrameStoreNum;
+	int HasMm2s;
+	int HasS2Mm;
+	int Mm2SStreamWidth;	// bytes per pixel
+	int S2MmStreamWidth;
+} XAxiVdma_Config;
+
+typedef void (*XAxiVdma_CallBack)(void* CallBackRef, u32 InterruptTypes);
+typedef void (*XAxiVdma_ErrorCallBack)(void* CallBackRef, u32 ErrorMask);
+
+typedef struct
+{
+	UINTPTR ChanBase;
+	UINTPTR InstanceBase;
+	UINTPTR StartAddrBase;
+	int IsValid;
+	int FlushonFsync;
+	int HasSG;
+	int IsRead;
+	int StreamWidth;
+	int direction;
+	int NumFrames;
+	int Vsize;
+} XAxiVdma_Channel;
+
+typedef struct
+{
+	XAxiVdma_CallBack CompletionCallBack;
+	void* CompletionRef;
+	XAxiVdma_ErrorCallBack ErrCallBack;
+	void* ErrRef;
+} XAxiVdma_ChannelCallBack;
+
+typedef struct
+{
+	UINTPTR BaseAddr;
+	int MaxNumFrames;
+	int HasMm2S;
+	int HasS2Mm;
+	XAxiVdma_Channel ReadChannel;
+	XAxiVdma_Channel WriteChannel;
+	XAxiVdma_ChannelCallBack ReadCallBack;
+	XAxiVdma_ChannelCallBack WriteCallBack;
+	int IsReady;
+} XAxiVdma;
+
+typedef struct
+{
+	int VertSizeInput;
+	int HoriSizeInput;
+	int Stride;
+	int FrameDelay;
+	int EnableCircularBuf;
+	int EnableSync;
+	int PointNum;
+	int EnableFrameCounter;
+	UINTPTR FrameStoreStartAddr[XAXIVDMA_MAX_FRAMESTORE];
+	int FixedFrameStoreAddr;
+	int GenLockRepeat;
+} XAxiVdma_DmaSetup;
+
+XAxiVdma_Config* XAxiVdma_LookupConfig(u16 id);
+int XAxiVdma_CfgInitialize(XAxiVdma* inst, XAxiVdma_Config* cfg, UINTPTR base);
+int XAxiVdma_SetCallBack(XAxiVdma* inst, u32 type, void* func, void* ref, u16 direction);
+void XAxiVdma_ReadIntrHandler(void* inst);
+void XAxiVdma_WriteIntrHandler(void* inst);
+void XAxiVdma_ChannelReset(XAxiVdma_Channel* chan);
+int XAxiVdma_ChannelResetNotDone(XAxiVdma_Channel* chan);
+int XAxiVdma_ChannelIsRunning(XAxiVdma_Channel* chan);
+void XAxiVdma_ChannelStop(XAxiVdma_Channel* chan);
+int XAxiVdma_DmaConfig(XAxiVdma* inst, u16 direction, XAxiVdma_DmaSetup* setup);
+int XAxiVdma_DmaSetBufferAddr(XAxiVdma* inst, u16 direction, UINTPTR* addrs);
+int XAxiVdma_DmaStart(XAxiVdma* inst, u16 direction);
+void XAxiVdma_DmaStop(XAxiVdma* inst, u16 direction);
+int XAxiVdma_ClearChannelErrors(XAxiVdma_Channel* chan, u32 mask);
+int XAxiVdma_ClearDmaChannelErrors(XAxiVdma* inst, u16 direction, u32 mask);
+int XAxiVdma_MaskS2MMErrIntr(XAxiVdma* inst, u32 mask, u16 direction);
+void XAxiVdma_IntrEnable(XAxiVdma* inst, u32 mask, u16 direction);
+void XAxiVdma_IntrDisable(XAxiVdma* inst, u32 mask, u16 direction);
+u32 XAxiVdma_IntrGetPending(XAxiVdma* inst, u16 direction);
+void XAxiVdma_IntrClear(XAxiVdma* inst, u32 mask, u16 direction);
+int XAxiVdma_CurrFrameStore(XAxiVdma* inst, u16 direction);
+int XAxiVdma_StartParking(XAxiVdma* inst, int frame_index, u16 direction);
+void XAxiVdma_StopParking(XAxiVdma* inst, u16 direction);
+u32 XAxiVdma_GetStatus(XAxiVdma* inst, u16 direction);
+
+#define XAxiVdma_ReadReg(b, o) Xil_In32((b) + (o))
+#define XAxiVdma_WriteReg(b, o, v) Xil_Out32((b) + (o), (v))
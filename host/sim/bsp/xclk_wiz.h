@@ -0,0 +1,23 @@
+/*
+ * xclk_wiz.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xil_io.h"
+
+typedef struct { u16 DeviceId; UINTPTR BaseAddr; } XClk_Wiz_Config;
+typedef struct { XClk_Wiz_Config Config; u32 IsReady; } XClk_Wiz;
+
+XClk_Wiz_Config* XClk_Wiz_LookupConfig(u16 id);
+int XClk_Wiz_CfgInitialize(XClk_Wiz* inst, XClk_Wiz_Config* cfg, UINTPTR base);
+
+#define XClk_Wiz_ReadReg(b, o) Xil_In32((b) + (o))
+#define XClk_Wiz_WriteReg(b, o, v) Xil_Out32((b) + (o), (v))
@@ -0,0 +1,74 @@
+/*
+ * xcsi_hw.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_io.h"
+
+#define XCSI_CCR_OFFSET 0x00
+#define XCSI_PCR_OFFSET 0x04
+#define XCSI_CSR_OFFSET 0x10
+#define XCSI_GIER_OFFSET 0x20
+#define XCSI_ISR_OFFSET 0x24
+#define XCSI_IER_OFFSET 0x28
+#define XCSI_SPKTR_OFFSET 0x30
+#define XCSI_CLKINFR_OFFSET 0x3C
+#define XCSI_L0INFR_OFFSET 0x40
+#define XCSI_L1INFR_OFFSET 0x44
+#define XCSI_VC0INF1R_OFFSET 0x60
+#define XCSI_VC0INF2R_OFFSET 0x64
+#define XCSI_CCR_COREENB_MASK 0x1
+#define XCSI_CCR_COREENB_SHIFT 0
+#define XCSI_CCR_SOFTRESET_MASK 0x2
+#define XCSI_CCR_SOFTRESET_SHIFT 1
+#define XCSI_CSR_PKTCOUNT_MASK 0xFFFF0000
+#define XCSI_CSR_PKTCOUNT_SHIFT 16
+#define XCSI_CSR_SPFIFOFULL_MASK 0x8
+#define XCSI_CSR_SPFIFONE_MASK 0x4
+#define XCSI_CSR_SLBF_MASK 0x2
+#define XCSI_CSR_RIPCD_MASK 0x1
+#define XCSI_GIER_GIE_MASK 0x1
+#define XCSI_ISR_FR_MASK (1U<<31)
+#define XCSI_ISR_VCXFE_MASK (1U<<30)
+#define XCSI_ISR_WC_MASK (1U<<22)
+#define XCSI_ISR_ILC_MASK (1U<<21)
+#define XCSI_ISR_SPFIFOF_MASK (1U<<20)
+#define XCSI_ISR_SPFIFONE_MASK (1U<<19)
+#define XCSI_ISR_SLBF_MASK (1U<<18)
+#define XCSI_ISR_STOP_MASK (1U<<17)
+#define XCSI_ISR_SOTERR_MASK (1U<<13)
+#define XCSI_ISR_SOTSYNCERR_MASK (1U<<12)
+#define XCSI_ISR_ECC2BERR_MASK (1U<<11)
+#define XCSI_ISR_ECC1BERR_MASK (1U<<10)
+#define XCSI_ISR_CRCERR_MASK (1U<<9)
+#define XCSI_ISR_DATAIDERR_MASK (1U<<8)
+#define XCSI_ISR_VC0FSYNCERR_MASK (1U<<4)
+#define XCSI_ISR_VC0FLVLERR_MASK (1U<<0)
+#define XCSI_ISR_ALLINTR_MASK 0xC03FFFFF
+#define XCSI_IER_ALLINTR_MASK 0xC03FFFFF
+#define XCSI_PCR_MAXLANES_MASK 0x18
+#define XCSI_PCR_MAXLANES_SHIFT 3
+#define XCSI_PCR_ACTLANES_MASK 0x3
+#define XCSI_PCR_ACTLANES_SHIFT 0
+#define XCSI_CLKINFR_STOP_MASK 0x2
+#define XCSI_LXINFR_STOP_MASK 0x20
+#define XCSI_LXINFR_SKEWCALHS_MASK 0x4
+#define XCSI_LXINFR_SOTERR_MASK 0x2
+#define XCSI_LXINFR_SOTSYNCERR_MASK 0x1
+#define XCSI_SPKTR_VC_MASK 0xC0
+#define XCSI_SPKTR_VC_SHIFT 6
+#define XCSI_SPKTR_DT_MASK 0x3F
+#define XCSI_SPKTR_DATA_MASK 0xFFFF00
+#define XCSI_SPKTR_DATA_SHIFT 8
+#define XCSI_VCXINF1R_LINECOUNT_MASK 0xFFFF0000
+#define XCSI_VCXINF1R_LINECOUNT_SHIFT 16
+#define XCSI_VCXINF1R_BYTECOUNT_MASK 0xFFFF
+#define XCSI_VCXINF2R_DATATYPE_MASK 0x3F
+#define XCsi_ReadReg(b,o) Xil_In32((b)+(o))
+#define XCsi_WriteReg(b,o,v) Xil_Out32((b)+(o),(v))
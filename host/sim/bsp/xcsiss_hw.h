@@ -0,0 +1,15 @@
+/*
+ * xcsiss_hw.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_io.h"
+
+#define XCsiSs_ReadReg(b,o) Xil_In32((b)+(o))
+#define XCsiSs_WriteReg(b,o,v) Xil_Out32((b)+(o),(v))
@@ -0,0 +1,27 @@
+/*
+ * xgpiops.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XGPIOPS_MAX_PINS 118
+
+typedef struct { u16 DeviceId; UINTPTR BaseAddr; } XGpioPs_Config;
+typedef struct { XGpioPs_Config GpioConfig; u32 IsReady; u8 Out[XGPIOPS_MAX_PINS]; } XGpioPs;
+
+XGpioPs_Config* XGpioPs_LookupConfig(u16 id);
+s32 XGpioPs_CfgInitialize(XGpioPs* inst, const XGpioPs_Config* cfg, UINTPTR base);
+s32 XGpioPs_SelfTest(XGpioPs* inst);
+void XGpioPs_SetOutputEnablePin(XGpioPs* inst, u32 pin, u32 enable);
+void XGpioPs_SetDirectionPin(XGpioPs* inst, u32 pin, u32 direction);
+// Output changes are reported to the hook set with Sim::onGpio()
+void XGpioPs_WritePin(XGpioPs* inst, u32 pin, u32 value);
+u32 XGpioPs_ReadPin(XGpioPs* inst, u32 pin);
@@ -0,0 +1,51 @@
+/*
+ * xiicps.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XIICPS_EVENT_COMPLETE_SEND 0x0001U
+#define XIICPS_EVENT_COMPLETE_RECV 0x0002U
+#define XIICPS_EVENT_TIME_OUT 0x0004U
+#define XIICPS_EVENT_ERROR 0x0008U
+#define XIICPS_EVENT_ARB_LOST 0x0010U
+#define XIICPS_EVENT_NACK 0x0020U
+#define XIICPS_EVENT_SLAVE_RDY 0x0040U
+#define XIICPS_EVENT_RX_OVR 0x0080U
+#define XIICPS_EVENT_TX_OVR 0x0100U
+#define XIICPS_EVENT_RX_UNF 0x0200U
+#define XIICPS_REP_START_OPTION 0x02U
+
+typedef void (*XIicPs_IntrHandler)(void* CallBackRef, u32 StatusEvent);
+typedef struct { u16 DeviceId; UINTPTR BaseAddress; u32 InputClockHz; } XIicPs_Config;
+typedef struct
+{
+	XIicPs_Config Config;
+	u32 IsReady;
+	u32 Options;
+	XIicPs_IntrHandler StatusHandler;
+	void* CallBackRef;
+} XIicPs;
+
+XIicPs_Config* XIicPs_LookupConfig(u16 id);
+s32 XIicPs_CfgInitialize(XIicPs* inst, XIicPs_Config* cfg, UINTPTR base);
+s32 XIicPs_SelfTest(XIicPs* inst);
+// Sets the bus rate of the I2C timing model
+s32 XIicPs_SetSClk(XIicPs* inst, u32 rate_Hz);
+void XIicPs_MasterInterruptHandler(XIicPs* inst);
+void XIicPs_SetStatusHandler(XIicPs* inst, void* ref, XIicPs_IntrHandler handler);
+// Transfers complete synchronously on the device set with Sim::setI2cBus(),
+// the status handler is called before they return
+void XIicPs_MasterSend(XIicPs* inst, u8* buf, s32 count, u16 addr);
+void XIicPs_MasterRecv(XIicPs* inst, u8* buf, s32 count, u16 addr);
+s32 XIicPs_BusIsBusy(XIicPs* inst);
+s32 XIicPs_SetOptions(XIicPs* inst, u32 options);
+s32 XIicPs_ClearOptions(XIicPs* inst, u32 options);
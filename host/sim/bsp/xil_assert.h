@@ -0,0 +1,13 @@
+/*
+ * xil_assert.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#define Xil_AssertVoid(x) do { if (!(x)) return; } while (0)
+#define Xil_AssertNonvoid(x) do { if (!(x)) return 0; } while (0)
@@ -0,0 +1,20 @@
+/*
+ * xil_cache.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+
+// No caches to maintain on the host
+void Xil_DCacheInvalidateRange(INTPTR addr, u32 len);
+void Xil_DCacheFlushRange(INTPTR addr, u32 len);
+void Xil_DCacheEnable();
+void Xil_DCacheDisable();
+void Xil_ICacheEnable();
+void Xil_ICacheDisable();
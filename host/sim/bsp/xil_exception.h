@@ -0,0 +1,18 @@
+/*
+ * xil_exception.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+
+#define XIL_EXCEPTION_ID_INT 5
+
+void Xil_ExceptionRegisterHandler(u32 id, Xil_ExceptionHandler handler, void* data);
+void Xil_ExceptionEnable();
+void Xil_ExceptionDisable();
@@ -0,0 +1,18 @@
+/*
+ * xil_io.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+
+// Routed to the device models registered with Sim::map(), counted and timed
+u32 Xil_In32(UINTPTR addr);
+void Xil_Out32(UINTPTR addr, u32 value);
+u8 Xil_In8(UINTPTR addr);
+void Xil_Out8(UINTPTR addr, u8 value);
@@ -0,0 +1,19 @@
+/*
+ * xil_printf.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void xil_printf(const char* fmt, ...);
+void outbyte(char c);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+/*
+ * xil_types.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef uintptr_t UINTPTR;
+typedef uintptr_t INTPTR;
+
+typedef void (*Xil_InterruptHandler)(void* data);
+typedef void (*Xil_ExceptionHandler)(void* data);
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
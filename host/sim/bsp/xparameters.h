@@ -0,0 +1,43 @@
+/*
+ * xparameters.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+
+#define XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ 666666687
+#define XPAR_DDR_MEM_BASEADDR 0x00100000
+
+#define XPAR_PS7_SCUGIC_0_DEVICE_ID 0
+#define XPAR_XSCUTIMER_0_DEVICE_ID 0
+#define XPAR_SCUTIMER_INTR 29
+
+#define XPAR_PS7_GPIO_0_DEVICE_ID 0
+#define XPAR_PS7_GPIO_0_BASEADDR 0xE000A000
+#define XPAR_PS7_GPIO_0_INTR 52
+#define XPAR_PS7_I2C_0_DEVICE_ID 0
+#define XPAR_PS7_I2C_0_BASEADDR 0xE0004000
+#define XPAR_PS7_I2C_0_INTR 57
+#define XPAR_PS7_UART_1_DEVICE_ID 0
+#define XPAR_PS7_UART_1_INTR 82
+#define STDIN_BASEADDRESS 0xE0001000
+#define STDOUT_BASEADDRESS 0xE0001000
+#define XPS_SYS_CTRL_BASEADDR 0xF8000000
+
+#define XPAR_AXIVDMA_0_DEVICE_ID 0
+#define XPAR_AXIVDMA_0_BASEADDR 0x43000000
+#define XPAR_FABRIC_AXI_VDMA_0_MM2S_INTROUT_INTR 61
+#define XPAR_FABRIC_AXI_VDMA_0_S2MM_INTROUT_INTR 62
+#define XPAR_VTC_0_DEVICE_ID 0
+#define XPAR_VTC_0_BASEADDR 0x43C00000
+#define XPAR_AXI_GAMMACORRECTION_0_BASEADDR 0x43C10000
+#define XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR 0x43C20000
+#define XPAR_FABRIC_MIPI_CSI2_RX_SUBSYST_0_CSIRXSS_CSI_IRQ_INTR 63
+#define XPAR_VIDEO_DYNCLK_DEVICE_ID 0
+#define XPAR_VIDEO_DYNCLK_BASEADDR 0x43C30000
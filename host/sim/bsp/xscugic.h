@@ -0,0 +1,39 @@
+/*
+ * xscugic.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xil_exception.h"
+
+#define XSCUGIC_MAX_NUM_INTR_INPUTS 95
+#define XSCUGIC_SPI_CPU0_MASK 0x1
+
+typedef struct { u16 DeviceId; UINTPTR CpuBaseAddress; UINTPTR DistBaseAddress; } XScuGic_Config;
+typedef struct { Xil_InterruptHandler Handler; void* CallBackRef; } XScuGic_VectorTableEntry;
+typedef struct
+{
+	XScuGic_Config* Config;
+	u32 IsReady;
+	XScuGic_VectorTableEntry Table[XSCUGIC_MAX_NUM_INTR_INPUTS];
+	u8 Enabled[XSCUGIC_MAX_NUM_INTR_INPUTS];
+} XScuGic;
+
+XScuGic_Config* XScuGic_LookupConfig(u16 id);
+s32 XScuGic_CfgInitialize(XScuGic* inst, XScuGic_Config* cfg, u32 base);
+s32 XScuGic_SelfTest(XScuGic* inst);
+s32 XScuGic_Connect(XScuGic* inst, u32 id, Xil_InterruptHandler handler, void* ref);
+void XScuGic_Disconnect(XScuGic* inst, u32 id);
+void XScuGic_Enable(XScuGic* inst, u32 id);
+void XScuGic_Disable(XScuGic* inst, u32 id);
+void XScuGic_InterruptHandler(XScuGic* inst);
+// Runs the handler of an enabled interrupt synchronously
+s32 XScuGic_SoftwareIntr(XScuGic* inst, u32 id, u32 cpu_mask);
+void XScuGic_SetPriorityTriggerType(XScuGic* inst, u32 id, u8 priority, u8 trigger);
@@ -0,0 +1,28 @@
+/*
+ * xscutimer.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+typedef struct { u16 DeviceId; u32 BaseAddr; } XScuTimer_Config;
+typedef struct { XScuTimer_Config Config; u32 IsReady; u32 IsStarted; u32 Load; } XScuTimer;
+
+XScuTimer_Config* XScuTimer_LookupConfig(u16 id);
+s32 XScuTimer_CfgInitialize(XScuTimer* inst, XScuTimer_Config* cfg, u32 base);
+s32 XScuTimer_SelfTest(XScuTimer* inst);
+void XScuTimer_Start(XScuTimer* inst);
+void XScuTimer_Stop(XScuTimer* inst);
+void XScuTimer_LoadTimer(XScuTimer* inst, u32 value);
+void XScuTimer_EnableAutoReload(XScuTimer* inst);
+void XScuTimer_EnableInterrupt(XScuTimer* inst);
+void XScuTimer_DisableInterrupt(XScuTimer* inst);
+void XScuTimer_ClearInterruptStatus(XScuTimer* inst);
+u32 XScuTimer_GetCounterValue(XScuTimer* inst);
@@ -0,0 +1,16 @@
+/*
+ * xstatus.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+
+typedef int XStatus;
+#define XST_SUCCESS 0L
+#define XST_FAILURE 1L
@@ -0,0 +1,18 @@
+/*
+ * xtime_l.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+
+typedef u64 XTime;
+#define COUNTS_PER_SECOND 333333343ULL
+
+// Simulated time: every call advances the clock by Sim::model.timer_read_ns
+void XTime_GetTime(XTime* t);
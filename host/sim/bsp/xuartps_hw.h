@@ -0,0 +1,34 @@
+/*
+ * xuartps_hw.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_io.h"
+
+#define XUARTPS_FIFO_OFFSET 0x30
+#define XUARTPS_SR_OFFSET 0x2C
+#define XUARTPS_SR_RXEMPTY 0x2U
+#define XUARTPS_SR_TXFULL 0x10U
+#define XUARTPS_IER_OFFSET 0x08
+#define XUARTPS_IDR_OFFSET 0x0C
+#define XUARTPS_IMR_OFFSET 0x10
+#define XUARTPS_ISR_OFFSET 0x14
+#define XUARTPS_RXWM_OFFSET 0x20
+#define XUARTPS_RXTOUT_OFFSET 0x1C
+#define XUARTPS_IXR_RXOVR 0x1U
+#define XUARTPS_IXR_RXFULL 0x4U
+#define XUARTPS_IXR_TOUT 0x100U
+#define XUARTPS_IXR_OVER 0x20U
+#define XUARTPS_IXR_MASK 0x3FFFU
+#define XUartPs_IsReceiveData(b) (!((Xil_In32((b)+XUARTPS_SR_OFFSET)) & XUARTPS_SR_RXEMPTY))
+#define XUartPs_IsTransmitFull(b) ((Xil_In32((b)+XUARTPS_SR_OFFSET)) & XUARTPS_SR_TXFULL)
+#define XUartPs_ReadReg(b,o) Xil_In32((b)+(o))
+#define XUartPs_WriteReg(b,o,v) Xil_Out32((b)+(o),(v))
+void XUartPs_SendByte(u32 base, u8 data);
+u8 XUartPs_RecvByte(u32 base);
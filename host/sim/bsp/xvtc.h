@@ -0,0 +1,44 @@
+/*
+ * xvtc.h
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Host stand-in for the standalone BSP header of the same name: only what
+ * the firmware uses. See host/sim/Sim.h.
+ */
+
+#pragma once
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XVTC_CTL_OFFSET 0x000
+#define XVTC_GASIZE_OFFSET 0x060
+#define XVTC_GPOL_OFFSET 0x06C
+#define XVTC_GHSIZE_OFFSET 0x070
+#define XVTC_GVSIZE_OFFSET 0x074
+#define XVTC_GHSYNC_OFFSET 0x078
+#define XVTC_GVBHOFF_OFFSET 0x07C
+#define XVTC_GVSYNC_OFFSET 0x080
+#define XVTC_GVSHOFF_OFFSET 0x084
+#define XVTC_CTL_SW_MASK 0x00000001
+#define XVTC_CTL_RU_MASK 0x00000002
+#define XVTC_CTL_GE_MASK 0x00000004
+#define XVTC_CTL_RESET_MASK 0x80000000
+
+typedef struct { u16 DeviceId; UINTPTR BaseAddress; } XVtc_Config;
+typedef struct { XVtc_Config Config; u32 IsReady; } XVtc;
+typedef struct
+{
+	u16 HActiveVideo, HFrontPorch, HSyncWidth, HBackPorch, HSyncPolarity;
+	u16 VActiveVideo, V0FrontPorch, V0SyncWidth, V0BackPorch, V1FrontPorch, V1SyncWidth, V1BackPorch, VSyncPolarity;
+	u8 Interlaced;
+} XVtc_Timing;
+
+XVtc_Config* XVtc_LookupConfig(u16 id);
+int XVtc_CfgInitialize(XVtc* inst, XVtc_Config* cfg, UINTPTR base);
+void XVtc_Reset(XVtc* inst);
+void XVtc_SetGeneratorTiming(XVtc* inst, XVtc_Timing* timing);
+void XVtc_RegUpdateEnable(XVtc* inst);
+void XVtc_EnableGenerator(XVtc* inst);
+void XVtc_DisableGenerator(XVtc* inst);
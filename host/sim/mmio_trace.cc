@@ -0,0 +1,457 @@
+/*
+ * mmio_trace.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Records, inspects, compares and replays register access traces in the
+ * format of src/util/MmioTrace.h.
+ *
+ *   mmio_trace record [-k i2c_kHz] [-m mode]... out.trace
+ *       Cold bring-up and pipeline_mode_change() into each mode (default the
+ *       firmware's boot mode) on the register models, every MMIO access
+ *       recorded, the Xilinx driver internals included.
+ *
+ *   mmio_trace show in.trace
+ *   mmio_trace analyse in.trace
+ *       Accesses per device, folded polls, and writes that left a register
+ *       at the value it already had (redundant) or repeat the write just
+ *       before them (duplicate), with the bus time they cost.
+ *
+ *   mmio_trace diff a.trace b.trace
+ *       Programming sequence differences, timestamps and poll counts aside.
+ *
+ *   mmio_trace replay in.trace
+ *       Drives the writes into fresh register models at the recorded times
+ *       and checks every read against the recorded value. The sensor and
+ *       I2C are not modelled in a replay, only the MMIO devices, and S2MM
+ *       frames arrive at 30 fps while the CSI-2 core is enabled, so frame
+ *       store pointers read back may differ.
+ *
+ * Input files are either written by "record" or the text of the firmware's
+ * "mt d" console command, captured from the UART.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Sim.h"
+#include "PipelineRig.h"
+#include "VdmaModel.h"
+
+#include "util/Log.h"
+#include "util/MmioTrace.h"
+
+using namespace digilent;
+
+namespace {
+
+//! \brief File header of "record" output, followed by Mmio::record_t entries
+struct file_header_t
+{
+	char magic[4];			// "MMIO"
+	uint32_t version;
+	uint32_t ticks_per_us;
+	uint32_t count;
+};
+
+//! \brief A record with its timestamp unwrapped
+struct entry_t
+{
+	uint64_t t_ns;
+	uint32_t addr;
+	uint32_t value;
+	uint32_t repeat;
+	bool write;
+};
+
+using trace_t = std::vector<entry_t>;
+
+struct device_t { char const* name; uint32_t base, size; };
+
+device_t const devices[] = {
+	{"vdma", XPAR_AXIVDMA_0_BASEADDR, 0x10000},
+	{"vtc", XPAR_VTC_0_BASEADDR, 0x10000},
+	{"gamma", XPAR_AXI_GAMMACORRECTION_0_BASEADDR, 0x10000},
+	{"csi", XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR, 0x1000},
+	{"dphy", XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR + 0x1000, 0x1000},
+	{"clkwiz", XPAR_VIDEO_DYNCLK_BASEADDR, 0x10000},
+	{"i2c0", XPAR_PS7_I2C_0_BASEADDR, 0x1000},
+	{"gpio", XPAR_PS7_GPIO_0_BASEADDR, 0x1000},
+	{"uart", STDIN_BASEADDRESS, 0x1000},
+	{"scu", 0xF8F00000, 0x2000},			// GIC CPU interface, private timer, distributor
+};
+
+char const* deviceOf(uint32_t addr, uint32_t* offset)
+{
+	for (device_t const& d : devices)
+	{
+		if (addr >= d.base && addr - d.base < d.size)
+		{
+			*offset = addr - d.base;
+			return d.name;
+		}
+	}
+	*offset = 0;
+	return "other";
+}
+
+void append(trace_t& t, Mmio::record_t const& r, uint32_t ticks_per_us, uint64_t& base, uint32_t& last)
+{
+	if (!t.empty() && r.ticks < last)
+		base += 1ull << 32;
+	last = r.ticks;
+	uint64_t const ticks = base + r.ticks;
+	t.push_back({ticks * 1000 / ticks_per_us, r.addr & ~3u, r.value, r.repeat, (r.addr & Mmio::F_WRITE) != 0});
+}
+
+bool load(char const* path, trace_t& t)
+{
+	FILE* f = fopen(path, "rb");
+	if (!f)
+	{
+		perror(path);
+		return false;
+	}
+	uint64_t base = 0;
+	uint32_t last = 0;
+	file_header_t h;
+	if (fread(&h, sizeof(h), 1, f) == 1 && !memcmp(h.magic, "MMIO", 4))
+	{
+		if (h.version != 1 || !h.ticks_per_us)
+		{
+			fprintf(stderr, "%s: unsupported trace version %u\n", path, h.version);
+			fclose(f);
+			return false;
+		}
+		Mmio::record_t r;
+		for (uint32_t i = 0; i < h.count && fread(&r, sizeof(r), 1, f) == 1; ++i)
+			append(t, r, h.ticks_per_us, base, last);
+		fclose(f);
+		return true;
+	}
+
+	//Console dump: "# mmio <n> ticks/us" then "ticks addr value repeat" in hex
+	rewind(f);
+	uint32_t ticks_per_us = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), f))
+	{
+		Mmio::record_t r;
+		if (sscanf(line, "# mmio %u", &ticks_per_us) == 1)
+			continue;
+		if (ticks_per_us && sscanf(line, "%8x %8x %8x %8x", &r.ticks, &r.addr, &r.value, &r.repeat) == 4)
+			append(t, r, ticks_per_us, base, last);
+	}
+	fclose(f);
+	if (!ticks_per_us)
+		fprintf(stderr, "%s: neither a trace file nor an \"mt d\" dump\n", path);
+	return ticks_per_us != 0;
+}
+
+bool save(char const* path, trace_t const& t)
+{
+	FILE* f = fopen(path, "wb");
+	if (!f)
+	{
+		perror(path);
+		return false;
+	}
+	file_header_t const h = {{'M', 'M', 'I', 'O'}, 1, 1000, (uint32_t)t.size()};
+	fwrite(&h, sizeof(h), 1, f);
+	for (entry_t const& e : t)
+	{
+		Mmio::record_t const r = {(uint32_t)e.t_ns, e.addr | (e.write ? Mmio::F_WRITE : 0), e.value, e.repeat};
+		fwrite(&r, sizeof(r), 1, f);
+	}
+	return fclose(f) == 0;
+}
+
+//! \brief Folds polls as Mmio::record() does
+void onAccess(void* ctx, uint64_t t_ns, uintptr_t addr, uint32_t value, bool write)
+{
+	trace_t& t = *static_cast<trace_t*>(ctx);
+	if (!write && !t.empty() && !t.back().write && t.back().addr == addr && t.back().value == value)
+	{
+		++t.back().repeat;
+		return;
+	}
+	t.push_back({t_ns, (uint32_t)addr, value, 0, write});
+}
+
+int record(uint32_t i2c_kHz, std::vector<int> const& modes, char const* path)
+{
+	trace_t t;
+	Sim::setEcho(false);
+	Sim::onMmio(&onAccess, &t);
+	{
+		Sim::PipelineRig rig(i2c_kHz * 1000);
+		fprintf(stderr, "bring-up: records 0-%zu\n", t.size());
+		for (int m : modes)
+		{
+			OV5640_cfg::mode_t const mode = static_cast<OV5640_cfg::mode_t>(m);
+			size_t const first = t.size();
+			rig.modeChange(Sim::PipelineRig::outputFor(mode), mode);
+			fprintf(stderr, "mode %d: records %zu-%zu\n", m, first, t.size());
+		}
+		Sim::onMmio(nullptr, nullptr);
+	}
+	Log::drain();
+	Sim::setEcho(true);
+	return save(path, t) ? 0 : 1;
+}
+
+void print(entry_t const& e)
+{
+	uint32_t off;
+	char const* dev = deviceOf(e.addr, &off);
+	printf("%12.3f %c %08x %-6s+%04x %08x", e.t_ns / 1000.0, e.write ? 'W' : 'R', e.addr, dev, off, e.value);
+	if (e.repeat)
+		printf("  x%u", e.repeat + 1);
+	printf("\n");
+}
+
+int show(trace_t const& t)
+{
+	printf("%12s %c %8s %-11s %8s\n", "t us", ' ', "addr", "device", "value");
+	for (entry_t const& e : t)
+		print(e);
+	return 0;
+}
+
+int analyse(trace_t const& t)
+{
+	struct count_t { uint64_t reads, polls, writes, redundant, duplicate; };
+	std::map<std::string, count_t> per_dev;
+	std::map<uint32_t, uint32_t> known;			// last value seen per register
+	std::map<uint32_t, uint32_t> redundant;		// per register
+	uint64_t n_redundant = 0, n_duplicate = 0;
+	for (size_t i = 0; i < t.size(); ++i)
+	{
+		entry_t const& e = t[i];
+		uint32_t off;
+		count_t& c = per_dev[deviceOf(e.addr, &off)];
+		if (!e.write)
+		{
+			++c.reads;
+			c.polls += e.repeat;
+			known[e.addr] = e.value;
+			continue;
+		}
+		++c.writes;
+		auto const k = known.find(e.addr);
+		if (k != known.end() && k->second == e.value)
+		{
+			++c.redundant;
+			++n_redundant;
+			++redundant[e.addr];
+			if (i && t[i - 1].write && t[i - 1].addr == e.addr)
+			{
+				++c.duplicate;
+				++n_duplicate;
+			}
+		}
+		known[e.addr] = e.value;
+	}
+
+	printf("%-8s %8s %8s %8s %10s %10s\n", "device", "reads", "polls", "writes", "redundant", "duplicate");
+	for (auto const& d : per_dev)
+		printf("%-8s %8llu %8llu %8llu %10llu %10llu\n", d.first.c_str(),
+				(unsigned long long)d.second.reads, (unsigned long long)d.second.polls,
+				(unsigned long long)d.second.writes, (unsigned long long)d.second.redundant,
+				(unsigned long long)d.second.duplicate);
+	printf("\n%llu writes left a register unchanged (%llu back to back), %llu ns of bus time\n",
+			(unsigned long long)n_redundant, (unsigned long long)n_duplicate,
+			(unsigned long long)(n_redundant * Sim::model.mmio_write_ns));
+	if (!redundant.empty())
+	{
+		printf("Per register; reset, trigger and write-1-to-clear bits repeat legitimately:\n");
+		for (auto const& r : redundant)
+		{
+			uint32_t off;
+			char const* dev = deviceOf(r.first, &off);
+			printf("  %08x %-6s+%04x %6u\n", r.first, dev, off, r.second);
+		}
+	}
+	return 0;
+}
+
+bool same(entry_t const& a, entry_t const& b)
+{
+	return a.addr == b.addr && a.value == b.value && a.write == b.write;
+}
+
+int diff(trace_t const& a, trace_t const& b)
+{
+	size_t pre = 0;
+	while (pre < a.size() && pre < b.size() && same(a[pre], b[pre]))
+		++pre;
+	size_t suf = 0;
+	while (suf < a.size() - pre && suf < b.size() - pre && same(a[a.size() - 1 - suf], b[b.size() - 1 - suf]))
+		++suf;
+	size_t const n = a.size() - pre - suf, m = b.size() - pre - suf;
+	if (!n && !m)
+	{
+		printf("identical programming sequences, %zu accesses\n", a.size());
+		return 0;
+	}
+	if ((uint64_t)(n + 1) * (m + 1) > 256ull << 20)
+	{
+		fprintf(stderr, "traces differ over %zu x %zu accesses, too many to align\n", n, m);
+		return 1;
+	}
+
+	//Longest common subsequence of the differing middle
+	std::vector<uint32_t> lcs((n + 1) * (m + 1), 0);
+	auto at = [&](size_t i, size_t j) -> uint32_t& { return lcs[i * (m + 1) + j]; };
+	for (size_t i = n; i-- > 0;)
+		for (size_t j = m; j-- > 0;)
+			at(i, j) = same(a[pre + i], b[pre + j]) ? at(i + 1, j + 1) + 1 : std::max(at(i + 1, j), at(i, j + 1));
+
+	printf("%zu common accesses before, %zu after the first and last difference\n", pre, suf);
+	size_t i = 0, j = 0, removed = 0, added = 0;
+	while (i < n || j < m)
+	{
+		if (i < n && j < m && same(a[pre + i], b[pre + j]))
+		{
+			++i;
+			++j;
+		}
+		else if (j < m && (i == n || at(i, j + 1) >= at(i + 1, j)))
+		{
+			printf("+ ");
+			print(b[pre + j++]);
+			++added;
+		}
+		else
+		{
+			printf("- ");
+			print(a[pre + i++]);
+			++removed;
+		}
+	}
+	printf("%zu accesses only in the first trace, %zu only in the second\n", removed, added);
+	return 1;
+}
+
+bool replaySource(void*, uint8_t*, uint32_t, uint32_t, uint32_t)
+{
+	return Sim::peek(XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR + XCSI_CCR_OFFSET) & XCSI_CCR_COREENB_MASK;
+}
+
+int replay(trace_t const& t)
+{
+	Sim::VdmaModel vdma(3);
+	Sim::ClkWizModel clk_wiz;
+	Sim::map(XPAR_AXIVDMA_0_BASEADDR, 0x10000, vdma);
+	Sim::map(XPAR_VIDEO_DYNCLK_BASEADDR, 0x10000, clk_wiz);
+	vdma.setSource(&replaySource, nullptr);
+	vdma.setFramePeriod(XAXIVDMA_WRITE, 1000000000 / 30);
+	vdma.setFramePeriod(XAXIVDMA_READ, 1000000000 / 60);
+
+	uint64_t const t0 = t.empty() ? 0 : t.front().t_ns;
+	size_t mismatches = 0;
+	for (entry_t const& e : t)
+	{
+		if (e.t_ns - t0 > Sim::now_ns())
+			Sim::advance(e.t_ns - t0 - Sim::now_ns());
+		if (e.write)
+		{
+			Xil_Out32(e.addr, e.value);
+			continue;
+		}
+		//A folded poll: read until the recorded value shows up, at most as often
+		uint32_t v = 0;
+		for (uint32_t n = 0; n <= e.repeat; ++n)
+			if ((v = Xil_In32(e.addr)) == e.value)
+				break;
+		if (v != e.value && ++mismatches <= 20)
+		{
+			printf("replay 0x%08x, recorded:", v);
+			print(e);
+		}
+	}
+	printf("%zu accesses replayed over %.3f ms, %zu reads differ\n", t.size(),
+			(t.empty() ? 0 : t.back().t_ns - t0) / 1e6, mismatches);
+	Sim::reset();
+	return mismatches ? 1 : 0;
+}
+
+void usage(char const* argv0)
+{
+	fprintf(stderr, "usage: %s record [-k i2c_kHz] [-m mode]... out.trace\n"
+			"       %s show|analyse|replay in.trace\n"
+			"       %s diff a.trace b.trace\n", argv0, argv0, argv0);
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		usage(argv[0]);
+		return 2;
+	}
+	char const* const cmd = argv[1];
+	uint32_t i2c_kHz = 100;
+	std::vector<int> modes;
+	int opt;
+	optind = 2;
+	while ((opt = getopt(argc, argv, "k:m:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'k': i2c_kHz = strtoul(optarg, NULL, 0); break;
+		case 'm': modes.push_back(atoi(optarg)); break;
+		default:
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	int const files = argc - optind;
+	char** const file = argv + optind;
+
+	try
+	{
+		if (!strcmp(cmd, "record") && files == 1)
+		{
+			if (modes.empty())
+				modes.push_back(OV5640_cfg::MODE_480P_640_480_15FPS);
+			for (int m : modes)
+			{
+				if (m < 0 || m >= OV5640_cfg::MODE_END)
+				{
+					fprintf(stderr, "no mode %d\n", m);
+					return 2;
+				}
+			}
+			return record(i2c_kHz, modes, file[0]);
+		}
+		trace_t a, b;
+		if (files >= 1 && !load(file[0], a))
+			return 1;
+		if (!strcmp(cmd, "show") && files == 1)
+			return show(a);
+		if (!strcmp(cmd, "analyse") && files == 1)
+			return analyse(a);
+		if (!strcmp(cmd, "replay") && files == 1)
+			return replay(a);
+		if (!strcmp(cmd, "diff") && files == 2)
+			return load(file[1], b) ? diff(a, b) : 1;
+	}
+	catch (std::exception const& e)
+	{
+		Log::drain();
+		fprintf(stderr, "failed: %s\n", e.what());
+		return 1;
+	}
+	usage(argv[0]);
+	return 2;
+}
@@ -0,0 +1,211 @@
+/*
+ * mode_bench.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Mode-switch latency of every ordered pair of sensor modes, plus the cold
+ * bring-up into each, through the firmware's pipeline reconfiguration
+ * (PipelineController::apply() after bandwidth admission) on the register
+ * models, at 100 and 400 kHz camera I2C.
+ *
+ *   mode_bench [-k i2c_kHz] [-o out.csv] [-v]
+ *
+ *   -k   run one I2C rate only (repeatable), default 100 and 400
+ *   -o   write the CSV there instead of stdout
+ *   -v   print the firmware log
+ *
+ * One CSV row per transition, times in simulated microseconds:
+ *   i2c_us      modelled I2C bus time
+ *   mmio_us     modelled register access time, polling included
+ *   delay_us    total_us - i2c_us: settling deadlines, clock lock, frame
+ *               waits and the polling that spans them
+ *   apply_us    reconfiguration as the firmware measured it
+ *   first_us    until the first new frame was displayed, 0 if none
+ *   total_us    simulated time across the whole call
+ * A per-rate summary goes to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "Sim.h"
+#include "PipelineRig.h"
+
+#include "util/Log.h"
+
+using namespace digilent;
+
+namespace {
+
+using row_t = struct
+{
+	uint32_t i2c_kHz;
+	int from, to;				// from -1: cold bring-up
+	Pipeline::plan_t plan;
+	Sim::stats_t d;
+	uint32_t gpio_writes;
+	uint64_t total_ns;
+	uint32_t apply_us, first_us;
+};
+
+void printCsvHeader(FILE* f)
+{
+	fprintf(f, "i2c_khz,from,to,from_res,to_res,plan,i2c_xfers,i2c_wr_bytes,i2c_rd_bytes,i2c_nacks,"
+			"i2c_us,mmio_reads,mmio_writes,mmio_us,gpio_writes,delay_us,apply_us,first_us,total_us\n");
+}
+
+void printCsvRow(FILE* f, row_t const& r)
+{
+	int const from_res = r.from < 0 ? -1 :
+			static_cast<int>(Sim::PipelineRig::outputFor(static_cast<OV5640_cfg::mode_t>(r.from)));
+	int const to_res = static_cast<int>(Sim::PipelineRig::outputFor(static_cast<OV5640_cfg::mode_t>(r.to)));
+	fprintf(f, "%u,%d,%d,%d,%d,0x%04x,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%u,%llu,%u,%u,%llu\n",
+			r.i2c_kHz, r.from, r.to, from_res, to_res, r.plan,
+			(unsigned long long)r.d.i2c_transfers, (unsigned long long)r.d.i2c_bytes_wr,
+			(unsigned long long)r.d.i2c_bytes_rd, (unsigned long long)r.d.i2c_nacks,
+			(unsigned long long)(r.d.i2c_ns / 1000),
+			(unsigned long long)r.d.mmio_reads, (unsigned long long)r.d.mmio_writes,
+			(unsigned long long)(r.d.mmio_ns / 1000), r.gpio_writes,
+			(unsigned long long)((r.total_ns - r.d.i2c_ns) / 1000),
+			r.apply_us, r.first_us, (unsigned long long)(r.total_ns / 1000));
+}
+
+Sim::stats_t delta(Sim::stats_t const& a, Sim::stats_t const& b)
+{
+	return {b.mmio_reads - a.mmio_reads, b.mmio_writes - a.mmio_writes, b.mmio_ns - a.mmio_ns,
+			b.i2c_transfers - a.i2c_transfers, b.i2c_bytes_wr - a.i2c_bytes_wr,
+			b.i2c_bytes_rd - a.i2c_bytes_rd, b.i2c_nacks - a.i2c_nacks, b.i2c_ns - a.i2c_ns};
+}
+
+void flushLog(bool verbose)
+{
+	Sim::setEcho(verbose);
+	Log::drain();
+}
+
+row_t measure(Sim::PipelineRig& rig, uint32_t i2c_kHz, int from, int to)
+{
+	OV5640_cfg::mode_t const mode = static_cast<OV5640_cfg::mode_t>(to);
+	Sim::stats_t const s0 = Sim::stats;
+	uint64_t const t0 = Sim::now_ns();
+	uint32_t const g0 = rig.gpioWrites();
+	Pipeline::transition_t const& tr = rig.transition(Sim::PipelineRig::outputFor(mode), mode, from < 0);
+	row_t r;
+	r.d = delta(s0, Sim::stats);
+	r.total_ns = Sim::now_ns() - t0;
+	r.gpio_writes = rig.gpioWrites() - g0;
+	r.i2c_kHz = i2c_kHz;
+	r.from = from;
+	r.to = to;
+	r.plan = tr.plan;
+	r.apply_us = tr.total_us;
+	r.first_us = tr.first_frame_us;
+	return r;
+}
+
+void run(uint32_t i2c_kHz, bool verbose, std::vector<row_t>& rows)
+{
+	Sim::setEcho(verbose);
+	Sim::PipelineRig rig(i2c_kHz * 1000);
+	flushLog(verbose);
+	for (int to = 0; to < OV5640_cfg::MODE_END; ++to)
+	{
+		rows.push_back(measure(rig, i2c_kHz, -1, to));
+		flushLog(verbose);
+	}
+	for (int from = 0; from < OV5640_cfg::MODE_END; ++from)
+	{
+		for (int to = 0; to < OV5640_cfg::MODE_END; ++to)
+		{
+			if (from == to)
+				continue;
+			OV5640_cfg::mode_t const m = static_cast<OV5640_cfg::mode_t>(from);
+			rig.transition(Sim::PipelineRig::outputFor(m), m);
+			rows.push_back(measure(rig, i2c_kHz, from, to));
+			flushLog(verbose);
+		}
+	}
+}
+
+void summary(uint32_t i2c_kHz, std::vector<row_t> const& rows)
+{
+	uint64_t sum = 0, bus = 0;
+	uint32_t n = 0;
+	row_t const* worst = nullptr;
+	row_t const* best = nullptr;
+	for (row_t const& r : rows)
+	{
+		if (r.i2c_kHz != i2c_kHz || r.from < 0)
+			continue;
+		sum += r.total_ns;
+		bus += r.d.i2c_ns;
+		++n;
+		if (!worst || r.total_ns > worst->total_ns) worst = &r;
+		if (!best || r.total_ns < best->total_ns) best = &r;
+	}
+	if (!n)
+		return;
+	fprintf(stderr, "%3u kHz: %u mode switches, mean %llu us (I2C %llu us), best %d->%d %llu us, worst %d->%d %llu us\n",
+			i2c_kHz, n, (unsigned long long)(sum / n / 1000), (unsigned long long)(bus / n / 1000),
+			best->from, best->to, (unsigned long long)(best->total_ns / 1000),
+			worst->from, worst->to, (unsigned long long)(worst->total_ns / 1000));
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+	std::vector<uint32_t> rates;
+	char const* out_path = NULL;
+	bool verbose = false;
+	int opt;
+	while ((opt = getopt(argc, argv, "k:o:v")) != -1)
+	{
+		switch (opt)
+		{
+		case 'k': rates.push_back(strtoul(optarg, NULL, 0)); break;
+		case 'o': out_path = optarg; break;
+		case 'v': verbose = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-k i2c_kHz] [-o out.csv] [-v]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (rates.empty())
+		rates = {100, 400};
+
+	FILE* out = out_path ? fopen(out_path, "w") : stdout;
+	if (!out)
+	{
+		perror(out_path);
+		return 1;
+	}
+
+	std::vector<row_t> rows;
+	for (uint32_t kHz : rates)
+	{
+		try
+		{
+			run(kHz, verbose, rows);
+		}
+		catch (std::exception const& e)
+		{
+			flushLog(true);
+			fprintf(stderr, "%u kHz: failed: %s\n", kHz, e.what());
+			return 1;
+		}
+		Sim::reset();
+	}
+
+	printCsvHeader(out);
+	for (row_t const& r : rows)
+		printCsvRow(out, r);
+	if (out != stdout)
+		fclose(out);
+	for (uint32_t kHz : rates)
+		summary(kHz, rows);
+	return 0;
+}
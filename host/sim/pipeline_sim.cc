@@ -0,0 +1,557 @@
+/*
+ * pipeline_sim.cc
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Runs the firmware's cold bring-up and pipeline_mode_change() for every
+ * sensor mode against the register models, and reports per step the I2C
+ * traffic, MMIO accesses and modelled bus time. Then checks admission under
+ * a reduced bandwidth budget, takes a full resolution
+ * still from the preview of every mode and reports its latencies, compares
+ * restoring a register snapshot of every mode with replaying its tables, runs
+ * the software AE loop in every mode from a dark and a saturated start,
+ * the software AWB under a warm and a cool illuminant, sweeps the HTS/VTS
+ * blanking of a mode with the timing characterisation, calibrates the
+ * liquid lens model with focus sweeps and focuses it by distance, and checks
+ * that the warm-boot state store falls back to the older record on a card
+ * whose newest one is damaged.
+ *
+ *   pipeline_sim [-v] [-k i2c_kHz]
+ *
+ *   -v   print the firmware log after every step
+ *   -k   camera I2C rate, 100 (default) or 400
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Sim.h"
+#include "PipelineRig.h"
+
+#include "ov5640/RegSnapshot.h"
+#include "pipeline/CameraState.h"
+#include "pipeline/LensCalibration.h"
+#include "pipeline/TimingSweep.h"
+#include "util/Log.h"
+
+using namespace digilent;
+
+namespace {
+
+struct snapshot_t
+{
+	Sim::stats_t stats;
+	uint64_t ns;
+	uint32_t s2mm, mm2s;
+};
+
+snapshot_t snapshot(Sim::PipelineRig const& rig)
+{
+	return {Sim::stats, Sim::now_ns(), rig.s2mmFrames(), rig.mm2sFrames()};
+}
+
+void printHeader()
+{
+	printf("%-28s %5s %6s %5s %5s %7s %7s %9s %9s %9s %9s %5s %5s\n",
+			"step", "xfers", "wr B", "rd B", "nack", "mmio rd", "mmio wr",
+			"i2c us", "mmio us", "total us", "1st frm us", "s2mm", "mm2s");
+}
+
+void printRow(char const* step, snapshot_t const& a, snapshot_t const& b, uint32_t first_frame_us)
+{
+	Sim::stats_t const& s = b.stats;
+	Sim::stats_t const& r = a.stats;
+	printf("%-28s %5llu %6llu %5llu %5llu %7llu %7llu %9llu %9llu %9llu %9u %5u %5u\n", step,
+			(unsigned long long)(s.i2c_transfers - r.i2c_transfers),
+			(unsigned long long)(s.i2c_bytes_wr - r.i2c_bytes_wr),
+			(unsigned long long)(s.i2c_bytes_rd - r.i2c_bytes_rd),
+			(unsigned long long)(s.i2c_nacks - r.i2c_nacks),
+			(unsigned long long)(s.mmio_reads - r.mmio_reads),
+			(unsigned long long)(s.mmio_writes - r.mmio_writes),
+			(unsigned long long)((s.i2c_ns - r.i2c_ns) / 1000),
+			(unsigned long long)((s.mmio_ns - r.mmio_ns) / 1000),
+			(unsigned long long)((b.ns - a.ns) / 1000),
+			first_frame_us, b.s2mm - a.s2mm, b.mm2s - a.mm2s);
+}
+
+void flushLog(bool verbose)
+{
+	Sim::setEcho(verbose);
+	Log::drain();
+}
+
+/*
+ * Admission under a reduced bandwidth budget: the requested target must be
+ * downgraded or rejected as expected, and only a target within the budget
+ * may reach PipelineController::apply().
+ */
+bool budgetRow(Sim::PipelineRig& rig, uint8_t max_util_pct, Resolution res, OV5640_cfg::mode_t mode,
+		Bandwidth::Errc expect)
+{
+	static char const* const errc_names[] = {"ok", "downgraded", "rejected"};
+	Bandwidth::budget_t const saved = rig.budget;
+	rig.budget.max_util_pct = max_util_pct;
+	uint8_t const bpp = rig.vdma.writeBytesPerPixel();
+	Pipeline::target_t tgt = {res, mode, OV5640_cfg::awb_t::AWB_ADVANCED, 3};
+	Pipeline::target_t const before = rig.pipeline.target();
+	size_t const n0 = rig.pipeline.transitions();
+	//Pure: deciding alone touches nothing
+	Bandwidth::Errc const e = Bandwidth::admit(tgt, bpp, rig.budget);
+	bool ok = e == expect && rig.pipeline.transitions() == n0;
+
+	Pipeline::plan_t const plan = rig.modeChange(res, mode);
+	size_t const applied = rig.pipeline.transitions() - n0;
+	Pipeline::target_t const& now = rig.pipeline.target();
+	if (e == Bandwidth::REJECTED)
+		ok = ok && !plan && !applied && now.mode == before.mode && now.res == before.res;
+	else
+		ok = ok && applied <= 1 && now.mode == tgt.mode && now.res == tgt.res &&
+				Bandwidth::estimate(now.mode, now.res, bpp, rig.budget).fits;
+	printf("%5u%% %4d %5d %-11s %4d %5d %7zu  %s\n", max_util_pct, mode, static_cast<int>(res), errc_names[e],
+			now.mode, static_cast<int>(now.res), applied, ok ? "ok" : "OVER BUDGET");
+	rig.budget = saved;
+	return ok;
+}
+
+//A still taken from the running preview, checked for a rendered last line
+bool captureRow(Sim::PipelineRig& rig, OV5640_cfg::mode_t mode)
+{
+	StillCapture::result_t const r = rig.still.capture(mode, rig.pipeline.state().s2mm_h,
+			rig.pipeline.state().s2mm_v);
+	bool ok = r.errc == StillCapture::result_t::OK;
+	if (ok && rig.hasMemory())
+	{
+		uint8_t const* last = reinterpret_cast<uint8_t const*>((uintptr_t)r.addr + r.size - 3);
+		ok = last[0] == 0x80 && last[1] == 0x80 && last[2] == 0x80;
+	}
+	printf("%-8d %5u %-6s %5u %-6s %9u %9u %9u %9u %6u  %s\n", mode,
+			r.delta_in, r.grouped_in ? "hold" : "pwdn", r.delta_out,
+			r.early ? "queued" : r.grouped_out ? "hold" : "pwdn",
+			r.switch_us, r.shutter_us, r.restore_us, r.gap_us, r.frames,
+			ok ? "ok" : r.errc ? StillCapture::errc_names[r.errc] : "not stored");
+	return ok;
+}
+
+//Snapshot of the running mode, against replaying init, mode and AWB tables after a reset
+bool snapshotRow(Sim::PipelineRig& rig, OV5640_cfg::mode_t mode)
+{
+	//Tuned by hand as "wr" does: no table writes it, the snapshot must still carry it
+	uint16_t const hand_reg = 0x5586;	// SDE contrast
+	uint8_t const hand_val = 0x28;
+	rig.cam.writeReg(hand_reg, hand_val);
+	RegSnapshot::touch(hand_reg);
+
+	static uint8_t image[RegSnapshot::image_max];
+	RegSnapshot::stats_t cap, rst;
+	size_t const size = RegSnapshot::capture(rig.cam, image, sizeof(image), cap);
+	if (!size)
+	{
+		printf("%-8d image does not fit %zu bytes\n", mode, sizeof(image));
+		return false;
+	}
+
+	Sim::stats_t const s0 = Sim::stats;
+	rig.cam.init();
+	rig.cam.set_mode(mode);
+	rig.cam.set_awb(OV5640_cfg::AWB_ADVANCED);
+	Sim::stats_t const s1 = Sim::stats;
+	rig.cam.soft_reset();
+	bool ok = RegSnapshot::restore(rig.cam, image, size, rst);
+	Sim::stats_t const s2 = Sim::stats;
+
+	//Every register in the image must read back as captured
+	RegSnapshot::header_t h;
+	memcpy(&h, image, sizeof(h));
+	uint8_t const* body = image + sizeof(h);
+	uint32_t mismatches = 0;
+	for (size_t r = 0, i = 0; r < h.ranges; ++r)
+	{
+		uint16_t const addr = (uint16_t)((body[i] << 8) | body[i + 1]);
+		uint8_t const count = body[i + 2];
+		uint8_t vals[RegSnapshot::range_max];
+		i += 3 + RegSnapshot::unpack(body + i + 3, h.size - i - 3, vals, count);
+		for (uint16_t k = 0; k < count; ++k)
+			mismatches += rig.sensor.reg((uint16_t)(addr + k)) != vals[k];
+	}
+	mismatches += rig.sensor.reg(0x3008) != h.r3008;
+	mismatches += rig.sensor.reg(hand_reg) != hand_val;
+	ok = ok && !mismatches;
+
+	uint64_t const replay_us = (s1.i2c_ns - s0.i2c_ns) / 1000;
+	uint64_t const restore_us = (s2.i2c_ns - s1.i2c_ns) / 1000;
+	printf("%-8d %5u %5u %6zu %7u %9llu %6llu %9llu %6llu %9llu %5.1fx  %s\n", mode, cap.regs, cap.ranges, size,
+			cap.us, (unsigned long long)(s1.i2c_transfers - s0.i2c_transfers), (unsigned long long)(s1.i2c_bytes_wr - s0.i2c_bytes_wr),
+			(unsigned long long)replay_us, (unsigned long long)(s2.i2c_transfers - s1.i2c_transfers),
+			(unsigned long long)restore_us, restore_us ? (double)replay_us / restore_us : 0.0,
+			ok ? "ok" : "MISMATCH");
+	return ok;
+}
+
+//Software AE from a manual start until it settles in the deadband
+bool aeRow(Sim::PipelineRig& rig, OV5640_cfg::mode_t mode, char const* from, uint32_t us, uint16_t gain_x16)
+{
+	uint32_t const max_frames = 60;
+	uint32_t const slow_frames = 10;
+	rig.ae.setMode(mode);
+	rig.ae.setManual(us, gain_x16);
+	//A steady start: frames exposed with the manual setting are coming in
+	rig.vdma.waitWriteFrames(2, 1000000);
+	rig.ae.start();
+	uint64_t const t0 = time_us();
+	while (!rig.ae.stats().converged && rig.ae.stats().frames < max_frames)
+		rig.ae.poll();
+	uint32_t const ms = (uint32_t)((time_us() - t0) / 1000);
+	Exposure::stats_t const& st = rig.ae.stats();
+	Exposure::setting_t const& set = rig.ae.setting();
+	bool const ok = st.converged && st.converged <= slow_frames && !st.reversals;
+	printf("%-8d %-9s %6u %7u %9u %5u %9u %5u.%02u %6u  %s\n", mode, from, st.converged, st.updates,
+			st.reversals, st.luma, rig.ae.exposureUs(), set.gain_x16 / 16, set.gain_x16 % 16 * 100 / 16, ms,
+			ok ? "ok" : !st.converged ? "not converged" : st.reversals ? "oscillates" : "slow");
+	rig.ae.stop();
+	return ok;
+}
+
+//Software AWB from unity gains under an illuminant until it settles
+bool awbRow(Sim::PipelineRig& rig, OV5640_cfg::mode_t mode, WhiteBalance::Method method,
+		char const* illum, uint16_t r, uint16_t g, uint16_t b)
+{
+	uint32_t const max_frames = 60;
+	WhiteBalance::config_t cfg = WhiteBalance::defaults;
+	cfg.method = method;
+	rig.sensor.setIlluminant(r, g, b);
+	rig.awb.setManual(WhiteBalance::gains_t{WhiteBalance::unity, WhiteBalance::unity, WhiteBalance::unity});
+	rig.awb.start(cfg);
+	uint64_t const t0 = time_us();
+	while (!rig.awb.stats().converged && rig.awb.stats().frames < max_frames)
+		rig.awb.poll();
+	uint32_t const ms = (uint32_t)((time_us() - t0) / 1000);
+	WhiteBalance::stats_t const& st = rig.awb.stats();
+	WhiteBalance::gains_t const& gn = rig.awb.gains();
+	//Residual cast: largest channel difference of the last measured mean
+	int const hi = st.r > st.g ? (st.r > st.b ? st.r : st.b) : (st.g > st.b ? st.g : st.b);
+	int const lo = st.r < st.g ? (st.r < st.b ? st.r : st.b) : (st.g < st.b ? st.g : st.b);
+	bool const ok = st.converged && hi - lo <= 2;
+	printf("%-8d %-11s %-5s %6u %7u   %3u/%3u/%3u  %03X/%03X/%03X %6u  %s\n", mode,
+			WhiteBalance::method_names[method], illum, st.converged, st.updates, st.r, st.g, st.b,
+			gn.r, gn.g, gn.b, ms, ok ? "ok" : st.converged ? "cast" : "not converged");
+	rig.awb.stop();
+	rig.sensor.setIlluminant(WhiteBalance::unity, WhiteBalance::unity, WhiteBalance::unity);
+	return ok;
+}
+
+/*
+ * HTS/VTS characterisation of the running mode. The sensor model takes any
+ * blanking, so both bisections must end on their floors in one try each, the
+ * measured rate match the one predicted, and the nominal timing and test
+ * pattern be back afterwards.
+ */
+bool timingRow(Sim::PipelineRig& rig, OV5640_cfg::mode_t mode)
+{
+	TimingSweep::config_t cfg = TimingSweep::defaults;
+	cfg.frames = 4;
+	cfg.settle_frames = 2;
+	OV5640_cfg::mode_info_t const& mi = OV5640_cfg::mode_info[mode];
+	bool const bars = rig.sensor.testPattern();
+	uint64_t const ns0 = Sim::now_ns();
+	TimingSweep::result_t const r = runTimingSweep(rig.cam, rig.vdma, rig.monitor, mode, cfg);
+	uint32_t const ms = (uint32_t)((Sim::now_ns() - ns0) / 1000000);
+	uint32_t const diff = r.fps_measured_x100 > r.fps_max_x100 ? r.fps_measured_x100 - r.fps_max_x100 :
+			r.fps_max_x100 - r.fps_measured_x100;
+	bool const ok = r.errc == TimingSweep::result_t::OK && r.steps_run == 4 &&
+			r.vts_min == mi.height + cfg.vblank_min && r.hts_min == mi.width &&
+			diff * 100 <= r.fps_max_x100 &&
+			rig.sensor.hts() == r.hts_nominal && rig.sensor.vts() == r.vts_nominal &&
+			rig.sensor.testPattern() == bars && !(rig.vdma.writeStatus() & XAXIVDMA_SR_HALTED_MASK);
+	printf("%-8d %4u x %4u %4u x %4u %5u.%02u %5u.%02u %5zu %6u  %s\n", mode, r.hts_nominal, r.vts_nominal,
+			r.hts_min, r.vts_min, r.fps_max_x100 / 100, r.fps_max_x100 % 100, r.fps_measured_x100 / 100,
+			r.fps_measured_x100 % 100, r.steps_run, ms, ok ? "ok" : r.errc ? "UNSTABLE" : "WRONG");
+	return ok;
+}
+
+//Focus sweep against a target at a distance, its point added to the table
+bool sweepRow(Sim::PipelineRig& rig, LensCalibration& cal, uint32_t mm)
+{
+	int16_t const temp_c = 25;
+	rig.sensor.setLensTemp(temp_c);
+	rig.sensor.setFocusTarget(LensCal::mdpt_at(mm));
+	LensCal::result_t const r = runFocusSweep(rig.cam, rig.vdma, mm, temp_c);
+	int const ideal = rig.sensor.focusCode();
+	int const miss = r.point.code_x16 - ideal * 16;
+	bool const ok = r.errc == LensCal::result_t::OK && miss <= 16 && miss >= -16 && cal.add(r.point) == LensCal::OK;
+	printf("%-8u %6d %4u.%02u %5d %7u %6u %6u  %s\n", mm, LensCal::mdpt_at(mm), r.point.code_x16 / 16,
+			r.point.code_x16 % 16 * 100 / 16, ideal, (unsigned)r.step_count, r.frames, r.us / 1000,
+			ok ? "ok" : r.errc ? "FAILED" : "MISSED");
+	return ok;
+}
+
+//Focus by distance from the table: one lens write, how far the power is off
+bool focusRow(Sim::PipelineRig& rig, LensCalibration& cal, uint32_t mm, int16_t temp_c)
+{
+	int32_t const mdpt = LensCal::mdpt_at(mm);
+	rig.sensor.setLensTemp(temp_c);
+	rig.sensor.setFocusTarget(mdpt);
+	uint64_t const xfers = Sim::stats.i2c_transfers;
+	uint8_t code = 0;
+	bool const focused = cal.focus(mm, temp_c, code) == LensCal::OK;
+	uint64_t const writes = Sim::stats.i2c_transfers - xfers;
+	int const ideal = rig.sensor.focusCode();
+	int32_t const err = rig.sensor.lensPower(code) - mdpt;
+	int32_t const step = rig.sensor.lensPower((uint8_t)(ideal + 1)) - rig.sensor.lensPower((uint8_t)ideal);
+	//Within a code of the best, or off by no more than one code step of power
+	bool const ok = focused && writes == 1 && (abs(code - ideal) <= 1 || abs(err) <= step);
+	printf("%-8u %6d %5d %5u %5d %6u %8d  %s\n", mm, mdpt, temp_c, code, ideal, (unsigned)writes, err,
+			ok ? "ok" : "MISSED");
+	return ok;
+}
+
+using StateDamage = enum { DMG_NONE = 0, DMG_CRC, DMG_TORN, DMG_SHORT, DMG_END };
+char const* const damage_names[DMG_END] = {"none", "crc", "torn", "short"};
+
+/*
+ * Two saves to a fresh card, the newer record damaged, then a boot's load:
+ * a bad CRC or a torn write loads the older record, a shorter record of an
+ * older version loads with the newer fields zero.
+ */
+bool stateRow(StateDamage damage)
+{
+	Sim::setCard(true);
+	CameraState::state_t older = CameraState::defaults;
+	older.exposure_us = 10000;
+	older.ae = CameraState::AE_MANUAL;
+	CameraState::state_t newer = older;
+	newer.zoom_x100 = 200;
+	newer.lens = 0x40;
+	newer.flags = CameraState::F_LENS;
+	CameraStateStore store;
+	bool ok = store.mount() == CameraStateStore::OK && store.save(older) == CameraStateStore::OK &&
+			store.save(newer) == CameraStateStore::OK;
+
+	char const* const path = CameraState::slot_paths[store.slot()];
+	uint8_t rec[CameraState::record_size] = {};
+	size_t len = 0;
+	uint8_t const* file = Sim::cardFile(path, len);
+	ok = ok && file && len == sizeof(rec);
+	if (ok)
+		memcpy(rec, file, sizeof(rec));
+	CameraState::state_t expect = older;
+	uint32_t expect_seq = 1;
+	switch (damage)
+	{
+	case DMG_NONE:
+		expect = newer;
+		expect_seq = 2;
+		break;
+	case DMG_CRC:
+		rec[sizeof(CameraState::header_t)] ^= 0x01;
+		break;
+	case DMG_TORN:
+		len = sizeof(CameraState::header_t) + 4;
+		break;
+	default:
+	{
+		//As written before the lens fields were appended
+		CameraState::header_t h;
+		memcpy(&h, rec, sizeof(h));
+		h.size = offsetof(CameraState::state_t, lens);
+		memcpy(rec, &h, sizeof(h));
+		uint16_t const crc = crc16(rec, sizeof(h) + h.size);
+		rec[sizeof(h) + h.size] = crc & 0xFF;
+		rec[sizeof(h) + h.size + 1] = crc >> 8;
+		len = sizeof(h) + h.size + 2;
+		expect = newer;
+		expect.lens = 0;
+		expect.flags = 0;
+		expect_seq = 2;
+		break;
+	}
+	}
+	Sim::cardWrite(path, rec, len);
+
+	CameraStateStore boot;
+	CameraState::state_t s = CameraState::defaults;
+	ok = ok && boot.mount() == CameraStateStore::OK && boot.load(s) == CameraStateStore::OK &&
+			boot.seq() == expect_seq && !memcmp(&s, &expect, sizeof(s));
+	printf("%-8s %5zu %-13s %4zu %4u  %s\n", damage_names[damage], len, path, boot.slot(),
+			boot.seq(), ok ? "ok" : "WRONG RECORD");
+	Sim::setCard(false);
+	return ok;
+}
+
+/*!
+ * \brief Runs fn(mode) for every mode given, each after a transition to it at
+ * its own output resolution. fn returns its failed rows; a throw counts as
+ * one. Returns the failures.
+ */
+template <typename F>
+int forEachMode(Sim::PipelineRig& rig, bool verbose, OV5640_cfg::mode_t const* modes, size_t count, F fn)
+{
+	int failures = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		OV5640_cfg::mode_t const mode = modes[i];
+		try
+		{
+			rig.transition(Sim::PipelineRig::outputFor(mode), mode);
+			failures += fn(mode);
+		}
+		catch (std::exception const& e)
+		{
+			printf("%-8d FAILED: %s\n", mode, e.what());
+			++failures;
+		}
+		flushLog(verbose);
+	}
+	return failures;
+}
+
+template <size_t N, typename F>
+int forEachMode(Sim::PipelineRig& rig, bool verbose, OV5640_cfg::mode_t const (&modes)[N], F fn)
+{
+	return forEachMode(rig, verbose, modes, N, fn);
+}
+
+//Every sensor mode
+template <typename F>
+int forEachMode(Sim::PipelineRig& rig, bool verbose, F fn)
+{
+	OV5640_cfg::mode_t modes[OV5640_cfg::MODE_END];
+	for (int m = 0; m < OV5640_cfg::MODE_END; ++m)
+		modes[m] = static_cast<OV5640_cfg::mode_t>(m);
+	return forEachMode(rig, verbose, modes, OV5640_cfg::MODE_END, fn);
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+	bool verbose = false;
+	uint32_t i2c_kHz = 100;
+	int opt;
+	while ((opt = getopt(argc, argv, "vk:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'v': verbose = true; break;
+		case 'k': i2c_kHz = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-v] [-k i2c_kHz]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	Sim::setEcho(verbose);
+	snapshot_t const t0 = {};
+	Sim::PipelineRig rig(i2c_kHz * 1000);
+	snapshot_t prev = snapshot(rig);
+	flushLog(verbose);
+	if (!rig.hasMemory())
+		fprintf(stderr, "frame stores not mapped at 0x%08lx, frames are counted but not rendered\n",
+				(unsigned long)Sim::PipelineRig::mem_base);
+
+	printf("I2C %u kHz, MMIO read %u ns / write %u ns\n", i2c_kHz,
+			Sim::model.mmio_read_ns, Sim::model.mmio_write_ns);
+	printHeader();
+	printRow("driver init", t0, prev, 0);
+
+	int failures = 0;
+	for (int m = 0; m < OV5640_cfg::MODE_END; ++m)
+	{
+		OV5640_cfg::mode_t const mode = static_cast<OV5640_cfg::mode_t>(m);
+		Resolution const res = Sim::PipelineRig::outputFor(mode);
+		OV5640_cfg::mode_info_t const& mi = OV5640_cfg::mode_info[mode];
+		char step[64];
+		snprintf(step, sizeof(step), "mode %d %ux%u@%u res %d", m, mi.width, mi.height, mi.fps,
+				static_cast<int>(res));
+		try
+		{
+			rig.modeChange(res, mode);
+		}
+		catch (std::exception const& e)
+		{
+			flushLog(verbose);
+			printf("%-28s FAILED: %s\n", step, e.what());
+			++failures;
+			prev = snapshot(rig);
+			continue;
+		}
+		snapshot_t const now = snapshot(rig);
+		flushLog(verbose);
+		printRow(step, prev, now, rig.pipeline.history(0).first_frame_us);
+		prev = now;
+	}
+
+	printRow("total", t0, prev, 0);
+
+	printf("\n%6s %4s %5s %-11s %4s %5s %7s\n", "budget", "mode", "res", "admit", "now", "res", "applied");
+	failures += !budgetRow(rig, 50, Resolution::R1920_1080_60_PP, OV5640_cfg::MODE_1080P_1920_1080_30fps,
+			Bandwidth::DOWNGRADED);
+	failures += !budgetRow(rig, 5, Resolution::R1920_1080_60_PP, OV5640_cfg::MODE_1080P_1920_1080_30fps,
+			Bandwidth::REJECTED);
+	flushLog(verbose);
+
+	printf("\n%-8s %5s %-6s %5s %-6s %9s %9s %9s %9s %6s\n", "still of", "in", "", "out", "",
+			"switch us", "stored us", "restore us", "gap us", "frames");
+	failures += forEachMode(rig, verbose, [&](OV5640_cfg::mode_t mode) {
+		return !captureRow(rig, mode);
+	});
+
+	printf("\n%-8s %5s %5s %6s %7s %9s %6s %9s %6s %9s %6s\n", "snap of", "regs", "runs", "bytes", "cap us",
+			"replay tx", "wr B", "i2c us", "rst tx", "i2c us", "faster");
+	failures += forEachMode(rig, verbose, [&](OV5640_cfg::mode_t mode) {
+		return !snapshotRow(rig, mode);
+	});
+
+	printf("\n%-8s %-9s %6s %7s %9s %5s %9s %8s %6s\n", "ae in", "from", "frames", "updates",
+			"reversals", "luma", "exp us", "gain", "ms");
+	failures += forEachMode(rig, verbose, [&](OV5640_cfg::mode_t mode) {
+		return !aeRow(rig, mode, "dark", 100, 16) + !aeRow(rig, mode, "saturated", 1000000, 0x40);
+	});
+
+	printf("\n%-8s %-11s %-5s %6s %7s %13s %13s %6s\n", "awb in", "method", "light", "frames", "updates",
+			"mean R/G/B", "gains R/G/B", "ms");
+	OV5640_cfg::mode_t const awb_modes[] = {OV5640_cfg::MODE_720P_1280_720_60fps, OV5640_cfg::MODE_1080P_1920_1080_30fps};
+	failures += forEachMode(rig, verbose, awb_modes, [&](OV5640_cfg::mode_t mode) {
+		int failed = 0;
+		for (int m = 0; m < WhiteBalance::METHOD_END; ++m)
+		{
+			WhiteBalance::Method const method = static_cast<WhiteBalance::Method>(m);
+			failed += !awbRow(rig, mode, method, "warm", 0x500, 0x400, 0x280);
+			failed += !awbRow(rig, mode, method, "cool", 0x340, 0x400, 0x580);
+		}
+		return failed;
+	});
+
+	printf("\n%-8s %11s %11s %8s %8s %5s %6s\n", "timing", "nominal", "min", "fps max", "measured",
+			"steps", "ms");
+	OV5640_cfg::mode_t const timing_modes[] = {OV5640_cfg::MODE_720P_1280_720_60fps};
+	failures += forEachMode(rig, verbose, timing_modes, [&](OV5640_cfg::mode_t mode) {
+		return !timingRow(rig, mode);
+	});
+
+	printf("\n%-8s %6s %7s %5s %7s %6s %6s\n", "sweep mm", "mdpt", "code", "ideal", "samples", "frames", "ms");
+	OV5640_cfg::mode_t const lens_modes[] = {OV5640_cfg::MODE_720P_1280_720_60fps};
+	LensCalibration lens_cal(rig.cam);
+	failures += forEachMode(rig, verbose, lens_modes, [&](OV5640_cfg::mode_t) {
+		uint32_t const sweep_mm[] = {0, 1000, 400, 200, 100};
+		uint32_t const focus_mm[] = {2000, 600, 250, 150};
+		int failed = 0;
+		for (uint32_t mm : sweep_mm)
+			failed += !sweepRow(rig, lens_cal, mm);
+		printf("\n%-8s %6s %5s %5s %5s %6s %8s\n", "focus mm", "mdpt", "temp", "code", "ideal", "writes", "err mdpt");
+		lens_cal.setTempCoeff(Sim::Ov5640Sim::lens_tc);
+		for (int16_t temp_c : {25, 45})
+			for (uint32_t mm : focus_mm)
+				failed += !focusRow(rig, lens_cal, mm, temp_c);
+		return failed;
+	});
+	rig.sensor.setFocusTarget(-1);
+	rig.sensor.setLensTemp(25);
+
+	printf("\n%-8s %5s %-13s %4s %4s\n", "damage", "bytes", "newest", "slot", "seq");
+	for (int d = 0; d < DMG_END; ++d)
+		failures += !stateRow(static_cast<StateDamage>(d));
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Console.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "LineParser.h"
+
+#include "xil_printf.h"
+
+namespace digilent {
+
+namespace Cli {
+	using handler_t = void (*)(void* ctx, int argc, char* argv[]);
+
+	/*!
+	 * \brief One console command. argv[0] is the command name itself.
+	 */
+	using command_t = struct
+	{
+		char const* name;
+		char const* usage;
+		handler_t fn;
+	};
+
+	//! \brief Table entry for name, or NULL. Pure function.
+	inline command_t const* find(command_t const* table, size_t count, char const* name)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (!strcmp(table[i].name, name))
+				return &table[i];
+		}
+		return NULL;
+	}
+}
+
+/*!
+ * \brief Non-blocking command console. poll() consumes whatever the UART has
+ * received, echoes it and runs a command from the table once a line is
+ * complete. Call it from the main loop alongside other periodic work.
+ *
+ * Bytes between two 0x00 delimiters are a binary frame and go, without echo,
+ * to the frame handler if one is set (see RegProto).
+ */
+template <typename UART>
+class Console
+{
+public:
+	static size_t const line_max = 64;
+	static int const argv_max = 8;
+	static size_t const frame_max = 1040;
+	typedef void (*FrameHandler)(void* ctx, uint8_t* buf, size_t len);
+
+	Console(UART& uart, Cli::command_t const* table, size_t count, void* ctx) :
+		uart_(uart), table_(table), count_(count), ctx_(ctx)
+	{
+	}
+
+	void setFrameHandler(FrameHandler handler, void* ctx)
+	{
+		frame_handler_ = handler;
+		frame_ctx_ = ctx;
+	}
+
+	/*!
+	 * \brief Processes pending input. Returns true if a command was run.
+	 */
+	bool poll()
+	{
+		char c;
+		while (uart_.getc(c))
+		{
+			if (c == '\0' || in_frame_)
+			{
+				frame(c);
+				continue;
+			}
+			switch (parser_.feed(c))
+			{
+			case Parser::EV_ECHO:
+				xil_printf("%c", c);
+				break;
+			case Parser::EV_ERASE:
+				xil_printf("\b \b");
+				break;
+			case Parser::EV_LINE:
+				xil_printf("\r\n");
+				return execute(parser_.line());
+			default:
+				break;
+			}
+		}
+		return false;
+	}
+
+	void prompt() const { xil_printf("> "); }
+
+	uint32_t frames() const { return frames_; }
+	uint32_t frameErrors() const { return frame_errors_; }
+
+private:
+	void frame(char c)
+	{
+		if (c != '\0')
+		{
+			if (frame_len_ < frame_max) frame_buf_[frame_len_++] = c;
+			else frame_overflow_ = true;
+			return;
+		}
+		//A delimiter closes a non-empty frame, or opens one
+		if (!in_frame_ || !frame_len_)
+		{
+			in_frame_ = true;
+			frame_len_ = 0;
+			frame_overflow_ = false;
+			return;
+		}
+		in_frame_ = false;
+		if (frame_overflow_ || !frame_handler_)
+		{
+			++frame_errors_;
+			return;
+		}
+		++frames_;
+		frame_handler_(frame_ctx_, frame_buf_, frame_len_);
+	}
+
+	bool execute(char* line)
+	{
+		char* argv[argv_max];
+		int const argc = Parser::split(line, argv, argv_max);
+		if (!argc)
+		{
+			prompt();
+			return false;
+		}
+		Cli::command_t const* cmd = Cli::find(table_, count_, argv[0]);
+		if (cmd)
+			cmd->fn(ctx_, argc, argv);
+		else
+			xil_printf("Unknown command, h for help\r\n");
+		prompt();
+		return cmd != NULL;
+	}
+
+private:
+	using Parser = LineParser<line_max>;
+	UART& uart_;
+	Cli::command_t const* const table_;
+	size_t const count_;
+	void* const ctx_;
+	Parser parser_;
+	FrameHandler frame_handler_ = NULL;
+	void* frame_ctx_ = NULL;
+	uint8_t frame_buf_[frame_max];
+	size_t frame_len_ = 0;
+	bool in_frame_ = false, frame_overflow_ = false;
+	uint32_t frames_ = 0, frame_errors_ = 0;
+};
+
+} /* namespace digilent */
+
+#endif /* CONSOLE_H_ */
@@ -0,0 +1,94 @@
+/*
+ * LineParser.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LINEPARSER_H_
+#define LINEPARSER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace digilent {
+
+/*!
+ * \brief Incremental console line editor. Fed one received character at a
+ * time, it tells the caller what to echo and when a line is complete, so the
+ * main loop never blocks waiting for input. CR, LF and CR LF all end a line.
+ * No hardware access.
+ */
+template <size_t N>
+class LineParser
+{
+	static_assert(N >= 2, "need room for one character and the terminator");
+public:
+	using Event = enum { EV_NONE = 0, EV_ECHO, EV_ERASE, EV_LINE };
+
+	Event feed(char c)
+	{
+		if (complete_)
+			reset();
+
+		bool const after_cr = last_cr_;
+		last_cr_ = (c == '\r');
+		if (c == '\n' && after_cr)
+			return EV_NONE;
+		if (c == '\r' || c == '\n')
+		{
+			buf_[len_] = '\0';
+			complete_ = true;
+			return EV_LINE;
+		}
+		if ((c == '\b' || c == 127) && len_ > 0)
+		{
+			--len_;
+			return EV_ERASE;
+		}
+		if (len_ < N - 1 && c >= 32 && c <= 126)
+		{
+			buf_[len_++] = c;
+			return EV_ECHO;
+		}
+		return EV_NONE;
+	}
+
+	//! \brief Completed line, valid after EV_LINE until the next feed()
+	char* line() { return buf_; }
+	size_t length() const { return len_; }
+
+	void reset()
+	{
+		len_ = 0;
+		buf_[0] = '\0';
+		complete_ = false;
+	}
+
+	/*!
+	 * \brief Splits line in place on spaces into at most max words. Returns
+	 * the number of words.
+	 */
+	static int split(char* line, char* argv[], int max)
+	{
+		int argc = 0;
+		while (*line && argc < max)
+		{
+			while (*line == ' ') *line++ = '\0';
+			if (!*line) break;
+			argv[argc++] = line;
+			while (*line && *line != ' ') ++line;
+		}
+		while (*line == ' ') *line++ = '\0';
+		return argc;
+	}
+
+private:
+	char buf_[N] = {};
+	size_t len_ = 0;
+	bool complete_ = false;
+	bool last_cr_ = false;
+};
+
+} /* namespace digilent */
+
+#endif /* LINEPARSER_H_ */
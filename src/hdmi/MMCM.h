@@ -0,0 +1,108 @@
+/*
+ * MMCM.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MMCM_H_
+#define MMCM_H_
+
+#include <stdint.h>
+
+namespace digilent {
+
+namespace MMCM {
+	/*!
+	 * \brief MMCME2_ADV limits, defaults for Zynq-7000 speed grade -1 (DS187).
+	 * Multiplier and divider are in 1/8 steps, as the clock wizard's dynamic
+	 * reconfiguration supports fractional CLKFBOUT_MULT_F and CLKOUT0_DIVIDE_F.
+	 */
+	struct limits_t
+	{
+		uint32_t pfd_min_Hz = 10000000, pfd_max_Hz = 450000000;
+		uint32_t vco_min_Hz = 600000000, vco_max_Hz = 1200000000;
+		uint32_t out_max_Hz = 800000000;
+		uint16_t div_min = 1, div_max = 106;		// DIVCLK_DIVIDE
+		uint16_t mul_min_x8 = 2*8, mul_max_x8 = 64*8;	// CLKFBOUT_MULT_F * 8
+		uint16_t out_min_x8 = 1*8, out_max_x8 = 128*8;	// CLKOUT0_DIVIDE_F * 8
+	};
+
+	struct setting_t
+	{
+		bool valid;
+		uint8_t div;		// DIVCLK_DIVIDE
+		uint16_t mul_x8;	// CLKFBOUT_MULT_F * 8
+		uint16_t out_x8;	// CLKOUT0_DIVIDE_F * 8
+		uint32_t vco_Hz;
+		uint32_t out_Hz;	// achieved output frequency
+		int32_t error_ppm;	// (out_Hz - requested) / requested
+	};
+
+	/*!
+	 * \brief Closest achievable fout for fin over the whole D/M/O0 space. On
+	 * equal error the higher VCO frequency wins, as it gives lower jitter.
+	 * Pure function, safe to run on the host.
+	 */
+	inline setting_t solve(uint32_t fin_Hz, uint32_t fout_Hz, limits_t const& lim = limits_t())
+	{
+		setting_t best = {};
+		if (!fin_Hz || !fout_Hz || fout_Hz > lim.out_max_Hz)
+			return best;
+
+		uint64_t best_err = UINT64_MAX;
+		for (uint32_t div = lim.div_min; div <= lim.div_max; ++div)
+		{
+			uint64_t const pfd = fin_Hz / div;
+			if (pfd < lim.pfd_min_Hz) break;
+			if (pfd > lim.pfd_max_Hz) continue;
+
+			for (uint32_t mul_x8 = lim.mul_min_x8; mul_x8 <= lim.mul_max_x8; ++mul_x8)
+			{
+				//vco = fin * mul / div, computed in Hz * 8 to stay exact
+				uint64_t const vco_x8 = (uint64_t)fin_Hz * mul_x8 / div;
+				if (vco_x8 < (uint64_t)lim.vco_min_Hz * 8) continue;
+				if (vco_x8 > (uint64_t)lim.vco_max_Hz * 8) break;
+
+				//Ideal O0 in 1/8 steps, rounded; fractional only from 2.0 up
+				uint64_t out_x8 = (vco_x8 + fout_Hz / 2) / fout_Hz;
+				if (out_x8 < 16) out_x8 = (out_x8 + 4) / 8 * 8;
+				if (out_x8 < lim.out_min_x8) out_x8 = lim.out_min_x8;
+				if (out_x8 > lim.out_max_x8) out_x8 = lim.out_max_x8;
+
+				uint64_t const out_Hz = vco_x8 / out_x8;
+				if (out_Hz > lim.out_max_Hz) continue;
+				uint64_t const err = out_Hz > fout_Hz ? out_Hz - fout_Hz : fout_Hz - out_Hz;
+				if (err < best_err || (err == best_err && vco_x8 / 8 > best.vco_Hz))
+				{
+					best_err = err;
+					best.valid = true;
+					best.div = div;
+					best.mul_x8 = mul_x8;
+					best.out_x8 = out_x8;
+					best.vco_Hz = vco_x8 / 8;
+					best.out_Hz = out_Hz;
+				}
+			}
+		}
+		if (best.valid)
+			best.error_ppm = (int32_t)(((int64_t)best.out_Hz - fout_Hz) * 1000000 / fout_Hz);
+		return best;
+	}
+
+	//! \brief Clock wizard register 0x200 (clock configuration 0) value
+	inline uint32_t reg_config0(setting_t const& s)
+	{
+		uint32_t const mul_frac = (s.mul_x8 % 8) * 125; //thousandths, MMCME2 limit 875
+		return ((mul_frac & 0x3FF) << 16) | (((s.mul_x8 / 8) & 0xFF) << 8) | (s.div & 0xFF);
+	}
+	//! \brief Clock wizard register 0x208 (clock configuration 2, CLKOUT0) value
+	inline uint32_t reg_config2(setting_t const& s)
+	{
+		uint32_t const out_frac = (s.out_x8 % 8) * 125;
+		return ((out_frac & 0x3FF) << 8) | ((s.out_x8 / 8) & 0xFF);
+	}
+}
+
+} /* namespace digilent */
+
+#endif /* MMCM_H_ */
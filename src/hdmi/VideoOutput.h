@@ -16,6 +16,10 @@
 #include "xvtc.h"
 #include "xclk_wiz.h"
 
+#include "MMCM.h"
+#include "../util/MmioTrace.h"
+#include "../util/Profile.h"
+
 #define STRINGIZE(x) STRINGIZE2(x)
 #define STRINGIZE2(x) #x
 #define LINE_STRING STRINGIZE(__LINE__)
@@ -27,7 +31,16 @@ enum class Resolution
 	R1920_1080_60_PP = 0,
 	R1280_720_60_PP,
 	R640_480_60_NN,
-	R640_480_5_NN
+	R640_480_5_NN,
+	R1920_1080_30_PP,
+	R1920_1080_25_PP,
+	R1920_1080_24_PP,
+	R1280_720_50_PP,
+	R1280_720_30_PP,
+	R1280_720_25_PP,
+	R800_600_60_PP,
+	R1024_768_60_NN,
+	R1280_1024_60_PP
 };
 
 typedef struct
@@ -47,9 +60,40 @@ timing_t const timing[] = {
 		{Resolution::R1920_1080_60_PP, 1920, 88, 44, 148, timing_t::POS, 1080, 4, 5, 36, timing_t::POS, 148500000},
 		{Resolution::R1280_720_60_PP, 1280, 110, 40, 220, timing_t::POS, 720, 5, 5, 20, timing_t::POS, 74250000},
 		{Resolution::R640_480_60_NN, 640, 16, 96, 48, timing_t::NEG, 480, 10, 2, 33, timing_t::NEG, 25000000},
-
+	// CEA-861 lower refresh modes, half or less of the 60 Hz MM2S read bandwidth
+		{Resolution::R1920_1080_30_PP, 1920, 88, 44, 148, timing_t::POS, 1080, 4, 5, 36, timing_t::POS, 74250000},	// VIC 34
+		{Resolution::R1920_1080_25_PP, 1920, 528, 44, 148, timing_t::POS, 1080, 4, 5, 36, timing_t::POS, 74250000},	// VIC 33
+		{Resolution::R1920_1080_24_PP, 1920, 638, 44, 148, timing_t::POS, 1080, 4, 5, 36, timing_t::POS, 74250000},	// VIC 32
+		{Resolution::R1280_720_50_PP, 1280, 440, 40, 220, timing_t::POS, 720, 5, 5, 20, timing_t::POS, 74250000},	// VIC 19
+		{Resolution::R1280_720_30_PP, 1280, 1760, 40, 220, timing_t::POS, 720, 5, 5, 20, timing_t::POS, 74250000},	// VIC 62
+		{Resolution::R1280_720_25_PP, 1280, 2420, 40, 220, timing_t::POS, 720, 5, 5, 20, timing_t::POS, 74250000},	// VIC 61
+	// VESA DMT
+		{Resolution::R800_600_60_PP, 800, 40, 128, 88, timing_t::POS, 600, 1, 4, 23, timing_t::POS, 40000000},
+		{Resolution::R1024_768_60_NN, 1024, 24, 136, 160, timing_t::NEG, 768, 3, 6, 29, timing_t::NEG, 65000000},
+		{Resolution::R1280_1024_60_PP, 1280, 48, 112, 248, timing_t::POS, 1024, 1, 3, 38, timing_t::POS, 108000000},
 };
 
+/*!
+ * \brief Timing entry for res, or NULL if the database has none (e.g.
+ * R640_480_5_NN, which no monitor accepts).
+ */
+inline timing_t const* find_timing(Resolution res)
+{
+	for (size_t i = 0; i < sizeof(timing)/sizeof(timing[0]); i++)
+	{
+		if (timing[i].res == res) return &timing[i];
+	}
+	return NULL;
+}
+
+//! \brief Frame rate of a timing entry in mHz
+inline uint32_t refresh_mHz(timing_t const& t)
+{
+	uint64_t const h_total = t.h_active + t.h_fp + t.h_sync + t.h_bp;
+	uint64_t const v_total = t.v_active + t.v_fp + t.v_sync + t.v_bp;
+	return (uint64_t)t.pclk_freq_Hz * 1000 / (h_total * v_total);
+}
+
 class VideoOutput
 {
 public:
@@ -80,9 +124,9 @@ public:
 			throw std::runtime_error(__FILE__ ":" LINE_STRING);
 		}
 		//Reset clock to hardware default
-		XClk_Wiz_WriteReg(sClkWiz_.Config.BaseAddr, 0x0, 0x0000000A);
+		Mmio::write32(sClkWiz_.Config.BaseAddr + 0x0, 0x0000000A);
 		//Wait for lock because we will need it later for initializing other IP
-		while (!(XClk_Wiz_ReadReg(sClkWiz_.Config.BaseAddr, 0x4) & 0x1));
+		while (!(Mmio::read32(sClkWiz_.Config.BaseAddr + 0x4) & 0x1));
 
 	}
 
@@ -93,58 +137,63 @@ public:
 
 	void configure(Resolution res)
 	{
-		size_t i;
-		for (i = 0; i < sizeof(timing)/sizeof(timing[0]); i++)
-		{
-			if (timing[i].res == res) break;
+		PROFILE_ZONE("VideoOutput::configure");
+		startConfigure(res);
+		while (!isLocked()); //Wait for lock
+		finishConfigure(res);
+	}
+
+	/*!
+	 * \brief First half of configure(): loads the new pixel clock into the
+	 * clock wizard without waiting for lock, so the caller can do other work.
+	 */
+	void startConfigure(Resolution res)
+	{
+		timing_t const* t = find_timing(res);
+		if (!t) {
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
 		}
 
 //		Configure video clock generator first, since losing clock will reset all IP connected to it
-		u32 divclk = 8;
-		double mul = 33.0, clkout_div0 = 33.0;
-		switch (timing[i].pclk_freq_Hz)
-		{
-		case 148500000:
-			//Factors for 742.5 MHz
-			mul = 37.125; divclk = 5; clkout_div0 = 1.0;
-			break;
-		case 74250000:
-			//Factors for 371.25 MHz
-			mul = 37.125; divclk = 4; clkout_div0 = 2.5;
-			break;
-		case 25000000:
-			//Factors for 125 MHz
-			mul = 10.0; divclk = 1; clkout_div0 = 8.0;
-			break;
+		//Serializer needs 5x pixel clock
+		clk_ = MMCM::solve(clkin_Hz_, 5 * t->pclk_freq_Hz);
+		if (!clk_.valid) {
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
 		}
-		Xil_AssertVoid(mul < 256.0); //one byte limit for integer part
-		uint16_t mul_frac = (uint16_t)((mul-(uint8_t)mul)*1000);
-		uint8_t mul_int = (uint8_t)mul;
-		Xil_AssertVoid(mul_frac <= 875); //MMCME2 limit
-		XClk_Wiz_WriteReg(sClkWiz_.Config.BaseAddr, 0x200, ((mul_frac & 0x3FF) << 16) | ((mul_int & 0xFF) << 8) | (divclk & 0xFF));
+		Mmio::write32(sClkWiz_.Config.BaseAddr + 0x200, MMCM::reg_config0(clk_));
+		Mmio::write32(sClkWiz_.Config.BaseAddr + 0x208, MMCM::reg_config2(clk_));
 
-		Xil_AssertVoid(clkout_div0 < 256.0); //one byte limit for integer part
-		uint16_t clkout_div0_frac = (uint16_t)((clkout_div0-(uint8_t)clkout_div0)*1000);
-		uint8_t clkout_div0_int = (uint8_t)clkout_div0;
-		XClk_Wiz_WriteReg(sClkWiz_.Config.BaseAddr, 0x208, ((clkout_div0_frac & 0x3FF) << 8)| (clkout_div0_int & 0xFF));
+		Mmio::write32(sClkWiz_.Config.BaseAddr + 0x25C, 0x00000003); //Load configuration
+	}
 
-		XClk_Wiz_WriteReg(sClkWiz_.Config.BaseAddr, 0x25C, 0x00000003); //Load configuration
-		while (!(XClk_Wiz_ReadReg(sClkWiz_.Config.BaseAddr, 0x4) & 0x1)); //Wait for lock
+	//! \brief Clock wizard setting chosen by the last configure
+	MMCM::setting_t const& clock() const { return clk_; }
 
+	bool isLocked()
+	{
+		return Mmio::read32(sClkWiz_.Config.BaseAddr + 0x4) & 0x1;
+	}
 
-		if (i < sizeof(timing)/sizeof(timing[0]))
+	/*!
+	 * \brief Second half of configure(): programs the timing controller. Call
+	 * once isLocked() returns true.
+	 */
+	void finishConfigure(Resolution res)
+	{
+		timing_t const* t = find_timing(res);
+		if (t)
 		{
 			XVtc_Timing sTiming = {}; //Will init to 0 (C99 6.7.8.21)
-			sTiming.HActiveVideo 	= timing[i].h_active;
-			sTiming.HFrontPorch 	= timing[i].h_fp;
-			sTiming.HBackPorch 	= timing[i].h_bp;
-			sTiming.HSyncWidth 	= timing[i].h_sync;
-			sTiming.HSyncPolarity	= (u16)timing[i].h_pol;
-			sTiming.VActiveVideo 	= timing[i].v_active;
-			sTiming.V0FrontPorch 	= timing[i].v_fp;
-			sTiming.V0BackPorch 	= timing[i].v_bp;
-			sTiming.V0SyncWidth 	= timing[i].v_sync;
-			sTiming.VSyncPolarity	= (u16)timing[i].v_pol;
+			sTiming.HActiveVideo 	= t->h_active;
+			sTiming.HFrontPorch 	= t->h_fp;
+			sTiming.HBackPorch 	= t->h_bp;
+			sTiming.HSyncWidth 	= t->h_sync;
+			sTiming.HSyncPolarity	= (u16)t->h_pol;
+			sTiming.VActiveVideo 	= t->v_active;
+			sTiming.V0FrontPorch 	= t->v_fp;
+			sTiming.V0BackPorch 	= t->v_bp;
+			sTiming.V0SyncWidth 	= t->v_sync;
+			sTiming.VSyncPolarity	= (u16)t->v_pol;
 			XVtc_SetGeneratorTiming(&sVtc_, &sTiming);
 			XVtc_RegUpdateEnable(&sVtc_);
 
@@ -158,6 +207,8 @@ public:
 private:
 	XVtc sVtc_;
 	XClk_Wiz sClkWiz_;
+	MMCM::setting_t clk_ = {};
+	uint32_t const clkin_Hz_ = 100000000; //video_dynclk reference
 };
 
 } /* namespace digilent */
@@ -9,6 +9,28 @@
 #include "ov5640/PS_GPIO.h"
 #include "ov5640/AXI_VDMA.h"
 #include "ov5640/PS_IIC.h"
+#include "ov5640/PS_UART.h"
+#include "ov5640/RegSnapshot.h"
+#include "ov5640/ScuTimer.h"
+#include "ov5640/IrqLatency.h"
+#include "cli/Console.h"
+#include "proto/HwRegTarget.h"
+#include "util/Log.h"
+#include "util/MmioTrace.h"
+#include "util/Profile.h"
+#include "pipeline/AutoExposure.h"
+#include "pipeline/ColorBarTest.h"
+#include "pipeline/PipelineController.h"
+#include "pipeline/Bandwidth.h"
+#include "pipeline/CameraState.h"
+#include "pipeline/ModeChange.h"
+#include "pipeline/FrameMonitor.h"
+#include "pipeline/LensCalibration.h"
+#include "pipeline/StillCapture.h"
+#include "pipeline/Telemetry.h"
+#include "pipeline/TimingSweep.h"
+#include "pipeline/VdmaRecovery.h"
+#include "pipeline/WhiteBalance.h"
 
 #include "ff.h"
 #include "xil_cache.h"
@@ -22,6 +44,12 @@
 #define VDMA_MM2S_IRPT_ID	XPAR_FABRIC_AXI_VDMA_0_MM2S_INTROUT_INTR
 #define VDMA_S2MM_IRPT_ID	XPAR_FABRIC_AXI_VDMA_0_S2MM_INTROUT_INTR
 #define CAM_I2C_SCLK_RATE	100000
+#define UART_IRPT_ID		XPAR_PS7_UART_1_INTR
+#define CSI_IRPT_ID			XPAR_FABRIC_MIPI_CSI2_RX_SUBSYST_0_CSIRXSS_CSI_IRQ_INTR
+#define TIMER_DEVID			XPAR_XSCUTIMER_0_DEVICE_ID
+#define TIMER_IRPT_ID		XPAR_SCUTIMER_INTR
+#define TELEMETRY_RATE_HZ	1000
+#define LATENCY_SGI_ID		14
 
 #define DDR_BASE_ADDR		XPAR_DDR_MEM_BASEADDR
 #define MEM_BASE_ADDR		(DDR_BASE_ADDR + 0x0A000000)
@@ -36,197 +64,22 @@
 
 using namespace digilent;
 
-void print_mipi_status(void) {
-    u32 base = MIPI_RX_BASE;
-    u32 ccr = Xil_In32(base + XCSI_CCR_OFFSET);
-    u32 csr = Xil_In32(base + XCSI_CSR_OFFSET);
-    u32 isr = Xil_In32(base + XCSI_ISR_OFFSET);
-
-    xil_printf("\r\n=== Xilinx MIPI CSI-2 RX Status ===\r\n");
-    xil_printf(" CCR (0x00): 0x%08X  [Core Enable:%d  Soft Reset:%d]\r\n",
-               ccr,
-               (ccr & XCSI_CCR_COREENB_MASK) >> XCSI_CCR_COREENB_SHIFT,
-               (ccr & XCSI_CCR_SOFTRESET_MASK) >> XCSI_CCR_SOFTRESET_SHIFT);
-
-    xil_printf(" CSR (0x10): 0x%08X  [PktCnt:%u  SP FIFO Full:%d  NotEmpty:%d  LineBufFull:%d]\r\n",
-               csr,
-               (csr & XCSI_CSR_PKTCOUNT_MASK) >> XCSI_CSR_PKTCOUNT_SHIFT,
-               (csr & XCSI_CSR_SPFIFOFULL_MASK) ? 1 : 0,
-               (csr & XCSI_CSR_SPFIFONE_MASK)   ? 1 : 0,
-               (csr & XCSI_CSR_SLBF_MASK)       ? 1 : 0);
-
-    xil_printf(" ISR (0x24): 0x%08X\r\n", isr);
-
-    if (isr & XCSI_ISR_FR_MASK)       xil_printf("  * Frame Received\r\n");
-    if (isr & XCSI_ISR_VCXFE_MASK)     xil_printf("  * VCx Frame Level Error\r\n");
-    if (isr & (1U<<22))                xil_printf("  * Word Count Corruption\r\n");
-
-    u32 pcr = Xil_In32(base + 0x04);
-    xil_printf(" PCR (0x04): 0x%08X  [Max Lanes:%d  Active Lanes:%d]\r\n",
-               pcr,
-               (pcr & XCSI_PCR_MAXLANES_MASK) >> XCSI_PCR_MAXLANES_SHIFT,
-               (pcr & XCSI_PCR_ACTLANES_MASK) >> XCSI_PCR_ACTLANES_SHIFT);
-
-    u32 clkinfr = Xil_In32(base + XCSI_CLKINFR_OFFSET);
-    xil_printf(" Clock Lane Info (0x3C): 0x%08X  [Stop State:%d]\r\n",
-               clkinfr,
-               (clkinfr & XCSI_CLKINFR_STOP_MASK) ? 1 : 0);
-
-    u32 l0infr = Xil_In32(base + XCSI_L0INFR_OFFSET);
-    u32 l1infr = Xil_In32(base + XCSI_L1INFR_OFFSET);
-    xil_printf(" Lane 0 Info (0x40): 0x%08X  [Stop:%d  SkewCalHS:%d  SoTErr:%d  SoTSyncErr:%d]\r\n",
-               l0infr,
-               (l0infr & XCSI_LXINFR_STOP_MASK) ? 1 : 0,
-               (l0infr & XCSI_LXINFR_SKEWCALHS_MASK) ? 1 : 0,
-               (l0infr & XCSI_LXINFR_SOTERR_MASK) ? 1 : 0,
-               (l0infr & XCSI_LXINFR_SOTSYNCERR_MASK) ? 1 : 0);
-    xil_printf(" Lane 1 Info (0x44): 0x%08X  [Stop:%d  SkewCalHS:%d  SoTErr:%d  SoTSyncErr:%d]\r\n",
-               l1infr,
-               (l1infr & XCSI_LXINFR_STOP_MASK) ? 1 : 0,
-               (l1infr & XCSI_LXINFR_SKEWCALHS_MASK) ? 1 : 0,
-               (l1infr & XCSI_LXINFR_SOTERR_MASK) ? 1 : 0,
-               (l1infr & XCSI_LXINFR_SOTSYNCERR_MASK) ? 1 : 0);
-
-    u32 spktr = Xil_In32(base + XCSI_SPKTR_OFFSET);
-    xil_printf(" Short Packet FIFO (0x30): 0x%08X  [VC:%d  DataType:0x%02X  Data:0x%04X]\r\n",
-               spktr,
-               (spktr & XCSI_SPKTR_VC_MASK) >> XCSI_SPKTR_VC_SHIFT,
-               (spktr & XCSI_SPKTR_DT_MASK),
-               (spktr & XCSI_SPKTR_DATA_MASK) >> XCSI_SPKTR_DATA_SHIFT);
-
-    u32 vc0inf1 = Xil_In32(base + XCSI_VC0INF1R_OFFSET);
-    u32 vc0inf2 = Xil_In32(base + XCSI_VC0INF2R_OFFSET);
-    xil_printf(" VC0 Image Info1 (0x60): 0x%08X  [LineCount:%u  ByteCount:%u]\r\n",
-               vc0inf1,
-               (vc0inf1 & XCSI_VCXINF1R_LINECOUNT_MASK) >> XCSI_VCXINF1R_LINECOUNT_SHIFT,
-               (vc0inf1 & XCSI_VCXINF1R_BYTECOUNT_MASK));
-    xil_printf(" VC0 Image Info2 (0x64): 0x%08X  [DataType:0x%02X]\r\n",
-               vc0inf2,
-               (vc0inf2 & XCSI_VCXINF2R_DATATYPE_MASK));
-
-    u32 dphy_base = XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR + 0x1000;
-    xil_printf("D-PHY SR: 0x%08X\r\n", Xil_In32(dphy_base + 0x04));
-    xil_printf("D-PHY CR: 0x%08X\r\n", Xil_In32(dphy_base + 0x00));
-}
-
-// Helper: Print VDMA S2MM (write from camera) status
-void print_vdma_s2mm_status() {
-    u32 base = XPAR_AXIVDMA_0_BASEADDR;
-
-    // Correct offsets from xaxivdma_hw.h and PG020 (S2MM starts at 0x30)
-    u32 s2mm_dmacr = Xil_In32(base + 0x30);   // S2MM_VDMACR (Control)
-    u32 s2mm_dmasr = Xil_In32(base + 0x34);   // S2MM_VDMASR (Status)
-    xil_printf("\r\n=== VDMA S2MM (Camera → DDR) Status ===\r\n");
-    xil_printf(" S2MM_VDMACR (Control): 0x%08X\r\n", s2mm_dmacr);
-    xil_printf(" S2MM_VDMASR (Status):  0x%08X\r\n", s2mm_dmasr);
-
-    // Interrupt status bits (in SR)
-    if (s2mm_dmasr & XAXIVDMA_IXR_FRMCNT_MASK)
-        xil_printf(" → IOC_Irq: Interrupt on Complete (frame/descriptor finished)\r\n");
-
-    if (s2mm_dmasr & XAXIVDMA_IXR_DELAYCNT_MASK)
-        xil_printf(" → Dly_Irq: Delay interrupt\r\n");
-
-    if (s2mm_dmasr & XAXIVDMA_IXR_ERROR_MASK)
-        xil_printf(" → Err_Irq: Error interrupt active (check error bits below)\r\n");
-
-    // Run / Halted state
-    if (!(s2mm_dmacr & XAXIVDMA_CR_RUNSTOP_MASK))
-        xil_printf(" WARNING: S2MM channel is HALTED (Run/Stop bit = 0)\r\n");
-
-    // Bonus: show common error flags (bits 4–11 in SR)
-    if (s2mm_dmasr & XAXIVDMA_SR_ERR_ALL_MASK) {
-        xil_printf("  -> DMA Errors:\r\n");
-        if (s2mm_dmasr & XAXIVDMA_SR_ERR_INTERNAL_MASK) xil_printf("     Internal error\r\n");
-        if (s2mm_dmasr & XAXIVDMA_SR_ERR_FSZ_LESS_MASK) xil_printf("     Frame size LESS than expected\r\n");
-        if (s2mm_dmasr & XAXIVDMA_SR_ERR_LSZ_LESS_MASK) xil_printf("     Line size LESS than expected\r\n");
-        if (s2mm_dmasr & XAXIVDMA_SR_ERR_FSZ_MORE_MASK) xil_printf("     Frame size MORE than expected\r\n");
-        if (s2mm_dmasr & XAXIVDMA_SR_ERR_SLAVE_MASK)    xil_printf("     Slave error\r\n");
-        if (s2mm_dmasr & XAXIVDMA_SR_ERR_DECODE_MASK)   xil_printf("     Decode error\r\n");
-    }
-}
-
-void pipeline_mode_change(AXI_VDMA<ScuGicInterruptController>& vdma_driver,
-                          OV5640& cam,
-                          VideoOutput& vid,
-                          Resolution res,
-                          OV5640_cfg::mode_t mode)
-{
-    xil_printf("\r\n=== Starting mode change to mode %d ===\r\n", mode);
-
-	// 1. Stop everything cleanly
-	vdma_driver.resetWrite();
-	// 2. Assert CSI-2 RX reset (bit 1 = soft reset)
-	XCsiSs_WriteReg(MIPI_RX_BASE, XCSI_CCR_OFFSET, 0x00000002);
-	// 3. De-assert reset but do NOT enable yet
-	XCsiSs_WriteReg(MIPI_RX_BASE, XCSI_CCR_OFFSET, 0x00000000);
-	cam.reset();
-
-	vdma_driver.configureWrite(timing[static_cast<int>(res)].h_active,
-								   timing[static_cast<int>(res)].v_active);
-	Xil_Out32(GAMMA_BASE_ADDR, 3);
-	cam.init();
-
-	vdma_driver.enableWrite();
-	XCsiSs_WriteReg(MIPI_RX_BASE, XCSI_CCR_OFFSET, 0x00000001);
-
-	cam.set_mode(mode);
-	cam.set_awb(OV5640_cfg::awb_t::AWB_ADVANCED);
-
-
-	vid.reset();
-	vdma_driver.resetRead();
-	vid.configure(res);
-	vdma_driver.configureRead(timing[static_cast<int>(res)].h_active, timing[static_cast<int>(res)].v_active);
-
-	vid.enable();
-	vdma_driver.enableRead();
+typedef AXI_VDMA<ScuGicInterruptController> Vdma;
+typedef PipelineController<Vdma> Pipe;
+typedef CsiFrameMonitor<ScuGicInterruptController> CsiMon;
+typedef PipelineTelemetry<Vdma, CsiMon> Telem;
+typedef VdmaRecovery<Pipe, Vdma, CsiMon> Recover;
+typedef StillCapturer<Vdma, CsiMon> Still;
+typedef FrameSampler<Vdma> Sampler;
+typedef AutoExposure<Vdma> Ae;
+typedef AutoWhiteBalance<Vdma> Awb;
 
+static Bandwidth::budget_t bw_budget;
 
-	print_mipi_status();
-	print_vdma_s2mm_status();
-
-	uint8_t r3035, r3036, r3037, r3824;
-	cam.readReg(0x3035, r3035);
-	cam.readReg(0x3036, r3036);
-	cam.readReg(0x3037, r3037);
-	cam.readReg(0x3824, r3824);
-
-
-	xil_printf("PLL: 3035=0x%02X 3036=0x%02X 3037=0x%02X 3824=0x%02X\r\n",
-	           r3035, r3036, r3037, r3824);
-	uint8_t r300e, r4800;
-	cam.readReg(0x300E, r300e);
-	cam.readReg(0x4800, r4800);
-	xil_printf("MIPI ctrl: 300E=0x%02X 4800=0x%02X\r\n", r300e, r4800);
-}
-
-static void cli_readline(char *buf, size_t maxlen)
-{
-	size_t idx = 0;
-	while (1)
-	{
-		u32 ch = Xil_In32(STDOUT_BASEADDRESS + XUARTPS_FIFO_OFFSET);
-		char c = (char)(ch & 0xFF);
-
-		if (c == '\r' || c == '\n')
-		{
-			xil_printf("\r\n");
-			buf[idx] = '\0';
-			return;
-		}
-		else if ((c == '\b' || c == 127) && idx > 0)
-		{
-			idx--;
-			xil_printf("\b \b");
-		}
-		else if (idx < maxlen - 1 && c >= 32 && c <= 126)
-		{
-			buf[idx++] = c;
-			xil_printf("%c", c);
-		}
-	}
-}
+//Register snapshot taken with "rs c", kept in DDR
+static uint8_t reg_image[RegSnapshot::image_max];
+static size_t reg_image_size;
+static char const* const reg_image_path = "0:/pcam_regs.snp";
 
 static bool parse_hex_u16(const char *s, uint16_t &out)
 {
@@ -256,147 +109,1060 @@ static bool parse_hex_u8(const char *s, uint8_t &out)
 	return true;
 }
 
-static void cmd_resolution(AXI_VDMA<ScuGicInterruptController>& vdma,
-                           OV5640& cam,
-                           VideoOutput& vid)
+//Hex with an optional leading '-'
+static bool parse_hex_s16(const char *s, int16_t &out)
 {
-	xil_printf(
-		"\r\nResolution options:\r\n"
-		"  1) 1280x720 @60\r\n"
-		"  2) 1920x1080 @15\r\n"
-		"  3) 1920x1080 @30\r\n"
-		"  4) 640x480 @15\r\n"
-		"  5) 1280x720 @15\r\n"
-		"  6) test pattern\r\n"
-		"> ");
+	bool const neg = *s == '-';
+	uint16_t tmp;
+	if (!parse_hex_u16(neg ? s + 1 : s, tmp) || tmp > 0x7FFF)
+		return false;
+	out = (int16_t)(neg ? -tmp : tmp);
+	return true;
+}
+
 
-	char line[16];
-	cli_readline(line, sizeof(line));
+/*!
+ * Everything the console commands operate on
+ */
+using app_t = struct
+{
+	Pipe& pipeline;
+	CsiMon& monitor;
+	Vdma& vdma;
+	OV5640& cam;
+	VideoOutput& vid;
+	Telem& telemetry;
+	Recover& recovery;
+	Still& still;
+	Ae& ae;
+	Awb& awb;
+	CameraStateStore& store;
+	LensCalibration& lens_cal;
+	ScuGicInterruptController& irpt_ctl;
+	bool quit;
+	uint16_t zoom_x100, zoom_cx, zoom_cy;	// sensor window set with "z", zoom 0 for the mode's own
+	int16_t lens;							// last liquid lens value, -1 before the first
+};
+
+//The settings a warm boot restores, as the app has them now
+static CameraState::state_t current_state(app_t& app)
+{
+	CameraState::state_t s = CameraState::defaults;
+	s.res = (uint8_t)app.pipeline.target().res;
+	s.mode = (uint8_t)app.pipeline.target().mode;
+	if (app.lens >= 0)
+	{
+		s.lens = (uint8_t)app.lens;
+		s.flags |= CameraState::F_LENS;
+	}
+	if (app.awb.manual())
+	{
+		WhiteBalance::gains_t const& g = app.awb.gains();
+		s.wb_r = g.r;
+		s.wb_g = g.g;
+		s.wb_b = g.b;
+		s.wb = !app.awb.running() ? CameraState::WB_MANUAL :
+				app.awb.config().method == WhiteBalance::WHITE_PATCH ? CameraState::WB_WHITE_PATCH :
+				CameraState::WB_GRAY_WORLD;
+	}
+	if (app.ae.manual())
+	{
+		s.exposure_us = app.ae.exposureUs();
+		s.gain_x16 = app.ae.setting().gain_x16;
+		s.ae_target = app.ae.config().target;
+		s.ae = !app.ae.running() ? CameraState::AE_MANUAL :
+				app.ae.config().source == Exposure::SRC_SENSOR ? CameraState::AE_SENSOR_LUMA :
+				CameraState::AE_FRAME;
+	}
+	s.zoom_x100 = app.zoom_x100;
+	s.zoom_cx = app.zoom_cx;
+	s.zoom_cy = app.zoom_cy;
+	return s;
+}
 
-	switch (line[0])
+//Everything but the mode, which the boot sequence brings up itself
+static void apply_state(app_t& app, CameraState::state_t const& s)
+{
+	if (s.flags & CameraState::F_LENS)
+	{
+		app.cam.writeRegLiquid(s.lens);
+		app.lens = s.lens;
+	}
+	if (s.zoom_x100)
+	{
+		OV5640_cfg::window_t w;
+		if (app.cam.set_roi(app.pipeline.target().mode, s.zoom_x100, s.zoom_cx, s.zoom_cy, w) == OK)
+		{
+			app.zoom_x100 = s.zoom_x100;
+			app.zoom_cx = s.zoom_cx;
+			app.zoom_cy = s.zoom_cy;
+		}
+	}
+	if (s.wb != CameraState::WB_SENSOR)
+	{
+		app.awb.setManual(WhiteBalance::gains_t{s.wb_r, s.wb_g, s.wb_b});
+		if (s.wb != CameraState::WB_MANUAL)
+		{
+			WhiteBalance::config_t cfg = WhiteBalance::defaults;
+			cfg.method = s.wb == CameraState::WB_WHITE_PATCH ? WhiteBalance::WHITE_PATCH : WhiteBalance::GRAY_WORLD;
+			app.awb.start(cfg);
+		}
+	}
+	if (s.ae != CameraState::AE_SENSOR)
+	{
+		app.ae.setManual(s.exposure_us, s.gain_x16);
+		if (s.ae != CameraState::AE_MANUAL)
+		{
+			Exposure::config_t cfg = Exposure::defaults;
+			cfg.source = s.ae == CameraState::AE_SENSOR_LUMA ? Exposure::SRC_SENSOR : Exposure::SRC_FRAME;
+			if (s.ae_target)
+				cfg.target = s.ae_target;
+			app.ae.start(cfg);
+		}
+	}
+}
+
+/*
+ * Puts the sensor settings the app reports back after the pipeline has
+ * reprogrammed the sensor: a restart runs the init and mode tables again,
+ * which hand exposure and white balance back to the sensor, reset the
+ * window and power cycle the lens driver with the sensor.
+ */
+static void restore_sensor(app_t& app)
+{
+	OV5640_cfg::mode_t const mode = app.pipeline.target().mode;
+	if (app.lens >= 0)
+		app.cam.writeRegLiquid((uint8_t)app.lens);
+	OV5640_cfg::window_t w;
+	if (app.zoom_x100 && app.cam.set_roi(mode, app.zoom_x100, app.zoom_cx, app.zoom_cy, w) != OK)
+		app.zoom_x100 = 0;
+	//Exposure lines follow the new line time
+	app.ae.setMode(mode);
+	app.awb.restore();
+}
+
+//After every change a warm boot should keep; without a card this does nothing
+static void save_state(app_t& app)
+{
+	if (!app.store.mounted())
+		return;
+	if (app.store.save(current_state(app)) != CameraStateStore::OK)
+		LOG_WARN("Camera state not saved to %s\r\n", CameraState::slot_paths[(app.store.slot() + 1) % CameraState::slot_count]);
+}
+
+static void cmd_resolution(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	if (argc < 2)
+	{
+		xil_printf(
+			"Resolution options (r <n>):\r\n"
+			"  1) 1280x720 @60\r\n"
+			"  2) 1920x1080 @15\r\n"
+			"  3) 1920x1080 @30\r\n"
+			"  4) 640x480 @15\r\n"
+			"  5) 1280x720 @15\r\n"
+			"  6) test pattern\r\n"
+			"  7) 1920x1080 @30 on 1080p30 display\r\n"
+			"  8) 1280x720 @15 on 720p30 display\r\n");
+		return;
+	}
+
+	Pipeline::plan_t plan = 0;
+	switch (argv[1][0])
 	{
 	case '1':
-		pipeline_mode_change(vdma, cam, vid,
+		plan = pipeline_mode_change(app.pipeline, app.monitor, app.vdma, app.cam, app.vid,
 			Resolution::R1280_720_60_PP,
-			OV5640_cfg::MODE_720P_1280_720_60fps);
+			OV5640_cfg::MODE_720P_1280_720_60fps, bw_budget);
 		break;
 	case '2':
-		pipeline_mode_change(vdma, cam, vid,
+		plan = pipeline_mode_change(app.pipeline, app.monitor, app.vdma, app.cam, app.vid,
 			Resolution::R1920_1080_60_PP,
-			OV5640_cfg::MODE_1080P_1920_1080_15fps);
+			OV5640_cfg::MODE_1080P_1920_1080_15fps, bw_budget);
 		break;
 	case '3':
-		pipeline_mode_change(vdma, cam, vid,
+		plan = pipeline_mode_change(app.pipeline, app.monitor, app.vdma, app.cam, app.vid,
 			Resolution::R1920_1080_60_PP,
-			OV5640_cfg::MODE_1080P_1920_1080_30fps);
+			OV5640_cfg::MODE_1080P_1920_1080_30fps, bw_budget);
 		break;
 	case '4':
-		pipeline_mode_change(vdma, cam, vid,
+		plan = pipeline_mode_change(app.pipeline, app.monitor, app.vdma, app.cam, app.vid,
 			Resolution::R640_480_60_NN,
-			OV5640_cfg::MODE_480P_640_480_15FPS);
+			OV5640_cfg::MODE_480P_640_480_15FPS, bw_budget);
 		break;
 	case '5':
-		pipeline_mode_change(vdma, cam, vid,
+		plan = pipeline_mode_change(app.pipeline, app.monitor, app.vdma, app.cam, app.vid,
 			Resolution::R640_480_60_NN,
-			OV5640_cfg::MODE_720P_1280_720_15fps);
+			OV5640_cfg::MODE_720P_1280_720_15fps, bw_budget);
 		break;
 	case '6':
-		cam.set_test(OV5640_cfg::TEST_EIGHT_COLOR_BAR);
+		//No mode change: zoom, exposure and white balance stay as they are
+		app.cam.set_test(OV5640_cfg::TEST_EIGHT_COLOR_BAR);
 	    xil_printf("Test pattern enabled (8-color bars).\r\n");
-	    break;
+	    return;
+	case '7':
+		plan = pipeline_mode_change(app.pipeline, app.monitor, app.vdma, app.cam, app.vid,
+			Resolution::R1920_1080_30_PP,
+			OV5640_cfg::MODE_1080P_1920_1080_30fps, bw_budget);
+		break;
+	case '8':
+		plan = pipeline_mode_change(app.pipeline, app.monitor, app.vdma, app.cam, app.vid,
+			Resolution::R1280_720_30_PP,
+			OV5640_cfg::MODE_720P_1280_720_15fps, bw_budget);
+		break;
 	default:
 		xil_printf("Invalid selection\r\n");
 		return;
 	}
+	//Rejected or already running: the sensor still holds zoom and settings
+	if (!plan)
+	{
+		xil_printf("Resolution not changed.\r\n");
+		return;
+	}
+	//Errors during the reconfiguration are expected
+	app.recovery.quiet();
+	//Rates and geometry of the old mode must not blend into the new windows
+	app.irpt_ctl.disableInterrupt(TIMER_IRPT_ID);
+	app.telemetry.reset();
+	app.irpt_ctl.enableInterrupt(TIMER_IRPT_ID);
+	//The mode table has put its own window back, a zoom belongs to the old mode
+	if (Pipeline::scheduled(plan, Pipeline::ACT_SENSOR_MODE))
+		app.zoom_x100 = 0;
+	restore_sensor(app);
+	//Only a mode that got frames to the display is worth coming back to
+	if (app.pipeline.history(0).first_frame_us)
+		save_state(app);
 
 	xil_printf("Resolution changed.\r\n");
 }
 
-static void cmd_reg_write(OV5640& cam)
+static void cmd_reg_write(void* ctx, int argc, char* argv[])
 {
-	char line[32];
+	app_t& app = *static_cast<app_t*>(ctx);
 	uint16_t addr;
 	uint8_t val;
 
-	xil_printf("Register address (hex): ");
-	cli_readline(line, sizeof(line));
-	if (!parse_hex_u16(line, addr))
+	if (argc < 3 || !parse_hex_u16(argv[1], addr) || !parse_hex_u8(argv[2], val))
 	{
-		xil_printf("Invalid hex\r\n");
+		xil_printf("Usage: wr <addr hex> <value hex>\r\n");
 		return;
 	}
 
-	xil_printf("Register value (hex): ");
-	cli_readline(line, sizeof(line));
-	if (!parse_hex_u8(line, val))
-	{
-		xil_printf("Invalid hex\r\n");
-		return;
-	}
-
-	cam.writeReg(addr, val);
+	app.cam.writeReg(addr, val);
+	//Hand tuning outside the tables belongs in the next register snapshot
+	RegSnapshot::touch(addr);
 	xil_printf("Wrote 0x%02X to 0x%04X\r\n", val, addr);
 }
 
 
-static void cmd_reg_read(OV5640& cam)
+static void cmd_reg_read(void* ctx, int argc, char* argv[])
 {
-	char line[32];
+	app_t& app = *static_cast<app_t*>(ctx);
 	uint16_t addr;
 	uint8_t val;
 
-	xil_printf("Register address (hex): ");
-	cli_readline(line, sizeof(line));
-	if (!parse_hex_u16(line, addr))
+	if (argc < 2 || !parse_hex_u16(argv[1], addr))
 	{
-		xil_printf("Invalid hex\r\n");
+		xil_printf("Usage: rr <addr hex>\r\n");
 		return;
 	}
 
-	cam.readReg(addr, val);
+	app.cam.readReg(addr, val);
 	xil_printf("0x%04X = 0x%02X\r\n", addr, val);
 }
 
 
-static void cmd_liquid_lens(OV5640& cam)
+static void cmd_liquid_lens(void* ctx, int argc, char* argv[])
 {
-	char line[16];
+	app_t& app = *static_cast<app_t*>(ctx);
 	uint8_t val;
 
-	xil_printf("Liquid lens value (hex): ");
-	cli_readline(line, sizeof(line));
-	if (!parse_hex_u8(line, val))
+	if (argc < 2 || !parse_hex_u8(argv[1], val))
 	{
-		xil_printf("Invalid hex\r\n");
+		xil_printf("Usage: l <value hex>\r\n");
 		return;
 	}
 
-	cam.writeRegLiquid(val);
+	app.cam.writeRegLiquid(val);
+	app.lens = val;
+	save_state(app);
 	xil_printf("Liquid lens set to 0x%02X\r\n", val);
 }
 
 
-static void print_menu()
+static void cmd_self_test(void* ctx, int, char*[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	print_self_test(runColorBarSelfTest(app.cam, app.vdma));
+}
+
+static void cmd_pipeline_log(void* ctx, int, char*[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	if (!app.pipeline.historyCount())
+		xil_printf("No transitions yet\r\n");
+	for (size_t i = app.pipeline.historyCount(); i > 0; --i)
+		Pipe::printTransition(app.pipeline.history(i - 1));
+}
+
+static void cmd_bandwidth(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	uint8_t val;
+	uint8_t const bpp = app.vdma.writeBytesPerPixel();
+	Resolution const res = app.pipeline.target().res;
+
+	if (argc > 1 && parse_hex_u8(argv[1], val) && val && val <= 100)
+		bw_budget.max_util_pct = val;
+	if (argc > 2 && parse_hex_u8(argv[2], val))
+		bw_budget.cpu_pass_pct = val;
+
+	xil_printf("Budget: DDR %u MB/s x %u%%, HP port %u MB/s, limit %u%%, CPU %u%% of a frame per frame\r\n",
+	           bw_budget.ddr_MBps, bw_budget.ddr_efficiency_pct, bw_budget.port_MBps,
+	           bw_budget.max_util_pct, bw_budget.cpu_pass_pct);
+	xil_printf("Sensor modes on current output (res %d):\r\n", static_cast<int>(res));
+	for (int mode = 0; mode < OV5640_cfg::MODE_END; ++mode)
+	{
+		OV5640_cfg::mode_t const m = static_cast<OV5640_cfg::mode_t>(mode);
+		print_bandwidth(m, res, Bandwidth::estimate(m, res, bpp, bw_budget));
+	}
+}
+
+static void cmd_status(void*, int, char*[])
+{
+	print_mipi_status();
+	print_vdma_s2mm_status();
+}
+
+static void cmd_frame_monitor(void* ctx, int, char*[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	CsiMon& mon = app.monitor;
+	FrameMonitor::expect_t const e = mon.expected();
+	FrameMonitor::counters_t const c = mon.counters();
+	FrameMonitor::timing_t const t = mon.timing();
+	uint32_t const ticks_per_us = COUNTS_PER_SECOND / 1000000;
+
+	xil_printf("Last frame %u lines x %u bytes, expected %u x %u, VDMA %u lines\r\n",
+	           mon.lastLines(), mon.lastBytes(), e.lines, e.bytes, e.vdma_lines);
+	xil_printf("Frames %u (FS %u FE %u), mismatches %u, frame number gaps %u, events dropped %u\r\n",
+	           c.frames, c.fs, c.fe, c.mismatches, c.frame_gaps, mon.eventsDropped());
+	xil_printf("Errors: ECC1 %u ECC2 %u CRC %u SoT %u WC %u frame %u overflow %u\r\n",
+	           c.ecc1, c.ecc2, c.crc, c.sot, c.wc, c.frame_err, c.overflow);
+	if (!t.periods)
+	{
+		xil_printf("No frame start packets timed yet\r\n");
+		return;
+	}
+	uint32_t const mean = (uint32_t)(t.period_sum / t.periods);
+	xil_printf("Period over %u frames: mean %u us (%u.%02u fps), min %u us, max %u us\r\n",
+	           t.periods, mean / ticks_per_us,
+	           (uint32_t)(COUNTS_PER_SECOND * 100ULL / mean / 100), (uint32_t)(COUNTS_PER_SECOND * 100ULL / mean % 100),
+	           t.period_min / ticks_per_us, t.period_max / ticks_per_us);
+	xil_printf("Jitter: mean %u ns, max %u ns; active FS to FE %u us\r\n",
+	           (uint32_t)(t.periods > 1 ? t.jitter_sum * 1000 / ticks_per_us / (t.periods - 1) : 0),
+	           (uint32_t)((uint64_t)t.jitter_max * 1000 / ticks_per_us), t.active_last / ticks_per_us);
+}
+
+//Step table, then HTS/VTS lines and a mode_info row to paste into OV5640.h
+static void print_timing_sweep(TimingSweep::result_t const& r)
+{
+	OV5640_cfg::mode_info_t const& info = OV5640_cfg::mode_info[r.mode];
+	xil_printf("  %5s %5s %6s %6s %5s %5s %5s %9s\r\n",
+	           "HTS", "VTS", "frames", "lines", "vdma", "hash", "fps", "result");
+	for (size_t i = 0; i < r.step_count; ++i)
+	{
+		TimingSweep::step_t const& s = r.steps[i];
+		uint32_t const fps_x10 = s.period_us ? 10000000u / s.period_us : 0;
+		xil_printf("  %5u %5u %6u %6u %5u %5u %3u.%u %9s\r\n", s.hts, s.vts, s.frames,
+		           s.bad_lines, s.vdma_errors, s.hash_changes, fps_x10 / 10, fps_x10 % 10,
+		           s.stable ? "stable" : "UNSTABLE");
+	}
+	if (r.steps_run > r.step_count)
+		xil_printf("  ... %u more steps not listed\r\n", r.steps_run - r.step_count);
+	if (r.errc == TimingSweep::result_t::ERR_NOMINAL)
+	{
+		xil_printf("Nominal timing %u x %u is not stable, nothing to report\r\n", r.hts_nominal, r.vts_nominal);
+		return;
+	}
+
+	xil_printf("\r\n// %ux%u mode %d: HTS %u -> %u, VTS %u -> %u (vertical blanking %u lines)\r\n",
+	           info.width, info.height, r.mode, r.hts_nominal, r.hts_min, r.vts_nominal, r.vts_min,
+	           r.vts_min - info.height);
+	xil_printf("// %u.%02u fps nominal, %u.%02u fps predicted, %u.%02u fps measured\r\n",
+	           r.fps_nominal_x100 / 100, r.fps_nominal_x100 % 100, r.fps_max_x100 / 100, r.fps_max_x100 % 100,
+	           r.fps_measured_x100 / 100, r.fps_measured_x100 % 100);
+	xil_printf("{0x380c, (%u >> 8) & 0x1F}, {0x380d, %u & 0xFF},  // HTS\r\n", r.hts_min, r.hts_min);
+	xil_printf("{0x380e, (%u >> 8) & 0xFF}, {0x380f, %u & 0xFF},  // VTS\r\n", r.vts_min, r.vts_min);
+	xil_printf("{ %4u, %4u, %4u, %4u, %2u, %u },  // mode_info\r\n",
+	           info.width, info.height, r.hts_min, r.vts_min, r.fps_max_x100 / 100, info.lanes);
+}
+
+static void cmd_timing_sweep(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	TimingSweep::config_t cfg = TimingSweep::defaults;
+	uint8_t val;
+	if (argc > 1 && parse_hex_u8(argv[1], val) && val)
+		cfg.frames = val;
+
+	Pipeline::target_t const tgt = app.pipeline.target();
+	xil_printf("Sweeping mode %d, %u frames per step...\r\n", tgt.mode, cfg.frames);
+	//The sweep provokes S2MM size errors on purpose
+	app.recovery.setEnabled(false);
+	TimingSweep::result_t const r = runTimingSweep(app.cam, app.vdma, app.monitor, tgt.mode, cfg);
+	print_timing_sweep(r);
+
+	if (app.vdma.writeStatus() & XAXIVDMA_SR_HALTED_MASK)
+	{
+		xil_printf("S2MM halted during the sweep, restarting the pipeline\r\n");
+		app.monitor.expect(FrameMonitor::expect_t{0, 0, 0});
+		Pipe::printTransition(app.pipeline.restart(tgt));
+		app.monitor.expect(frame_expectation(app.pipeline, app.vdma));
+		restore_sensor(app);
+	}
+	app.recovery.quiet();
+	app.recovery.setEnabled(true);
+}
+
+static void print_still_capture(StillCapture::result_t const& r)
+{
+	xil_printf("Still %ux%u at 0x%08x, %u bytes: %s\r\n",
+	           r.width, r.height, r.addr, r.size, StillCapture::errc_names[r.errc]);
+	if (r.errc == StillCapture::result_t::ERR_MODE)
+		return;
+	xil_printf("  mode %d to still %u registers (%s), back %u registers (%s)\r\n",
+	           r.preview, r.delta_in, r.grouped_in ? "group hold" : "power down", r.delta_out,
+	           r.early ? "group hold, queued" : r.grouped_out ? "group hold" : "power down");
+	xil_printf("  shutter to stored %u us (switch %u us), %u frames, %u bad\r\n",
+	           r.shutter_us, r.switch_us, r.frames, r.bad_frames);
+	xil_printf("  preview gap %u us (restore %u us), display held meanwhile\r\n", r.gap_us, r.restore_us);
+}
+
+static void cmd_capture(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	StillCapture::config_t cfg = StillCapture::defaults;
+	uint8_t val;
+	if (argc > 1 && parse_hex_u8(argv[1], val))
+		cfg.skip_frames = val;
+
+	Pipeline::state_t const st = app.pipeline.state();
+	if (!st.sensor_ready || !st.csi_enabled || !st.s2mm_h)
+	{
+		xil_printf("Preview is not running\r\n");
+		return;
+	}
+	//The still deltas start from the mode table's window and return to it
+	OV5640_cfg::mode_t const mode = app.pipeline.target().mode;
+	if (app.zoom_x100)
+		app.cam.reset_roi(mode);
+	//The sensor switches provoke S2MM size errors
+	app.recovery.setEnabled(false);
+	StillCapture::result_t const r = app.still.capture(mode, st.s2mm_h, st.s2mm_v, cfg);
+	app.recovery.quiet();
+	app.recovery.setEnabled(true);
+	OV5640_cfg::window_t w;
+	if (app.zoom_x100)
+		app.cam.set_roi(mode, app.zoom_x100, app.zoom_cx, app.zoom_cy, w);
+	print_still_capture(r);
+}
+
+static void cmd_zoom(void* ctx, int argc, char* argv[])
 {
-	xil_printf(
-		"\r\n==== PCAM CLI ====\r\n"
-		"r  - Change resolution\r\n"
-		"l  - Liquid lens\r\n"
-		"wr - Write OV5640 register\r\n"
-		"rr - Read OV5640 register\r\n"
-		"q  - Quit\r\n"
-		"> ");
+	app_t& app = *static_cast<app_t*>(ctx);
+	OV5640_cfg::mode_t const mode = app.pipeline.target().mode;
+	OV5640_cfg::window_t w = OV5640_cfg::mode_window(mode);
+	uint16_t zoom = 100;
+	uint16_t cx = (w.x_start + w.x_end + 1) / 2;
+	uint16_t cy = (w.y_start + w.y_end + 1) / 2;
+	if ((argc > 1 && !parse_hex_u16(argv[1], zoom)) ||
+	    (argc > 3 && (!parse_hex_u16(argv[2], cx) || !parse_hex_u16(argv[3], cy))))
+	{
+		xil_printf("Invalid argument\r\n");
+		return;
+	}
+
+	uint64_t const t0 = time_us();
+	if (argc > 1)
+		app.cam.set_roi(mode, zoom, cx, cy, w);
+	else
+		app.cam.reset_roi(mode);
+	uint32_t const write_us = (uint32_t)(time_us() - t0);
+	app.zoom_x100 = argc > 1 ? zoom : 0;
+	app.zoom_cx = cx;
+	app.zoom_cy = cy;
+	save_state(app);
+
+	OV5640_cfg::mode_info_t const& m = OV5640_cfg::mode_info[mode];
+	uint32_t const frame_us = 1000000u / m.fps;
+	uint8_t const base_sub = OV5640_cfg::mode_window(mode).sub;
+	xil_printf("Window %u,%u-%u,%u offset %u,%u, zoom %ux, written in %u us (frame %u us)\r\n",
+	           w.x_start, w.y_start, w.x_end, w.y_end, w.x_off, w.y_off, base_sub / w.sub, write_us, frame_us);
+}
+
+static void cmd_exposure(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	char const opt = argc > 1 ? argv[1][0] : 0;
+	switch (opt)
+	{
+	case 'm':
+	{
+		uint16_t us, gain;
+		if (argc < 4 || !parse_hex_u16(argv[2], us) || !parse_hex_u16(argv[3], gain))
+		{
+			xil_printf("Usage: e m <exposure us hex> <gain x16 hex>\r\n");
+			return;
+		}
+		app.ae.setManual(us, gain);
+		break;
+	}
+	case 'f':
+	case 's':
+	{
+		Exposure::config_t cfg = Exposure::defaults;
+		cfg.source = opt == 's' ? Exposure::SRC_SENSOR : Exposure::SRC_FRAME;
+		if (argc > 2 && !parse_hex_u8(argv[2], cfg.target))
+		{
+			xil_printf("Invalid argument\r\n");
+			return;
+		}
+		app.ae.start(cfg);
+		break;
+	}
+	case 'x':
+		app.ae.stop();
+		break;
+	case 0:
+		break;
+	default:
+		xil_printf("Usage: e [m <us> <gain>|f [target]|s [target]|x]\r\n");
+		return;
+	}
+	if (opt)
+		save_state(app);
+
+	if (!app.ae.manual())
+	{
+		xil_printf("Exposure: sensor AEC/AGC\r\n");
+		return;
+	}
+	Exposure::setting_t const& set = app.ae.setting();
+	xil_printf("Exposure %u us (%u.%02u lines), gain %u.%02ux, %s\r\n", app.ae.exposureUs(),
+	           set.lines_x16 / 16, set.lines_x16 % 16 * 100 / 16, set.gain_x16 / 16, set.gain_x16 % 16 * 100 / 16,
+	           app.ae.running() ? "software AE" : "manual");
+	if (!app.ae.running())
+		return;
+	Exposure::config_t const& cfg = app.ae.config();
+	Exposure::stats_t const& st = app.ae.stats();
+	xil_printf("  %s luma %u, target %u +/- %u, measured in %u us\r\n", Exposure::source_names[cfg.source],
+	           st.luma, cfg.target, cfg.deadband, st.measure_us);
+	xil_printf("  %u frames, %u updates, %u reversals\r\n", st.frames, st.updates, st.reversals);
+	if (st.converged)
+		xil_printf("  converged at frame %u\r\n", st.converged);
+}
+
+static void cmd_white_balance(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	char const opt = argc > 1 ? argv[1][0] : 0;
+	switch (opt)
+	{
+	case 'm':
+	{
+		WhiteBalance::gains_t g;
+		if (argc < 5 || !parse_hex_u16(argv[2], g.r) || !parse_hex_u16(argv[3], g.g) || !parse_hex_u16(argv[4], g.b))
+		{
+			xil_printf("Usage: wb m <r> <g> <b> (hex, 400 = 1x)\r\n");
+			return;
+		}
+		app.awb.setManual(g);
+		break;
+	}
+	case 'p':
+	{
+		uint8_t n;
+		if (argc < 3 || !parse_hex_u8(argv[2], n) || !app.awb.setPreset(n))
+		{
+			for (size_t i = 0; i < WhiteBalance::preset_count; ++i)
+				xil_printf("  %u) %s\r\n", (unsigned)i, WhiteBalance::presets[i].name);
+			return;
+		}
+		break;
+	}
+	case 'g':
+	case 'w':
+	{
+		WhiteBalance::config_t cfg = WhiteBalance::defaults;
+		cfg.method = opt == 'w' ? WhiteBalance::WHITE_PATCH : WhiteBalance::GRAY_WORLD;
+		app.awb.start(cfg);
+		break;
+	}
+	case 'x':
+		app.awb.stop();
+		break;
+	case 0:
+		break;
+	default:
+		xil_printf("Usage: wb [m <r> <g> <b>|p <n>|g|w|x]\r\n");
+		return;
+	}
+	if (opt)
+		save_state(app);
+
+	if (!app.awb.manual())
+	{
+		xil_printf("White balance: sensor AWB\r\n");
+		return;
+	}
+	WhiteBalance::gains_t const& g = app.awb.gains();
+	xil_printf("White balance gains R 0x%03X G 0x%03X B 0x%03X, %s\r\n", g.r, g.g, g.b,
+	           app.awb.running() ? WhiteBalance::method_names[app.awb.config().method] : "manual");
+	if (!app.awb.running())
+		return;
+	WhiteBalance::stats_t const& st = app.awb.stats();
+	xil_printf("  mean R %u G %u B %u over %u samples, measured in %u us\r\n",
+	           st.r, st.g, st.b, st.samples, st.measure_us);
+	xil_printf("  %u frames, %u updates\r\n", st.frames, st.updates);
+	if (st.converged)
+		xil_printf("  converged at frame %u\r\n", st.converged);
+}
+
+static void print_camera_state(CameraState::state_t const& s)
+{
+	char const* const wb_names[] = { "sensor", "manual", "gray world", "white patch" };
+	char const* const ae_names[] = { "sensor", "manual", "frame luma", "sensor luma" };
+	xil_printf("  mode %u res %u, lens %s0x%02X, zoom %u%%\r\n", s.mode, s.res,
+	           (s.flags & CameraState::F_LENS) ? "" : "unset ", s.lens, s.zoom_x100);
+	xil_printf("  WB %s (R 0x%03X G 0x%03X B 0x%03X), AE %s (%u us, gain x16 0x%X)\r\n",
+	           wb_names[s.wb], s.wb_r, s.wb_g, s.wb_b, ae_names[s.ae], s.exposure_us, s.gain_x16);
+}
+
+static void cmd_camera_state(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	if (!app.store.mounted())
+	{
+		xil_printf("No SD card, camera state is not kept\r\n");
+		return;
+	}
+	switch (argc > 1 ? argv[1][0] : 0)
+	{
+	case 'w':
+		if (app.store.save(current_state(app)) != CameraStateStore::OK)
+			xil_printf("Save failed\r\n");
+		break;
+	case 'x':
+		app.store.erase();
+		xil_printf("Camera state erased, next boot is a cold one\r\n");
+		return;
+	case 0:
+		break;
+	default:
+		xil_printf("Usage: st [w|x]\r\n");
+		return;
+	}
+	if (!app.store.stored())
+	{
+		xil_printf("No camera state saved\r\n");
+		return;
+	}
+	xil_printf("Camera state in %s, save %u (load %u us, last save %u us):\r\n",
+	           CameraState::slot_paths[app.store.slot()], app.store.seq(), app.store.loadUs(), app.store.saveUs());
+	print_camera_state(app.store.last());
+}
+
+static void print_snapshot(char const* what, RegSnapshot::stats_t const& st)
+{
+	xil_printf("%s %u registers in %u runs, %u byte image, %u I2C transactions, %u us\r\n",
+	           what, st.regs, st.ranges, st.image_size, st.transfers, st.us);
+}
+
+static void cmd_reg_snapshot(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	RegSnapshot::stats_t st;
+	switch (argc > 1 ? argv[1][0] : 0)
+	{
+	case 'c':
+		reg_image_size = RegSnapshot::capture(app.cam, reg_image, sizeof(reg_image), st);
+		if (!reg_image_size)
+			xil_printf("Snapshot does not fit %u bytes\r\n", sizeof(reg_image));
+		else
+			print_snapshot("Captured", st);
+		return;
+	case 'r':
+		//The pipeline is not told: restore a snapshot of the mode it expects
+		if (!reg_image_size || !RegSnapshot::restore(app.cam, reg_image, reg_image_size, st))
+			xil_printf("No snapshot to restore\r\n");
+		else
+			print_snapshot("Restored", st);
+		return;
+	case 'w':
+		if (!reg_image_size || !RegSnapshot::save(reg_image_path, reg_image, reg_image_size))
+			xil_printf("Not saved\r\n");
+		else
+			xil_printf("Saved %u bytes to %s\r\n", reg_image_size, reg_image_path);
+		return;
+	case 'l':
+		reg_image_size = RegSnapshot::load(reg_image_path, reg_image, sizeof(reg_image));
+		xil_printf(reg_image_size ? "Loaded %u bytes\r\n" : "No intact snapshot on SD\r\n", reg_image_size);
+		return;
+	case 0:
+		xil_printf("Snapshot in DDR: %u bytes\r\n", reg_image_size);
+		return;
+	default:
+		xil_printf("Usage: rs [c|r|w|l]\r\n");
+		return;
+	}
+}
+
+static void print_lens_table(LensCal::table_t const& t)
+{
+	if (!t.count)
+	{
+		xil_printf("Lens not calibrated\r\n");
+		return;
+	}
+	xil_printf("Lens calibration, %u points, drift %d mdpt/C:\r\n", t.count, t.tc_mdpt_per_c);
+	for (size_t i = 0; i < t.count; ++i)
+	{
+		LensCal::point_t const& p = t.points[i];
+		uint32_t const mm = LensCal::mm_at(p.mdpt);
+		xil_printf("  %6d mdpt %6u mm  code 0x%02X + %2u/16", p.mdpt, mm, p.code_x16 / 16, p.code_x16 % 16);
+		if (p.temp_c != LensCal::temp_unknown)
+			xil_printf(" at %d C", p.temp_c);
+		xil_printf("\r\n");
+	}
+}
+
+static void print_focus_sweep(LensCal::result_t const& r)
+{
+	for (size_t i = 0; i < r.step_count; ++i)
+		xil_printf("%s%02X:%5u", i % 8 ? "  " : i ? "\r\n  " : "  ", r.steps[i].code, r.steps[i].sharpness);
+	xil_printf("\r\n%u samples, %u frames, %u ms, sharpness %u to %u\r\n",
+	           r.step_count, r.frames, r.us / 1000, r.floor, r.peak);
+	char const* const errors[] = { "", "Frames stopped", "No sharpness peak, is the target in view?", "Too many samples" };
+	if (r.errc != LensCal::result_t::OK)
+		xil_printf("%s\r\n", errors[r.errc]);
+	else
+		xil_printf("In focus at code 0x%02X + %u/16\r\n", r.point.code_x16 / 16, r.point.code_x16 % 16);
+}
+
+static void cmd_lens_cal(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	char const opt = argc > 1 ? argv[1][0] : 0;
+	uint16_t mm = 0;
+	int16_t temp = LensCal::temp_unknown;
+	if ((opt == 's' || opt == 'f') &&
+			(argc < 3 || !parse_hex_u16(argv[2], mm) || (argc > 3 && !parse_hex_s16(argv[3], temp))))
+	{
+		xil_printf("Usage: lc %c <distance mm hex, 0 for infinity> [lens temperature C hex]\r\n", opt);
+		return;
+	}
+	switch (opt)
+	{
+	case 's':
+	{
+		xil_printf("Sweeping the lens for a target at %u mm...\r\n", mm);
+		LensCal::result_t const r = runFocusSweep(app.cam, app.vdma, mm, temp);
+		print_focus_sweep(r);
+		if (r.errc != LensCal::result_t::OK)
+		{
+			if (app.lens >= 0)
+				app.cam.writeRegLiquid((uint8_t)app.lens);
+			return;
+		}
+		app.lens = (int16_t)((r.point.code_x16 + 8) / 16);
+		save_state(app);
+		LensCal::Errc const e = app.lens_cal.add(r.point);
+		if (e == LensCal::ERR_NOT_MONOTONIC)
+			xil_printf("Not added: the code is out of order with the other points, re-sweep them\r\n");
+		else if (e == LensCal::ERR_FULL)
+			xil_printf("Not added: table full, \"lc x\" starts over\r\n");
+		else if (app.lens_cal.save() != LensCal::OK)
+			xil_printf("Not saved to %s\r\n", LensCal::path);
+		break;
+	}
+	case 'f':
+	{
+		uint8_t code;
+		if (app.lens_cal.focus(mm, temp, code) != LensCal::OK)
+		{
+			xil_printf("Lens not calibrated, sweep at two distances or more first\r\n");
+			return;
+		}
+		app.lens = code;
+		save_state(app);
+		xil_printf("Focused at %u mm: lens 0x%02X\r\n", mm, code);
+		return;
+	}
+	case 't':
+	{
+		int16_t tc;
+		if (argc < 3 || !parse_hex_s16(argv[2], tc))
+		{
+			xil_printf("Usage: lc t <lens drift mdpt per C hex, '-' for negative>\r\n");
+			return;
+		}
+		app.lens_cal.setTempCoeff(tc);
+		if (app.lens_cal.save() != LensCal::OK)
+			xil_printf("Not saved to %s\r\n", LensCal::path);
+		break;
+	}
+	case 'x':
+		app.lens_cal.clear();
+		break;
+	case 0:
+		break;
+	default:
+		xil_printf("Usage: lc [s <mm> [C]|f <mm> [C]|t <mdpt/C>|x]\r\n");
+		return;
+	}
+	print_lens_table(app.lens_cal.table());
+}
+
+static void cmd_recovery(void* ctx, int, char*[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	xil_printf("VDMA error recovery %s\r\n", app.recovery.enabled() ? "enabled" : "disabled");
+	for (int ch = 0; ch < Recovery::CH_END; ++ch)
+	{
+		Recovery::channel_t const c = static_cast<Recovery::channel_t>(ch);
+		Recovery::metrics_t const& m = app.recovery.metrics(c);
+		xil_printf("  %s: errors size %u bus %u internal %u (last 0x%03X), attempts in a row %u\r\n",
+		           Recovery::channel_names[ch], m.errors[Recovery::CLS_SIZE], m.errors[Recovery::CLS_BUS],
+		           m.errors[Recovery::CLS_INTERNAL], m.last_mask, app.recovery.attempts(c));
+		xil_printf("    recoveries: channel %u, CSI-2 %u, pipeline %u, failed %u\r\n",
+		           m.recoveries[Recovery::LVL_CHANNEL], m.recoveries[Recovery::LVL_CSI],
+		           m.recoveries[Recovery::LVL_PIPELINE], m.failed);
+		xil_printf("    downtime frames: last %u max %u total %u\r\n",
+		           m.downtime_last, m.downtime_max, m.downtime_total);
+	}
+}
+
+static void print_fps(char const* name, uint16_t fps_x10, Telemetry::minmax_t const& mm)
+{
+	xil_printf("  %-4s %3u.%u fps  (min %u.%u max %u.%u)\r\n", name, fps_x10 / 10, fps_x10 % 10,
+	           mm.min / 10, mm.min % 10, mm.max / 10, mm.max % 10);
+}
+
+static void cmd_telemetry(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	Telem& tm = app.telemetry;
+	uint8_t n = 1;
+	if (argc > 1 && (!parse_hex_u8(argv[1], n) || !n))
+	{
+		xil_printf("Usage: tm [windows hex]\r\n");
+		return;
+	}
+
+	Telemetry::snapshot_t s;
+	if (!tm.snapshot(0, s))
+	{
+		xil_printf("No telemetry window closed yet\r\n");
+		return;
+	}
+	Telemetry::rates_t const r = tm.rates();
+	Telemetry::counters_t const t = tm.total();
+	xil_printf("Telemetry at %u ms (%u Hz sampling, worst sample %u ns):\r\n", s.t_ms, tm.rate(),
+	           (uint32_t)((uint64_t)tm.tickMax() * 1000000000 / COUNTS_PER_SECOND));
+	print_fps("CSI", s.csi_fps_x10, r.csi);
+	print_fps("S2MM", s.s2mm_fps_x10, r.s2mm);
+	print_fps("MM2S", s.mm2s_fps_x10, r.mm2s);
+	xil_printf("  lines %u..%u  bytes %u..%u  packets/s %u\r\n",
+	           s.lines.min, s.lines.max, s.bytes.min, s.bytes.max, s.delta.csi_packets);
+	xil_printf("  totals: CSI %u frames, S2MM %u, MM2S %u, dropped %u\r\n",
+	           t.csi_frames, t.s2mm_frames, t.mm2s_frames,
+	           t.csi_frames > t.s2mm_frames ? t.csi_frames - t.s2mm_frames : 0);
+	xil_printf("  CSI errors: ECC1 %u ECC2 %u CRC %u SoT %u WC %u frame %u overflow %u geometry %u\r\n",
+	           t.csi_ecc1, t.csi_ecc2, t.csi_crc, t.csi_sot, t.csi_wc, t.csi_frame_err, t.csi_overflow,
+	           t.csi_mismatches);
+	xil_printf("  VDMA errors: S2MM %u (SR 0x%08X)  MM2S %u (SR 0x%08X)\r\n",
+	           t.s2mm_errors, s.s2mm_sr, t.mm2s_errors, s.mm2s_sr);
+
+	if (n == 1)
+		return;
+	xil_printf("  %8s %6s %6s %6s %4s %4s\r\n", "t_ms", "csi", "s2mm", "mm2s", "drop", "err");
+	for (size_t i = 0; i < n && tm.snapshot(i, s); ++i)
+	{
+		Telemetry::counters_t const& d = s.delta;
+		uint32_t const errors = d.csi_ecc2 + d.csi_crc + d.csi_sot + d.csi_wc + d.csi_frame_err +
+				d.csi_overflow + d.csi_mismatches + d.s2mm_errors + d.mm2s_errors;
+		xil_printf("  %8u %4u.%u %4u.%u %4u.%u %4u %4u\r\n", s.t_ms,
+		           s.csi_fps_x10 / 10, s.csi_fps_x10 % 10, s.s2mm_fps_x10 / 10, s.s2mm_fps_x10 % 10,
+		           s.mm2s_fps_x10 / 10, s.mm2s_fps_x10 % 10, s.dropped, errors);
+	}
+}
+
+static void cmd_log_bench(void*, int, char*[])
+{
+	Log::bench_t const b = Log::benchmark();
+	XTime t0, t1;
+	XTime_GetTime(&t0);
+	xil_printf("VDMA Frame %d Addr: 0x%08x\r\n", 0, MEM_BASE_ADDR);
+	XTime_GetTime(&t1);
+	xil_printf("Log call: %u ns (no args), %u ns (%u args), %u calls each\r\n",
+	           b.ticks_0args * 1000 / b.ticks_per_us, b.ticks_6args * 1000 / b.ticks_per_us,
+	           Log::arg_max, b.calls);
+	xil_printf("Same line through xil_printf: %u us\r\n", (uint32_t)(t1 - t0) / b.ticks_per_us);
+}
+
+static void print_latency(char const* name, IrqLatency::stats_t const& s, uint32_t ticks_per_us)
+{
+	if (!s.samples)
+	{
+		xil_printf("  %-14s no interrupt taken\r\n", name);
+		return;
+	}
+	xil_printf("  %-14s min %4u ns  mean %4u ns  max %5u ns  (%u samples, %u lost)\r\n", name,
+	           s.min * 1000 / ticks_per_us, (uint32_t)(s.sum * 1000 / s.samples / ticks_per_us),
+	           s.max * 1000 / ticks_per_us, s.samples, s.timeouts);
+}
+
+static void cmd_irq_latency(void* ctx, int argc, char* argv[])
+{
+	app_t& app = *static_cast<app_t*>(ctx);
+	uint16_t n = 0x400;
+	if (argc > 1 && (!parse_hex_u16(argv[1], n) || !n))
+	{
+		xil_printf("Usage: il [samples hex]\r\n");
+		return;
+	}
+	IrqLatencyBench<ScuGicInterruptController> bench(app.irpt_ctl, LATENCY_SGI_ID);
+	IrqLatency::result_t const r = bench.run(n);
+	xil_printf("SGI %u trigger to handler entry:\r\n", LATENCY_SGI_ID);
+	print_latency("std::function", r.function_shim, r.ticks_per_us);
+	print_latency("Irq::Member", r.direct, r.ticks_per_us);
+}
+
+static void cmd_profile(void*, int argc, char* argv[])
+{
+	if (argc > 1 && argv[1][0] == 'r')
+	{
+		Profile::reset();
+		xil_printf("Profile zones reset\r\n");
+		return;
+	}
+	uint32_t const tpu = Profile::ticks_per_us;
+	xil_printf("  %-26s %6s %10s %9s %9s %9s (us)\r\n", "zone", "calls", "total", "min", "max", "p99");
+	for (Profile::zone_t const* z = Profile::zones; z; z = z->next)
+	{
+		if (!z->calls)
+			continue;
+		xil_printf("  %-26s %6u %10u %9u %9u %9u\r\n", z->name, z->calls,
+		           (uint32_t)(z->total / tpu), z->min / tpu, z->max / tpu, Profile::percentile(*z, 99) / tpu);
+	}
+}
+
+static void cmd_mmio_trace(void*, int argc, char* argv[])
+{
+	char const op = argc > 1 ? argv[1][0] : 0;
+	switch (op)
+	{
+	case 's':
+	case 'w':
+		Mmio::start(op == 'w');
+		xil_printf("MMIO trace started%s\r\n", op == 'w' ? ", wrapping" : "");
+		return;
+	case 'x':
+		Mmio::stop();
+		break;
+	case 'd':
+		//Same layout as Mmio::record_t, for host/sim/mmio_trace
+		xil_printf("# mmio %u ticks/us\r\n", Profile::ticks_per_us);
+		for (uint32_t i = 0; i < Mmio::trace.count; ++i)
+		{
+			Mmio::record_t const& r = Mmio::at(i);
+			xil_printf("%08x %08x %08x %08x\r\n", r.ticks, r.addr, r.value, r.repeat);
+		}
+		return;
+	case 0:
+		break;
+	default:
+		xil_printf("Usage: mt [s|w|x|d]\r\n");
+		return;
+	}
+	xil_printf("MMIO trace %s: %u records, %u dropped\r\n", Mmio::trace.on ? "running" : "stopped",
+	           Mmio::trace.count, Mmio::trace.dropped);
+}
+
+static void cmd_quit(void* ctx, int, char*[])
+{
+	static_cast<app_t*>(ctx)->quit = true;
+}
+
+static void cmd_help(void* ctx, int, char*[]);
+
+static Cli::command_t const commands[] =
+{
+	{"h",  " - This help", &cmd_help},
+	{"r",  " [n] - Change resolution", &cmd_resolution},
+	{"l",  " <hex> - Liquid lens", &cmd_liquid_lens},
+	{"wr", " <addr> <val> - Write OV5640 register", &cmd_reg_write},
+	{"rr", " <addr> - Read OV5640 register", &cmd_reg_read},
+	{"t",  " - Colour bar self-test", &cmd_self_test},
+	{"p",  " - Pipeline transition log", &cmd_pipeline_log},
+	{"b",  " [limit% cpu%] - Bandwidth budget (hex)", &cmd_bandwidth},
+	{"s",  " - MIPI and VDMA status", &cmd_status},
+	{"fm", " - CSI-2 frame monitor", &cmd_frame_monitor},
+	{"ts", " [frames hex] - HTS/VTS characterisation sweep of the current mode", &cmd_timing_sweep},
+	{"rc", " - VDMA error recovery metrics", &cmd_recovery},
+	{"tm", " [n] - Telemetry, last n one-second windows (hex)", &cmd_telemetry},
+	{"lb", " - Log call cost benchmark", &cmd_log_bench},
+	{"il", " [n] - Interrupt entry latency, n samples (hex)", &cmd_irq_latency},
+	{"pf", " [r] - Profile zones, r resets", &cmd_profile},
+	{"mt", " [s|w|x|d] - MMIO trace: start, start wrapping, stop, dump", &cmd_mmio_trace},
+	{"c",  " [skip] - Capture a full resolution still, skipping frames (hex)", &cmd_capture},
+	{"z",  " [zoom% [cx cy]] - Sensor window zoom and centre (hex), none for the mode's", &cmd_zoom},
+	{"e",  " [m us gain|f|s [target]|x] - Exposure: manual (hex, gain x16), AE on frame/sensor luma, sensor AE", &cmd_exposure},
+	{"wb", " [m r g b|p n|g|w|x] - White balance: manual gains (hex), preset, gray world, white patch, sensor AWB", &cmd_white_balance},
+	{"st", " [w|x] - Camera state kept on SD for warm boot: show, save now, erase", &cmd_camera_state},
+	{"rs", " [c|r|w|l] - OV5640 register snapshot: capture, restore, write to SD, load from SD", &cmd_reg_snapshot},
+	{"lc", " [s mm [C]|f mm [C]|t mdpt/C|x] - Lens calibration: sweep at a distance, focus at one, temperature drift, clear (hex)", &cmd_lens_cal},
+	{"q",  " - Quit", &cmd_quit},
+};
+
+//Register windows open to the binary protocol
+static HwRegTarget::window_t const reg_windows[] =
+{
+	{MIPI_RX_BASE, 0x2000},					// CSI-2 RX controller and D-PHY
+	{XPAR_AXIVDMA_0_BASEADDR, 0x100},
+	{XPAR_VTC_0_BASEADDR, 0x200},
+	{GAMMA_BASE_ADDR, 0x100},
+	{XPAR_VIDEO_DYNCLK_BASEADDR, 0x400},	// clock wizard
+};
+
+static void uart_write(void*, uint8_t const* buf, size_t len)
+{
+	for (size_t i = 0; i < len; ++i)
+		outbyte(buf[i]);
+}
+
+static void cmd_help(void*, int, char*[])
+{
+	xil_printf("\r\n==== PCAM CLI ====\r\n");
+	for (size_t i = 0; i < SIZEOF_ARRAY(commands); ++i)
+		xil_printf("%-3s%s\r\n", commands[i].name, commands[i].usage);
 }
 
 int main()
 {
 	init_platform();
+	Profile::init();
+	uint64_t const t_main = time_us();
 
 	xil_printf("=== Running 2-LANE MIPI BUILD - built %s %s ===\r\n", __DATE__, __TIME__);
 
 	ScuGicInterruptController irpt_ctl(IRPT_CTL_DEVID);
 	PS_GPIO<ScuGicInterruptController> gpio(GPIO_DEVID, irpt_ctl, GPIO_IRPT_ID);
 	PS_IIC<ScuGicInterruptController> iic(CAM_I2C_DEVID, irpt_ctl, CAM_I2C_IRPT_ID, 100000);
+	PS_UART<ScuGicInterruptController> uart(STDIN_BASEADDRESS, irpt_ctl, UART_IRPT_ID);
 
 	OV5640 cam(iic, gpio);
 	AXI_VDMA<ScuGicInterruptController> vdma(
@@ -405,6 +1171,8 @@ int main()
 
 	VideoOutput vid(XPAR_VTC_0_DEVICE_ID, XPAR_VIDEO_DYNCLK_DEVICE_ID);
 
+	Pipe pipeline(vdma, cam, vid, MIPI_RX_BASE, GAMMA_BASE_ADDR);
+
 	uint8_t r3035, r3036, r3037, r3034, r3108;
 	cam.readReg(0x3035, r3035);
 	cam.readReg(0x3036, r3036);
@@ -414,38 +1182,91 @@ int main()
 	xil_printf("Cold boot PLL: 3034=0x%02X 3035=0x%02X 3036=0x%02X 3037=0x%02X 3108=0x%02X\r\n",
 	           r3034, r3035, r3036, r3037, r3108);
 
-	pipeline_mode_change(vdma, cam, vid,
-		Resolution::R640_480_60_NN,
-		OV5640_cfg::MODE_480P_640_480_15FPS);
-
+	CsiMon monitor(MIPI_RX_BASE, irpt_ctl, CSI_IRPT_ID);
 
-	uint32_t counter = 0;
+	//Warm boot: straight to the last mode that reached the display
+	CameraStateStore store;
+	CameraState::state_t saved = CameraState::defaults;
+	bool warm = store.mount() == CameraStateStore::OK && store.load(saved) == CameraStateStore::OK;
+	if (warm)
+	{
+		xil_printf("Camera state from %s, save %u, read in %u us\r\n",
+		           CameraState::slot_paths[store.slot()], store.seq(), store.loadUs());
+		print_camera_state(saved);
+	}
+	pipeline_mode_change(pipeline, monitor, vdma, cam, vid,
+		static_cast<Resolution>(saved.res),
+		static_cast<OV5640_cfg::mode_t>(saved.mode), bw_budget);
+	if (warm && !pipeline.history(0).first_frame_us)
+	{
+		xil_printf("Saved mode did not come up, falling back to 480p\r\n");
+		warm = false;
+		saved = CameraState::defaults;
+		pipeline_mode_change(pipeline, monitor, vdma, cam, vid,
+			static_cast<Resolution>(saved.res),
+			static_cast<OV5640_cfg::mode_t>(saved.mode), bw_budget);
+	}
 
-	while (1)
+	Telem telemetry(vdma, monitor, TELEMETRY_RATE_HZ);
+	ScuTimer<ScuGicInterruptController> timer(TIMER_DEVID, irpt_ctl, TIMER_IRPT_ID,
+			TELEMETRY_RATE_HZ, &Telem::tick, &telemetry);
+
+	Recover recovery(pipeline, vdma, monitor);
+	Still still(cam, vdma, monitor, MEM_BASE_ADDR + StillCapture::store_offset,
+			MEM_BASE_ADDR + StillCapture::scratch_offset);
+
+	Sampler sampler(vdma);
+	Ae ae(cam, sampler, pipeline.target().mode);
+	Awb awb(cam, sampler);
+
+	LensCalibration lens_cal(cam);
+	if (store.mounted() && lens_cal.load())
+		xil_printf("Lens calibration from %s, %u points\r\n", LensCal::path, lens_cal.table().count);
+
+	app_t app = {pipeline, monitor, vdma, cam, vid, telemetry, recovery, still, ae, awb, store, lens_cal, irpt_ctl,
+			false, 0, 0, 0, -1};
+	if (warm)
+		apply_state(app, saved);
+	uint64_t const t_op = time_us();
+	xil_printf("Operational (%s boot) in mode %d: %u ms after reset, %u ms in main, first frame %u us into the mode change\r\n",
+	           warm ? "warm" : "cold", pipeline.target().mode, (uint32_t)(t_op / 1000),
+	           (uint32_t)((t_op - t_main) / 1000), pipeline.history(0).first_frame_us);
+	Console<PS_UART<ScuGicInterruptController> > console(uart, commands, SIZEOF_ARRAY(commands), &app);
+	HwRegTarget reg_target(cam, reg_windows, SIZEOF_ARRAY(reg_windows));
+	RegProto::Server reg_server(reg_target, &uart_write, NULL);
+	console.setFrameHandler(&RegProto::Server::onFrame, &reg_server);
+	cmd_help(&app, 0, NULL);
+	console.prompt();
+
+	//Event loop: nothing in here may block, the console is serviced every pass.
+	//Frame and error counting happens in the telemetry tick, see "tm".
+	while (!app.quit)
 	{
-		char cmd[16];
-		print_menu();
-		cli_readline(cmd, sizeof(cmd));
+		FrameMonitor::event_t ev;
+		while (monitor.popEvent(ev))
+		{
+			LOG_WARN("CSI frame %u: %u lines x %u bytes, expected %u x %u, VDMA %u lines\r\n",
+			         ev.frame, ev.lines, ev.bytes, ev.expected.lines, ev.expected.bytes, ev.expected.vdma_lines);
+		}
 
-		if (!strcmp(cmd, "r"))
-			cmd_resolution(vdma, cam, vid);
-		else if (!strcmp(cmd, "l"))
-			cmd_liquid_lens(cam);
-		else if (!strcmp(cmd, "wr"))
-			cmd_reg_write(cam);
-		else if (!strcmp(cmd, "rr"))
-			cmd_reg_read(cam);
-		else if (!strcmp(cmd, "q"))
-			break;
-		else
-			xil_printf("Unknown command\r\n");
-
-		counter++;
-        if (counter % 3 == 0) {
-            xil_printf("\r\n=== Periodic Status (count %u) ===\r\n", counter/10);
-            print_mipi_status();
-            print_vdma_s2mm_status();
-        }
+		uint32_t const restarts = recovery.restarts();
+		if (recovery.poll())
+		{
+			//A restart re-ran the sensor tables
+			if (recovery.restarts() != restarts)
+				restore_sensor(app);
+			continue;
+		}
+
+		//One software AE and AWB step per stored frame, when running
+		ae.poll();
+		awb.poll();
+
+		if (!console.poll())
+		{
+			//Idle: print one deferred log entry per pass
+			Log::drain(1);
+		}
 	}
 
 	cleanup_platform();
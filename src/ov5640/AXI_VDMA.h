@@ -9,10 +9,14 @@
 #define AXI_VDMA_H_
 
 #include <stdexcept>
-#include <functional>
 
 #include "xaxivdma.h"
 
+#include "IrqDispatch.h"
+#include "../util/Timer.h"
+#include "../util/Log.h"
+#include "../util/Profile.h"
+
 #define STRINGIZE(x) STRINGIZE2(x)
 #define STRINGIZE2(x) #x
 #define LINE_STRING STRINGIZE(__LINE__)
@@ -47,20 +51,13 @@ class AXI_VDMA
 		unsigned int number_of_frame_count;
 	} vdma_context_t;
 public:
-	// Shim function to extract function object from CallbackRef and call it
-	// This should call our member function handlers below
-	template <typename Func>
-	static void MyCallback(void* CallbackRef, uint32_t mask_or_type)
-	{
-		auto pfn = static_cast<Func*>(CallbackRef);
-		pfn->operator()(mask_or_type);
-	}
+	/*!
+	 * \brief Called from the error interrupt with XAXIVDMA_READ or
+	 * XAXIVDMA_WRITE and the channel's DMASR error bits.
+	 */
+	typedef void (*ErrorHook)(void* ctx, uint16_t direction, uint32_t mask);
 
 	AXI_VDMA(uint16_t dev_id, uint32_t frame_buf_base_addr, IrptCtl& irpt_ctl, uint16_t rd_irpt_id, uint16_t wr_irpt_id) :
-		rd_handler_(std::bind(&AXI_VDMA::readHandler, this, std::placeholders::_1)),
-		wr_handler_(std::bind(&AXI_VDMA::writeHandler, this, std::placeholders::_1)),
-		rd_err_handler_(std::bind(&AXI_VDMA::readErrorHandler, this, std::placeholders::_1)),
-		wr_err_handler_(std::bind(&AXI_VDMA::writeErrorHandler, this, std::placeholders::_1)),
 		context_{},
 		frame_buf_base_addr_(frame_buf_base_addr),
 		irpt_ctl_(irpt_ctl)
@@ -81,13 +78,13 @@ public:
 
 		//Set error interrupt error handlers, which for some reason need completion handler defined too
 		XAxiVdma_SetCallBack(&drv_inst_, XAXIVDMA_HANDLER_GENERAL,
-				reinterpret_cast<void*>(&MyCallback<decltype(rd_handler_)>), &rd_handler_, XAXIVDMA_READ);
+				reinterpret_cast<void*>(&Irq::Member<&AXI_VDMA::readHandler>::thunk), this, XAXIVDMA_READ);
 		XAxiVdma_SetCallBack(&drv_inst_, XAXIVDMA_HANDLER_GENERAL,
-				reinterpret_cast<void*>(&MyCallback<decltype(wr_handler_)>), &wr_handler_, XAXIVDMA_WRITE);
+				reinterpret_cast<void*>(&Irq::Member<&AXI_VDMA::writeHandler>::thunk), this, XAXIVDMA_WRITE);
 		XAxiVdma_SetCallBack(&drv_inst_, XAXIVDMA_HANDLER_ERROR,
-				reinterpret_cast<void*>(&MyCallback<decltype(rd_err_handler_)>), &rd_err_handler_, XAXIVDMA_READ);
+				reinterpret_cast<void*>(&Irq::Member<&AXI_VDMA::readErrorHandler>::thunk), this, XAXIVDMA_READ);
 		XAxiVdma_SetCallBack(&drv_inst_, XAXIVDMA_HANDLER_ERROR,
-				reinterpret_cast<void*>(&MyCallback<decltype(wr_err_handler_)>), &wr_err_handler_, XAXIVDMA_WRITE);
+				reinterpret_cast<void*>(&Irq::Member<&AXI_VDMA::writeErrorHandler>::thunk), this, XAXIVDMA_WRITE);
 
 		//Register the IIC handler with the interrupt controller
 		irpt_ctl_.registerHandler(rd_irpt_id, &XAxiVdma_ReadIntrHandler, &drv_inst_);
@@ -99,6 +96,7 @@ public:
 
 	void resetRead()
 	{
+		PROFILE_ZONE("AXI_VDMA::resetRead");
 //		XAxiVdma_ChannelStop(&drv_inst_.ReadChannel);
 //		while (XAxiVdma_ChannelIsRunning(&drv_inst_.ReadChannel)) ;
 
@@ -117,6 +115,7 @@ public:
 
 	void resetWrite()
 	{
+		PROFILE_ZONE("AXI_VDMA::resetWrite");
 //		XAxiVdma_ChannelStop(&drv_inst_.WriteChannel);
 //		while (XAxiVdma_ChannelIsRunning(&drv_inst_.WriteChannel)) ;
 
@@ -135,6 +134,7 @@ public:
 
 	void configureRead(uint16_t h_res, uint16_t v_res)
 	{
+		PROFILE_ZONE("AXI_VDMA::configureRead");
 		XStatus status;
 		context_.ReadCfg.HoriSizeInput = h_res * drv_inst_.ReadChannel.StreamWidth;
 		context_.ReadCfg.VertSizeInput = v_res;
@@ -153,7 +153,7 @@ public:
 		uint32_t addr = frame_buf_base_addr_;
 		for (int iFrm=0; iFrm<drv_inst_.MaxNumFrames; ++iFrm) {
 			context_.ReadCfg.FrameStoreStartAddr[iFrm] = addr;
-			xil_printf("VDMA Frame %d Addr: 0x%08x\r\n", iFrm, addr);
+			LOG_DEBUG("VDMA Frame %d Addr: 0x%08x\r\n", iFrm, addr);
 			//memset((void*)addr,0,context_.ReadCfg.HoriSizeInput * context_.ReadCfg.VertSizeInput);
 			addr += context_.ReadCfg.HoriSizeInput * context_.ReadCfg.VertSizeInput;
 		}
@@ -180,6 +180,125 @@ public:
 		}
 	}
 	void configureWrite(uint16_t h_res, uint16_t v_res)
+	{
+		PROFILE_ZONE("AXI_VDMA::configureWrite");
+		UINTPTR addr[XAXIVDMA_MAX_FRAMESTORE];
+		uint32_t const frame_size = (uint32_t)h_res * drv_inst_.WriteChannel.StreamWidth * v_res;
+		for (int iFrm=0; iFrm<drv_inst_.MaxNumFrames; ++iFrm)
+			addr[iFrm] = frame_buf_base_addr_ + iFrm * frame_size;
+		configureWriteAt(h_res, v_res, addr);
+	}
+	/*!
+	 * \brief Points S2MM frame store frm at addr and every other one at
+	 * scratch, for capturing into a single buffer outside the ring shared
+	 * with MM2S: of the frames S2MM writes only those in store frm land
+	 * in addr.
+	 */
+	void configureWriteStore(uint16_t h_res, uint16_t v_res, uint32_t addr, uint32_t scratch, int frm)
+	{
+		PROFILE_ZONE("AXI_VDMA::configureWriteStore");
+		UINTPTR addrs[XAXIVDMA_MAX_FRAMESTORE];
+		for (int iFrm=0; iFrm<drv_inst_.MaxNumFrames; ++iFrm)
+			addrs[iFrm] = iFrm == frm ? addr : scratch;
+		configureWriteAt(h_res, v_res, addrs);
+	}
+	void enableWrite()
+	{
+		XStatus status;
+		//Start read channel
+		status = XAxiVdma_DmaStart(&drv_inst_, XAXIVDMA_WRITE);
+		if (XST_SUCCESS != status)
+		{
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+	}
+	/*!
+	 * \brief Halts S2MM without the soft reset, which would take MM2S down
+	 * with it; the channel keeps its configuration.
+	 */
+	void stopWrite()
+	{
+		PROFILE_ZONE("AXI_VDMA::stopWrite");
+		XAxiVdma_DmaStop(&drv_inst_, XAXIVDMA_WRITE);
+
+		int Polls = RESET_POLL;
+
+		while (Polls && XAxiVdma_ChannelIsRunning(&drv_inst_.WriteChannel)) {
+			--Polls;
+		}
+
+		if (!Polls) {
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+	}
+	/*!
+	 * \brief Keeps MM2S on the frame store it is reading, out of circular
+	 * mode and genlock, until unparkRead().
+	 */
+	void parkRead()
+	{
+		if (XST_SUCCESS != XAxiVdma_StartParking(&drv_inst_, currentReadFrame(), XAXIVDMA_READ))
+		{
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+	}
+	void unparkRead() { XAxiVdma_StopParking(&drv_inst_, XAXIVDMA_READ); }
+	int numFrameStores() const { return drv_inst_.MaxNumFrames; }
+	int currentWriteFrame() { return XAxiVdma_CurrFrameStore(&drv_inst_, XAXIVDMA_WRITE); }
+	int currentReadFrame() { return XAxiVdma_CurrFrameStore(&drv_inst_, XAXIVDMA_READ); }
+	uint32_t frameBufBase() const { return frame_buf_base_addr_; }
+	uint32_t writeFrameAddr(int frm) const { return context_.WriteCfg.FrameStoreStartAddr[frm]; }
+	uint32_t writeStride() const { return context_.WriteCfg.Stride; }
+	uint16_t writeLines() const { return context_.WriteCfg.VertSizeInput; }
+	uint8_t writeBytesPerPixel() const { return drv_inst_.WriteChannel.StreamWidth; }
+	//! \brief Raw DMASR of the MM2S (read) and S2MM (write) channels
+	uint32_t readStatus() const { return XAxiVdma_ReadReg(drv_inst_.ReadChannel.ChanBase, XAXIVDMA_SR_OFFSET); }
+	uint32_t writeStatus() const { return XAxiVdma_ReadReg(drv_inst_.WriteChannel.ChanBase, XAXIVDMA_SR_OFFSET); }
+	void clearWriteErrors() { XAxiVdma_ClearDmaChannelErrors(&drv_inst_, XAXIVDMA_WRITE, XAXIVDMA_SR_ERR_ALL_MASK); }
+	void clearReadErrors() { XAxiVdma_ClearDmaChannelErrors(&drv_inst_, XAXIVDMA_READ, XAXIVDMA_SR_ERR_ALL_MASK); }
+
+	void setErrorHook(ErrorHook hook, void* ctx)
+	{
+		err_hook_ctx_ = ctx;
+		err_hook_ = hook;
+	}
+
+	/*!
+	 * \brief Polls the S2MM frame store pointer until it has advanced n times
+	 * or timeout_us elapsed. Returns the number of frames seen.
+	 */
+	uint32_t waitWriteFrames(uint32_t n, uint32_t timeout_us)
+	{
+		return waitFrames(XAXIVDMA_WRITE, n, timeout_us);
+	}
+	uint32_t waitReadFrames(uint32_t n, uint32_t timeout_us)
+	{
+		return waitFrames(XAXIVDMA_READ, n, timeout_us);
+	}
+
+	void readHandler(uint32_t irq_types)
+	{
+		LOG_DEBUG("VDMA:read complete 0x%x\r\n", irq_types);
+	}
+	void writeHandler(uint32_t irq_types)
+	{
+		LOG_DEBUG("VDMA:write complete 0x%x\r\n", irq_types);
+	}
+	void readErrorHandler(uint32_t mask)
+	{
+		LOG_ERROR("VDMA:read error 0x%x\r\n", mask);
+		if (err_hook_)
+			err_hook_(err_hook_ctx_, XAXIVDMA_READ, mask);
+	}
+	void writeErrorHandler(uint32_t mask)
+	{
+		LOG_ERROR("VDMA:write error 0x%x\r\n", mask);
+		if (err_hook_)
+			err_hook_(err_hook_ctx_, XAXIVDMA_WRITE, mask);
+	}
+	~AXI_VDMA() = default;
+private:
+	void configureWriteAt(uint16_t h_res, uint16_t v_res, UINTPTR const* addr)
 	{
 		XAxiVdma_ClearDmaChannelErrors(&drv_inst_, XAXIVDMA_WRITE, XAXIVDMA_SR_ERR_ALL_MASK);
 
@@ -198,11 +317,8 @@ public:
 		{
 			throw std::runtime_error(__FILE__ ":" LINE_STRING);
 		}
-		uint32_t addr = frame_buf_base_addr_;
-		for (int iFrm=0; iFrm<drv_inst_.MaxNumFrames; ++iFrm) {
-			context_.WriteCfg.FrameStoreStartAddr[iFrm] = addr;
-			addr += context_.WriteCfg.HoriSizeInput * context_.WriteCfg.VertSizeInput;
-		}
+		for (int iFrm=0; iFrm<drv_inst_.MaxNumFrames; ++iFrm)
+			context_.WriteCfg.FrameStoreStartAddr[iFrm] = addr[iFrm];
 		status = XAxiVdma_DmaSetBufferAddr(&drv_inst_, XAXIVDMA_WRITE, context_.WriteCfg.FrameStoreStartAddr);
 		if (XST_SUCCESS != status)
 		{
@@ -215,42 +331,29 @@ public:
 		//Enable write channel error and frame count interrupts
 		XAxiVdma_IntrEnable(&drv_inst_, XAXIVDMA_IXR_ERROR_MASK, XAXIVDMA_WRITE);
 	}
-	void enableWrite()
+	uint32_t waitFrames(uint16_t direction, uint32_t n, uint32_t timeout_us)
 	{
-		XStatus status;
-		//Start read channel
-		status = XAxiVdma_DmaStart(&drv_inst_, XAXIVDMA_WRITE);
-		if (XST_SUCCESS != status)
+		uint32_t frames = 0;
+		int frm = XAxiVdma_CurrFrameStore(&drv_inst_, direction);
+		uint64_t const t_end = time_us() + timeout_us;
+		while (frames < n && time_us() < t_end)
 		{
-			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+			int cur = XAxiVdma_CurrFrameStore(&drv_inst_, direction);
+			if (cur != frm)
+			{
+				frm = cur;
+				++frames;
+			}
 		}
+		return frames;
 	}
-	void readHandler(uint32_t irq_types)
-	{
-		std::cout << "VDMA:read complete" << std::endl;
-	}
-	void writeHandler(uint32_t irq_types)
-	{
-		std::cout << "VDMA:write complete" << std::endl;
-	}
-	void readErrorHandler(uint32_t mask)
-	{
-		std::cout << "VDMA:read error" << std::endl;
-	}
-	void writeErrorHandler(uint32_t mask)
-	{
-		std::cout << "VDMA:write error" << std::endl;
-	}
-	~AXI_VDMA() = default;
 private:
 	XAxiVdma drv_inst_;
-	std::function<void(uint32_t)> rd_handler_;
-	std::function<void(uint32_t)> wr_handler_;
-	std::function<void(uint32_t)> rd_err_handler_;
-	std::function<void(uint32_t)> wr_err_handler_;
 	vdma_context_t context_;
 	uint32_t frame_buf_base_addr_;
 	IrptCtl& irpt_ctl_;
+	ErrorHook err_hook_ = NULL;
+	void* err_hook_ctx_ = NULL;
 	int const RESET_POLL = 1000;
 };
 
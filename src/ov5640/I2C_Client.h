@@ -23,7 +23,44 @@ public:
 	};
 	virtual void read(uint8_t addr, uint8_t* buf, size_t count) = 0;
 	virtual void write(uint8_t addr, uint8_t const* buf, size_t count) = 0;
+
+	/*!
+	 * \brief Produces the next message of a batch into buf (at most max bytes)
+	 * and returns its length, or 0 once the batch is exhausted. May be called
+	 * from interrupt context.
+	 */
+	typedef size_t (*BatchSource)(void* ctx, uint8_t* buf, size_t max);
+	static size_t const batch_msg_max = 8;
+
+	/*!
+	 * \brief Writes every message of a batch to addr. Clients with interrupt
+	 * support return immediately and chain the messages from the completion
+	 * interrupt; this default runs the batch to the end before returning.
+	 */
+	virtual void startBatch(uint8_t addr, BatchSource src, void* ctx)
+	{
+		uint8_t buf[batch_msg_max];
+		size_t count;
+		batch_error_ = false;
+		try
+		{
+			while ((count = src(ctx, buf, sizeof(buf))) > 0)
+				write(addr, buf, count);
+		}
+		catch (TransmitError const&)
+		{
+			batch_error_ = true;
+		}
+	}
+	//! \brief True while a batch started by startBatch is still running
+	virtual bool batchBusy() { return false; }
+	//! \brief True if the last batch stopped early on a bus error
+	bool batchFailed() const { return batch_error_; }
+	//! \brief Once the caller has finished a failed batch by other means
+	void clearBatchError() { batch_error_ = false; }
 	virtual ~I2C_Client() = default;
+protected:
+	volatile bool batch_error_ = false;
 };
 
 } /* namespace digilent */
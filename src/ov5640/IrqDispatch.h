@@ -0,0 +1,37 @@
+/*
+ * IrqDispatch.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef IRQDISPATCH_H_
+#define IRQDISPATCH_H_
+
+namespace digilent {
+
+namespace Irq {
+	/*!
+	 * \brief Compile-time binding of a member function to the C callback
+	 * signature the Xilinx drivers and the GIC use: the instance travels as
+	 * the void* callback reference and the member is a template argument, so
+	 * the thunk is a direct (inlinable) call with no type-erased object.
+	 *
+	 *   irpt_ctl.registerHandler(id, &Irq::Member<&PS_UART::service>::thunk, this);
+	 *   XIicPs_SetStatusHandler(&iic, this, &Irq::Member<&PS_IIC::StatusHandler>::thunk);
+	 */
+	template <auto Fn>
+	struct Member;
+
+	template <typename T, typename ...Args, void (T::*Fn)(Args...)>
+	struct Member<Fn>
+	{
+		static void thunk(void* ctx, Args... args)
+		{
+			(static_cast<T*>(ctx)->*Fn)(args...);
+		}
+	};
+}
+
+} /* namespace digilent */
+
+#endif /* IRQDISPATCH_H_ */
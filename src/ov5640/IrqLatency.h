@@ -0,0 +1,103 @@
+/*
+ * IrqLatency.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef IRQLATENCY_H_
+#define IRQLATENCY_H_
+
+#include <stdint.h>
+#include <functional>
+
+#include "IrqDispatch.h"
+
+#include "xtime_l.h"
+
+namespace digilent {
+
+namespace IrqLatency {
+	//! \brief Trigger to handler entry, in XTime ticks
+	using stats_t = struct { uint32_t samples, timeouts; uint32_t min, max; uint64_t sum; };
+	using result_t = struct { stats_t function_shim; stats_t direct; uint32_t ticks_per_us; };
+
+	// Old driver callback path: C shim into a std::function wrapping a std::bind
+	inline void functionShim(void* ref)
+	{
+		(*static_cast<std::function<void()>*>(ref))();
+	}
+}
+
+/*!
+ * \brief Interrupt entry latency of a software-generated interrupt, once
+ * through the std::function shim the drivers used to have and once through
+ * Irq::Member. The GIC and vector path is the same for both, so the
+ * difference is the dispatch itself. Run with nothing else interrupt heavy.
+ */
+template <typename IrptCtl>
+class IrqLatencyBench
+{
+public:
+	IrqLatencyBench(IrptCtl& irpt_ctl, uint32_t sgi_id) :
+		irpt_ctl_(irpt_ctl), sgi_id_(sgi_id)
+	{
+	}
+
+	IrqLatency::result_t run(uint32_t n)
+	{
+		IrqLatency::result_t res = {};
+		res.ticks_per_us = COUNTS_PER_SECOND / 1000000;
+
+		std::function<void()> fn = std::bind(&IrqLatencyBench::entry, this);
+		irpt_ctl_.registerHandler(sgi_id_, &IrqLatency::functionShim, &fn);
+		measure(res.function_shim, n);
+
+		irpt_ctl_.registerHandler(sgi_id_, &Irq::Member<&IrqLatencyBench::entry>::thunk, this);
+		measure(res.direct, n);
+
+		irpt_ctl_.disableInterrupt(sgi_id_);
+		return res;
+	}
+
+private:
+	void entry()
+	{
+		XTime_GetTime(&t_entry_);
+		__atomic_store_n(&done_, 1, __ATOMIC_RELEASE);
+	}
+
+	void measure(IrqLatency::stats_t& s, uint32_t n)
+	{
+		s.min = UINT32_MAX;
+		uint32_t const spin_max = 1000000;
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			done_ = 0;
+			XTime t0;
+			XTime_GetTime(&t0);
+			irpt_ctl_.softwareInterrupt(sgi_id_);
+			uint32_t spin = 0;
+			while (!__atomic_load_n(&done_, __ATOMIC_ACQUIRE) && ++spin < spin_max) ;
+			if (spin >= spin_max)
+			{
+				++s.timeouts;
+				continue;
+			}
+			uint32_t const d = (uint32_t)(t_entry_ - t0);
+			if (d < s.min) s.min = d;
+			if (d > s.max) s.max = d;
+			s.sum += d;
+			++s.samples;
+		}
+	}
+
+private:
+	IrptCtl& irpt_ctl_;
+	uint32_t const sgi_id_;
+	XTime t_entry_ = 0;
+	uint32_t done_ = 0;
+};
+
+} /* namespace digilent */
+
+#endif /* IRQLATENCY_H_ */
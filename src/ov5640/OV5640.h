@@ -11,11 +11,13 @@
 #include <sstream>
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 #include <climits>
 
 #include "I2C_Client.h"
 #include "GPIO_Client.h"
 #include "../hdmi/VideoOutput.h"
+#include "../util/Profile.h"
 
 #define SIZEOF_ARRAY(x) sizeof(x)/sizeof(x[0])
 #define MAP_ENUM_TO_CFG(en, cfg) en, cfg, SIZEOF_ARRAY(cfg)
@@ -35,7 +37,7 @@ namespace digilent {
 typedef enum {OK=0, ERR_LOGICAL, ERR_GENERAL} Errc;
 
 namespace OV5640_cfg {
-	using config_word_t = struct { uint16_t addr; uint8_t data; } ;
+	struct config_word_t { uint16_t addr; uint8_t data; };
 	using mode_t = enum { MODE_480P_640_480_15FPS = 0, MODE_720P_1280_720_15fps, MODE_720P_1280_720_60fps, MODE_1080P_1920_1080_15fps,
 		MODE_1080P_1920_1080_30fps, MODE_1080P_1920_1080_30fps_336M_MIPI,
 		MODE_1080P_1920_1080_30fps_336M_1LANE_MIPI, MODE_END } ;
@@ -173,8 +175,8 @@ namespace OV5640_cfg {
 
 		{0x3800, (OV5640_PIXEL_ARRAY_LEFT >> 8) & 0x0F}, {0x3801, OV5640_PIXEL_ARRAY_LEFT & 0xFF},   // X start ~16 
 		{0x3802, (OV5640_PIXEL_ARRAY_TOP >> 8) & 0x07}, {0x3803, OV5640_PIXEL_ARRAY_TOP & 0xFF},   // Y start ~14 (similar to 1080p crop)
-		{0x3804, (OV5640_PIXEL_ARRAY_LEFT+OV5640_PIXEL_ARRAY_WIDTH-1 >> 8) & 0x0F}, {0x3805, (OV5640_PIXEL_ARRAY_LEFT+OV5640_PIXEL_ARRAY_WIDTH-1) & 0xFF},  // X end
-		{0x3806, (OV5640_PIXEL_ARRAY_TOP+OV5640_PIXEL_ARRAY_HEIGHT-1 >> 8) & 0x07}, {0x3807, (OV5640_PIXEL_ARRAY_TOP+OV5640_PIXEL_ARRAY_HEIGHT-1) & 0xFF},  // Y end
+		{0x3804, ((OV5640_PIXEL_ARRAY_LEFT+OV5640_PIXEL_ARRAY_WIDTH-1) >> 8) & 0x0F}, {0x3805, (OV5640_PIXEL_ARRAY_LEFT+OV5640_PIXEL_ARRAY_WIDTH-1) & 0xFF},  // X end
+		{0x3806, ((OV5640_PIXEL_ARRAY_TOP+OV5640_PIXEL_ARRAY_HEIGHT-1) >> 8) & 0x07}, {0x3807, (OV5640_PIXEL_ARRAY_TOP+OV5640_PIXEL_ARRAY_HEIGHT-1) & 0xFF},  // Y end
 
 		{0x3810, 0x00}, {0x3811, 0x02},  // H offset
 		{0x3812, 0x00}, {0x3813, 0x04},  // V offset
@@ -667,6 +669,56 @@ config_word_t const cfg_1080p_30fps_336M_1lane_mipi_[] =
 		//[2:0]=0x3 Format select ISP RAW (DPC)
 		{0x501f, 0x03}
 	};
+	/*
+	 * Full array still: the same registers as the mode tables so that deltas
+	 * both ways are complete. PLL, offsets and MIPI timing are those of
+	 * 1080p15, so coming from that preview only the window, output size and
+	 * HTS/VTS change (16 registers, one group hold).
+	 */
+	config_word_t const cfg_5mp_still_[] =
+	{//2592 x 1944 @ 7.5 fps, RAW10, MIPISCLK=210, SCLK=42MHz, PCLK=42M
+		// [7:4]=0100 System clock divider /4, [3:0]=0001 Scale divider for MIPI /1
+		{0x3035, 0x41},
+		// [7:0]=105 PLL multiplier
+		{0x3036, 0x69},
+		// [4]=0 PLL root divider /1, [3:0]=5 PLL pre-divider /1.5
+		{0x3037, 0x05},
+		// [5:4]=01 PCLK root divider /2, [3:2]=00 SCLK2x root divider /1, [1:0]=01 SCLK root divider /2
+		{0x3108, 0x11},
+		// [6:4]=001 PLL charge pump, [3:0]=1010 MIPI 10-bit mode
+		{0x3034, 0x1A},
+
+		// Whole native array, X 0..2623, Y 0..1963
+		{0x3800, 0x00}, {0x3801, 0x00},
+		{0x3802, 0x00}, {0x3803, 0x00},
+		{0x3804, ((OV5640_NATIVE_WIDTH - 1) >> 8) & 0x0F}, {0x3805, (OV5640_NATIVE_WIDTH - 1) & 0xFF},
+		{0x3806, ((OV5640_NATIVE_HEIGHT - 1) >> 8) & 0x07}, {0x3807, (OV5640_NATIVE_HEIGHT - 1) & 0xFF},
+		{0x3810, (16 >> 8) & 0x0F}, {0x3811, 16 & 0xFF},
+		{0x3812, (12 >> 8) & 0x07}, {0x3813, 12 & 0xFF},
+
+		{0x3808, (OV5640_PIXEL_ARRAY_WIDTH >> 8) & 0x0F}, {0x3809, OV5640_PIXEL_ARRAY_WIDTH & 0xFF},
+		{0x380a, (OV5640_PIXEL_ARRAY_HEIGHT >> 8) & 0x7F}, {0x380b, OV5640_PIXEL_ARRAY_HEIGHT & 0xFF},
+
+		// HTS 2844, VTS 1968: a 2592 pixel line takes 62 us on two 210 Mbps lanes, HTS/SCLK is 68 us
+		{0x380c, (2844 >> 8) & 0x1F}, {0x380d, 2844 & 0xFF},
+		{0x380e, (1968 >> 8) & 0xFF}, {0x380f, 1968 & 0xFF},
+
+		// No subsampling, no binning
+		{0x3814, 0x11},
+		{0x3815, 0x11},
+		{0x3821, 0x00},
+
+		{0x4837, 48}, // 1/42M*2
+
+		{0x3618, 0x00},
+		{0x3612, 0x59},
+		{0x3708, 0x64},
+		{0x3709, 0x52},
+		{0x370c, 0x03},
+
+		{0x4300, 0x00},
+		{0x501f, 0x03}
+	};
 	config_word_t const cfg_init_[] =
 	{
 		//[7]=0 Software reset; [6]=1 Software power down; Default=0x02
@@ -820,6 +872,16 @@ config_word_t const cfg_1080p_30fps_336M_1lane_mipi_[] =
 		//[7]=0 Special digital effects, [5]=0 scaling, [2]=0 UV average disabled, [1]=1 Color matrix enabled, [0]=1 Auto white balance enabled
 		{0x5001, 0x03}
 	};
+	config_word_t const cfg_sw_standby_[] =
+	{
+		//[7]=0 Software reset; [6]=1 Software power down; Default=0x02
+		{0x3008, 0x42}
+	};
+	config_word_t const cfg_sw_wake_[] =
+	{
+		//[7]=0 Software reset; [6]=0 Software power down; Default=0x02
+		{0x3008, 0x02}
+	};
 	config_modes_t const modes[] =
 	{
 			{ MAP_ENUM_TO_CFG(MODE_480P_640_480_15FPS, cfg_480p_15fps_) },
@@ -830,6 +892,135 @@ config_word_t const cfg_1080p_30fps_336M_1lane_mipi_[] =
 			{ MAP_ENUM_TO_CFG(MODE_1080P_1920_1080_30fps_336M_MIPI, cfg_1080p_30fps_336M_mipi_) },
 			{ MAP_ENUM_TO_CFG(MODE_1080P_1920_1080_30fps_336M_1LANE_MIPI, cfg_1080p_30fps_336M_1lane_mipi_) },
 	};
+	// Output geometry and timing programmed by each mode table, indexed by mode_t
+	using mode_info_t = struct { uint16_t width, height; uint16_t hts, vts; uint8_t fps; uint8_t lanes; };
+	mode_info_t const mode_info[] =
+	{
+			{  640,  480, 1600, 2343, 15, 2 },
+			{ 1280,  720, 1896, 3936, 15, 2 },
+			{ 1280,  720, 1896,  984, 60, 2 },
+			{ 1920, 1080, 2500, 1120, 15, 2 },
+			{ 1920, 1080, 2500, 1120, 30, 2 },
+			{ 1920, 1080, 2500, 1120, 30, 2 },
+			{ 1920, 1080, 2500, 1120, 30, 1 },
+	};
+	mode_info_t const still_info = { OV5640_PIXEL_ARRAY_WIDTH, OV5640_PIXEL_ARRAY_HEIGHT, 2844, 1968, 7, 2 };
+
+	//! \brief PLL and MIPI clocking registers, only rewritten in software power down
+	inline bool is_clock_reg(uint16_t addr)
+	{
+		return (addr >= 0x3034 && addr <= 0x3039) || addr == 0x3108 || addr == 0x3824 || addr == 0x4837;
+	}
+
+	/*!
+	 * \brief Words of table to whose value differs from what table from
+	 * leaves behind, in to's order. Registers only from writes keep their
+	 * values. Stores at most max words and returns the count needed, like
+	 * snprintf.
+	 */
+	inline size_t config_delta(config_word_t const* from, size_t from_size,
+			config_word_t const* to, size_t to_size, config_word_t* out, size_t max)
+	{
+		size_t n = 0;
+		for (size_t i = 0; i < to_size; ++i)
+		{
+			bool later = false;
+			for (size_t j = i + 1; j < to_size && !later; ++j)
+				later = to[j].addr == to[i].addr;
+			if (later)
+				continue;
+			bool same = false;
+			for (size_t j = from_size; j-- > 0;)
+			{
+				if (from[j].addr == to[i].addr)
+				{
+					same = from[j].data == to[i].data;
+					break;
+				}
+			}
+			if (same)
+				continue;
+			if (n < max)
+				out[n] = to[i];
+			++n;
+		}
+		return n;
+	}
+	/*!
+	 * \brief Sensor read-out window in array coordinates (inclusive), ISP
+	 * crop offset and subsampling factor, as 0x3800-0x3815 program them.
+	 */
+	using window_t = struct { uint16_t x_start, y_start, x_end, y_end; uint16_t x_off, y_off; uint8_t sub; };
+
+	//! \brief The window a mode table leaves behind
+	inline window_t mode_window(mode_t mode)
+	{
+		uint8_t r[0x16] = {};
+		for (size_t i = 0; i < modes[mode].cfg_size; ++i)
+		{
+			config_word_t const& w = modes[mode].cfg[i];
+			if (w.addr >= 0x3800 && w.addr < 0x3816)
+				r[w.addr - 0x3800] = w.data;
+		}
+		auto reg16 = [&r](int i) { return (uint16_t)((r[i] << 8) | r[i + 1]); };
+		//0x3814 [7:4] odd, [3:0] even increment: 0x11 every pixel, 0x31 every other pair
+		uint8_t const sub = (uint8_t)(((r[0x14] >> 4) + (r[0x14] & 0x0F)) / 2);
+		return window_t{reg16(0x00), reg16(0x02), reg16(0x04), reg16(0x06), reg16(0x10), reg16(0x12), sub ? sub : (uint8_t)1};
+	}
+
+	/*!
+	 * \brief Window for zoom_x100 (100 = the mode's own field of view) centred
+	 * on array position cx, cy. The RAW path runs without the ISP scaler, so
+	 * the output always covers output size x subsampling pixels of the
+	 * array: the only zoom step is a binned mode reading every pixel of
+	 * half its window each way instead (2x, from zoom_x100 >= 150). That
+	 * reads out as many rows and columns as the mode does, so HTS, VTS and
+	 * the frame rate hold. Pan moves the window within the native array, on
+	 * even coordinates to keep the CFA phase. The ISP input, and so output
+	 * size and offsets, stays that of the mode.
+	 */
+	inline window_t roi_window(mode_t mode, uint16_t zoom_x100, uint16_t cx, uint16_t cy)
+	{
+		window_t const base = mode_window(mode);
+		bool const zoom = base.sub > 1 && zoom_x100 >= 150;
+		uint8_t const sub = zoom ? 1 : base.sub;
+		int32_t const w = (base.x_end - base.x_start + 1) * sub / base.sub;
+		int32_t const h = (base.y_end - base.y_start + 1) * sub / base.sub;
+		auto place = [](int32_t c, int32_t size, int32_t limit) {
+			int32_t start = c - size / 2;
+			if (start > limit - size) start = limit - size;
+			if (start < 0) start = 0;
+			return (uint16_t)(start & ~1);
+		};
+		window_t r = base;
+		r.sub = sub;
+		r.x_start = place(cx, w, OV5640_NATIVE_WIDTH);
+		r.y_start = place(cy, h, OV5640_NATIVE_HEIGHT);
+		r.x_end = (uint16_t)(r.x_start + w - 1);
+		r.y_end = (uint16_t)(r.y_start + h - 1);
+		return r;
+	}
+
+	size_t const window_words = 15;
+	//! \brief Register words for a window, window_words of them, fit for group hold
+	inline size_t window_config(window_t const& w, config_word_t* out)
+	{
+		uint8_t const inc = w.sub > 1 ? 0x31 : 0x11;
+		config_word_t const cfg[window_words] = {
+			{0x3800, (uint8_t)((w.x_start >> 8) & 0x0F)}, {0x3801, (uint8_t)(w.x_start & 0xFF)},
+			{0x3802, (uint8_t)((w.y_start >> 8) & 0x07)}, {0x3803, (uint8_t)(w.y_start & 0xFF)},
+			{0x3804, (uint8_t)((w.x_end >> 8) & 0x0F)}, {0x3805, (uint8_t)(w.x_end & 0xFF)},
+			{0x3806, (uint8_t)((w.y_end >> 8) & 0x07)}, {0x3807, (uint8_t)(w.y_end & 0xFF)},
+			{0x3810, (uint8_t)((w.x_off >> 8) & 0x0F)}, {0x3811, (uint8_t)(w.x_off & 0xFF)},
+			{0x3812, (uint8_t)((w.y_off >> 8) & 0x07)}, {0x3813, (uint8_t)(w.y_off & 0xFF)},
+			//[0]=1 horizontal binning along with subsampling, as the mode tables do
+			{0x3814, inc}, {0x3815, inc}, {0x3821, (uint8_t)(w.sub > 1 ? 0x01 : 0x00)}
+		};
+		for (size_t i = 0; i < window_words; ++i)
+			out[i] = cfg[i];
+		return window_words;
+	}
+
 	config_awb_t const awbs[] =
 	{
 			{ MAP_ENUM_TO_CFG(AWB_DISABLED, cfg_disable_awb_) },
@@ -842,6 +1033,15 @@ class OV5640 {
 public:
 	class HardwareError;
 
+	//Power-up and software reset settling times for non-blocking bring-up
+	static uint32_t const power_off_us = 50000;
+	static uint32_t const power_on_us = 20000;
+	static uint32_t const soft_reset_us = 5000;
+	//Registers group 0 holds with the default group start addresses (64 bytes)
+	static size_t const group_words = 16;
+	//Data bytes per sequential write transaction
+	static size_t const burst_max = 64;
+
 	OV5640(I2C_Client& iic, GPIO_Client& gpio) :
 		iic_(iic), gpio_(gpio)
 	{
@@ -850,6 +1050,26 @@ public:
 	}
 
 	void init()
+	{
+		PROFILE_ZONE("OV5640::init");
+		soft_reset();
+
+		usleep(1000000);
+
+		size_t i;
+		for (i=0;i<sizeof(OV5640_cfg::cfg_init_)/sizeof(OV5640_cfg::cfg_init_[0]); ++i)
+		{
+			writeReg(OV5640_cfg::cfg_init_[i].addr, OV5640_cfg::cfg_init_[i].data);
+		}
+
+		//Stay in power down
+	}
+
+	/*!
+	 * \brief Checks the chip ID and issues a software reset. The sensor needs
+	 * soft_reset_us before the init table can be written.
+	 */
+	void soft_reset()
 	{
 		uint8_t id_h, id_l;
 		readReg(reg_ID_h, id_h);
@@ -868,24 +1088,20 @@ public:
 		writeReg(0x3103, 0x11);
 		//[7]=1 Software reset; [6]=0 Software power down; Default=0x02
 		writeReg(0x3008, 0x82);
+	}
 
-		usleep(1000000);
-
-		size_t i;
-		for (i=0;i<sizeof(OV5640_cfg::cfg_init_)/sizeof(OV5640_cfg::cfg_init_[0]); ++i)
-		{
-			writeReg(OV5640_cfg::cfg_init_[i].addr, OV5640_cfg::cfg_init_[i].data);
-		}
-
-		//Stay in power down
+	void set_power(bool on)
+	{
+		if (on) gpio_.setBit(gpio_.Bits::CAM_GPIO0);
+		else gpio_.clearBit(gpio_.Bits::CAM_GPIO0);
 	}
 
 	Errc reset()
 	{
 		//Power cycle
-		gpio_.clearBit(gpio_.Bits::CAM_GPIO0);
+		set_power(false);
 		usleep(1000000);
-		gpio_.setBit(gpio_.Bits::CAM_GPIO0);
+		set_power(true);
 		usleep(1000000);
 
 		return OK;
@@ -893,6 +1109,7 @@ public:
 
 	Errc set_mode(OV5640_cfg::mode_t mode)
 	{
+		PROFILE_ZONE("OV5640::set_mode");
 		if (mode >= OV5640_cfg::mode_t::MODE_END)
 			return ERR_LOGICAL;
 
@@ -909,6 +1126,7 @@ public:
 
 	Errc set_awb(OV5640_cfg::awb_t awb)
 	{
+		PROFILE_ZONE("OV5640::set_awb");
 		if (awb >= OV5640_cfg::awb_t::AWB_END)
 			return ERR_LOGICAL;
 		//[7]=0 Software reset; [6]=1 Software power down; Default=0x02
@@ -922,6 +1140,56 @@ public:
 		return OK;
 	}
 
+	/*!
+	 * \brief Starts writing a config table in the background through the I2C
+	 * client batch interface. With standby set the table is wrapped in a
+	 * software power down and wake-up like set_mode does. Poll config_busy()
+	 * before any other register access.
+	 */
+	Errc start_config(OV5640_cfg::config_word_t const* cfg, size_t cfg_size, bool standby)
+	{
+		upload_ = {};
+		if (standby) upload_.segs[upload_.seg_count++] = {OV5640_cfg::cfg_sw_standby_, SIZEOF_ARRAY(OV5640_cfg::cfg_sw_standby_)};
+		upload_.segs[upload_.seg_count++] = {cfg, cfg_size};
+		if (standby) upload_.segs[upload_.seg_count++] = {OV5640_cfg::cfg_sw_wake_, SIZEOF_ARRAY(OV5640_cfg::cfg_sw_wake_)};
+		iic_.startBatch(dev_address_, &OV5640::uploadSource, this);
+		return OK;
+	}
+
+	Errc start_mode(OV5640_cfg::mode_t mode)
+	{
+		if (mode >= OV5640_cfg::mode_t::MODE_END)
+			return ERR_LOGICAL;
+		return start_config(OV5640_cfg::modes[mode].cfg, OV5640_cfg::modes[mode].cfg_size, true);
+	}
+
+	Errc start_awb(OV5640_cfg::awb_t awb)
+	{
+		if (awb >= OV5640_cfg::awb_t::AWB_END)
+			return ERR_LOGICAL;
+		return start_config(OV5640_cfg::awbs[awb].cfg, OV5640_cfg::awbs[awb].cfg_size, true);
+	}
+
+	/*!
+	 * \brief True while a background upload is running. A batch stopped by a
+	 * bus error is finished here with the retrying writeReg, once: the error
+	 * is cleared after the resend, so later calls do not repeat it.
+	 */
+	bool config_busy()
+	{
+		if (iic_.batchBusy())
+			return true;
+		if (iic_.batchFailed())
+		{
+			--upload_.idx; //resend the word that failed
+			uint8_t buf[I2C_Client::batch_msg_max];
+			while (uploadSource(this, buf, sizeof(buf)))
+				writeReg((buf[0] << 8) | buf[1], buf[2]);
+			iic_.clearBatchError();
+		}
+		return false;
+	}
+
 	Errc set_isp_format(OV5640_cfg::isp_format_t isp)
 	{
 		if (isp >= OV5640_cfg::isp_format_t::ISP_END)
@@ -961,6 +1229,174 @@ public:
 				break;
 		}
 	}
+	/*!
+	 * \brief Writes the table into group 0 and quick-launches it, so that the
+	 * sensor applies all of it at the same frame boundary. Group 0 holds
+	 * 64 bytes (about 16 registers).
+	 */
+	void writeGroup(OV5640_cfg::config_word_t const* cfg, size_t cfg_size)
+	{
+		//[7:4] 0 group hold start, 1 end, A quick launch; [3:0] group 0
+		writeReg(0x3212, 0x00);
+		writeConfig(cfg, cfg_size);
+		writeReg(0x3212, 0x10);
+		writeReg(0x3212, 0xA0);
+	}
+
+	//! \brief True if the words fit group 0 and leave the clocks alone
+	static bool fitsGroup(OV5640_cfg::config_word_t const* cfg, size_t cfg_size)
+	{
+		if (cfg_size > group_words)
+			return false;
+		for (size_t i = 0; i < cfg_size; ++i)
+			if (OV5640_cfg::is_clock_reg(cfg[i].addr))
+				return false;
+		return true;
+	}
+
+	/*!
+	 * \brief Writes a delta from OV5640_cfg::config_delta(). With hold set,
+	 * one that fitsGroup() goes in under group hold, so the sensor keeps
+	 * streaming and switches at the next frame boundary; any other is
+	 * written in software power down like set_mode. Returns true if group
+	 * hold was used.
+	 */
+	bool writeDelta(OV5640_cfg::config_word_t const* delta, size_t delta_size, bool hold = true)
+	{
+		PROFILE_ZONE("OV5640::writeDelta");
+		if (hold && fitsGroup(delta, delta_size))
+		{
+			writeGroup(delta, delta_size);
+			return true;
+		}
+		//[7]=0 Software reset; [6]=1 Software power down; Default=0x02
+		writeReg(0x3008, 0x42);
+		writeConfig(delta, delta_size);
+		//[7]=0 Software reset; [6]=0 Software power down; Default=0x02
+		writeReg(0x3008, 0x02);
+		return false;
+	}
+
+	/*!
+	 * \brief Zoom and pan within the given running mode, see
+	 * OV5640_cfg::roi_window(). All window registers go in under one group
+	 * hold, so the next frame has the new window and output size and timing
+	 * are unchanged. The window written is returned in applied.
+	 */
+	Errc set_roi(OV5640_cfg::mode_t mode, uint16_t zoom_x100, uint16_t cx, uint16_t cy, OV5640_cfg::window_t& applied)
+	{
+		PROFILE_ZONE("OV5640::set_roi");
+		if (mode >= OV5640_cfg::mode_t::MODE_END)
+			return ERR_LOGICAL;
+		applied = OV5640_cfg::roi_window(mode, zoom_x100, cx, cy);
+		OV5640_cfg::config_word_t cfg[OV5640_cfg::window_words];
+		writeGroup(cfg, OV5640_cfg::window_config(applied, cfg));
+		return OK;
+	}
+
+	//! \brief Back to the window of the mode table
+	Errc reset_roi(OV5640_cfg::mode_t mode)
+	{
+		if (mode >= OV5640_cfg::mode_t::MODE_END)
+			return ERR_LOGICAL;
+		OV5640_cfg::config_word_t cfg[OV5640_cfg::window_words];
+		writeGroup(cfg, OV5640_cfg::window_config(OV5640_cfg::mode_window(mode), cfg));
+		return OK;
+	}
+
+	/*!
+	 * \brief Manual exposure in 1/16 lines and real gain in 1/16 (16 = 1x),
+	 * applied together with AEC/AGC switched to manual under one group hold.
+	 * Exposure must stay below VTS - 4 lines.
+	 */
+	void set_exposure(uint32_t lines_x16, uint16_t gain_x16)
+	{
+		OV5640_cfg::config_word_t const cfg[] =
+		{
+			//[1]=1 AGC manual, [0]=1 AEC manual
+			{0x3503, 0x03},
+			{0x3500, (uint8_t)((lines_x16 >> 16) & 0x0F)}, {0x3501, (uint8_t)((lines_x16 >> 8) & 0xFF)},
+			{0x3502, (uint8_t)(lines_x16 & 0xFF)},
+			{0x350a, (uint8_t)((gain_x16 >> 8) & 0x03)}, {0x350b, (uint8_t)(gain_x16 & 0xFF)}
+		};
+		writeGroup(cfg, SIZEOF_ARRAY(cfg));
+	}
+	void get_exposure(uint32_t& lines_x16, uint16_t& gain_x16)
+	{
+		uint8_t e[3], g[2];
+		readRegs(0x3500, e, sizeof(e));
+		readRegs(0x350a, g, sizeof(g));
+		lines_x16 = ((uint32_t)(e[0] & 0x0F) << 16) | (e[1] << 8) | e[2];
+		gain_x16 = (uint16_t)(((g[0] & 0x03) << 8) | g[1]);
+	}
+	//! \brief Hands exposure and gain back to the sensor's AEC/AGC
+	void set_auto_exposure()
+	{
+		//[1]=0 AGC auto, [0]=0 AEC auto
+		writeReg(0x3503, 0x00);
+	}
+	//! \brief The sensor's average luminance readout (0x56A1) over its AEC window
+	uint8_t average_luma()
+	{
+		uint8_t avg;
+		readReg(0x56a1, avg);
+		return avg;
+	}
+
+	/*!
+	 * \brief Manual white balance gains in 1/1024 (0x400 = 1x, 12 bits),
+	 * applied with AWB switched to manual under one group hold. They take
+	 * effect while the AWB gain stage is on (0x5001[0], every AWB table but
+	 * AWB_DISABLED).
+	 */
+	void set_wb_gains(uint16_t r, uint16_t g, uint16_t b)
+	{
+		OV5640_cfg::config_word_t const cfg[] =
+		{
+			//[0]=1 AWB gain manual
+			{0x3406, 0x01},
+			{0x3400, (uint8_t)((r >> 8) & 0x0F)}, {0x3401, (uint8_t)(r & 0xFF)},
+			{0x3402, (uint8_t)((g >> 8) & 0x0F)}, {0x3403, (uint8_t)(g & 0xFF)},
+			{0x3404, (uint8_t)((b >> 8) & 0x0F)}, {0x3405, (uint8_t)(b & 0xFF)}
+		};
+		writeGroup(cfg, SIZEOF_ARRAY(cfg));
+	}
+	void get_wb_gains(uint16_t& r, uint16_t& g, uint16_t& b)
+	{
+		uint8_t v[6];
+		readRegs(0x3400, v, sizeof(v));
+		r = (uint16_t)(((v[0] & 0x0F) << 8) | v[1]);
+		g = (uint16_t)(((v[2] & 0x0F) << 8) | v[3]);
+		b = (uint16_t)(((v[4] & 0x0F) << 8) | v[5]);
+	}
+	//! \brief Hands the white balance gains back to the sensor's AWB
+	void set_auto_wb()
+	{
+		//[0]=0 AWB gain auto
+		writeReg(0x3406, 0x00);
+	}
+
+	/*!
+	 * \brief Total line length (HTS, pixel clocks) and frame length (VTS,
+	 * lines) of the active mode, changed together under group hold.
+	 */
+	void set_timing(uint16_t hts, uint16_t vts)
+	{
+		OV5640_cfg::config_word_t const cfg[] =
+		{
+			{0x380c, (uint8_t)((hts >> 8) & 0x1F)}, {0x380d, (uint8_t)(hts & 0xFF)},
+			{0x380e, (uint8_t)((vts >> 8) & 0xFF)}, {0x380f, (uint8_t)(vts & 0xFF)}
+		};
+		writeGroup(cfg, SIZEOF_ARRAY(cfg));
+	}
+	void get_timing(uint16_t& hts, uint16_t& vts)
+	{
+		uint8_t r[4];
+		readRegs(0x380c, r, sizeof(r));
+		hts = ((r[0] & 0x1F) << 8) | r[1];
+		vts = (r[2] << 8) | r[3];
+	}
+
 	void readReg(uint16_t reg_addr, uint8_t& buf)
 	{
 		for(auto retry_count = retry_count_; retry_count > 0; --retry_count)
@@ -1002,6 +1438,60 @@ public:
 			}
 		}
 	}
+	/*!
+	 * \brief Sequential read of count registers from reg_addr in one I2C
+	 * transaction, relying on the sensor's address auto-increment.
+	 */
+	void readRegs(uint16_t reg_addr, uint8_t* buf, size_t count)
+	{
+		for(auto retry_count = retry_count_; retry_count > 0; --retry_count)
+		{
+			try
+			{
+				uint8_t const buf_addr[] = {(uint8_t)(reg_addr>>8), (uint8_t)reg_addr};
+				iic_.write(dev_address_, buf_addr, sizeof(buf_addr));
+				iic_.read(dev_address_, buf, count);
+				break;
+			}
+			catch (I2C_Client::TransmitError const& e)
+			{
+				if (retry_count > 1) continue;
+				else throw HardwareError(HardwareError::IIC_NACK, e.what());
+			}
+		}
+	}
+
+	/*!
+	 * \brief Sequential write of count registers from reg_addr, burst_max
+	 * per I2C transaction, relying on the sensor's address auto-increment.
+	 */
+	void writeRegs(uint16_t reg_addr, uint8_t const* buf, size_t count)
+	{
+		while (count)
+		{
+			size_t const n = count < burst_max ? count : burst_max;
+			uint8_t msg[2 + burst_max];
+			msg[0] = (uint8_t)(reg_addr >> 8);
+			msg[1] = (uint8_t)reg_addr;
+			memcpy(msg + 2, buf, n);
+			for (auto retry_count = retry_count_; retry_count > 0; --retry_count)
+			{
+				try
+				{
+					iic_.write(dev_address_, msg, 2 + n);
+					break;
+				}
+				catch (I2C_Client::TransmitError const& e)
+				{
+					if (retry_count > 1) continue;
+					else throw HardwareError(HardwareError::IIC_NACK, e.what());
+				}
+			}
+			reg_addr = (uint16_t)(reg_addr + n);
+			buf += n;
+			count -= n;
+		}
+	}
 
 	void writeRegLiquid(uint8_t const reg_data)
 		{
@@ -1030,6 +1520,22 @@ public:
 		Errc errc_;
 	};
 private:
+	static size_t uploadSource(void* ctx, uint8_t* buf, size_t max)
+	{
+		upload_t& up = static_cast<OV5640*>(ctx)->upload_;
+		while (up.seg < up.seg_count && up.idx >= up.segs[up.seg].cfg_size)
+		{
+			++up.seg;
+			up.idx = 0;
+		}
+		if (up.seg >= up.seg_count || max < 3)
+			return 0;
+		OV5640_cfg::config_word_t const& word = up.segs[up.seg].cfg[up.idx++];
+		buf[0] = word.addr >> 8;
+		buf[1] = word.addr & 0xFF;
+		buf[2] = word.data;
+		return 3;
+	}
 	void usleep(uint32_t time)
 	{//TODO couldn't think of anything better
 		for (uint32_t i=0; i<time; i++) ;
@@ -1051,6 +1557,12 @@ private:
 	uint16_t const reg_ID_h = 0x300A;
 	uint16_t const reg_ID_l = 0x300B;
 	unsigned int const retry_count_ = 10;
+	using upload_t = struct
+	{
+		struct { OV5640_cfg::config_word_t const* cfg; size_t cfg_size; } segs[3];
+		size_t seg_count, seg, idx;
+	};
+	upload_t upload_ = {};
 };
 
 } /* namespace digilent */
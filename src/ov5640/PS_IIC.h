@@ -9,12 +9,12 @@
 #define I2C_CLIENTAXI_IIC_H_
 
 #include "I2C_Client.h"
+#include "IrqDispatch.h"
 
 #include <stdio.h>
 #include <stdint.h>
 #include <string>
 #include <stdexcept>
-#include <functional>
 
 #include "xiicps.h"
 
@@ -24,27 +24,12 @@
 
 namespace digilent {
 
-
-
-using namespace std::placeholders;
-
 template <typename IrptCtl>
 class PS_IIC: public I2C_Client {
 public:
-
-	// Shim function to extract function object from CallbackRef and call it
-	// This should call our member function handlers below
-	template <typename Func>
-	static void MyCallback(void* CallbackRef, u32 StatusEvent)
-	{
-		auto pfn = static_cast<Func*>(CallbackRef);
-		pfn->operator()(StatusEvent);
-	}
-
 	PS_IIC(uint16_t dev_id, IrptCtl& irpt_ctl, uint32_t irpt_id, uint32_t sclk_rate_Hz) :
 		drv_inst_(),
-		irpt_ctl_(irpt_ctl),
-		stat_handler_(std::bind(&PS_IIC::StatusHandler, this, _1))
+		irpt_ctl_(irpt_ctl)
 	{
 		XIicPs_Config* ConfigPtr;
 		XStatus Status;
@@ -78,12 +63,13 @@ public:
 		irpt_ctl_.enableInterrupt(irpt_id);
 		irpt_ctl_.enableInterrupts();
 
-		XIicPs_SetStatusHandler	(&drv_inst_, &stat_handler_, &MyCallback<decltype(stat_handler_)>);
+		XIicPs_SetStatusHandler(&drv_inst_, this, &Irq::Member<&PS_IIC::StatusHandler>::thunk);
 	}
 
 	virtual void read(uint8_t addr, uint8_t* buf, size_t count) override
 	{
 		// Receive the Data.
+		while (batch_busy_) ;
 
 		resetFlags();
 
@@ -102,6 +88,7 @@ public:
 		//xintc.h is not const-correct, so we create local copy
 		std::vector<uint8_t> buf_local(count);
 		buf_local.assign(buf, buf+count);
+		while (batch_busy_) ;
 
 		resetFlags();
 
@@ -114,11 +101,53 @@ public:
 		if (other_error_flag_) throw TransmitError("Other I2C error");
 	}
 
+	virtual void startBatch(uint8_t addr, BatchSource src, void* ctx) override
+	{
+		while (batch_busy_) ;
+		batch_addr_ = addr;
+		batch_src_ = src;
+		batch_ctx_ = ctx;
+		batch_error_ = false;
+		batch_busy_ = 1;
+		nextBatchMessage();
+	}
+
+	virtual bool batchBusy() override
+	{
+		return batch_busy_;
+	}
+
 	virtual ~PS_IIC() { }
 
 private:
-	void StatusHandler(int Event)
+	// Sends the next batch message or ends the batch. Called from the status
+	// handler, i.e. in interrupt context, for every message but the first.
+	void nextBatchMessage()
+	{
+		size_t count = batch_src_(batch_ctx_, batch_buf_, sizeof(batch_buf_));
+		if (!count)
+		{
+			batch_busy_ = 0;
+			return;
+		}
+		resetFlags();
+		XIicPs_MasterSend(&drv_inst_, batch_buf_, count, batch_addr_);
+	}
+	void StatusHandler(u32 Event)
 	{
+		if (batch_busy_)
+		{
+			if (Event & XIICPS_EVENT_COMPLETE_SEND)
+			{
+				nextBatchMessage();
+			}
+			else
+			{
+				batch_error_ = true;
+				batch_busy_ = 0;
+			}
+			return;
+		}
 		if (Event & XIICPS_EVENT_COMPLETE_SEND) //Transmit Complete Event
 		{
 			tx_complete_flag_ = 1;
@@ -153,12 +182,16 @@ private:
 private:
 	XIicPs drv_inst_;
 	IrptCtl& irpt_ctl_;
-	std::function<void(int)> stat_handler_;
 	volatile uint8_t tx_complete_flag_;	// Flag to check completion of Transmission
 	volatile uint8_t rx_complete_flag_;	// Flag to check completion of Reception
 	volatile uint8_t slave_nack_flag_;	// Flag to check completion of Reception
 	volatile uint8_t arb_lost_flag_;	// Flag to check completion of Reception
 	volatile uint8_t other_error_flag_;	// Flag to check completion of Transmission
+	volatile uint8_t batch_busy_ = 0;	// Flag to check completion of a batch
+	uint8_t batch_addr_;
+	BatchSource batch_src_;
+	void* batch_ctx_;
+	uint8_t batch_buf_[batch_msg_max];
 };
 
 } /* namespace digilent */
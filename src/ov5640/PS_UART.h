@@ -0,0 +1,82 @@
+/*
+ * PS_UART.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef PS_UART_H_
+#define PS_UART_H_
+
+#include <stdint.h>
+
+#include "IrqDispatch.h"
+#include "../util/RingBuffer.h"
+
+#include "xil_io.h"
+#include "xuartps_hw.h"
+
+namespace digilent {
+
+/*!
+ * \brief Interrupt-driven receive side of a PS UART. The handler drains the RX
+ * FIFO into a ring the main loop reads with getc(). Transmit stays with
+ * xil_printf, which polls the same UART.
+ */
+template <typename IrptCtl>
+class PS_UART
+{
+public:
+	static size_t const rx_ring_size = 256;
+
+	PS_UART(uint32_t base_addr, IrptCtl& irpt_ctl, uint32_t irpt_id) :
+		base_addr_(base_addr), irpt_ctl_(irpt_ctl), irpt_id_(irpt_id)
+	{
+		Xil_Out32(base_addr_ + XUARTPS_IDR_OFFSET, XUARTPS_IXR_MASK);
+		Xil_Out32(base_addr_ + XUARTPS_ISR_OFFSET, XUARTPS_IXR_MASK);
+		//Interrupt on every byte; the timeout catches anything the trigger misses
+		Xil_Out32(base_addr_ + XUARTPS_RXWM_OFFSET, 1);
+		Xil_Out32(base_addr_ + XUARTPS_RXTOUT_OFFSET, 8);
+
+		irpt_ctl_.registerHandler(irpt_id_, &Irq::Member<&PS_UART::service>::thunk, this);
+		irpt_ctl_.enableInterrupt(irpt_id_);
+		irpt_ctl_.enableInterrupts();
+
+		Xil_Out32(base_addr_ + XUARTPS_IER_OFFSET,
+				XUARTPS_IXR_RXOVR | XUARTPS_IXR_TOUT | XUARTPS_IXR_OVER);
+	}
+
+	~PS_UART()
+	{
+		Xil_Out32(base_addr_ + XUARTPS_IDR_OFFSET, XUARTPS_IXR_MASK);
+		irpt_ctl_.disableInterrupt(irpt_id_);
+	}
+
+	//! \brief Next received character, false if none is pending
+	bool getc(char& c) { return rx_.pop(c); }
+	bool rxPending() const { return !rx_.empty(); }
+	//! \brief Characters lost to a full ring and to RX FIFO overruns
+	uint32_t rxDropped() const { return rx_.dropped(); }
+	uint32_t rxOverruns() const { return overruns_; }
+
+private:
+	void service()
+	{
+		uint32_t const isr = Xil_In32(base_addr_ + XUARTPS_ISR_OFFSET);
+		Xil_Out32(base_addr_ + XUARTPS_ISR_OFFSET, isr);
+		if (isr & XUARTPS_IXR_OVER)
+			++overruns_;
+		while (XUartPs_IsReceiveData(base_addr_))
+			rx_.push((char)Xil_In32(base_addr_ + XUARTPS_FIFO_OFFSET));
+	}
+
+private:
+	uint32_t const base_addr_;
+	IrptCtl& irpt_ctl_;
+	uint32_t const irpt_id_;
+	RingBuffer<char, rx_ring_size> rx_;
+	volatile uint32_t overruns_ = 0;
+};
+
+} /* namespace digilent */
+
+#endif /* PS_UART_H_ */
@@ -0,0 +1,372 @@
+/*
+ * RegSnapshot.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef REGSNAPSHOT_H_
+#define REGSNAPSHOT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "OV5640.h"
+#include "../util/Crc16.h"
+#include "../util/Profile.h"
+#include "../util/Timer.h"
+
+#include "ff.h"
+
+namespace digilent {
+
+/*
+ * OV5640 register snapshots. The registers covered are every register any
+ * of the init, mode, still and AWB tables write, plus the manual exposure,
+ * gain and AWB gain registers, the test pattern and whatever was written by
+ * hand since boot (touch()), grouped into runs of
+ * consecutive addresses. A gap of up to merge_gap registers within a
+ * 256-register block is taken into the run: writing back the value read
+ * costs 9 SCL cycles per register, a new transaction about 29. A capture
+ * reads each run in one auto-increment transaction and keeps the values
+ * PackBits-compressed; a restore writes each run back in one burst instead
+ * of one transaction per register.
+ *
+ * Restore order: software power down, the runs holding clock registers
+ * (PLL, MIPI pclk period) first, then the rest by address, and 0x3008, the
+ * power down / reset register, last with the value captured. Group hold
+ * control (0x3212) is left out.
+ */
+namespace RegSnapshot {
+	uint32_t const magic = 0x534E564F;	// "OVNS"
+	uint16_t const version = 1;
+	uint16_t const reg_first = 0x3000;
+	uint16_t const reg_last = 0x5FFF;
+	size_t const max_ranges = 128;
+	size_t const range_max = 255;		// registers per run, the run count is a byte
+	size_t const image_max = 4096;
+	uint16_t const merge_gap = 3;
+
+	using range_t = struct { uint16_t addr; uint16_t count; };
+	using layout_t = struct { range_t ranges[max_ranges]; size_t count; uint16_t regs; };
+
+	// Registers no table writes, set at run time: AWB, AEC/AGC and test pattern
+	range_t const extra_ranges[] = { {0x3400, 7}, {0x3500, 4}, {0x350a, 2}, {0x503d, 1} };
+
+	inline bool excluded(uint16_t addr) { return addr == 0x3008 || addr == 0x3212; }
+
+	/*!
+	 * \brief Snapshot header; PackBits-coded runs follow, each as address
+	 * high, address low, register count, then the coded values
+	 */
+	struct header_t
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t size;		// bytes after the header
+		uint16_t crc;		// CRC-16 of those bytes
+		uint8_t r3008;		// restored last
+		uint8_t ranges;
+	};
+	static_assert(sizeof(header_t) == 12, "header_t is the image format");
+
+	using stats_t = struct
+	{
+		uint16_t ranges, regs;
+		uint32_t image_size;	// header included
+		uint32_t transfers;		// I2C transactions
+		uint32_t us;
+	};
+
+	inline void mark(uint8_t* bits, uint16_t addr)
+	{
+		if (addr >= reg_first && addr <= reg_last && !excluded(addr))
+			bits[(addr - reg_first) / 8] |= 1 << ((addr - reg_first) % 8);
+	}
+
+	inline void mark(uint8_t* bits, OV5640_cfg::config_word_t const* cfg, size_t cfg_size)
+	{
+		for (size_t i = 0; i < cfg_size; ++i)
+			mark(bits, cfg[i].addr);
+	}
+
+	inline bool marked(uint8_t const* bits, uint32_t addr)
+	{
+		return bits[(addr - reg_first) / 8] & (1 << ((addr - reg_first) % 8));
+	}
+
+	using touched_t = struct { uint8_t bits[(reg_last - reg_first + 1) / 8]; uint32_t rev; };
+
+	//! \brief Registers written by hand, bumping rev on every new one
+	inline touched_t& touched()
+	{
+		static touched_t t = {};
+		return t;
+	}
+
+	/*!
+	 * \brief Records a register written outside the tables ("wr", the
+	 * register protocol), so captures from now on cover it
+	 */
+	inline void touch(uint16_t addr)
+	{
+		touched_t& t = touched();
+		if (addr < reg_first || addr > reg_last || excluded(addr) || marked(t.bits, addr))
+			return;
+		mark(t.bits, addr);
+		++t.rev;
+	}
+
+	//! \brief The runs covered: the tables' worked out once, merged again after every touch()
+	inline layout_t const& layout()
+	{
+		static layout_t l = {};
+		static uint32_t rev = 0;
+		touched_t const& t = touched();
+		if (l.count && rev == t.rev)
+			return l;
+		static uint8_t tables[(reg_last - reg_first + 1) / 8];
+		static bool tables_marked = false;
+		if (!tables_marked)
+		{
+			using namespace OV5640_cfg;
+			mark(tables, cfg_init_, SIZEOF_ARRAY(cfg_init_));
+			for (config_modes_t const& m : modes)
+				mark(tables, m.cfg, m.cfg_size);
+			mark(tables, cfg_5mp_still_, SIZEOF_ARRAY(cfg_5mp_still_));
+			for (config_awb_t const& a : awbs)
+				mark(tables, a.cfg, a.cfg_size);
+			for (range_t const& r : extra_ranges)
+				for (uint16_t i = 0; i < r.count; ++i)
+					mark(tables, (uint16_t)(r.addr + i));
+			tables_marked = true;
+		}
+
+		l = layout_t{};
+		rev = t.rev;
+		for (uint32_t a = reg_first; a <= reg_last && l.count < max_ranges; ++a)
+		{
+			if (!marked(tables, a) && !marked(t.bits, a))
+				continue;
+			range_t& last = l.ranges[l.count ? l.count - 1 : 0];
+			uint32_t const end = last.addr + last.count;
+			bool extend = l.count && a - end <= merge_gap && a + 1 - last.addr <= range_max &&
+					(a >> 8) == (last.addr >> 8u);
+			for (uint32_t g = end; extend && g < a; ++g)
+				extend = !excluded((uint16_t)g);
+			if (extend)
+			{
+				l.regs = (uint16_t)(l.regs + a + 1 - end);
+				last.count = (uint16_t)(a + 1 - last.addr);
+			}
+			else
+			{
+				l.ranges[l.count++] = range_t{(uint16_t)a, 1};
+				++l.regs;
+			}
+		}
+		return l;
+	}
+
+	//! \brief PackBits: n+1 literals after a control byte n < 128, or the next byte 257-n times
+	inline size_t pack(uint8_t const* src, size_t n, uint8_t* dst, size_t max)
+	{
+		size_t o = 0, i = 0;
+		while (i < n)
+		{
+			size_t run = 1;
+			while (i + run < n && run < 128 && src[i + run] == src[i])
+				++run;
+			if (run >= 3)
+			{
+				if (o + 2 > max)
+					return 0;
+				dst[o++] = (uint8_t)(257 - run);
+				dst[o++] = src[i];
+				i += run;
+				continue;
+			}
+			//Literals up to the next run of three
+			size_t lit = 0;
+			while (i + lit < n && lit < 128 &&
+					!(i + lit + 2 < n && src[i + lit] == src[i + lit + 1] && src[i + lit] == src[i + lit + 2]))
+				++lit;
+			if (o + 1 + lit > max)
+				return 0;
+			dst[o++] = (uint8_t)(lit - 1);
+			memcpy(dst + o, src + i, lit);
+			o += lit;
+			i += lit;
+		}
+		return o;
+	}
+
+	//! \brief Decodes exactly n values, returns the coded bytes used or 0
+	inline size_t unpack(uint8_t const* src, size_t max, uint8_t* dst, size_t n)
+	{
+		size_t o = 0, i = 0;
+		while (o < n)
+		{
+			if (i >= max)
+				return 0;
+			uint8_t const c = src[i++];
+			if (c < 128)
+			{
+				size_t const lit = c + 1u;
+				if (i + lit > max || o + lit > n)
+					return 0;
+				memcpy(dst + o, src + i, lit);
+				i += lit;
+				o += lit;
+			}
+			else if (c > 128)
+			{
+				size_t const run = 257u - c;
+				if (i >= max || o + run > n)
+					return 0;
+				memset(dst + o, src[i++], run);
+				o += run;
+			}
+		}
+		return i;
+	}
+
+	inline bool has_clock_reg(uint16_t addr, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			if (OV5640_cfg::is_clock_reg((uint16_t)(addr + i)))
+				return true;
+		return false;
+	}
+
+	/*!
+	 * \brief Reads the covered registers into image. Returns the image size,
+	 * 0 if it does not fit max.
+	 */
+	inline size_t capture(OV5640& cam, uint8_t* image, size_t max, stats_t& st)
+	{
+		PROFILE_ZONE("RegSnapshot::capture");
+		uint64_t const t0 = time_us();
+		layout_t const& l = layout();
+		st = stats_t{};
+		header_t h = {magic, version, 0, 0, 0, (uint8_t)l.count};
+		if (max < sizeof(h))
+			return 0;
+		cam.readReg(0x3008, h.r3008);
+		++st.transfers;
+		size_t o = sizeof(h);
+		for (size_t r = 0; r < l.count; ++r)
+		{
+			range_t const& rg = l.ranges[r];
+			uint8_t vals[range_max];
+			cam.readRegs(rg.addr, vals, rg.count);
+			++st.transfers;
+			if (o + 3 > max)
+				return 0;
+			image[o++] = (uint8_t)(rg.addr >> 8);
+			image[o++] = (uint8_t)rg.addr;
+			image[o++] = (uint8_t)rg.count;
+			size_t const n = pack(vals, rg.count, image + o, max - o);
+			if (!n)
+				return 0;
+			o += n;
+			st.regs = (uint16_t)(st.regs + rg.count);
+		}
+		h.size = (uint16_t)(o - sizeof(h));
+		h.crc = crc16(image + sizeof(h), h.size);
+		memcpy(image, &h, sizeof(h));
+		st.ranges = (uint16_t)l.count;
+		st.image_size = (uint32_t)o;
+		st.us = (uint32_t)(time_us() - t0);
+		return o;
+	}
+
+	//! \brief Intact image of this version
+	inline bool check(uint8_t const* image, size_t size, header_t& h)
+	{
+		if (size < sizeof(h))
+			return false;
+		memcpy(&h, image, sizeof(h));
+		return h.magic == magic && h.version == version && sizeof(h) + h.size <= size &&
+				crc16(image + sizeof(h), h.size) == h.crc;
+	}
+
+	/*!
+	 * \brief Writes an image back in burst transactions, clock runs first and
+	 * 0x3008 last. Nothing is written unless the whole image decodes.
+	 */
+	inline bool restore(OV5640& cam, uint8_t const* image, size_t size, stats_t& st)
+	{
+		PROFILE_ZONE("RegSnapshot::restore");
+		uint64_t const t0 = time_us();
+		st = stats_t{};
+		header_t h;
+		if (!check(image, size, h))
+			return false;
+		uint8_t const* const body = image + sizeof(h);
+		uint8_t vals[range_max];
+		//Dry run: every run must decode before the sensor is touched
+		for (size_t i = 0, r = 0; r < h.ranges; ++r)
+		{
+			if (i + 3 > h.size)
+				return false;
+			size_t const n = unpack(body + i + 3, h.size - i - 3, vals, body[i + 2]);
+			if (!n)
+				return false;
+			i += 3 + n;
+		}
+
+		//[7]=0 Software reset; [6]=1 Software power down; Default=0x02
+		cam.writeReg(0x3008, 0x42);
+		++st.transfers;
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (size_t i = 0, r = 0; r < h.ranges; ++r)
+			{
+				uint16_t const addr = (uint16_t)((body[i] << 8) | body[i + 1]);
+				uint8_t const count = body[i + 2];
+				size_t const n = unpack(body + i + 3, h.size - i - 3, vals, count);
+				i += 3 + n;
+				if (has_clock_reg(addr, count) != (pass == 0))
+					continue;
+				cam.writeRegs(addr, vals, count);
+				st.transfers += (count + OV5640::burst_max - 1) / OV5640::burst_max;
+				st.regs = (uint16_t)(st.regs + count);
+				++st.ranges;
+			}
+		}
+		cam.writeReg(0x3008, h.r3008);
+		++st.transfers;
+		st.image_size = (uint32_t)(sizeof(h) + h.size);
+		st.us = (uint32_t)(time_us() - t0);
+		return true;
+	}
+
+	inline bool save(char const* path, uint8_t const* image, size_t size)
+	{
+		FIL f;
+		UINT n = 0;
+		if (f_open(&f, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+			return false;
+		bool const ok = f_write(&f, image, (UINT)size, &n) == FR_OK && n == size && f_sync(&f) == FR_OK;
+		f_close(&f);
+		return ok;
+	}
+
+	//! \brief Image size read, 0 on error or a damaged image
+	inline size_t load(char const* path, uint8_t* image, size_t max)
+	{
+		FIL f;
+		UINT n = 0;
+		if (f_open(&f, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+			return 0;
+		bool const ok = f_read(&f, image, (UINT)max, &n) == FR_OK;
+		f_close(&f);
+		header_t h;
+		return ok && check(image, n, h) ? sizeof(h) + h.size : 0;
+	}
+}
+
+} /* namespace digilent */
+
+#endif /* REGSNAPSHOT_H_ */
@@ -90,6 +90,11 @@ public:
 		XScuGic_Enable(&drv_inst_, irpt_id);
 		return XST_SUCCESS;
 	}
+	//! \brief Raises software-generated interrupt irpt_id (0-15) on CPU0
+	Errc softwareInterrupt(uint32_t irpt_id)
+	{
+		return XScuGic_SoftwareIntr(&drv_inst_, irpt_id, XSCUGIC_SPI_CPU0_MASK);
+	}
 
 private:
 	XScuGic drv_inst_;
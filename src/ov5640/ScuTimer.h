@@ -0,0 +1,90 @@
+/*
+ * ScuTimer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SCUTIMER_H_
+#define SCUTIMER_H_
+
+#include <stdint.h>
+#include <stdexcept>
+
+#include "IrqDispatch.h"
+
+#include "xscutimer.h"
+#include "xparameters.h"
+
+#define STRINGIZE(x) STRINGIZE2(x)
+#define STRINGIZE2(x) #x
+#define LINE_STRING STRINGIZE(__LINE__)
+
+namespace digilent {
+
+/*!
+ * \brief Cortex-A9 private timer as a periodic tick. The callback runs in
+ * interrupt context at rate_Hz.
+ */
+template <typename IrptCtl>
+class ScuTimer
+{
+public:
+	typedef void (*Callback)(void* ctx);
+
+	ScuTimer(uint16_t dev_id, IrptCtl& irpt_ctl, uint32_t irpt_id, uint32_t rate_Hz,
+			Callback cb, void* ctx) :
+		drv_inst_(), irpt_ctl_(irpt_ctl), irpt_id_(irpt_id), cb_(cb), ctx_(ctx), rate_Hz_(rate_Hz)
+	{
+		XScuTimer_Config* config = XScuTimer_LookupConfig(dev_id);
+		if (config == NULL) {
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+		if (XScuTimer_CfgInitialize(&drv_inst_, config, config->BaseAddr) != XST_SUCCESS) {
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+		if (!rate_Hz) {
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+
+		//Private timer runs at half the CPU clock
+		XScuTimer_LoadTimer(&drv_inst_, XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2 / rate_Hz - 1);
+		XScuTimer_EnableAutoReload(&drv_inst_);
+
+		irpt_ctl_.registerHandler(irpt_id_, &Irq::Member<&ScuTimer::service>::thunk, this);
+		irpt_ctl_.enableInterrupt(irpt_id_);
+		irpt_ctl_.enableInterrupts();
+
+		XScuTimer_EnableInterrupt(&drv_inst_);
+		XScuTimer_Start(&drv_inst_);
+	}
+
+	~ScuTimer()
+	{
+		XScuTimer_Stop(&drv_inst_);
+		irpt_ctl_.disableInterrupt(irpt_id_);
+	}
+
+	uint32_t rate() const { return rate_Hz_; }
+	uint32_t ticks() const { return ticks_; }
+
+private:
+	void service()
+	{
+		XScuTimer_ClearInterruptStatus(&drv_inst_);
+		++ticks_;
+		cb_(ctx_);
+	}
+
+private:
+	XScuTimer drv_inst_;
+	IrptCtl& irpt_ctl_;
+	uint32_t const irpt_id_;
+	Callback const cb_;
+	void* const ctx_;
+	uint32_t const rate_Hz_;
+	volatile uint32_t ticks_ = 0;
+};
+
+} /* namespace digilent */
+
+#endif /* SCUTIMER_H_ */
@@ -0,0 +1,262 @@
+/*
+ * AutoExposure.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef AUTOEXPOSURE_H_
+#define AUTOEXPOSURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameStats.h"
+#include "../ov5640/OV5640.h"
+#include "../util/Profile.h"
+
+namespace digilent {
+
+namespace Exposure {
+	//! \brief Exposure in 1/16 lines and real gain in 1/16, 16 = 1x
+	using setting_t = struct { uint32_t lines_x16; uint16_t gain_x16; };
+
+	using Source = enum { SRC_FRAME = 0, SRC_SENSOR };
+	char const* const source_names[] = { "frame", "sensor" };
+
+	using config_t = struct
+	{
+		Source source;			// frame store statistics or the sensor average (0x56A1)
+		uint8_t target;			// mean luma aimed at
+		uint8_t deadband;		// no correction within target +/- deadband
+		uint8_t loop_pct;		// share of the measured error corrected per step near the target
+		uint8_t settle_frames;	// frames skipped after a write, the one under way when the group launches
+		uint8_t grid;			// frame statistics sample every grid-th pixel and line
+		uint16_t gain_max_x16;
+	};
+	config_t const defaults = {SRC_FRAME, 0x70, 6, 75, 1, 16, 0xF8};
+
+	using stats_t = struct
+	{
+		uint32_t frames;		// new S2MM frames seen since start
+		uint32_t updates;		// exposure writes
+		uint32_t converged;		// frame at which luma last entered the deadband, 0 outside it
+		uint32_t reversals;		// corrections against the direction of the previous one
+		uint8_t luma;			// last measurement
+		uint32_t measure_us;	// last sensor read or frame statistics pass
+	};
+
+	//! \brief The sensor needs the exposure this many lines below VTS
+	uint16_t const vts_margin = 4;
+
+	inline uint32_t max_lines_x16(OV5640_cfg::mode_info_t const& m)
+	{
+		return (uint32_t)(m.vts - vts_margin) * 16;
+	}
+
+	/*!
+	 * \brief Exposure time to 1/16 lines. The line time is HTS/SCLK, and the
+	 * mode's SCLK is HTS * VTS * fps, so a line lasts 1/(VTS * fps) s.
+	 * Clamped to one line and to the frame length.
+	 */
+	inline uint32_t us_to_lines_x16(uint32_t us, OV5640_cfg::mode_info_t const& m)
+	{
+		uint64_t lines = (uint64_t)us * 16 * m.vts * m.fps / 1000000;
+		if (lines < 16)
+			lines = 16;
+		if (lines > max_lines_x16(m))
+			lines = max_lines_x16(m);
+		return (uint32_t)lines;
+	}
+
+	inline uint32_t lines_x16_to_us(uint32_t lines_x16, OV5640_cfg::mode_info_t const& m)
+	{
+		return (uint32_t)((uint64_t)lines_x16 * 1000000 / (16u * m.vts * m.fps));
+	}
+
+	/*!
+	 * \brief Splits a total exposure, lines_x16 * gain_x16, into exposure time
+	 * first, which adds no noise, and gain only for what the frame length
+	 * cannot hold.
+	 */
+	inline setting_t split(uint64_t total, uint32_t max_lines_x16, uint16_t gain_max_x16)
+	{
+		uint64_t lines = total / 16;
+		if (lines < 16)
+			lines = 16;
+		if (lines <= max_lines_x16)
+			return setting_t{(uint32_t)lines, 16};
+		lines = max_lines_x16;
+		uint64_t gain = (total + lines / 2) / lines;
+		if (gain < 16)
+			gain = 16;
+		if (gain > gain_max_x16)
+			gain = gain_max_x16;
+		return setting_t{(uint32_t)lines, (uint16_t)gain};
+	}
+}
+
+/*!
+ * \brief Manual exposure and a software AE loop over the OV5640's AEC/AGC
+ * registers. Times are converted to lines for the active mode, and exposure
+ * and gain always go in together under group hold.
+ *
+ * The loop runs from the main loop, one step per frame its FrameGate lets
+ * through. It measures the mean luma of the last completed frame store, or
+ * reads the sensor's own average, and scales the exposure by the ratio to
+ * the target: in full while the error is large, so a dark or saturated
+ * start takes a step or two, and by a share of it near the target. The
+ * settle frames after each write keep it from reacting to the sensor's
+ * exposure latency; that, the partial correction and the deadband keep it
+ * from oscillating at 60 fps.
+ */
+template <typename VDMA>
+class AutoExposure
+{
+public:
+	AutoExposure(OV5640& cam, FrameSampler<VDMA>& sampler, OV5640_cfg::mode_t mode) :
+		cam_(cam), sampler_(sampler), mode_(OV5640_cfg::mode_info[0]), cfg_(Exposure::defaults), set_{16, 16},
+		stats_{}, running_(false), manual_(false), last_dir_(0)
+	{
+		setMode(mode);
+	}
+
+	//! \brief Limits for the mode the sensor streams; call after each mode change
+	void setMode(OV5640_cfg::mode_t mode)
+	{
+		OV5640_cfg::mode_info_t const prev = mode_;
+		mode_ = mode < OV5640_cfg::MODE_END ? OV5640_cfg::mode_info[mode] : OV5640_cfg::mode_info[0];
+		if (!manual_)
+			return;
+		//Keep the same exposure time if the new frame length allows it
+		set_.lines_x16 = Exposure::us_to_lines_x16(Exposure::lines_x16_to_us(set_.lines_x16, prev), mode_);
+		cam_.set_exposure(set_.lines_x16, set_.gain_x16);
+	}
+
+	/*!
+	 * \brief Fixed exposure time and gain, stops the loop. Returns what was
+	 * applied after clamping.
+	 */
+	Exposure::setting_t setManual(uint32_t exposure_us, uint16_t gain_x16)
+	{
+		running_ = false;
+		set_.lines_x16 = Exposure::us_to_lines_x16(exposure_us, mode_);
+		set_.gain_x16 = gain_x16 < 16 ? 16 : gain_x16 > cfg_.gain_max_x16 ? cfg_.gain_max_x16 : gain_x16;
+		apply();
+		return set_;
+	}
+
+	/*!
+	 * \brief Starts the software loop from the current exposure: the manual
+	 * one if set, else the sensor's, which takes over from its own AEC
+	 * without a jump once its frames are through.
+	 */
+	void start(Exposure::config_t const& cfg = Exposure::defaults)
+	{
+		cfg_ = cfg;
+		uint8_t settle = 0;
+		if (!manual_)
+		{
+			cam_.get_exposure(set_.lines_x16, set_.gain_x16);
+			set_ = Exposure::split((uint64_t)set_.lines_x16 * (set_.gain_x16 < 16 ? 16 : set_.gain_x16),
+					Exposure::max_lines_x16(mode_), cfg_.gain_max_x16);
+			apply();
+			settle = cfg_.settle_frames;
+		}
+		stats_ = Exposure::stats_t{};
+		gate_.restart(sampler_.sequence(), settle);
+		last_dir_ = 0;
+		running_ = true;
+	}
+
+	//! \brief Stops the loop and hands exposure back to the sensor's AEC/AGC
+	void stop()
+	{
+		running_ = false;
+		manual_ = false;
+		cam_.set_auto_exposure();
+	}
+
+	//! \brief Main loop hook, returns true when the exposure was changed
+	bool poll()
+	{
+		if (!running_ || !gate_.pass(sampler_.sequence(), stats_.frames))
+			return false;
+
+		PROFILE_ZONE("AutoExposure::poll");
+		uint8_t luma;
+		if (cfg_.source == Exposure::SRC_SENSOR)
+		{
+			uint64_t const t0 = time_us();
+			luma = cam_.average_luma();
+			stats_.measure_us = (uint32_t)(time_us() - t0);
+		}
+		else
+		{
+			luma = FrameStats::mean_luma(sampler_.sums(cfg_.grid));
+			stats_.measure_us = sampler_.measureUs();
+		}
+		stats_.luma = luma;
+
+		int const err = (int)luma - cfg_.target;
+		if (err <= cfg_.deadband && err >= -cfg_.deadband)
+		{
+			if (!stats_.converged)
+				stats_.converged = stats_.frames;
+			return false;
+		}
+		stats_.converged = 0;
+
+		//Ratio to target in 1/256. The true mean is at least luma and under luma + 1,
+		//and any amount over for a clipped frame: the ratio to the end of that range
+		//nearer the target never steps past it.
+		int32_t ratio = (int32_t)cfg_.target * 256 / (err < 0 ? luma + 1 : luma);
+		//Within twice the deadband only loop_pct of it, against noise and the sensor's rounding
+		if (err <= 2 * cfg_.deadband && err >= -2 * cfg_.deadband)
+			ratio = 256 + (ratio - 256) * cfg_.loop_pct / 100;
+		Exposure::setting_t const next = Exposure::split(
+				(uint64_t)set_.lines_x16 * set_.gain_x16 * (uint32_t)ratio / 256,
+				Exposure::max_lines_x16(mode_), cfg_.gain_max_x16);
+		if (next.lines_x16 == set_.lines_x16 && next.gain_x16 == set_.gain_x16)
+			return false;	//Against a limit
+
+		int const dir = err < 0 ? 1 : -1;
+		if (last_dir_ && dir != last_dir_)
+			++stats_.reversals;
+		last_dir_ = dir;
+		set_ = next;
+		apply();
+		++stats_.updates;
+		gate_.settle(cfg_.settle_frames);
+		return true;
+	}
+
+	bool running() const { return running_; }
+	bool manual() const { return manual_; }
+	Exposure::setting_t const& setting() const { return set_; }
+	uint32_t exposureUs() const { return Exposure::lines_x16_to_us(set_.lines_x16, mode_); }
+	Exposure::stats_t const& stats() const { return stats_; }
+	Exposure::config_t const& config() const { return cfg_; }
+
+private:
+	void apply()
+	{
+		cam_.set_exposure(set_.lines_x16, set_.gain_x16);
+		manual_ = true;
+	}
+
+private:
+	OV5640& cam_;
+	FrameSampler<VDMA>& sampler_;
+	FrameGate gate_;
+	OV5640_cfg::mode_info_t mode_;
+	Exposure::config_t cfg_;
+	Exposure::setting_t set_;
+	Exposure::stats_t stats_;
+	bool running_;
+	bool manual_;
+	int last_dir_;
+};
+
+} /* namespace digilent */
+
+#endif /* AUTOEXPOSURE_H_ */
@@ -0,0 +1,134 @@
+/*
+ * Bandwidth.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef BANDWIDTH_H_
+#define BANDWIDTH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../ov5640/OV5640.h"
+#include "../hdmi/VideoOutput.h"
+#include "PipelineController.h"
+
+namespace digilent {
+
+namespace Bandwidth {
+	/*!
+	 * \brief Memory bandwidth available to the video pipeline. The VDMA S2MM
+	 * and MM2S channels share one PS HP port; CPU frame processing goes
+	 * through the same DDR controller.
+	 */
+	struct budget_t
+	{
+		uint32_t ddr_MBps = 4264;		// DDR3-1066 x32 peak
+		uint8_t ddr_efficiency_pct = 70;	// refresh, page misses, read/write turnaround
+		uint32_t port_MBps = 800;		// HP port, 64 bit at 100 MHz
+		uint8_t max_util_pct = 80;		// admission limit, headroom for bursts
+		uint16_t cpu_pass_pct = 0;		// CPU traffic per captured frame, % of one frame store
+	};
+
+	/*!
+	 * \brief Steady-state traffic of one sensor mode / output combination.
+	 * Utilisation is in permille of the usable bandwidth before max_util_pct.
+	 */
+	struct usage_t
+	{
+		uint64_t s2mm_Bps, mm2s_Bps, cpu_Bps;
+		uint64_t port_Bps, ddr_Bps;		// usable bandwidth
+		uint16_t port_permille, ddr_permille;
+		bool fits;
+	};
+
+	/*!
+	 * \brief Traffic model. S2MM writes the part of each sensor frame that
+	 * fits the frame store (output geometry) at the sensor frame rate, MM2S
+	 * reads the whole frame store at the display refresh rate. Pure function.
+	 */
+	inline usage_t estimate(OV5640_cfg::mode_t mode, Resolution res, uint8_t bpp,
+			budget_t const& budget = budget_t())
+	{
+		usage_t u = {};
+		timing_t const* t = find_timing(res);
+		if (!t || mode >= OV5640_cfg::MODE_END)
+			return u;
+
+		OV5640_cfg::mode_info_t const& m = OV5640_cfg::mode_info[mode];
+		uint64_t const w = m.width < t->h_active ? m.width : t->h_active;
+		uint64_t const h = m.height < t->v_active ? m.height : t->v_active;
+		u.s2mm_Bps = w * h * bpp * m.fps;
+		u.mm2s_Bps = (uint64_t)t->h_active * t->v_active * bpp * refresh_mHz(*t) / 1000;
+		u.cpu_Bps = u.s2mm_Bps * budget.cpu_pass_pct / 100;
+
+		u.port_Bps = (uint64_t)budget.port_MBps * 1000000;
+		u.ddr_Bps = (uint64_t)budget.ddr_MBps * 1000000 * budget.ddr_efficiency_pct / 100;
+		if (u.port_Bps)
+			u.port_permille = (u.s2mm_Bps + u.mm2s_Bps) * 1000 / u.port_Bps;
+		if (u.ddr_Bps)
+			u.ddr_permille = (u.s2mm_Bps + u.mm2s_Bps + u.cpu_Bps) * 1000 / u.ddr_Bps;
+		u.fits = u.port_Bps && u.ddr_Bps &&
+				u.port_permille <= budget.max_util_pct * 10U &&
+				u.ddr_permille <= budget.max_util_pct * 10U;
+		return u;
+	}
+
+	using Errc = enum { OK = 0, DOWNGRADED, REJECTED };
+
+	/*!
+	 * \brief Admission control for a pipeline target. If it exceeds the budget,
+	 * tries the same geometry at lower display refresh rates first, then at
+	 * lower sensor frame rates, and rewrites tgt with the first combination
+	 * that fits. Pure function.
+	 */
+	inline Errc admit(Pipeline::target_t& tgt, uint8_t bpp, budget_t const& budget = budget_t())
+	{
+		timing_t const* t = find_timing(tgt.res);
+		if (!t || tgt.mode >= OV5640_cfg::MODE_END)
+			return REJECTED;
+		if (estimate(tgt.mode, tgt.res, bpp, budget).fits)
+			return OK;
+
+		OV5640_cfg::mode_info_t const& m = OV5640_cfg::mode_info[tgt.mode];
+		//Sensor candidates: requested mode, then same size at decreasing frame rate
+		for (uint8_t fps = m.fps; fps > 0; --fps)
+		{
+			for (int mode = 0; mode < OV5640_cfg::MODE_END; ++mode)
+			{
+				OV5640_cfg::mode_info_t const& c = OV5640_cfg::mode_info[mode];
+				if (c.fps != fps || c.width != m.width || c.height != m.height || c.lanes != m.lanes)
+					continue;
+				if (fps == m.fps && mode != tgt.mode)
+					continue;
+
+				//Output candidates: same geometry, highest refresh that fits
+				timing_t const* best = NULL;
+				for (size_t i = 0; i < sizeof(timing)/sizeof(timing[0]); ++i)
+				{
+					timing_t const& o = timing[i];
+					if (o.h_active != t->h_active || o.v_active != t->v_active)
+						continue;
+					if (refresh_mHz(o) > refresh_mHz(*t))
+						continue;
+					if (!estimate(static_cast<OV5640_cfg::mode_t>(mode), o.res, bpp, budget).fits)
+						continue;
+					if (!best || refresh_mHz(o) > refresh_mHz(*best))
+						best = &o;
+				}
+				if (best)
+				{
+					tgt.mode = static_cast<OV5640_cfg::mode_t>(mode);
+					tgt.res = best->res;
+					return DOWNGRADED;
+				}
+			}
+		}
+		return REJECTED;
+	}
+}
+
+} /* namespace digilent */
+
+#endif /* BANDWIDTH_H_ */
@@ -0,0 +1,109 @@
+/*
+ * BringUpScheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef BRINGUPSCHEDULER_H_
+#define BRINGUPSCHEDULER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../util/Timer.h"
+
+namespace digilent {
+
+/*!
+ * \brief Runs a small dependency graph of bring-up steps cooperatively on one
+ * core. Steps are polled through Steps::step(id, first): the first call starts
+ * the step, later calls return true once it has finished. A step waiting on
+ * hardware (I2C batch, MMCM lock, power-up delay) therefore does not hold up
+ * independent steps. Deps are bitmasks of step ids; deps on steps that were
+ * not added count as satisfied.
+ */
+template <typename Steps, size_t N>
+class BringUpScheduler
+{
+	static_assert(N <= 32, "dependency masks are 32 bits");
+public:
+	using Errc = enum { OK = 0, ERR_TIMEOUT, ERR_DEADLOCK };
+
+	BringUpScheduler(Steps& steps) :
+		steps_(steps)
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		added_ = started_ = done_ = 0;
+		for (size_t i = 0; i < N; ++i)
+		{
+			deps_[i] = 0;
+			start_us_[i] = done_us_[i] = 0;
+		}
+	}
+
+	void add(size_t id, uint32_t deps)
+	{
+		added_ |= 1U << id;
+		deps_[id] = deps;
+	}
+
+	/*!
+	 * \brief Polls all ready steps round-robin until every added step is done.
+	 */
+	Errc run(uint32_t timeout_us)
+	{
+		started_ = done_ = 0;
+		t0_ = time_us();
+		while (done_ != added_)
+		{
+			bool progress = false;
+			for (size_t id = 0; id < N; ++id)
+			{
+				uint32_t const bit = 1U << id;
+				if (!(added_ & bit) || (done_ & bit))
+					continue;
+				if ((deps_[id] & added_ & ~done_) != 0)
+					continue;
+
+				bool const first = !(started_ & bit);
+				if (first)
+				{
+					started_ |= bit;
+					start_us_[id] = time_us() - t0_;
+				}
+				progress = true;
+				if (steps_.step(id, first))
+				{
+					done_ |= bit;
+					done_us_[id] = time_us() - t0_;
+				}
+			}
+			if (!progress)
+				return ERR_DEADLOCK;
+			if (time_us() - t0_ > timeout_us)
+				return ERR_TIMEOUT;
+		}
+		return OK;
+	}
+
+	bool added(size_t id) const { return added_ & (1U << id); }
+	//! \brief Step start and completion time relative to run()
+	uint32_t startedAt(size_t id) const { return start_us_[id]; }
+	uint32_t finishedAt(size_t id) const { return done_us_[id]; }
+	uint64_t runStart() const { return t0_; }
+
+private:
+	Steps& steps_;
+	uint32_t added_, started_, done_;
+	uint32_t deps_[N];
+	uint32_t start_us_[N], done_us_[N];
+	uint64_t t0_ = 0;
+};
+
+} /* namespace digilent */
+
+#endif /* BRINGUPSCHEDULER_H_ */
@@ -0,0 +1,240 @@
+/*
+ * CameraState.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CAMERASTATE_H_
+#define CAMERASTATE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "../hdmi/VideoOutput.h"
+#include "../ov5640/OV5640.h"
+#include "../util/Crc16.h"
+#include "../util/Timer.h"
+
+#include "ff.h"
+
+namespace digilent {
+
+namespace CameraState {
+	uint32_t const magic = 0x4D414350;	// "PCAM"
+	uint16_t const version = 1;
+	size_t const slot_count = 2;
+	char const* const slot_paths[slot_count] = { "0:/pcam_a.cfg", "0:/pcam_b.cfg" };
+
+	using WbMode = enum { WB_SENSOR = 0, WB_MANUAL, WB_GRAY_WORLD, WB_WHITE_PATCH, WB_END };
+	using AeMode = enum { AE_SENSOR = 0, AE_MANUAL, AE_FRAME, AE_SENSOR_LUMA, AE_END };
+	using Flags = enum { F_LENS = 1 };
+
+	/*!
+	 * \brief What a warm boot restores. Fields are only ever appended, with a
+	 * version bump; a record from an older version reads with the newer ones
+	 * zero. No implicit padding, so the record bytes are all defined.
+	 */
+	struct state_t
+	{
+		uint32_t exposure_us;
+		uint16_t wb_r, wb_g, wb_b;			// AWB gains, 0x400 = 1x
+		uint16_t gain_x16;
+		uint16_t zoom_x100, zoom_cx, zoom_cy;	// zoom 0 for the mode's own window
+		uint8_t res;						// Resolution
+		uint8_t mode;						// OV5640_cfg::mode_t
+		uint8_t wb;							// WbMode
+		uint8_t ae;							// AeMode
+		uint8_t ae_target;
+		uint8_t lens;						// valid with F_LENS
+		uint8_t flags;
+		uint8_t reserved[3];
+	};
+	static_assert(sizeof(state_t) == 28, "state_t is the record format");
+
+	state_t const defaults = {0, 0x400, 0x400, 0x400, 16, 0, 0, 0,
+			(uint8_t)Resolution::R640_480_60_NN, OV5640_cfg::MODE_480P_640_480_15FPS,
+			WB_SENSOR, AE_SENSOR, 0, 0, 0, {0, 0, 0}};
+
+	//! \brief Record header; the state follows, then a CRC-16 over both
+	struct header_t
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t size;		// state bytes that follow
+		uint32_t seq;		// incremented per save, the newer slot wins
+	};
+	static_assert(sizeof(header_t) == 12, "header_t is the record format");
+
+	size_t const record_size = sizeof(header_t) + sizeof(state_t) + 2;
+
+	inline bool valid(state_t const& s)
+	{
+		return s.res <= (uint8_t)Resolution::R1280_1024_60_PP && s.mode < OV5640_cfg::MODE_END &&
+				s.wb < WB_END && s.ae < AE_END;
+	}
+
+	//! \brief Wrap-safe sequence number comparison
+	inline bool newer(uint32_t a, uint32_t b) { return (int32_t)(a - b) > 0; }
+
+	inline size_t encode(state_t const& s, uint32_t seq, uint8_t* buf)
+	{
+		header_t const h = {magic, version, (uint16_t)sizeof(state_t), seq};
+		memcpy(buf, &h, sizeof(h));
+		memcpy(buf + sizeof(h), &s, sizeof(s));
+		uint16_t const crc = crc16(buf, sizeof(h) + sizeof(s));
+		buf[sizeof(h) + sizeof(s)] = crc & 0xFF;
+		buf[sizeof(h) + sizeof(s) + 1] = crc >> 8;
+		return record_size;
+	}
+
+	//! \brief False for anything but an intact record this version can read
+	inline bool decode(uint8_t const* buf, size_t len, state_t& s, uint32_t& seq)
+	{
+		header_t h;
+		if (len < sizeof(h))
+			return false;
+		memcpy(&h, buf, sizeof(h));
+		if (h.magic != magic || h.version == 0 || h.version > version || h.size > sizeof(state_t) ||
+				len < sizeof(h) + h.size + 2)
+			return false;
+		uint16_t const crc = crc16(buf, sizeof(h) + h.size);
+		if ((buf[sizeof(h) + h.size] | (buf[sizeof(h) + h.size + 1] << 8)) != crc)
+			return false;
+		state_t r = {};
+		memcpy(&r, buf + sizeof(h), h.size);
+		if (!valid(r))
+			return false;
+		s = r;
+		seq = h.seq;
+		return true;
+	}
+}
+
+/*!
+ * \brief Camera state on the SD card, in two fixed-size files written in
+ * turn. A save goes to the slot not holding the newest record and is synced
+ * before it counts, so a power cut mid-write leaves that record with a bad
+ * CRC and the other slot's, one save older, is loaded instead. Saves that
+ * would not change anything are skipped, to spare the card.
+ */
+class CameraStateStore
+{
+public:
+	using Errc = enum { OK = 0, ERR_MOUNT, ERR_NO_RECORD, ERR_IO };
+
+	CameraStateStore() : mounted_(false), loaded_(false), slot_(0), seq_(0), last_{}, load_us_(0), save_us_(0)
+	{
+	}
+
+	Errc mount()
+	{
+		mounted_ = f_mount(&fs_, "0:/", 1) == FR_OK;
+		return mounted_ ? OK : ERR_MOUNT;
+	}
+
+	//! \brief Newest intact record of the two slots
+	Errc load(CameraState::state_t& s)
+	{
+		if (!mounted_)
+			return ERR_MOUNT;
+		uint64_t const t0 = time_us();
+		loaded_ = false;
+		for (size_t i = 0; i < CameraState::slot_count; ++i)
+		{
+			uint8_t buf[CameraState::record_size];
+			size_t len;
+			CameraState::state_t st;
+			uint32_t seq;
+			if (readSlot(i, buf, len) && CameraState::decode(buf, len, st, seq) &&
+					(!loaded_ || CameraState::newer(seq, seq_)))
+			{
+				loaded_ = true;
+				slot_ = i;
+				seq_ = seq;
+				last_ = st;
+			}
+		}
+		load_us_ = (uint32_t)(time_us() - t0);
+		if (!loaded_)
+			return ERR_NO_RECORD;
+		s = last_;
+		return OK;
+	}
+
+	Errc save(CameraState::state_t const& s)
+	{
+		if (!mounted_)
+			return ERR_MOUNT;
+		if (loaded_ && !memcmp(&s, &last_, sizeof(s)))
+			return OK;
+		uint64_t const t0 = time_us();
+		size_t const slot = loaded_ ? (slot_ + 1) % CameraState::slot_count : 0;
+		uint8_t buf[CameraState::record_size];
+		CameraState::encode(s, seq_ + 1, buf);
+		FIL f;
+		UINT n = 0;
+		if (f_open(&f, CameraState::slot_paths[slot], FA_OPEN_ALWAYS | FA_WRITE) != FR_OK)
+			return ERR_IO;
+		bool const ok = f_lseek(&f, 0) == FR_OK && f_write(&f, buf, sizeof(buf), &n) == FR_OK &&
+				n == sizeof(buf) && f_sync(&f) == FR_OK;
+		f_close(&f);
+		if (!ok)
+			return ERR_IO;
+		loaded_ = true;
+		slot_ = slot;
+		++seq_;
+		last_ = s;
+		save_us_ = (uint32_t)(time_us() - t0);
+		return OK;
+	}
+
+	//! \brief Deletes both slots; the next boot is a cold one
+	Errc erase()
+	{
+		if (!mounted_)
+			return ERR_MOUNT;
+		for (size_t i = 0; i < CameraState::slot_count; ++i)
+			f_unlink(CameraState::slot_paths[i]);
+		loaded_ = false;
+		seq_ = 0;
+		return OK;
+	}
+
+	bool mounted() const { return mounted_; }
+	//! \brief A record is on the card, last() is it
+	bool stored() const { return loaded_; }
+	CameraState::state_t const& last() const { return last_; }
+	size_t slot() const { return slot_; }
+	uint32_t seq() const { return seq_; }
+	uint32_t loadUs() const { return load_us_; }
+	uint32_t saveUs() const { return save_us_; }
+
+private:
+	//! An older version's record is shorter; decode() checks the length against its header
+	bool readSlot(size_t i, uint8_t* buf, size_t& len)
+	{
+		FIL f;
+		UINT n = 0;
+		if (f_open(&f, CameraState::slot_paths[i], FA_READ | FA_OPEN_EXISTING) != FR_OK)
+			return false;
+		bool const ok = f_read(&f, buf, CameraState::record_size, &n) == FR_OK && n >= sizeof(CameraState::header_t);
+		f_close(&f);
+		len = n;
+		return ok;
+	}
+
+private:
+	FATFS fs_;
+	bool mounted_;
+	bool loaded_;
+	size_t slot_;
+	uint32_t seq_;
+	CameraState::state_t last_;
+	uint32_t load_us_;
+	uint32_t save_us_;
+};
+
+} /* namespace digilent */
+
+#endif /* CAMERASTATE_H_ */
@@ -0,0 +1,234 @@
+/*
+ * ColorBarTest.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef COLORBARTEST_H_
+#define COLORBARTEST_H_
+
+#include <stdint.h>
+
+#include "FrameView.h"
+#include "../ov5640/OV5640.h"
+#include "../util/Timer.h"
+
+#include "xil_cache.h"
+
+namespace digilent {
+
+namespace ColorBar {
+	// OV5640 eight colour bar (0x503D=0x80), left to right, as {R,G,B} on/off
+	uint8_t const bars[8][3] =
+	{
+		{1, 1, 1},	// white
+		{1, 1, 0},	// yellow
+		{0, 1, 1},	// cyan
+		{0, 1, 0},	// green
+		{1, 0, 1},	// magenta
+		{1, 0, 0},	// red
+		{0, 0, 1},	// blue
+		{0, 0, 0}	// black
+	};
+	size_t const bar_count = sizeof(bars)/sizeof(bars[0]);
+	char const* const names[bar_count] =
+		{"white", "yellow", "cyan", "green", "magenta", "red", "blue", "black"};
+
+	struct tolerance_t
+	{
+		uint8_t hi = 150;		// channel mean at or above counts as on
+		uint8_t lo = 100;		// channel mean at or below counts as off
+		uint8_t edge_div = 64;	// allowed bar edge error is width/edge_div pixels
+	};
+
+	/*!
+	 * \brief Outcome of a colour bar check. On failure, x/y/w/h is the frame
+	 * region that did not match and rgb the mean measured there.
+	 */
+	struct result_t
+	{
+		using Errc = enum { PASS = 0, ERR_TIMEOUT, ERR_GEOMETRY, ERR_COLOUR, ERR_EDGE };
+		Errc errc;
+		uint8_t bar;
+		uint16_t x, y, w, h;
+		uint8_t r, g, b;
+		uint32_t frames;		// frames waited for the pattern to settle
+		uint32_t elapsed_us;	// total self-test time including restore
+		bool pass() const { return errc == PASS; }
+	};
+
+	inline char const* errc_str(result_t::Errc errc)
+	{
+		switch (errc)
+		{
+			case result_t::PASS: return "PASS";
+			case result_t::ERR_TIMEOUT: return "no frames";
+			case result_t::ERR_GEOMETRY: return "bad geometry";
+			case result_t::ERR_COLOUR: return "wrong colour";
+			case result_t::ERR_EDGE: return "misplaced edge";
+			default: return "?";
+		}
+	}
+
+	/*!
+	 * \brief Bit-coded on/off classification of a mean colour: bit 2 = R,
+	 * bit 1 = G, bit 0 = B, or -1 if a channel lies between the thresholds.
+	 */
+	inline int classify(uint8_t r, uint8_t g, uint8_t b, tolerance_t const& tol)
+	{
+		int code = 0;
+		uint8_t const c[3] = {r, g, b};
+		for (int i = 0; i < 3; ++i)
+		{
+			code <<= 1;
+			if (c[i] >= tol.hi) code |= 1;
+			else if (c[i] > tol.lo) return -1;
+		}
+		return code;
+	}
+
+	inline int code_of(size_t bar)
+	{
+		return (bars[bar][0] << 2) | (bars[bar][1] << 1) | bars[bar][2];
+	}
+
+	/*!
+	 * \brief Mean colour of a rectangle, sampling every step-th pixel and line.
+	 */
+	inline void mean(frame_view_t const& f, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+			uint16_t step, uint8_t& r, uint8_t& g, uint8_t& b)
+	{
+		uint32_t sr = 0, sg = 0, sb = 0, n = 0;
+		for (uint16_t yy = y; yy < y + h; yy += step)
+		{
+			for (uint16_t xx = x; xx < x + w; xx += step)
+			{
+				sr += f.r(xx, yy); sg += f.g(xx, yy); sb += f.b(xx, yy);
+				++n;
+			}
+		}
+		if (!n) n = 1;
+		r = sr / n; g = sg / n; b = sb / n;
+	}
+
+	/*!
+	 * \brief Checks a captured frame against the eight colour bar pattern.
+	 * Bar interiors are compared by colour and every bar edge must be found
+	 * within the tolerance of its nominal position. Pure function, no hardware
+	 * access.
+	 */
+	inline result_t check(frame_view_t const& f, tolerance_t const& tol = tolerance_t())
+	{
+		result_t res = {};
+		uint16_t const bar_w = f.width / bar_count;
+		if (!f.data || bar_w < 8 || f.height < 8 || f.bpp < 3)
+		{
+			res.errc = result_t::ERR_GEOMETRY;
+			res.w = f.width; res.h = f.height;
+			return res;
+		}
+
+		// Colours: middle half of each bar, middle half of the frame
+		uint16_t const y0 = f.height / 4, h0 = f.height / 2;
+		for (size_t i = 0; i < bar_count; ++i)
+		{
+			uint16_t const x0 = i * bar_w + bar_w / 4;
+			uint8_t r, g, b;
+			mean(f, x0, y0, bar_w / 2, h0, 4, r, g, b);
+			if (classify(r, g, b, tol) != code_of(i))
+			{
+				res = {result_t::ERR_COLOUR, (uint8_t)i, x0, y0, (uint16_t)(bar_w / 2), h0, r, g, b, 0, 0};
+				return res;
+			}
+		}
+
+		// Edges: walk an 8-line strip around each nominal edge and take the first
+		// column classified as the right-hand bar
+		uint16_t const edge_tol = f.width / tol.edge_div + 1;
+		uint16_t const ys = f.height / 2 - 4;
+		for (size_t i = 1; i < bar_count; ++i)
+		{
+			uint16_t const nominal = i * bar_w;
+			uint16_t const xs = nominal - bar_w / 2;
+			uint16_t found = 0xFFFF;
+			uint8_t r = 0, g = 0, b = 0;
+			for (uint16_t x = xs; x < nominal + bar_w / 2; ++x)
+			{
+				mean(f, x, ys, 1, 8, 1, r, g, b);
+				if (classify(r, g, b, tol) == code_of(i))
+				{
+					found = x;
+					break;
+				}
+			}
+			if (found == 0xFFFF || (found > nominal ? found - nominal : nominal - found) > edge_tol)
+			{
+				res = {result_t::ERR_EDGE, (uint8_t)i, xs, ys, bar_w, 8, r, g, b, 0, 0};
+				return res;
+			}
+		}
+
+		res.errc = result_t::PASS;
+		return res;
+	}
+}
+
+/*!
+ * \brief View of the frame store the S2MM channel completed last.
+ */
+template <typename VDMA>
+frame_view_t lastWriteFrame(VDMA& vdma)
+{
+	int const n = vdma.numFrameStores();
+	int const last = (vdma.currentWriteFrame() + n - 1) % n;
+	frame_view_t f;
+	f.data = reinterpret_cast<uint8_t const*>(vdma.writeFrameAddr(last));
+	f.bpp = vdma.writeBytesPerPixel();
+	f.stride = vdma.writeStride();
+	f.width = f.bpp ? f.stride / f.bpp : 0;
+	f.height = vdma.writeLines();
+	return f;
+}
+
+/*!
+ * \brief Boot and mode-change self-test. Switches the sensor to its colour
+ * bar pattern, lets it propagate through CSI, BayerToRGB, gamma and the VDMA
+ * S2MM channel, checks the last completed frame store and restores the
+ * previous test pattern register.
+ */
+template <typename VDMA>
+ColorBar::result_t runColorBarSelfTest(OV5640& cam, VDMA& vdma,
+		ColorBar::tolerance_t const& tol = ColorBar::tolerance_t(),
+		uint32_t timeout_us = 500000)
+{
+	//Pattern starts on the next sensor frame, which is fully stored once the
+	//S2MM channel has moved past it
+	uint32_t const settle_frames = 3;
+	uint64_t const t_start = time_us();
+	ColorBar::result_t res = {};
+
+	uint8_t prev_test;
+	cam.readReg(OV5640_cfg::OV5640_REG_PRE_ISP_TEST_SET1, prev_test);
+	cam.set_test(OV5640_cfg::TEST_EIGHT_COLOR_BAR);
+
+	uint32_t frames = vdma.waitWriteFrames(settle_frames, timeout_us);
+	if (frames < settle_frames)
+	{
+		res.errc = ColorBar::result_t::ERR_TIMEOUT;
+	}
+	else
+	{
+		frame_view_t f = lastWriteFrame(vdma);
+		Xil_DCacheInvalidateRange((INTPTR)f.data, f.size());
+		res = ColorBar::check(f, tol);
+	}
+
+	cam.writeReg(OV5640_cfg::OV5640_REG_PRE_ISP_TEST_SET1, prev_test);
+	res.frames = frames;
+	res.elapsed_us = time_us() - t_start;
+	return res;
+}
+
+} /* namespace digilent */
+
+#endif /* COLORBARTEST_H_ */
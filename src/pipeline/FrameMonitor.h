@@ -0,0 +1,285 @@
+/*
+ * FrameMonitor.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMEMONITOR_H_
+#define FRAMEMONITOR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdexcept>
+
+#include "../ov5640/IrqDispatch.h"
+#include "../util/MmioTrace.h"
+#include "../util/RingBuffer.h"
+
+#include "xil_io.h"
+#include "xstatus.h"
+#include "xcsi_hw.h"
+#include "xtime_l.h"
+
+#define STRINGIZE(x) STRINGIZE2(x)
+#define STRINGIZE2(x) #x
+#define LINE_STRING STRINGIZE(__LINE__)
+
+namespace digilent {
+
+namespace FrameMonitor {
+	uint8_t const DT_FS = 0x00;		// frame start short packet
+	uint8_t const DT_FE = 0x01;		// frame end short packet
+	size_t const event_max = 16;
+
+	//! \brief Cumulative counts, only ever incremented by the interrupt handler
+	using counters_t = struct
+	{
+		uint32_t frames;		// frame received interrupts
+		uint32_t fs, fe;		// frame start/end short packets
+		uint32_t ecc1, ecc2, crc;
+		uint32_t sot;			// SoT and SoT sync errors
+		uint32_t wc;			// word count corruption
+		uint32_t frame_err;		// VCx frame level error
+		uint32_t overflow;		// line buffer or short packet FIFO full
+		uint32_t mismatches;	// frames whose geometry did not match the expectation
+		uint32_t frame_gaps;	// frame numbers skipped in FS packets
+	};
+
+	/*!
+	 * \brief What a frame should look like. lines and bytes come from the
+	 * sensor mode (bytes per long packet, RAW10: width * 5 / 4), vdma_lines
+	 * from the S2MM VSize. Zero fields are not checked.
+	 */
+	using expect_t = struct { uint16_t lines, bytes, vdma_lines; };
+
+	using Mismatch = enum { MM_LINES = 1, MM_BYTES = 2, MM_VDMA_LINES = 4 };
+
+	//! \brief A frame that did not match, as raised by the interrupt handler
+	using event_t = struct
+	{
+		uint32_t frame;			// counters_t::frames at the event
+		uint64_t ticks;			// XTime at frame received
+		uint16_t lines, bytes;	// received
+		expect_t expected;
+		uint16_t kind;			// Mismatch bits
+	};
+
+	/*!
+	 * \brief Frame timing from FS short packets, in XTime ticks. Jitter is the
+	 * change of period from one frame to the next.
+	 */
+	using timing_t = struct
+	{
+		uint32_t periods;		// number of FS to FS periods measured
+		uint32_t period_last, period_min, period_max;
+		uint64_t period_sum;
+		uint32_t jitter_max;
+		uint64_t jitter_sum;
+		uint32_t active_last;	// FS to FE of the last frame
+	};
+}
+
+/*!
+ * \brief Watches the MIPI CSI-2 RX controller from its interrupt: counts
+ * frames and errors, checks every received frame's VC0 line and byte count
+ * against the configured mode and VDMA geometry, and timestamps frame start
+ * and end short packets for the frame period and its jitter.
+ *
+ * Timestamps are taken on interrupt entry while draining the short packet
+ * FIFO, so they include the interrupt latency; on a quiet system that is
+ * nearly constant and cancels out of the period. Mismatches are queued as events for the main
+ * loop (popEvent()); the first settle_frames frames after expect() are not
+ * checked, as the sensor may still deliver a frame of the previous mode.
+ */
+template <typename IrptCtl>
+class CsiFrameMonitor
+{
+public:
+	static uint32_t const settle_frames = 2;
+
+	CsiFrameMonitor(uint32_t csi_base, IrptCtl& irpt_ctl, uint32_t irpt_id) :
+		csi_base_(csi_base), irpt_ctl_(irpt_ctl), irpt_id_(irpt_id)
+	{
+		timing_.period_min = UINT32_MAX;
+		if (irpt_ctl_.registerHandler(irpt_id_, &Irq::Member<&CsiFrameMonitor::service>::thunk, this) != XST_SUCCESS)
+		{
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+		arm();
+		irpt_ctl_.enableInterrupt(irpt_id_);
+		irpt_ctl_.enableInterrupts();
+	}
+
+	~CsiFrameMonitor()
+	{
+		Mmio::write32(csi_base_ + XCSI_GIER_OFFSET, 0);
+		irpt_ctl_.disableInterrupt(irpt_id_);
+	}
+
+	/*!
+	 * \brief Sets the geometry following frames are checked against and
+	 * restarts the timing statistics. Call after every mode change: a
+	 * controller soft reset also clears the interrupt enables, which are
+	 * rewritten here.
+	 */
+	void expect(FrameMonitor::expect_t const& e)
+	{
+		irpt_ctl_.disableInterrupt(irpt_id_);
+		expected_ = e;
+		settle_ = settle_frames;
+		timing_ = FrameMonitor::timing_t();
+		timing_.period_min = UINT32_MAX;
+		fs_ticks_ = 0;
+		arm();
+		irpt_ctl_.enableInterrupt(irpt_id_);
+	}
+
+	FrameMonitor::expect_t expected() const { return expected_; }
+	FrameMonitor::counters_t counters() const { return counters_; }
+	FrameMonitor::timing_t timing() const
+	{
+		irpt_ctl_.disableInterrupt(irpt_id_);
+		FrameMonitor::timing_t const t = timing_;
+		irpt_ctl_.enableInterrupt(irpt_id_);
+		return t;
+	}
+	//! \brief VC0 line and byte count of the last frame received
+	uint16_t lastLines() const { return last_lines_; }
+	uint16_t lastBytes() const { return last_bytes_; }
+	//! \brief Free-running 16-bit long packet counter of the controller
+	uint16_t packetCount() const
+	{
+		return (Xil_In32(csi_base_ + XCSI_CSR_OFFSET) & XCSI_CSR_PKTCOUNT_MASK) >> XCSI_CSR_PKTCOUNT_SHIFT;
+	}
+
+	//! \brief Main loop side of the mismatch event queue
+	bool popEvent(FrameMonitor::event_t& ev) { return events_.pop(ev); }
+	uint32_t eventsDropped() const { return events_.dropped(); }
+
+private:
+	static uint32_t const irq_mask = XCSI_ISR_FR_MASK | XCSI_ISR_VCXFE_MASK | XCSI_ISR_WC_MASK |
+			XCSI_ISR_SPFIFOF_MASK | XCSI_ISR_SPFIFONE_MASK | XCSI_ISR_SLBF_MASK |
+			XCSI_ISR_SOTERR_MASK | XCSI_ISR_SOTSYNCERR_MASK |
+			XCSI_ISR_ECC2BERR_MASK | XCSI_ISR_ECC1BERR_MASK | XCSI_ISR_CRCERR_MASK;
+
+	void arm()
+	{
+		Mmio::write32(csi_base_ + XCSI_ISR_OFFSET, XCSI_ISR_ALLINTR_MASK);
+		Mmio::write32(csi_base_ + XCSI_IER_OFFSET, irq_mask);
+		Mmio::write32(csi_base_ + XCSI_GIER_OFFSET, XCSI_GIER_GIE_MASK);
+	}
+
+	void service()
+	{
+		XTime now;
+		XTime_GetTime(&now);
+		uint32_t const isr = Xil_In32(csi_base_ + XCSI_ISR_OFFSET) & irq_mask;
+		Xil_Out32(csi_base_ + XCSI_ISR_OFFSET, isr);	// W1C
+
+		//Short packets first: FE of a frame precedes its frame received
+		if (isr & (XCSI_ISR_SPFIFONE_MASK | XCSI_ISR_SPFIFOF_MASK))
+			drainShortPackets(now);
+		if (isr & XCSI_ISR_FR_MASK)
+			frameReceived(now);
+
+		if (isr & XCSI_ISR_ECC1BERR_MASK) ++counters_.ecc1;
+		if (isr & XCSI_ISR_ECC2BERR_MASK) ++counters_.ecc2;
+		if (isr & XCSI_ISR_CRCERR_MASK) ++counters_.crc;
+		if (isr & (XCSI_ISR_SOTERR_MASK | XCSI_ISR_SOTSYNCERR_MASK)) ++counters_.sot;
+		if (isr & XCSI_ISR_WC_MASK) ++counters_.wc;
+		if (isr & XCSI_ISR_VCXFE_MASK) ++counters_.frame_err;
+		if (isr & (XCSI_ISR_SLBF_MASK | XCSI_ISR_SPFIFOF_MASK)) ++counters_.overflow;
+	}
+
+	void drainShortPackets(XTime now)
+	{
+		//Bounded, the FIFO is small and a stuck NotEmpty must not hang the CPU
+		for (int i = 0; i < 32 && (Xil_In32(csi_base_ + XCSI_CSR_OFFSET) & XCSI_CSR_SPFIFONE_MASK); ++i)
+		{
+			uint32_t const spktr = Xil_In32(csi_base_ + XCSI_SPKTR_OFFSET);
+			uint8_t const dt = spktr & XCSI_SPKTR_DT_MASK;
+			uint16_t const data = (spktr & XCSI_SPKTR_DATA_MASK) >> XCSI_SPKTR_DATA_SHIFT;
+			if (dt == FrameMonitor::DT_FS)
+				frameStart(now, data);
+			else if (dt == FrameMonitor::DT_FE)
+				frameEnd(now);
+		}
+	}
+
+	void frameStart(XTime now, uint16_t frame_num)
+	{
+		++counters_.fs;
+		//Frame numbers are optional (zero when unused)
+		if (frame_num && last_frame_num_ && frame_num != (uint16_t)(last_frame_num_ + 1) &&
+				frame_num != 1)
+			++counters_.frame_gaps;
+		last_frame_num_ = frame_num;
+
+		if (fs_ticks_)
+		{
+			uint32_t const period = now - fs_ticks_;
+			FrameMonitor::timing_t& t = timing_;
+			if (t.periods)
+			{
+				uint32_t const jitter = period > t.period_last ? period - t.period_last : t.period_last - period;
+				if (jitter > t.jitter_max) t.jitter_max = jitter;
+				t.jitter_sum += jitter;
+			}
+			if (period < t.period_min) t.period_min = period;
+			if (period > t.period_max) t.period_max = period;
+			t.period_sum += period;
+			t.period_last = period;
+			++t.periods;
+		}
+		fs_ticks_ = now;
+	}
+
+	void frameEnd(XTime now)
+	{
+		++counters_.fe;
+		if (fs_ticks_)
+			timing_.active_last = now - fs_ticks_;
+	}
+
+	void frameReceived(XTime now)
+	{
+		++counters_.frames;
+		uint32_t const inf1 = Xil_In32(csi_base_ + XCSI_VC0INF1R_OFFSET);
+		last_lines_ = (inf1 & XCSI_VCXINF1R_LINECOUNT_MASK) >> XCSI_VCXINF1R_LINECOUNT_SHIFT;
+		last_bytes_ = inf1 & XCSI_VCXINF1R_BYTECOUNT_MASK;
+
+		if (settle_)
+		{
+			--settle_;
+			return;
+		}
+		uint16_t kind = 0;
+		if (expected_.lines && last_lines_ != expected_.lines) kind |= FrameMonitor::MM_LINES;
+		if (expected_.bytes && last_bytes_ != expected_.bytes) kind |= FrameMonitor::MM_BYTES;
+		if (expected_.vdma_lines && last_lines_ != expected_.vdma_lines) kind |= FrameMonitor::MM_VDMA_LINES;
+		if (!kind)
+			return;
+		++counters_.mismatches;
+		FrameMonitor::event_t const ev = {counters_.frames, now, last_lines_, last_bytes_, expected_, kind};
+		events_.push(ev);
+	}
+
+private:
+	uint32_t const csi_base_;
+	IrptCtl& irpt_ctl_;
+	uint32_t const irpt_id_;
+
+	FrameMonitor::expect_t expected_ = {0, 0, 0};
+	uint32_t settle_ = settle_frames;
+	FrameMonitor::counters_t counters_ = FrameMonitor::counters_t();
+	FrameMonitor::timing_t timing_ = FrameMonitor::timing_t();
+	XTime fs_ticks_ = 0;
+	uint16_t last_frame_num_ = 0;
+	uint16_t last_lines_ = 0;
+	uint16_t last_bytes_ = 0;
+	RingBuffer<FrameMonitor::event_t, FrameMonitor::event_max> events_;
+};
+
+} /* namespace digilent */
+
+#endif /* FRAMEMONITOR_H_ */
@@ -0,0 +1,191 @@
+/*
+ * FrameStats.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameView.h"
+#include "ColorBarTest.h"
+#include "../util/Profile.h"
+#include "../util/Timer.h"
+
+#include "xil_cache.h"
+
+namespace digilent {
+
+namespace FrameStats {
+	//! \brief Channel level at which a sample counts as clipped and is left out of the bins
+	uint8_t const clip = 0xFA;
+	size_t const bins = 32;
+
+	/*!
+	 * \brief One pass over every grid-th pixel of every grid-th line: the
+	 * BT.601 luma sum of all samples, and the channel sums of the unclipped
+	 * ones binned by luma
+	 */
+	using sums_t = struct
+	{
+		uint32_t samples;
+		uint32_t luma;
+		uint32_t r[bins], g[bins], b[bins];
+		uint32_t n[bins];
+	};
+
+	inline void frame_sums(frame_view_t const& f, uint16_t grid, sums_t& s)
+	{
+		s = sums_t{};
+		if (!grid)
+			grid = 1;
+		for (uint16_t y = grid / 2; y < f.height; y += grid)
+			for (uint16_t x = grid / 2; x < f.width; x += grid)
+			{
+				uint8_t const* p = f.pixel(x, y);
+				uint8_t const r = p[frame_view_t::OFFSET_R];
+				uint8_t const g = p[frame_view_t::OFFSET_G];
+				uint8_t const b = p[frame_view_t::OFFSET_B];
+				uint32_t const luma = (77u * r + 150u * g + 29u * b) >> 8;
+				s.luma += luma;
+				++s.samples;
+				if (r >= clip || g >= clip || b >= clip)
+					continue;
+				size_t const bin = luma * bins / 256;
+				s.r[bin] += r;
+				s.g[bin] += g;
+				s.b[bin] += b;
+				++s.n[bin];
+			}
+	}
+
+	inline uint8_t mean_luma(sums_t const& s)
+	{
+		return s.samples ? (uint8_t)(s.luma / s.samples) : 0;
+	}
+}
+
+/*!
+ * \brief Frame gating of one software loop over FrameSampler::sequence():
+ * a step per new frame, none during the settle frames after a write, which
+ * were already under way with the old setting.
+ */
+class FrameGate
+{
+public:
+	FrameGate() : seq_(0), settle_(0) {}
+
+	void restart(uint32_t seq, uint8_t settle_frames)
+	{
+		seq_ = seq;
+		settle_ = settle_frames;
+	}
+
+	void settle(uint8_t frames) { settle_ = frames; }
+
+	//! \brief Adds the frames new since the last call to frames; true if the newest is past settling
+	bool pass(uint32_t seq, uint32_t& frames)
+	{
+		uint32_t const n = seq - seq_;
+		if (!n)
+			return false;
+		seq_ = seq;
+		frames += n;
+		if (n <= settle_)
+		{
+			settle_ = (uint8_t)(settle_ - n);
+			return false;
+		}
+		settle_ = 0;
+		return true;
+	}
+
+private:
+	uint32_t seq_;
+	uint8_t settle_;
+};
+
+/*!
+ * \brief Statistics of the last completed S2MM frame store for the software
+ * AE and AWB loops. It counts new frames once for both, and invalidates and
+ * scans the sampled lines of each frame once, for whichever loop asks first
+ * at a grid, so the two loops running together cost one pass per frame.
+ */
+template <typename VDMA>
+class FrameSampler
+{
+public:
+	explicit FrameSampler(VDMA& vdma) :
+		vdma_(vdma), last_frm_(-1), seq_(0), scans_{}, measure_us_(0)
+	{
+	}
+
+	//! \brief New S2MM frames seen so far, polls the frame store pointer
+	uint32_t sequence()
+	{
+		int const frm = vdma_.currentWriteFrame();
+		if (frm != last_frm_)
+		{
+			last_frm_ = frm;
+			++seq_;
+		}
+		return seq_;
+	}
+
+	//! \brief Statistics of the last frame at grid, scanned on the first call for that frame and grid
+	FrameStats::sums_t const& sums(uint16_t grid)
+	{
+		if (!grid)
+			grid = 1;
+		uint32_t const seq = sequence();
+		scan_t* sc = &scans_[0];
+		for (scan_t& s : scans_)
+		{
+			if (s.grid == grid)
+			{
+				sc = &s;
+				break;
+			}
+			if (s.seq < sc->seq)
+				sc = &s;
+		}
+		if (sc->grid == grid && sc->seq == seq)
+			return sc->sums;
+
+		PROFILE_ZONE("FrameSampler::sums");
+		uint64_t const t0 = time_us();
+		frame_view_t const f = lastWriteFrame(vdma_);
+		//Only the sampled lines
+		for (uint16_t y = grid / 2; y < f.height; y += grid)
+			Xil_DCacheInvalidateRange((INTPTR)(f.data + (size_t)y * f.stride), (size_t)f.width * f.bpp);
+		FrameStats::frame_sums(f, grid, sc->sums);
+		sc->grid = grid;
+		sc->seq = seq;
+		measure_us_ = (uint32_t)(time_us() - t0);
+		return sc->sums;
+	}
+
+	//! \brief Time the last scan took
+	uint32_t measureUs() const { return measure_us_; }
+
+private:
+	struct scan_t
+	{
+		uint16_t grid;	// 0 for none yet
+		uint32_t seq;
+		FrameStats::sums_t sums;
+	};
+
+	VDMA& vdma_;
+	int last_frm_;
+	uint32_t seq_;
+	scan_t scans_[2];	// AE and AWB at different grids
+	uint32_t measure_us_;
+};
+
+} /* namespace digilent */
+
+#endif /* FRAMESTATS_H_ */
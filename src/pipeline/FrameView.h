@@ -0,0 +1,40 @@
+/*
+ * FrameView.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMEVIEW_H_
+#define FRAMEVIEW_H_
+
+#include <stdint.h>
+
+namespace digilent {
+
+/*!
+ * \brief Non-owning view of a frame store written by the VDMA S2MM channel.
+ * Pixels follow the AXI4-Stream video RGB layout (UG934): byte 0 = G,
+ * byte 1 = B, byte 2 = R. Wider streams carry padding in the upper bytes.
+ */
+struct frame_view_t
+{
+	enum { OFFSET_G = 0, OFFSET_B = 1, OFFSET_R = 2 };
+
+	uint8_t const* data;
+	uint16_t width, height;
+	uint32_t stride;	// bytes per line
+	uint8_t bpp;		// bytes per pixel
+
+	uint8_t const* pixel(uint16_t x, uint16_t y) const
+	{
+		return data + (uint32_t)y * stride + (uint32_t)x * bpp;
+	}
+	uint8_t r(uint16_t x, uint16_t y) const { return pixel(x, y)[OFFSET_R]; }
+	uint8_t g(uint16_t x, uint16_t y) const { return pixel(x, y)[OFFSET_G]; }
+	uint8_t b(uint16_t x, uint16_t y) const { return pixel(x, y)[OFFSET_B]; }
+	uint32_t size() const { return stride * height; }
+};
+
+} /* namespace digilent */
+
+#endif /* FRAMEVIEW_H_ */
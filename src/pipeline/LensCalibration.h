@@ -0,0 +1,474 @@
+/*
+ * LensCalibration.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LENSCALIBRATION_H_
+#define LENSCALIBRATION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "FrameView.h"
+#include "ColorBarTest.h"
+#include "../ov5640/OV5640.h"
+#include "../util/Crc16.h"
+#include "../util/Profile.h"
+#include "../util/Timer.h"
+
+#include "ff.h"
+#include "xil_cache.h"
+
+namespace digilent {
+
+namespace LensCal {
+	uint32_t const magic = 0x534E454C;	// "LENS"
+	uint16_t const version = 1;
+	char const* const path = "0:/pcam_lens.cal";
+	size_t const point_max = 8;
+	size_t const step_max = 48;
+	uint16_t const code_x16_max = 0xFF * 16;
+	int16_t const temp_unknown = -0x8000;
+	//! \brief Targets closer in power than this are taken for the same distance
+	int32_t const same_mdpt = 50;
+
+	//! \brief Optical power in milli-dioptres to focus at a distance, 0 for infinity
+	inline int32_t mdpt_at(uint32_t mm) { return mm ? (int32_t)(1000000u / mm) : 0; }
+	inline uint32_t mm_at(int32_t mdpt) { return mdpt > 0 ? 1000000u / (uint32_t)mdpt : 0; }
+
+	//! \brief The lens code, in 1/16, that focuses at mdpt, found at temp_c
+	struct point_t
+	{
+		int32_t mdpt;
+		uint16_t code_x16;
+		int16_t temp_c;		// temp_unknown if not given
+	};
+	static_assert(sizeof(point_t) == 8, "point_t is the table format");
+
+	/*!
+	 * \brief The calibration as stored: points by ascending power, their codes
+	 * strictly monotonic, and how much the lens's power drifts per degree at
+	 * a fixed code, 0 for no compensation
+	 */
+	struct table_t
+	{
+		uint8_t count;
+		uint8_t reserved;
+		int16_t tc_mdpt_per_c;
+		point_t points[point_max];
+	};
+	static_assert(sizeof(table_t) == 68, "table_t is the table format");
+
+	//! \brief File header; the table follows
+	struct header_t
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t size;		// table bytes that follow
+		uint16_t crc;		// CRC-16 of those bytes
+		uint16_t reserved;
+	};
+	static_assert(sizeof(header_t) == 12, "header_t is the table format");
+
+	using config_t = struct
+	{
+		uint8_t coarse_step;	// codes between samples of the whole range
+		uint8_t fine_step;		// codes between samples around the coarse peak
+		uint8_t settle_frames;	// frames skipped after each lens write
+		uint8_t roi_pct;		// centre share of width and height measured
+		uint8_t grid;			// lines between measured lines
+		uint8_t min_rise_pct;	// the peak must stand this far above the weakest sample
+		uint32_t timeout_us;	// per frame
+	};
+	config_t const defaults = {16, 4, 1, 50, 4, 20, 500000};
+
+	using step_t = struct { uint8_t code; uint32_t sharpness; };
+
+	using result_t = struct
+	{
+		//Frames stopped; no peak, nothing in focus; more samples than step_max
+		using Errc = enum { OK = 0, ERR_TIMEOUT, ERR_FLAT, ERR_CONFIG };
+		Errc errc;
+		point_t point;
+		uint32_t peak, floor;		// highest and lowest sharpness seen
+		uint16_t frames;
+		uint32_t us;
+		size_t step_count;
+		step_t steps[step_max];
+	};
+
+	using roi_t = struct { uint16_t x, y, width, height; };
+
+	inline roi_t centre(frame_view_t const& f, uint8_t pct)
+	{
+		uint16_t const w = (uint16_t)((uint32_t)f.width * pct / 100);
+		uint16_t const h = (uint16_t)((uint32_t)f.height * pct / 100);
+		return roi_t{(uint16_t)((f.width - w) / 2), (uint16_t)((f.height - h) / 2), w, h};
+	}
+
+	/*!
+	 * \brief Mean absolute horizontal green gradient over every grid-th line
+	 * of the region, relative to the mean green level so that exposure
+	 * changes during a sweep do not move it. In 1/65536.
+	 */
+	inline uint32_t sharpness(frame_view_t const& f, roi_t const& r, uint16_t grid)
+	{
+		uint64_t grad = 0, sum = 0;
+		if (!grid)
+			grid = 1;
+		for (uint32_t y = r.y; y < (uint32_t)r.y + r.height; y += grid)
+		{
+			uint8_t const* p = f.pixel(r.x, (uint16_t)y) + frame_view_t::OFFSET_G;
+			int prev = p[0];
+			for (uint16_t x = 1; x < r.width; ++x)
+			{
+				p += f.bpp;
+				int const g = p[0];
+				grad += (uint32_t)(g > prev ? g - prev : prev - g);
+				sum += (uint32_t)g;
+				prev = g;
+			}
+		}
+		return sum ? (uint32_t)(grad * 65536 / sum) : 0;
+	}
+
+	inline bool monotonic(table_t const& t)
+	{
+		int dir = 0;
+		for (size_t i = 1; i < t.count; ++i)
+		{
+			int32_t const dc = (int32_t)t.points[i].code_x16 - t.points[i - 1].code_x16;
+			int const d = dc > 0 ? 1 : dc < 0 ? -1 : 0;
+			if (t.points[i].mdpt <= t.points[i - 1].mdpt || !d || (dir && d != dir))
+				return false;
+			dir = d;
+		}
+		return true;
+	}
+
+	using Errc = enum { OK = 0, ERR_NOT_CALIBRATED, ERR_NOT_MONOTONIC, ERR_FULL, ERR_IO };
+
+	/*!
+	 * \brief Adds a point, or replaces the one at the same distance. The table
+	 * is left as it was if the result would not be monotonic.
+	 */
+	inline Errc insert(table_t& t, point_t const& p)
+	{
+		table_t n = t;
+		size_t i = 0;
+		while (i < n.count && n.points[i].mdpt < p.mdpt - same_mdpt)
+			++i;
+		if (i < n.count && n.points[i].mdpt <= p.mdpt + same_mdpt)
+		{
+			n.points[i] = p;
+		}
+		else
+		{
+			if (n.count == point_max)
+				return ERR_FULL;
+			memmove(&n.points[i + 1], &n.points[i], (n.count - i) * sizeof(point_t));
+			n.points[i] = p;
+			++n.count;
+		}
+		if (!monotonic(n))
+			return ERR_NOT_MONOTONIC;
+		t = n;
+		return OK;
+	}
+
+	/*!
+	 * \brief Power the point's code focuses at temp_c: the lens drifts by the
+	 * table's coefficient per degree away from the calibration temperature
+	 */
+	inline int32_t power_at(table_t const& t, point_t const& p, int16_t temp_c)
+	{
+		if (temp_c == temp_unknown || p.temp_c == temp_unknown)
+			return p.mdpt;
+		return p.mdpt + (int32_t)t.tc_mdpt_per_c * (temp_c - p.temp_c);
+	}
+
+	/*!
+	 * \brief Tangents, code_x16 per mdpt in 1/65536, of a monotone cubic
+	 * through the points (Fritsch-Carlson): weighted harmonic means of the
+	 * neighbouring slopes inside, one-sided three-point estimates limited to
+	 * keep the curve monotonic at the ends
+	 */
+	inline void tangents(int64_t const* x, int64_t const* y, size_t n, int64_t* m)
+	{
+		int64_t d[point_max];
+		for (size_t i = 0; i + 1 < n; ++i)
+			d[i] = x[i + 1] > x[i] ? (y[i + 1] - y[i]) * 65536 / (x[i + 1] - x[i]) : 0;
+		if (n == 2)
+		{
+			m[0] = m[1] = d[0];
+			return;
+		}
+		for (size_t i = 1; i + 1 < n; ++i)
+		{
+			int64_t const h0 = x[i] - x[i - 1], h1 = x[i + 1] - x[i];
+			int64_t const den = (2 * h1 + h0) * d[i] + (h1 + 2 * h0) * d[i - 1];
+			m[i] = (d[i - 1] > 0) == (d[i] > 0) && d[i - 1] && d[i] && den ?
+					3 * (h0 + h1) * d[i - 1] * d[i] / den : 0;
+		}
+		for (int end = 0; end < 2; ++end)
+		{
+			size_t const k = end ? n - 2 : 0;		// the end segment
+			size_t const j = end ? n - 3 : 1;		// its neighbour
+			int64_t const h0 = x[k + 1] - x[k], h1 = x[j + 1] - x[j];
+			int64_t e = h0 + h1 ? ((2 * h0 + h1) * d[k] - h0 * d[j]) / (h0 + h1) : d[k];
+			if ((e > 0) != (d[k] > 0) || !d[k])
+				e = 0;
+			else if ((d[k] > 0) != (d[j] > 0) && (e > 3 * d[k]) == (d[k] > 0))
+				e = 3 * d[k];
+			m[end ? n - 1 : 0] = e;
+		}
+	}
+
+	/*!
+	 * \brief Code for a power on a monotone cubic through the points, which
+	 * follows the lens's bent curve better than straight segments and never
+	 * turns back between them. Beyond the ends the end tangents extend it.
+	 * Needs two points; with two it is the straight line through them.
+	 */
+	inline bool code_x16_for(table_t const& t, int32_t mdpt, int16_t temp_c, uint16_t& code_x16)
+	{
+		size_t const n = t.count;
+		if (n < 2)
+			return false;
+		int64_t x[point_max], y[point_max], m[point_max];
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] = power_at(t, t.points[i], temp_c);
+			y[i] = t.points[i].code_x16;
+		}
+		tangents(x, y, n, m);
+
+		int64_t c;
+		if (mdpt <= x[0])
+		{
+			c = y[0] + (mdpt - x[0]) * m[0] / 65536;
+		}
+		else if (mdpt >= x[n - 1])
+		{
+			c = y[n - 1] + (mdpt - x[n - 1]) * m[n - 1] / 65536;
+		}
+		else
+		{
+			size_t i = 0;
+			while (x[i + 1] < mdpt)
+				++i;
+			//Cubic Hermite basis at u = (mdpt - x0) / h, all in 1/65536
+			int64_t const h = x[i + 1] - x[i];
+			int64_t const u = (mdpt - x[i]) * 65536 / h;
+			int64_t const u2 = u * u / 65536, u3 = u2 * u / 65536;
+			int64_t const h00 = 2 * u3 - 3 * u2 + 65536, h01 = 3 * u2 - 2 * u3;
+			int64_t const h10 = u3 - 2 * u2 + u, h11 = u3 - u2;
+			c = (h00 * y[i] + h01 * y[i + 1] + h10 * (h * m[i] / 65536) + h11 * (h * m[i + 1] / 65536) + 32768) / 65536;
+		}
+		code_x16 = (uint16_t)(c < 0 ? 0 : c > code_x16_max ? code_x16_max : c);
+		return true;
+	}
+
+	inline bool save(table_t const& t)
+	{
+		uint8_t buf[sizeof(header_t) + sizeof(table_t)];
+		header_t const h = {magic, version, (uint16_t)sizeof(t), crc16(reinterpret_cast<uint8_t const*>(&t), sizeof(t)), 0};
+		memcpy(buf, &h, sizeof(h));
+		memcpy(buf + sizeof(h), &t, sizeof(t));
+		FIL f;
+		UINT n = 0;
+		if (f_open(&f, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+			return false;
+		bool const ok = f_write(&f, buf, sizeof(buf), &n) == FR_OK && n == sizeof(buf) && f_sync(&f) == FR_OK;
+		f_close(&f);
+		return ok;
+	}
+
+	//! \brief False for anything but an intact, monotonic table this version can read
+	inline bool load(table_t& t)
+	{
+		uint8_t buf[sizeof(header_t) + sizeof(table_t)];
+		FIL f;
+		UINT n = 0;
+		if (f_open(&f, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+			return false;
+		bool const ok = f_read(&f, buf, sizeof(buf), &n) == FR_OK;
+		f_close(&f);
+		header_t h;
+		if (!ok || n < sizeof(h))
+			return false;
+		memcpy(&h, buf, sizeof(h));
+		if (h.magic != magic || h.version == 0 || h.version > version || h.size > sizeof(table_t) ||
+				n < sizeof(h) + h.size || crc16(buf + sizeof(h), h.size) != h.crc)
+			return false;
+		table_t r = {};
+		memcpy(&r, buf + sizeof(h), h.size);
+		if (r.count > point_max || !monotonic(r))
+			return false;
+		t = r;
+		return true;
+	}
+}
+
+/*!
+ * \brief Finds the lens code that focuses on a target at a known distance.
+ * A coarse pass samples the whole code range, a fine pass the codes around
+ * the coarse peak, and a parabola through the fine peak and its neighbours
+ * places it to 1/16 code. Each sample is one lens write and one frame after
+ * the settle frames; with the defaults that is 26 samples, 52 frames, under
+ * a second at 60 fps. The lens is left at the code found. On failure it is
+ * left at the last code tried; the caller puts its own back.
+ */
+template <typename VDMA>
+LensCal::result_t runFocusSweep(OV5640& cam, VDMA& vdma, uint32_t distance_mm, int16_t temp_c,
+		LensCal::config_t const& cfg = LensCal::defaults)
+{
+	PROFILE_ZONE("runFocusSweep");
+	uint64_t const t0 = time_us();
+	LensCal::result_t res = {};
+	res.point.mdpt = LensCal::mdpt_at(distance_mm);
+	res.point.temp_c = temp_c;
+	res.floor = UINT32_MAX;
+	uint32_t const wait = cfg.settle_frames + 1u;
+	uint8_t const coarse = cfg.coarse_step ? cfg.coarse_step : 1;
+	uint8_t const fine = cfg.fine_step ? cfg.fine_step : 1;
+	if (0xFFu / coarse + 2 + 2u * coarse / fine + 1 > LensCal::step_max)
+	{
+		res.errc = LensCal::result_t::ERR_CONFIG;
+		return res;
+	}
+
+	auto measure = [&](uint32_t code) {
+		cam.writeRegLiquid((uint8_t)code);
+		uint32_t const n = vdma.waitWriteFrames(wait, cfg.timeout_us * wait);
+		res.frames = (uint16_t)(res.frames + n);
+		if (n < wait)
+			return false;
+		frame_view_t const f = lastWriteFrame(vdma);
+		LensCal::roi_t const r = LensCal::centre(f, cfg.roi_pct);
+		uint16_t const grid = cfg.grid ? cfg.grid : 1;
+		for (uint32_t y = r.y; y < (uint32_t)r.y + r.height; y += grid)
+			Xil_DCacheInvalidateRange((INTPTR)f.pixel(r.x, (uint16_t)y), (size_t)r.width * f.bpp);
+		uint32_t const s = LensCal::sharpness(f, r, grid);
+		res.steps[res.step_count++] = LensCal::step_t{(uint8_t)code, s};
+		if (s > res.peak)
+			res.peak = s;
+		if (s < res.floor)
+			res.floor = s;
+		return true;
+	};
+	auto finish = [&](LensCal::result_t::Errc errc) {
+		res.errc = errc;
+		res.us = (uint32_t)(time_us() - t0);
+		return res;
+	};
+
+	//Whole range, the last code included
+	size_t best = 0;
+	for (uint32_t code = 0;; code += coarse)
+	{
+		if (code > 0xFF)
+			code = 0xFF;
+		if (!measure(code))
+			return finish(LensCal::result_t::ERR_TIMEOUT);
+		if (res.steps[res.step_count - 1].sharpness > res.steps[best].sharpness)
+			best = res.step_count - 1;
+		if (code == 0xFF)
+			break;
+	}
+	if ((uint64_t)res.peak * 100 < (uint64_t)res.floor * (100 + cfg.min_rise_pct))
+		return finish(LensCal::result_t::ERR_FLAT);
+
+	//Around the coarse peak
+	int32_t const centre_code = res.steps[best].code;
+	uint32_t const lo = centre_code > coarse ? centre_code - coarse : 0;
+	uint32_t const hi = centre_code + coarse < 0xFF ? centre_code + coarse : 0xFF;
+	size_t const first = res.step_count;
+	for (uint32_t code = lo; code <= hi; code += fine)
+		if (!measure(code))
+			return finish(LensCal::result_t::ERR_TIMEOUT);
+	best = first;
+	for (size_t i = first; i < res.step_count; ++i)
+		if (res.steps[i].sharpness > res.steps[best].sharpness)
+			best = i;
+
+	int32_t code_x16 = res.steps[best].code * 16;
+	if (best > first && best + 1 < res.step_count)
+	{
+		int64_t const a = res.steps[best - 1].sharpness;
+		int64_t const b = res.steps[best].sharpness;
+		int64_t const c = res.steps[best + 1].sharpness;
+		int64_t const den = a - 2 * b + c;
+		if (den < 0)
+		{
+			int64_t off = 16 * fine * (a - c) / (2 * den);
+			if (off > 8 * fine)
+				off = 8 * fine;
+			if (off < -8 * fine)
+				off = -8 * fine;
+			code_x16 += (int32_t)off;
+		}
+	}
+	code_x16 = code_x16 < 0 ? 0 : code_x16 > LensCal::code_x16_max ? LensCal::code_x16_max : code_x16;
+	res.point.code_x16 = (uint16_t)code_x16;
+	cam.writeRegLiquid((uint8_t)((code_x16 + 8) / 16));
+	return finish(LensCal::result_t::OK);
+}
+
+/*!
+ * \brief The liquid lens by distance instead of by raw code. Focus sweeps
+ * at known target distances add points to a code to dioptre table kept on
+ * the SD card; focusing then interpolates the code and writes it once,
+ * without a search. With a temperature coefficient set and temperatures
+ * given, the points are shifted for the lens's drift before interpolating.
+ */
+class LensCalibration
+{
+public:
+	explicit LensCalibration(OV5640& cam) : cam_(cam), table_{}
+	{
+	}
+
+	//! \brief Table from the SD card, false with none or a damaged one
+	bool load() { return LensCal::load(table_); }
+	LensCal::Errc save() { return LensCal::save(table_) ? LensCal::OK : LensCal::ERR_IO; }
+
+	//! \brief Adds a sweep's point; save() keeps it
+	LensCal::Errc add(LensCal::point_t const& p) { return LensCal::insert(table_, p); }
+
+	//! \brief Forgets every point and the coefficient, and deletes the file
+	void clear()
+	{
+		table_ = LensCal::table_t{};
+		f_unlink(LensCal::path);
+	}
+
+	void setTempCoeff(int16_t tc_mdpt_per_c) { table_.tc_mdpt_per_c = tc_mdpt_per_c; }
+
+	/*!
+	 * \brief Focuses at a distance, 0 for infinity, in one lens write.
+	 * temp_c is the lens temperature, LensCal::temp_unknown if not known.
+	 */
+	LensCal::Errc focus(uint32_t distance_mm, int16_t temp_c, uint8_t& code)
+	{
+		uint16_t code_x16;
+		if (!LensCal::code_x16_for(table_, LensCal::mdpt_at(distance_mm), temp_c, code_x16))
+			return LensCal::ERR_NOT_CALIBRATED;
+		code = (uint8_t)((code_x16 + 8) / 16);
+		cam_.writeRegLiquid(code);
+		return LensCal::OK;
+	}
+
+	bool calibrated() const { return table_.count >= 2; }
+	LensCal::table_t const& table() const { return table_; }
+
+private:
+	OV5640& cam_;
+	LensCal::table_t table_;
+};
+
+} /* namespace digilent */
+
+#endif /* LENSCALIBRATION_H_ */
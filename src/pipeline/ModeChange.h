@@ -0,0 +1,257 @@
+/*
+ * ModeChange.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MODECHANGE_H_
+#define MODECHANGE_H_
+
+#include <stdint.h>
+
+#include "Bandwidth.h"
+#include "ColorBarTest.h"
+#include "FrameMonitor.h"
+#include "PipelineController.h"
+#include "../hdmi/VideoOutput.h"
+#include "../ov5640/OV5640.h"
+#include "../util/MmioTrace.h"
+#include "../util/Profile.h"
+
+#include "xparameters.h"
+#include "xil_io.h"
+#include "xil_printf.h"
+#include "xcsi_hw.h"
+#include "xaxivdma.h"
+
+namespace digilent {
+
+inline void print_mipi_status(void) {
+    u32 base = XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR;
+    u32 ccr = Mmio::read32(base + XCSI_CCR_OFFSET);
+    u32 csr = Mmio::read32(base + XCSI_CSR_OFFSET);
+    u32 isr = Mmio::read32(base + XCSI_ISR_OFFSET);
+
+    xil_printf("\r\n=== Xilinx MIPI CSI-2 RX Status ===\r\n");
+    xil_printf(" CCR (0x00): 0x%08X  [Core Enable:%d  Soft Reset:%d]\r\n",
+               ccr,
+               (ccr & XCSI_CCR_COREENB_MASK) >> XCSI_CCR_COREENB_SHIFT,
+               (ccr & XCSI_CCR_SOFTRESET_MASK) >> XCSI_CCR_SOFTRESET_SHIFT);
+
+    xil_printf(" CSR (0x10): 0x%08X  [PktCnt:%u  SP FIFO Full:%d  NotEmpty:%d  LineBufFull:%d]\r\n",
+               csr,
+               (csr & XCSI_CSR_PKTCOUNT_MASK) >> XCSI_CSR_PKTCOUNT_SHIFT,
+               (csr & XCSI_CSR_SPFIFOFULL_MASK) ? 1 : 0,
+               (csr & XCSI_CSR_SPFIFONE_MASK)   ? 1 : 0,
+               (csr & XCSI_CSR_SLBF_MASK)       ? 1 : 0);
+
+    xil_printf(" ISR (0x24): 0x%08X\r\n", isr);
+
+    if (isr & XCSI_ISR_FR_MASK)       xil_printf("  * Frame Received\r\n");
+    if (isr & XCSI_ISR_VCXFE_MASK)     xil_printf("  * VCx Frame Level Error\r\n");
+    if (isr & (1U<<22))                xil_printf("  * Word Count Corruption\r\n");
+
+    u32 pcr = Mmio::read32(base + 0x04);
+    xil_printf(" PCR (0x04): 0x%08X  [Max Lanes:%d  Active Lanes:%d]\r\n",
+               pcr,
+               (pcr & XCSI_PCR_MAXLANES_MASK) >> XCSI_PCR_MAXLANES_SHIFT,
+               (pcr & XCSI_PCR_ACTLANES_MASK) >> XCSI_PCR_ACTLANES_SHIFT);
+
+    u32 clkinfr = Mmio::read32(base + XCSI_CLKINFR_OFFSET);
+    xil_printf(" Clock Lane Info (0x3C): 0x%08X  [Stop State:%d]\r\n",
+               clkinfr,
+               (clkinfr & XCSI_CLKINFR_STOP_MASK) ? 1 : 0);
+
+    u32 l0infr = Mmio::read32(base + XCSI_L0INFR_OFFSET);
+    u32 l1infr = Mmio::read32(base + XCSI_L1INFR_OFFSET);
+    xil_printf(" Lane 0 Info (0x40): 0x%08X  [Stop:%d  SkewCalHS:%d  SoTErr:%d  SoTSyncErr:%d]\r\n",
+               l0infr,
+               (l0infr & XCSI_LXINFR_STOP_MASK) ? 1 : 0,
+               (l0infr & XCSI_LXINFR_SKEWCALHS_MASK) ? 1 : 0,
+               (l0infr & XCSI_LXINFR_SOTERR_MASK) ? 1 : 0,
+               (l0infr & XCSI_LXINFR_SOTSYNCERR_MASK) ? 1 : 0);
+    xil_printf(" Lane 1 Info (0x44): 0x%08X  [Stop:%d  SkewCalHS:%d  SoTErr:%d  SoTSyncErr:%d]\r\n",
+               l1infr,
+               (l1infr & XCSI_LXINFR_STOP_MASK) ? 1 : 0,
+               (l1infr & XCSI_LXINFR_SKEWCALHS_MASK) ? 1 : 0,
+               (l1infr & XCSI_LXINFR_SOTERR_MASK) ? 1 : 0,
+               (l1infr & XCSI_LXINFR_SOTSYNCERR_MASK) ? 1 : 0);
+
+    u32 spktr = Mmio::read32(base + XCSI_SPKTR_OFFSET);
+    xil_printf(" Short Packet FIFO (0x30): 0x%08X  [VC:%d  DataType:0x%02X  Data:0x%04X]\r\n",
+               spktr,
+               (spktr & XCSI_SPKTR_VC_MASK) >> XCSI_SPKTR_VC_SHIFT,
+               (spktr & XCSI_SPKTR_DT_MASK),
+               (spktr & XCSI_SPKTR_DATA_MASK) >> XCSI_SPKTR_DATA_SHIFT);
+
+    u32 vc0inf1 = Mmio::read32(base + XCSI_VC0INF1R_OFFSET);
+    u32 vc0inf2 = Mmio::read32(base + XCSI_VC0INF2R_OFFSET);
+    xil_printf(" VC0 Image Info1 (0x60): 0x%08X  [LineCount:%u  ByteCount:%u]\r\n",
+               vc0inf1,
+               (vc0inf1 & XCSI_VCXINF1R_LINECOUNT_MASK) >> XCSI_VCXINF1R_LINECOUNT_SHIFT,
+               (vc0inf1 & XCSI_VCXINF1R_BYTECOUNT_MASK));
+    xil_printf(" VC0 Image Info2 (0x64): 0x%08X  [DataType:0x%02X]\r\n",
+               vc0inf2,
+               (vc0inf2 & XCSI_VCXINF2R_DATATYPE_MASK));
+
+    u32 dphy_base = XPAR_MIPI_CSI2_RX_SUBSYST_0_BASEADDR + 0x1000;
+    xil_printf("D-PHY SR: 0x%08X\r\n", Mmio::read32(dphy_base + 0x04));
+    xil_printf("D-PHY CR: 0x%08X\r\n", Mmio::read32(dphy_base + 0x00));
+}
+
+// Helper: Print VDMA S2MM (write from camera) status
+inline void print_vdma_s2mm_status() {
+    u32 base = XPAR_AXIVDMA_0_BASEADDR;
+
+    // Correct offsets from xaxivdma_hw.h and PG020 (S2MM starts at 0x30)
+    u32 s2mm_dmacr = Mmio::read32(base + 0x30);   // S2MM_VDMACR (Control)
+    u32 s2mm_dmasr = Mmio::read32(base + 0x34);   // S2MM_VDMASR (Status)
+    xil_printf("\r\n=== VDMA S2MM (Camera → DDR) Status ===\r\n");
+    xil_printf(" S2MM_VDMACR (Control): 0x%08X\r\n", s2mm_dmacr);
+    xil_printf(" S2MM_VDMASR (Status):  0x%08X\r\n", s2mm_dmasr);
+
+    // Interrupt status bits (in SR)
+    if (s2mm_dmasr & XAXIVDMA_IXR_FRMCNT_MASK)
+        xil_printf(" → IOC_Irq: Interrupt on Complete (frame/descriptor finished)\r\n");
+
+    if (s2mm_dmasr & XAXIVDMA_IXR_DELAYCNT_MASK)
+        xil_printf(" → Dly_Irq: Delay interrupt\r\n");
+
+    if (s2mm_dmasr & XAXIVDMA_IXR_ERROR_MASK)
+        xil_printf(" → Err_Irq: Error interrupt active (check error bits below)\r\n");
+
+    // Run / Halted state
+    if (!(s2mm_dmacr & XAXIVDMA_CR_RUNSTOP_MASK))
+        xil_printf(" WARNING: S2MM channel is HALTED (Run/Stop bit = 0)\r\n");
+
+    // Bonus: show common error flags (bits 4–11 in SR)
+    if (s2mm_dmasr & XAXIVDMA_SR_ERR_ALL_MASK) {
+        xil_printf("  -> DMA Errors:\r\n");
+        if (s2mm_dmasr & XAXIVDMA_SR_ERR_INTERNAL_MASK) xil_printf("     Internal error\r\n");
+        if (s2mm_dmasr & XAXIVDMA_SR_ERR_FSZ_LESS_MASK) xil_printf("     Frame size LESS than expected\r\n");
+        if (s2mm_dmasr & XAXIVDMA_SR_ERR_LSZ_LESS_MASK) xil_printf("     Line size LESS than expected\r\n");
+        if (s2mm_dmasr & XAXIVDMA_SR_ERR_FSZ_MORE_MASK) xil_printf("     Frame size MORE than expected\r\n");
+        if (s2mm_dmasr & XAXIVDMA_SR_ERR_SLAVE_MASK)    xil_printf("     Slave error\r\n");
+        if (s2mm_dmasr & XAXIVDMA_SR_ERR_DECODE_MASK)   xil_printf("     Decode error\r\n");
+    }
+}
+
+inline void print_self_test(ColorBar::result_t const& res)
+{
+	if (res.pass())
+	{
+		xil_printf("Colour bar self-test PASS (%u frames, %u us)\r\n", res.frames, res.elapsed_us);
+		return;
+	}
+	xil_printf("Colour bar self-test FAIL: %s (%u frames, %u us)\r\n",
+	           ColorBar::errc_str(res.errc), res.frames, res.elapsed_us);
+	if (res.errc == ColorBar::result_t::ERR_COLOUR || res.errc == ColorBar::result_t::ERR_EDGE)
+	{
+		xil_printf("  bar %u (%s) region x=%u y=%u w=%u h=%u measured R=%u G=%u B=%u\r\n",
+		           res.bar, ColorBar::names[res.bar], res.x, res.y, res.w, res.h, res.r, res.g, res.b);
+	}
+	else if (res.errc == ColorBar::result_t::ERR_GEOMETRY)
+	{
+		xil_printf("  frame %ux%u\r\n", res.w, res.h);
+	}
+}
+
+inline void print_bandwidth(OV5640_cfg::mode_t mode, Resolution res, Bandwidth::usage_t const& u)
+{
+	xil_printf("  mode %d res %2d  S2MM %4u MB/s  MM2S %4u MB/s  CPU %4u MB/s  port %3u.%u%%  DDR %3u.%u%%  %s\r\n",
+	           mode, static_cast<int>(res),
+	           (uint32_t)(u.s2mm_Bps / 1000000), (uint32_t)(u.mm2s_Bps / 1000000), (uint32_t)(u.cpu_Bps / 1000000),
+	           u.port_permille / 10, u.port_permille % 10, u.ddr_permille / 10, u.ddr_permille % 10,
+	           u.fits ? "ok" : "OVER");
+}
+
+/*
+ * What the frame monitor should see for the pipeline's current target, RAW10
+ * packets. An S2MM shorter than the sensor frame crops it on purpose (a 720p
+ * mode into a 480-line output), so the VDMA lines are only checked when the
+ * two should agree; otherwise every frame would raise a mismatch.
+ */
+template <typename PIPE, typename VDMA>
+FrameMonitor::expect_t frame_expectation(PIPE& pipeline, VDMA& vdma_driver)
+{
+	OV5640_cfg::mode_info_t const& m = OV5640_cfg::mode_info[pipeline.target().mode];
+	uint16_t const vdma_lines = vdma_driver.writeLines();
+	FrameMonitor::expect_t const e = {m.height, (uint16_t)(m.width * 5 / 4),
+			vdma_lines < m.height ? (uint16_t)0 : vdma_lines};
+	return e;
+}
+
+/*!
+ * \brief Moves the pipeline to the given output resolution and sensor mode
+ * within the bandwidth budget, then logs the stage status and runs the
+ * colour bar self-test. Returns the plan executed: 0 if the budget rejected
+ * the change or the pipeline already runs the target, nothing was touched.
+ */
+template <typename PIPE, typename MON, typename VDMA>
+Pipeline::plan_t pipeline_mode_change(PIPE& pipeline,
+                          MON& monitor,
+                          VDMA& vdma_driver,
+                          OV5640& cam,
+                          VideoOutput& vid,
+                          Resolution res,
+                          OV5640_cfg::mode_t mode,
+                          Bandwidth::budget_t const& bw_budget)
+{
+	PROFILE_ZONE("pipeline_mode_change");
+    xil_printf("\r\n=== Starting mode change to mode %d ===\r\n", mode);
+
+	Pipeline::target_t tgt = {res, mode, OV5640_cfg::awb_t::AWB_ADVANCED, 3};
+	uint8_t const bpp = vdma_driver.writeBytesPerPixel();
+	switch (Bandwidth::admit(tgt, bpp, bw_budget))
+	{
+	case Bandwidth::REJECTED:
+		xil_printf("Rejected, exceeds %u%% bandwidth budget:\r\n", bw_budget.max_util_pct);
+		print_bandwidth(mode, res, Bandwidth::estimate(mode, res, bpp, bw_budget));
+		return 0;
+	case Bandwidth::DOWNGRADED:
+		xil_printf("Downgraded to fit %u%% bandwidth budget:\r\n", bw_budget.max_util_pct);
+		print_bandwidth(mode, res, Bandwidth::estimate(mode, res, bpp, bw_budget));
+		break;
+	default:
+		break;
+	}
+	print_bandwidth(tgt.mode, tgt.res, Bandwidth::estimate(tgt.mode, tgt.res, bpp, bw_budget));
+	if (!Pipeline::plan(pipeline.state(), tgt))
+	{
+		xil_printf("Already running mode %d/res %d\r\n", tgt.mode, static_cast<int>(tgt.res));
+		return 0;
+	}
+	//No geometry checks while the pipeline is torn down
+	monitor.expect(FrameMonitor::expect_t{0, 0, 0});
+	Pipeline::plan_t const plan = pipeline.apply(tgt).plan;
+	PIPE::printTransition(pipeline.history(0));
+	monitor.expect(frame_expectation(pipeline, vdma_driver));
+
+	MMCM::setting_t const& clk = vid.clock();
+	xil_printf("Pixel clock x5: %u Hz (%d ppm), D=%u M=%u/8 O0=%u/8 VCO=%u Hz\r\n",
+	           clk.out_Hz, clk.error_ppm, clk.div, clk.mul_x8, clk.out_x8, clk.vco_Hz);
+
+	print_mipi_status();
+	print_vdma_s2mm_status();
+
+	uint8_t r3035, r3036, r3037, r3824;
+	cam.readReg(0x3035, r3035);
+	cam.readReg(0x3036, r3036);
+	cam.readReg(0x3037, r3037);
+	cam.readReg(0x3824, r3824);
+
+
+	xil_printf("PLL: 3035=0x%02X 3036=0x%02X 3037=0x%02X 3824=0x%02X\r\n",
+	           r3035, r3036, r3037, r3824);
+	uint8_t r300e, r4800;
+	cam.readReg(0x300E, r300e);
+	cam.readReg(0x4800, r4800);
+	xil_printf("MIPI ctrl: 300E=0x%02X 4800=0x%02X\r\n", r300e, r4800);
+
+	print_self_test(runColorBarSelfTest(cam, vdma_driver));
+	return plan;
+}
+
+} /* namespace digilent */
+
+#endif /* MODECHANGE_H_ */
@@ -0,0 +1,441 @@
+/*
+ * PipelineController.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef PIPELINECONTROLLER_H_
+#define PIPELINECONTROLLER_H_
+
+#include <stdint.h>
+#include <stdexcept>
+
+#include "../ov5640/OV5640.h"
+#include "../hdmi/VideoOutput.h"
+#include "../util/Timer.h"
+#include "../util/MmioTrace.h"
+#include "BringUpScheduler.h"
+
+#include "xil_io.h"
+#include "xil_printf.h"
+#include "xcsiss_hw.h"
+#include "xcsi_hw.h"
+
+namespace digilent {
+
+namespace Pipeline {
+	// Reconfiguration steps, declared in the order they must execute
+	using action_t = enum {
+		ACT_SENSOR_STANDBY = 0, ACT_S2MM_STOP, ACT_CSI_RESET, ACT_SENSOR_POWER_CYCLE,
+		ACT_S2MM_CONFIG, ACT_GAMMA, ACT_SENSOR_INIT, ACT_S2MM_START, ACT_CSI_ENABLE,
+		ACT_SENSOR_MODE, ACT_SENSOR_AWB, ACT_OUTPUT_STOP, ACT_MM2S_STOP,
+		ACT_OUTPUT_CONFIG, ACT_MM2S_CONFIG, ACT_OUTPUT_START, ACT_MM2S_START, ACT_END };
+	char const* const action_names[ACT_END] = {
+		"sensor standby", "S2MM stop", "CSI reset", "sensor power cycle",
+		"S2MM config", "gamma", "sensor init", "S2MM start", "CSI enable",
+		"sensor mode", "sensor AWB", "VTC reset", "MM2S stop",
+		"VTC/MMCM config", "MM2S config", "VTC enable", "MM2S start" };
+	using plan_t = uint32_t; // bit n set = action n scheduled
+
+	#define PIPELINE_DEP(act) (1U << (act))
+	/*!
+	 * Hardware ordering constraints between actions. Sensor I2C traffic and
+	 * delays, the S2MM/CSI restart and the display side only depend on each
+	 * other where listed, so the bring-up scheduler overlaps them.
+	 */
+	uint32_t const action_deps[ACT_END] = {
+		/* ACT_SENSOR_STANDBY */	0,
+		/* ACT_S2MM_STOP */			PIPELINE_DEP(ACT_SENSOR_STANDBY),
+		/* ACT_CSI_RESET */			PIPELINE_DEP(ACT_S2MM_STOP),
+		/* ACT_SENSOR_POWER_CYCLE */PIPELINE_DEP(ACT_S2MM_STOP),
+		/* ACT_S2MM_CONFIG */		PIPELINE_DEP(ACT_CSI_RESET),
+		/* ACT_GAMMA */				0,
+		/* ACT_SENSOR_INIT */		PIPELINE_DEP(ACT_SENSOR_POWER_CYCLE),
+		/* ACT_S2MM_START */		PIPELINE_DEP(ACT_S2MM_CONFIG) | PIPELINE_DEP(ACT_GAMMA),
+		/* ACT_CSI_ENABLE */		PIPELINE_DEP(ACT_S2MM_START),
+		/* ACT_SENSOR_MODE */		PIPELINE_DEP(ACT_CSI_ENABLE) | PIPELINE_DEP(ACT_SENSOR_INIT) | PIPELINE_DEP(ACT_SENSOR_STANDBY),
+		/* ACT_SENSOR_AWB */		PIPELINE_DEP(ACT_SENSOR_MODE) | PIPELINE_DEP(ACT_SENSOR_INIT),
+		/* ACT_OUTPUT_STOP */		0,
+		/* ACT_MM2S_STOP */			PIPELINE_DEP(ACT_OUTPUT_STOP),
+		/* ACT_OUTPUT_CONFIG */		PIPELINE_DEP(ACT_OUTPUT_STOP),
+		/* ACT_MM2S_CONFIG */		PIPELINE_DEP(ACT_MM2S_STOP),
+		/* ACT_OUTPUT_START */		PIPELINE_DEP(ACT_OUTPUT_CONFIG) | PIPELINE_DEP(ACT_MM2S_CONFIG),
+		/* ACT_MM2S_START */		PIPELINE_DEP(ACT_OUTPUT_START) | PIPELINE_DEP(ACT_MM2S_CONFIG),
+	};
+	#undef PIPELINE_DEP
+
+	using target_t = struct
+	{
+		Resolution res;
+		OV5640_cfg::mode_t mode;
+		OV5640_cfg::awb_t awb;
+		uint32_t gamma;
+	};
+
+	/*!
+	 * \brief What each pipeline stage is currently programmed with.
+	 */
+	using state_t = struct
+	{
+		bool sensor_ready;		// powered, initialized and streaming
+		OV5640_cfg::mode_t sensor_mode;
+		OV5640_cfg::awb_t sensor_awb;
+		bool csi_enabled;
+		uint16_t s2mm_h, s2mm_v;
+		bool mm2s_running;
+		uint16_t mm2s_h, mm2s_v;
+		bool output_valid;		// VTC and MMCM programmed
+		Resolution output_res;
+		bool gamma_valid;
+		uint32_t gamma;
+	};
+
+	inline bool scheduled(plan_t plan, action_t act) { return plan & (1U << act); }
+
+	/*!
+	 * \brief Smallest ordered set of actions taking the pipeline from state to
+	 * target. Sensor and output sides are planned independently, so a camera
+	 * mode change leaves the HDMI clocking alone and an output change does not
+	 * power-cycle the sensor. Pure function.
+	 */
+	inline plan_t plan(state_t const& cur, target_t const& tgt)
+	{
+		plan_t p = 0;
+		auto add = [&p](action_t act) { p |= 1U << act; };
+
+		// S2MM and MM2S share the frame stores, so both follow the output geometry
+		timing_t const* t = find_timing(tgt.res);
+		uint16_t const h = t ? t->h_active : 0;
+		uint16_t const v = t ? t->v_active : 0;
+
+		bool const sensor_cold = !cur.sensor_ready;
+		bool const mode_changed = sensor_cold || cur.sensor_mode != tgt.mode;
+		bool const s2mm_changed = cur.s2mm_h != h || cur.s2mm_v != v;
+		bool const output_changed = !cur.output_valid || cur.output_res != tgt.res;
+		bool const mm2s_changed = !cur.mm2s_running || cur.mm2s_h != h || cur.mm2s_v != v;
+
+		if (sensor_cold)
+		{
+			add(ACT_SENSOR_POWER_CYCLE);
+			add(ACT_SENSOR_INIT);
+		}
+		else if (mode_changed)
+		{
+			add(ACT_SENSOR_STANDBY);
+		}
+		if (mode_changed || s2mm_changed || !cur.csi_enabled)
+		{
+			//Channel reset clears its registers, so a stop always implies a full restart
+			add(ACT_S2MM_STOP);
+			add(ACT_CSI_RESET);
+			add(ACT_S2MM_CONFIG);
+			add(ACT_S2MM_START);
+			add(ACT_CSI_ENABLE);
+		}
+		if (mode_changed)
+			add(ACT_SENSOR_MODE);
+		//Sensor init resets the AWB registers, mode tables leave them alone
+		if (sensor_cold || cur.sensor_awb != tgt.awb)
+			add(ACT_SENSOR_AWB);
+		if (!cur.gamma_valid || cur.gamma != tgt.gamma)
+			add(ACT_GAMMA);
+
+		if (output_changed)
+		{
+			add(ACT_OUTPUT_STOP);
+			add(ACT_OUTPUT_CONFIG);
+			add(ACT_OUTPUT_START);
+		}
+		if (output_changed || mm2s_changed)
+		{
+			add(ACT_MM2S_STOP);
+			add(ACT_MM2S_CONFIG);
+			add(ACT_MM2S_START);
+		}
+		return p;
+	}
+
+	/*!
+	 * \brief One executed transition with the cost of every action taken.
+	 */
+	using transition_t = struct
+	{
+		target_t from, to;
+		bool from_valid;
+		plan_t plan;
+		uint32_t start_us[ACT_END];	// relative to the start of the transition
+		uint32_t cost_us[ACT_END];
+		uint32_t total_us;
+		uint32_t first_frame_us;	// until a new S2MM frame was read by MM2S, 0 if none
+	};
+}
+
+/*!
+ * \brief Owns the camera-to-display pipeline configuration. Tracks what each
+ * stage is programmed with and only touches the stages a new target needs.
+ */
+template <typename VDMA>
+class PipelineController
+{
+public:
+	PipelineController(VDMA& vdma, OV5640& cam, VideoOutput& vid,
+			uint32_t csi_base_addr, uint32_t gamma_base_addr) :
+		vdma_(vdma), cam_(cam), vid_(vid),
+		csi_base_addr_(csi_base_addr), gamma_base_addr_(gamma_base_addr),
+		state_{}, history_{}, history_count_(0), sched_(*this)
+	{
+	}
+
+	/*!
+	 * \brief Reconfigures the pipeline for tgt, executing only the planned
+	 * actions. Returns the recorded transition.
+	 */
+	Pipeline::transition_t const& apply(Pipeline::target_t const& tgt)
+	{
+		if (!find_timing(tgt.res) || tgt.mode >= OV5640_cfg::MODE_END) {
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+		return execute(tgt, Pipeline::plan(state_, tgt));
+	}
+
+	/*!
+	 * \brief Full restart of every stage, including a sensor power cycle.
+	 */
+	Pipeline::transition_t const& restart(Pipeline::target_t const& tgt)
+	{
+		state_ = {};
+		return apply(tgt);
+	}
+
+	/*!
+	 * \brief Runs the given actions again for the current target, e.g. to
+	 * restart a single stage after an error.
+	 */
+	Pipeline::transition_t const& rerun(Pipeline::plan_t plan)
+	{
+		return execute(target_, plan);
+	}
+
+	Pipeline::state_t const& state() const { return state_; }
+	Pipeline::target_t const& target() const { return target_; }
+
+	//! \brief Transitions executed since construction
+	size_t transitions() const { return history_count_; }
+
+	size_t historyCount() const
+	{
+		return history_count_ < history_len_ ? history_count_ : history_len_;
+	}
+	//! \brief i-th most recent transition, 0 being the latest
+	Pipeline::transition_t const& history(size_t i) const
+	{
+		return history_[(history_count_ - 1 - i) % history_len_];
+	}
+
+	static void printTransition(Pipeline::transition_t const& tr)
+	{
+		if (tr.from_valid)
+			xil_printf("Transition mode %d/res %d -> mode %d/res %d: %u us, first frame %u us\r\n",
+			           tr.from.mode, static_cast<int>(tr.from.res),
+			           tr.to.mode, static_cast<int>(tr.to.res), tr.total_us, tr.first_frame_us);
+		else
+			xil_printf("Bring-up mode %d/res %d: %u us, first frame %u us\r\n",
+			           tr.to.mode, static_cast<int>(tr.to.res), tr.total_us, tr.first_frame_us);
+		for (int act = 0; act < Pipeline::ACT_END; ++act)
+		{
+			if (Pipeline::scheduled(tr.plan, static_cast<Pipeline::action_t>(act)))
+				xil_printf("  %-20s @%8u us %8u us\r\n", Pipeline::action_names[act],
+				           tr.start_us[act], tr.cost_us[act]);
+		}
+	}
+
+	/*!
+	 * \brief Scheduler hook: starts (first) or polls action id. Returns true
+	 * once the action has completed.
+	 */
+	bool step(size_t id, bool first)
+	{
+		Pipeline::action_t const act = static_cast<Pipeline::action_t>(id);
+		Pipeline::target_t const& tgt = pending_;
+		if (first)
+			phase_[act] = 0;
+
+		switch (act)
+		{
+		case Pipeline::ACT_SENSOR_POWER_CYCLE:
+			if (phase_[act] == 0)
+			{
+				state_.sensor_ready = false;
+				cam_.set_power(false);
+				deadline_[act] = time_us() + OV5640::power_off_us;
+				phase_[act] = 1;
+			}
+			else if (phase_[act] == 1 && time_us() >= deadline_[act])
+			{
+				cam_.set_power(true);
+				deadline_[act] = time_us() + OV5640::power_on_us;
+				phase_[act] = 2;
+			}
+			return phase_[act] == 2 && time_us() >= deadline_[act];
+		case Pipeline::ACT_SENSOR_INIT:
+			if (phase_[act] == 0)
+			{
+				cam_.soft_reset();
+				deadline_[act] = time_us() + OV5640::soft_reset_us;
+				phase_[act] = 1;
+			}
+			else if (phase_[act] == 1 && time_us() >= deadline_[act])
+			{
+				cam_.start_config(OV5640_cfg::cfg_init_, SIZEOF_ARRAY(OV5640_cfg::cfg_init_), false);
+				phase_[act] = 2;
+			}
+			return phase_[act] == 2 && !cam_.config_busy();
+		case Pipeline::ACT_SENSOR_MODE:
+			if (first)
+				cam_.start_mode(tgt.mode);
+			if (cam_.config_busy())
+				return false;
+			state_.sensor_mode = tgt.mode;
+			state_.sensor_ready = true;
+			return true;
+		case Pipeline::ACT_SENSOR_AWB:
+			if (first)
+				cam_.start_awb(tgt.awb);
+			if (cam_.config_busy())
+				return false;
+			state_.sensor_awb = tgt.awb;
+			return true;
+		case Pipeline::ACT_OUTPUT_CONFIG:
+			if (first)
+				vid_.startConfigure(tgt.res);
+			if (!vid_.isLocked())
+				return false;
+			vid_.finishConfigure(tgt.res);
+			return true;
+		default:
+			run(act, tgt);
+			return true;
+		}
+	}
+
+private:
+	Pipeline::transition_t const& execute(Pipeline::target_t const& tgt, Pipeline::plan_t plan)
+	{
+		Pipeline::transition_t& tr = history_[history_count_++ % history_len_];
+		tr = {};
+		tr.from = target_;
+		tr.from_valid = state_.sensor_ready && state_.output_valid;
+		tr.to = tgt;
+		tr.plan = plan;
+
+		pending_ = tgt;
+		sched_.clear();
+		for (int act = 0; act < Pipeline::ACT_END; ++act)
+		{
+			if (Pipeline::scheduled(plan, static_cast<Pipeline::action_t>(act)))
+				sched_.add(act, Pipeline::action_deps[act]);
+		}
+		typename Scheduler::Errc const errc = sched_.run(timeout_us_);
+		for (int act = 0; act < Pipeline::ACT_END; ++act)
+		{
+			tr.start_us[act] = sched_.startedAt(act);
+			tr.cost_us[act] = sched_.finishedAt(act) - sched_.startedAt(act);
+		}
+		tr.total_us = time_us() - sched_.runStart();
+		if (errc != Scheduler::OK)
+		{
+			throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+
+		//First displayed frame: S2MM completes a frame, then MM2S moves to it
+		if (plan && vdma_.waitWriteFrames(1, timeout_us_) && vdma_.waitReadFrames(1, timeout_us_))
+			tr.first_frame_us = time_us() - sched_.runStart();
+		target_ = tgt;
+		return tr;
+	}
+
+	void run(Pipeline::action_t act, Pipeline::target_t const& tgt)
+	{
+		timing_t const& t = *find_timing(tgt.res);
+		switch (act)
+		{
+		case Pipeline::ACT_SENSOR_STANDBY:
+			//[7]=0 Software reset; [6]=1 Software power down; Default=0x02
+			cam_.writeReg(0x3008, 0x42);
+			break;
+		case Pipeline::ACT_S2MM_STOP:
+			vdma_.resetWrite();
+			state_.s2mm_h = state_.s2mm_v = 0;
+			break;
+		case Pipeline::ACT_CSI_RESET:
+			//Assert soft reset, then de-assert but do NOT enable yet
+			Mmio::write32(csi_base_addr_ + XCSI_CCR_OFFSET, XCSI_CCR_SOFTRESET_MASK);
+			Mmio::write32(csi_base_addr_ + XCSI_CCR_OFFSET, 0x00000000);
+			state_.csi_enabled = false;
+			break;
+		case Pipeline::ACT_S2MM_CONFIG:
+			vdma_.configureWrite(t.h_active, t.v_active);
+			break;
+		case Pipeline::ACT_GAMMA:
+			Mmio::write32(gamma_base_addr_, tgt.gamma);
+			state_.gamma = tgt.gamma;
+			state_.gamma_valid = true;
+			break;
+		case Pipeline::ACT_S2MM_START:
+			vdma_.enableWrite();
+			state_.s2mm_h = t.h_active;
+			state_.s2mm_v = t.v_active;
+			break;
+		case Pipeline::ACT_CSI_ENABLE:
+			Mmio::write32(csi_base_addr_ + XCSI_CCR_OFFSET, XCSI_CCR_COREENB_MASK);
+			state_.csi_enabled = true;
+			break;
+		case Pipeline::ACT_OUTPUT_STOP:
+			vid_.reset();
+			state_.output_valid = false;
+			break;
+		case Pipeline::ACT_MM2S_STOP:
+			vdma_.resetRead();
+			state_.mm2s_running = false;
+			break;
+		case Pipeline::ACT_MM2S_CONFIG:
+			vdma_.configureRead(t.h_active, t.v_active);
+			break;
+		case Pipeline::ACT_OUTPUT_START:
+			vid_.enable();
+			state_.output_res = tgt.res;
+			state_.output_valid = true;
+			break;
+		case Pipeline::ACT_MM2S_START:
+			vdma_.enableRead();
+			state_.mm2s_h = t.h_active;
+			state_.mm2s_v = t.v_active;
+			state_.mm2s_running = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+private:
+	VDMA& vdma_;
+	OV5640& cam_;
+	VideoOutput& vid_;
+	uint32_t const csi_base_addr_;
+	uint32_t const gamma_base_addr_;
+	Pipeline::state_t state_;
+	Pipeline::target_t target_ = {};
+	static size_t const history_len_ = 8;
+	Pipeline::transition_t history_[history_len_];
+	size_t history_count_;
+	using Scheduler = BringUpScheduler<PipelineController, Pipeline::ACT_END>;
+	Scheduler sched_;
+	Pipeline::target_t pending_ = {};
+	uint8_t phase_[Pipeline::ACT_END] = {};
+	uint64_t deadline_[Pipeline::ACT_END] = {};
+	uint32_t const timeout_us_ = 5000000;
+};
+
+} /* namespace digilent */
+
+#endif /* PIPELINECONTROLLER_H_ */
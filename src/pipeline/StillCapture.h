@@ -0,0 +1,233 @@
+/*
+ * StillCapture.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef STILLCAPTURE_H_
+#define STILLCAPTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameMonitor.h"
+#include "../ov5640/OV5640.h"
+#include "../util/Timer.h"
+#include "../util/Profile.h"
+
+#include "xaxivdma.h"
+#include "xil_cache.h"
+
+namespace digilent {
+
+namespace StillCapture {
+	//! \brief Still frame store offset from the VDMA frame buffer base, past three 1080p RGB stores
+	uint32_t const store_offset = 0x01400000;
+	//! \brief Offset of the store the other S2MM frames around a still go to, past the still store
+	uint32_t const scratch_offset = 0x02400000;
+	size_t const delta_max = 48;
+
+	using config_t = struct
+	{
+		uint16_t skip_frames;	// good still frames dropped before the one kept
+		uint16_t tries;			// still frames waited for beyond those
+		uint32_t timeout_us;	// per frame
+		bool early_return;		// queue the return delta while the kept frame is still coming in
+	};
+	config_t const defaults = {0, 3, 1000000, true};
+
+	using result_t = struct
+	{
+		using Errc = enum { OK = 0, ERR_MODE, ERR_STILL, ERR_PREVIEW };
+		Errc errc;
+		OV5640_cfg::mode_t preview;
+		bool grouped_in, grouped_out;	// delta written under group hold, not in power down
+		bool early;						// return delta queued before the still frame ended
+		uint8_t delta_in, delta_out;	// registers written each way
+		uint16_t width, height;
+		uint32_t addr, size;			// still frame in DDR
+		uint16_t frames;				// still frames received, skipped and bad ones included
+		uint16_t bad_frames;			// ended with an S2MM size error
+		uint32_t switch_us;				// shutter to the still registers written and S2MM armed
+		uint32_t shutter_us;			// shutter to the still frame stored
+		uint32_t restore_us;			// still frame stored to S2MM back on the preview ring
+		uint32_t gap_us;				// last preview frame stored to the next one
+	};
+
+	char const* const errc_names[] = { "OK", "preview mode has no still delta", "no still frame", "preview did not resume" };
+}
+
+/*!
+ * \brief Full resolution stills from a running preview. The register deltas
+ * between every preview mode table and the still table, both ways, are
+ * worked out once at construction, so a capture only writes the registers
+ * that differ. MM2S is parked on the frame it is showing for the duration.
+ * One S2MM frame store points at the still store outside the preview ring
+ * and the others at a scratch buffer, so the frame after the still cannot
+ * overwrite it before S2MM is stopped.
+ *
+ * Where both deltas fit group hold (1080p15 preview) the sensor never stops
+ * streaming: it changes mode at a frame boundary each way, and the return
+ * delta is queued as soon as the still frame's FS packet is seen, so the
+ * sensor is back in preview mode right after it and only the first preview
+ * frame is waited for. Otherwise the deltas are written in software power
+ * down. The still is stored as the PL leaves it, demosaiced RGB at the S2MM
+ * stream width.
+ */
+template <typename VDMA, typename MON>
+class StillCapturer
+{
+public:
+	StillCapturer(OV5640& cam, VDMA& vdma, MON& mon, uint32_t store_addr, uint32_t scratch_addr) :
+		cam_(cam), vdma_(vdma), mon_(mon), store_addr_(store_addr), scratch_addr_(scratch_addr)
+	{
+		using namespace OV5640_cfg;
+		for (int m = 0; m < MODE_END; ++m)
+		{
+			in_[m].count = config_delta(modes[m].cfg, modes[m].cfg_size,
+					cfg_5mp_still_, SIZEOF_ARRAY(cfg_5mp_still_), in_[m].cfg, StillCapture::delta_max);
+			out_[m].count = config_delta(cfg_5mp_still_, SIZEOF_ARRAY(cfg_5mp_still_),
+					modes[m].cfg, modes[m].cfg_size, out_[m].cfg, StillCapture::delta_max);
+		}
+	}
+
+	uint32_t storeAddr() const { return store_addr_; }
+
+	/*!
+	 * \brief Takes one still while the sensor streams the given preview mode
+	 * into S2MM frames of s2mm_h x s2mm_v, and returns to that preview.
+	 * S2MM size errors are expected around the switches; callers keep error
+	 * recovery off meanwhile.
+	 */
+	StillCapture::result_t capture(OV5640_cfg::mode_t preview, uint16_t s2mm_h, uint16_t s2mm_v,
+			StillCapture::config_t const& cfg = StillCapture::defaults)
+	{
+		PROFILE_ZONE("StillCapturer::capture");
+		OV5640_cfg::mode_info_t const& still = OV5640_cfg::still_info;
+		StillCapture::result_t r = {};
+		r.preview = preview;
+		r.width = still.width;
+		r.height = still.height;
+		r.addr = store_addr_;
+		r.size = (uint32_t)still.width * still.height * vdma_.writeBytesPerPixel();
+		if (preview >= OV5640_cfg::MODE_END ||
+				in_[preview].count > StillCapture::delta_max || out_[preview].count > StillCapture::delta_max)
+		{
+			r.errc = StillCapture::result_t::ERR_MODE;
+			return r;
+		}
+		delta_t const& in = in_[preview];
+		delta_t const& out = out_[preview];
+		r.delta_in = (uint8_t)in.count;
+		r.delta_out = (uint8_t)out.count;
+		bool const out_groupable = OV5640::fitsGroup(out.cfg, out.count);
+
+		//Shutter: the display holds the last preview frame from here on
+		uint64_t const t0 = time_us();
+		vdma_.stopWrite();
+		vdma_.parkRead();
+		FrameMonitor::expect_t const preview_expect = mon_.expected();
+		mon_.expect(FrameMonitor::expect_t{still.height, (uint16_t)(still.width * 5 / 4), still.height});
+		r.grouped_in = cam_.writeDelta(in.cfg, in.count);
+		//Only the frame store S2MM resumes on writes the still store, so the
+		//frame after the kept one cannot overwrite it before S2MM stops
+		int const still_frm = vdma_.currentWriteFrame();
+		vdma_.configureWriteStore(still.width, still.height, store_addr_, scratch_addr_, still_frm);
+		uint32_t const fs0 = mon_.counters().fs;
+		vdma_.enableWrite();
+		r.switch_us = (uint32_t)(time_us() - t0);
+
+		uint32_t const size_errors = XAXIVDMA_SR_ERR_FSZ_LESS_MASK | XAXIVDMA_SR_ERR_LSZ_LESS_MASK |
+				XAXIVDMA_SR_ERR_FSZ_MORE_MASK;
+		bool stored = false;
+		uint16_t good = 0;
+		uint32_t ended = 0;	// S2MM frames since the switch, scratch ones included
+		uint32_t const ended_max = (uint32_t)(cfg.skip_frames + cfg.tries) * vdma_.numFrameStores();
+		while (!stored && r.frames < cfg.skip_frames + cfg.tries && ended < ended_max)
+		{
+			int const frm = vdma_.currentWriteFrame();
+			//Once the kept frame has started, the return can go in under group hold
+			bool const queue = frm == still_frm && cfg.early_return && out_groupable && !r.early &&
+					good == cfg.skip_frames;
+			vdma_.clearWriteErrors();
+			if (!waitStill(frm, queue, out, fs0 + ended, cfg.timeout_us, r.early))
+				break;
+			++ended;
+			if (frm != still_frm)
+				continue;	//Scratch, the still store comes round again
+			++r.frames;
+			if (vdma_.writeStatus() & size_errors)
+			{
+				++r.bad_frames;
+				if (r.early)
+					break;	//Already on the way back, no retry
+				continue;
+			}
+			stored = good++ == cfg.skip_frames;
+		}
+		uint64_t const t_stored = time_us();
+		r.shutter_us = (uint32_t)(t_stored - t0);
+
+		vdma_.stopWrite();
+		if (r.early)
+			r.grouped_out = true;
+		else
+			r.grouped_out = cam_.writeDelta(out.cfg, out.count, false);	//Group hold would wait out another still frame
+		mon_.expect(preview_expect);
+		vdma_.configureWrite(s2mm_h, s2mm_v);
+		vdma_.enableWrite();
+		r.restore_us = (uint32_t)(time_us() - t_stored);
+
+		bool const resumed = vdma_.waitWriteFrames(1, cfg.timeout_us) == 1;
+		r.gap_us = (uint32_t)(time_us() - t0);
+		vdma_.unparkRead();
+		vdma_.clearWriteErrors();
+
+		if (stored)
+			Xil_DCacheInvalidateRange((INTPTR)store_addr_, r.size);
+		r.errc = !stored ? StillCapture::result_t::ERR_STILL :
+				!resumed ? StillCapture::result_t::ERR_PREVIEW : StillCapture::result_t::OK;
+		return r;
+	}
+
+private:
+	struct delta_t
+	{
+		OV5640_cfg::config_word_t cfg[StillCapture::delta_max];
+		size_t count;
+	};
+
+	/*!
+	 * \brief Waits for the S2MM frame in store frm to end. With queue set,
+	 * writes the return delta under group hold as soon as the CSI-2 FS of
+	 * that frame arrives, the one after fs_before, and sets queued.
+	 */
+	bool waitStill(int frm, bool queue, delta_t const& out, uint32_t fs_before, uint32_t timeout_us, bool& queued)
+	{
+		uint64_t const t_end = time_us() + timeout_us;
+		while (time_us() < t_end)
+		{
+			if (vdma_.currentWriteFrame() != frm)
+				return true;
+			if (queue && !queued && (int32_t)(mon_.counters().fs - fs_before) > 0)
+			{
+				cam_.writeDelta(out.cfg, out.count);
+				queued = true;
+			}
+		}
+		return false;
+	}
+
+private:
+	OV5640& cam_;
+	VDMA& vdma_;
+	MON& mon_;
+	uint32_t const store_addr_;
+	uint32_t const scratch_addr_;
+	delta_t in_[OV5640_cfg::MODE_END];		// preview mode to still
+	delta_t out_[OV5640_cfg::MODE_END];	// still to preview mode
+};
+
+} /* namespace digilent */
+
+#endif /* STILLCAPTURE_H_ */
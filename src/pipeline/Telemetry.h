@@ -0,0 +1,297 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameMonitor.h"
+
+#include "xaxivdma.h"
+#include "xtime_l.h"
+
+namespace digilent {
+
+namespace Telemetry {
+	size_t const history_size = 16;	// one second windows, power of two
+
+	//! \brief Event counts over some interval
+	using counters_t = struct
+	{
+		uint32_t csi_frames;	// CSI-2 RX frame received
+		uint32_t csi_packets;	// long packets, from the CSR packet counter
+		uint32_t csi_ecc1;		// single bit header errors, corrected
+		uint32_t csi_ecc2;		// double bit header errors, packet lost
+		uint32_t csi_crc;
+		uint32_t csi_sot;		// SoT and SoT sync errors on any lane
+		uint32_t csi_wc;		// word count corruption
+		uint32_t csi_frame_err;	// VCx frame level error
+		uint32_t csi_overflow;	// line buffer or short packet FIFO full
+		uint32_t csi_mismatches;	// frames with unexpected geometry
+		uint32_t s2mm_frames;
+		uint32_t mm2s_frames;
+		uint32_t s2mm_errors;	// DMASR error bits newly set
+		uint32_t mm2s_errors;
+	};
+
+	using minmax_t = struct { uint16_t min, max; };
+
+	/*!
+	 * \brief One closed sampling window. Rates are frames per 10 s so that
+	 * 14.9 fps reads as 149. dropped is CSI-2 frames that did not reach DDR.
+	 */
+	using snapshot_t = struct
+	{
+		uint32_t t_ms;			// window end, ms since the sampler started
+		uint16_t csi_fps_x10;
+		uint16_t s2mm_fps_x10;
+		uint16_t mm2s_fps_x10;
+		uint16_t reserved;
+		uint32_t dropped;
+		counters_t delta;
+		minmax_t lines;			// VC0 line count at frame end
+		minmax_t bytes;			// VC0 byte count at frame end
+		uint32_t s2mm_sr;		// DMASR at window end
+		uint32_t mm2s_sr;
+	};
+
+	//! \brief Since-start extremes of the per-window rates
+	using rates_t = struct { minmax_t csi, s2mm, mm2s; };
+
+	inline void track(minmax_t& mm, uint16_t v)
+	{
+		if (v < mm.min) mm.min = v;
+		if (v > mm.max) mm.max = v;
+	}
+	inline void add(counters_t& acc, counters_t const& d)
+	{
+		uint32_t* a = reinterpret_cast<uint32_t*>(&acc);
+		uint32_t const* b = reinterpret_cast<uint32_t const*>(&d);
+		for (size_t i = 0; i < sizeof(counters_t) / sizeof(uint32_t); ++i)
+			a[i] += b[i];
+	}
+}
+
+/*!
+ * \brief Samples CSI-2 RX and VDMA status from a periodic timer tick and keeps
+ * counters, min/max and a short history of one second windows. CSI-2 events
+ * come from the counters of the frame monitor (CsiFrameMonitor), which owns
+ * the controller's interrupt status.
+ *
+ * tick() is meant to run in interrupt context at a fixed rate (1 kHz is
+ * plenty: one sample sees at most one frame at 60 fps). It does a handful of
+ * register reads and no printing. Readers in the main loop use snapshot(),
+ * total() and rates(), which copy under a sequence counter and retry if a
+ * window was closed in between.
+ *
+ * VDMA DMASR errors are counted on their rising edge and left for the
+ * driver to clear.
+ */
+template <typename VDMA, typename CSI>
+class PipelineTelemetry
+{
+public:
+	PipelineTelemetry(VDMA& vdma, CSI& csi, uint32_t rate_Hz) :
+		vdma_(vdma), csi_(csi), rate_Hz_(rate_Hz)
+	{
+		reset();
+	}
+
+	//! \brief Starts over, e.g. after a mode change. Call with the tick masked or idle.
+	void reset()
+	{
+		window_ = Telemetry::counters_t();
+		total_ = Telemetry::counters_t();
+		rates_ = {{0xFFFF, 0}, {0xFFFF, 0}, {0xFFFF, 0}};
+		lines_ = bytes_ = {0xFFFF, 0};
+		window_ticks_ = 0;
+		ticks_ = 0;
+		history_count_ = 0;
+		tick_max_ = 0;
+		last_s2mm_frame_ = vdma_.currentWriteFrame();
+		last_mm2s_frame_ = vdma_.currentReadFrame();
+		last_pkt_ = csi_.packetCount();
+		last_csi_ = csi_.counters();
+		last_s2mm_err_ = vdma_.writeStatus() & XAXIVDMA_SR_ERR_ALL_MASK;
+		last_mm2s_err_ = vdma_.readStatus() & XAXIVDMA_SR_ERR_ALL_MASK;
+	}
+
+	//! \brief Timer callback, ctx is the PipelineTelemetry
+	static void tick(void* ctx)
+	{
+		static_cast<PipelineTelemetry*>(ctx)->sample();
+	}
+
+	uint32_t rate() const { return rate_Hz_; }
+	uint32_t ticks() const { return ticks_; }
+	//! \brief Longest sample() so far, in XTime ticks
+	uint32_t tickMax() const { return tick_max_; }
+
+	//! \brief Number of closed windows available, at most history_size
+	size_t historyCount() const
+	{
+		return history_count_ < Telemetry::history_size ? history_count_ : Telemetry::history_size;
+	}
+
+	/*!
+	 * \brief Copies closed window i, 0 being the most recent. False if there
+	 * is no such window.
+	 */
+	bool snapshot(size_t i, Telemetry::snapshot_t& out) const
+	{
+		bool ok;
+		read([&] {
+			ok = i < historyCount();
+			if (ok)
+				out = history_[(history_count_ - 1 - i) & (Telemetry::history_size - 1)];
+		});
+		return ok;
+	}
+
+	//! \brief Counts since start, including the open window
+	Telemetry::counters_t total() const
+	{
+		Telemetry::counters_t t;
+		read([&] {
+			t = total_;
+			Telemetry::add(t, window_);
+		});
+		return t;
+	}
+
+	Telemetry::rates_t rates() const
+	{
+		Telemetry::rates_t r;
+		read([&] { r = rates_; });
+		return r;
+	}
+
+private:
+	void sample()
+	{
+		XTime t0, t1;
+		XTime_GetTime(&t0);
+
+		int const s2mm = vdma_.currentWriteFrame();
+		int const mm2s = vdma_.currentReadFrame();
+		int const n = vdma_.numFrameStores();
+		window_.s2mm_frames += (s2mm - last_s2mm_frame_ + n) % n;
+		window_.mm2s_frames += (mm2s - last_mm2s_frame_ + n) % n;
+		last_s2mm_frame_ = s2mm;
+		last_mm2s_frame_ = mm2s;
+
+		FrameMonitor::counters_t const c = csi_.counters();
+		if (c.frames != last_csi_.frames)
+		{
+			Telemetry::track(lines_, csi_.lastLines());
+			Telemetry::track(bytes_, csi_.lastBytes());
+		}
+		window_.csi_frames += c.frames - last_csi_.frames;
+		window_.csi_ecc1 += c.ecc1 - last_csi_.ecc1;
+		window_.csi_ecc2 += c.ecc2 - last_csi_.ecc2;
+		window_.csi_crc += c.crc - last_csi_.crc;
+		window_.csi_sot += c.sot - last_csi_.sot;
+		window_.csi_wc += c.wc - last_csi_.wc;
+		window_.csi_frame_err += c.frame_err - last_csi_.frame_err;
+		window_.csi_overflow += c.overflow - last_csi_.overflow;
+		window_.csi_mismatches += c.mismatches - last_csi_.mismatches;
+		last_csi_ = c;
+
+		uint32_t const pkt = csi_.packetCount();
+		window_.csi_packets += (pkt - last_pkt_) & 0xFFFF;
+		last_pkt_ = pkt;
+
+		uint32_t const s2mm_sr = vdma_.writeStatus();
+		uint32_t const mm2s_sr = vdma_.readStatus();
+		if ((s2mm_sr & XAXIVDMA_SR_ERR_ALL_MASK) & ~last_s2mm_err_) ++window_.s2mm_errors;
+		if ((mm2s_sr & XAXIVDMA_SR_ERR_ALL_MASK) & ~last_mm2s_err_) ++window_.mm2s_errors;
+		last_s2mm_err_ = s2mm_sr & XAXIVDMA_SR_ERR_ALL_MASK;
+		last_mm2s_err_ = mm2s_sr & XAXIVDMA_SR_ERR_ALL_MASK;
+
+		++ticks_;
+		if (++window_ticks_ >= rate_Hz_)
+			close(s2mm_sr, mm2s_sr);
+
+		XTime_GetTime(&t1);
+		if (t1 - t0 > tick_max_)
+			tick_max_ = t1 - t0;
+	}
+
+	void close(uint32_t s2mm_sr, uint32_t mm2s_sr)
+	{
+		__atomic_add_fetch(&seq_, 1, __ATOMIC_RELEASE);
+
+		Telemetry::snapshot_t& s = history_[history_count_ & (Telemetry::history_size - 1)];
+		s.t_ms = (uint32_t)((uint64_t)ticks_ * 1000 / rate_Hz_);
+		s.csi_fps_x10 = fps_x10(window_.csi_frames);
+		s.s2mm_fps_x10 = fps_x10(window_.s2mm_frames);
+		s.mm2s_fps_x10 = fps_x10(window_.mm2s_frames);
+		s.reserved = 0;
+		s.dropped = window_.csi_frames > window_.s2mm_frames ? window_.csi_frames - window_.s2mm_frames : 0;
+		s.delta = window_;
+		s.lines = lines_;
+		s.bytes = bytes_;
+		s.s2mm_sr = s2mm_sr;
+		s.mm2s_sr = mm2s_sr;
+		++history_count_;
+
+		Telemetry::track(rates_.csi, s.csi_fps_x10);
+		Telemetry::track(rates_.s2mm, s.s2mm_fps_x10);
+		Telemetry::track(rates_.mm2s, s.mm2s_fps_x10);
+		Telemetry::add(total_, window_);
+		window_ = Telemetry::counters_t();
+		lines_ = bytes_ = {0xFFFF, 0};
+		window_ticks_ = 0;
+
+		__atomic_add_fetch(&seq_, 1, __ATOMIC_RELEASE);
+	}
+
+	uint16_t fps_x10(uint32_t frames) const
+	{
+		return (uint16_t)(frames * 10 * rate_Hz_ / window_ticks_);
+	}
+
+	//! Runs f until it completed without a window being closed meanwhile
+	template <typename F>
+	void read(F f) const
+	{
+		uint32_t s;
+		do
+		{
+			s = __atomic_load_n(&seq_, __ATOMIC_ACQUIRE);
+			f();
+		} while ((s & 1) || s != __atomic_load_n(&seq_, __ATOMIC_ACQUIRE));
+	}
+
+private:
+	VDMA& vdma_;
+	CSI& csi_;
+	uint32_t const rate_Hz_;
+
+	Telemetry::counters_t window_;	// open window
+	Telemetry::counters_t total_;	// closed windows
+	Telemetry::minmax_t lines_, bytes_;
+	Telemetry::rates_t rates_;
+	Telemetry::snapshot_t history_[Telemetry::history_size];
+	uint32_t history_count_;
+	uint32_t window_ticks_;
+	uint32_t ticks_;
+	uint32_t tick_max_;
+	uint32_t seq_ = 0;
+
+	int last_s2mm_frame_;
+	int last_mm2s_frame_;
+	uint32_t last_pkt_;
+	FrameMonitor::counters_t last_csi_;
+	uint32_t last_s2mm_err_;
+	uint32_t last_mm2s_err_;
+};
+
+} /* namespace digilent */
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,263 @@
+/*
+ * TimingSweep.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TIMINGSWEEP_H_
+#define TIMINGSWEEP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ColorBarTest.h"
+#include "FrameMonitor.h"
+#include "FrameView.h"
+#include "../ov5640/OV5640.h"
+
+#include "xaxivdma.h"
+#include "xil_cache.h"
+#include "xtime_l.h"
+
+namespace digilent {
+
+namespace TimingSweep {
+	size_t const step_max = 64;
+
+	using config_t = struct
+	{
+		uint16_t vts_step;		// VTS resolution of the search, lines
+		uint16_t hts_step;		// HTS resolution of the search, pixel clocks
+		uint16_t vblank_min;	// VTS is never taken below height + vblank_min
+		uint16_t frames;		// frames checked per step
+		uint16_t settle_frames;	// frames skipped after each timing change
+		uint32_t timeout_us;	// per frame
+	};
+	config_t const defaults = {16, 32, 4, 30, 3, 500000};
+
+	//! \brief One timing tried. Counts are over the checked frames.
+	using step_t = struct
+	{
+		uint16_t hts, vts;
+		uint16_t frames;		// frames that arrived, short of config_t::frames on a stall
+		uint16_t bad_lines;		// CSI-2 geometry mismatches and frame level errors
+		uint16_t vdma_errors;	// frames ending with S2MM FSZ_LESS/LSZ_LESS/FSZ_MORE
+		uint16_t hash_changes;	// frames differing from the reference colour bars
+		uint32_t period_us;		// mean FS to FS, 0 if not measured
+		bool stable;
+	};
+
+	using result_t = struct
+	{
+		using Errc = enum { OK = 0, ERR_NOMINAL };	// nominal timing already unstable
+		Errc errc;
+		OV5640_cfg::mode_t mode;
+		uint16_t hts_nominal, vts_nominal;
+		uint16_t hts_min, vts_min;			// smallest stable values found
+		uint32_t fps_nominal_x100;
+		uint32_t fps_max_x100;				// predicted from hts_min * vts_min
+		uint32_t fps_measured_x100;			// from the FS period at hts_min, vts_min
+		size_t steps_run;					// steps beyond step_max ran but are not listed
+		size_t step_count;
+		step_t steps[step_max];
+	};
+
+	/*!
+	 * \brief FNV-1a over every 8th line and the last line. Truncated or
+	 * shifted frames change the hash; the colour bars themselves are noise free.
+	 */
+	inline uint32_t frameHash(frame_view_t const& f)
+	{
+		uint32_t h = 2166136261u;
+		if (!f.height)
+			return h;
+		for (uint32_t y = 0;; y += 8)
+		{
+			if (y >= f.height)
+				y = f.height - 1u;
+			uint32_t const* line = reinterpret_cast<uint32_t const*>(f.data + y * f.stride);
+			for (uint32_t i = 0; i < f.stride / 4; ++i)
+			{
+				h ^= line[i];
+				h *= 16777619u;
+			}
+			if (y == f.height - 1u)
+				break;
+		}
+		return h;
+	}
+
+	/*!
+	 * \brief Smallest value in [floor, nominal] at which stable() holds, to
+	 * within step, taking a value that holds to hold everywhere above it.
+	 * nominal is known to hold. The floor is tried first, then the range is
+	 * halved: about log2((nominal - floor) / step) + 1 tries.
+	 */
+	template <typename F>
+	int32_t bisect(int32_t floor, int32_t nominal, uint16_t step, F stable)
+	{
+		if (floor >= nominal)
+			return nominal;
+		if (stable(floor))
+			return floor;
+		int32_t good = nominal, bad = floor;
+		while (good - bad > (step ? step : 1))
+		{
+			int32_t const mid = bad + (good - bad) / 2;
+			if (stable(mid))
+				good = mid;
+			else
+				bad = mid;
+		}
+		return good;
+	}
+
+	//! \brief Frame rate for the given timing at the pixel clock of the nominal one
+	inline uint32_t scaleFps(uint32_t fps_x100, uint16_t hts0, uint16_t vts0, uint16_t hts, uint16_t vts)
+	{
+		return (uint32_t)((uint64_t)fps_x100 * hts0 * vts0 / ((uint32_t)hts * vts));
+	}
+}
+
+/*!
+ * \brief Holds the sensor on its colour bars, applies one HTS/VTS pair under
+ * group hold and checks a number of frames for CSI-2 geometry, S2MM size
+ * errors and an unchanged image.
+ */
+template <typename VDMA, typename MON>
+class TimingProbe
+{
+public:
+	TimingProbe(OV5640& cam, VDMA& vdma, MON& mon, TimingSweep::config_t const& cfg) :
+		cam_(cam), vdma_(vdma), mon_(mon), cfg_(cfg)
+	{
+	}
+
+	//! \brief Takes the reference image at the current timing
+	bool reference()
+	{
+		if (vdma_.waitWriteFrames(cfg_.settle_frames, cfg_.timeout_us * cfg_.settle_frames) < cfg_.settle_frames)
+			return false;
+		ref_hash_ = hash();
+		return true;
+	}
+
+	TimingSweep::step_t run(uint16_t hts, uint16_t vts)
+	{
+		TimingSweep::step_t s = {hts, vts, 0, 0, 0, 0, 0, false};
+		cam_.set_timing(hts, vts);
+		//Restarts the monitor's settle count and period statistics
+		mon_.expect(mon_.expected());
+		vdma_.waitWriteFrames(cfg_.settle_frames, cfg_.timeout_us * cfg_.settle_frames);
+		vdma_.clearWriteErrors();
+		FrameMonitor::counters_t const c0 = mon_.counters();
+
+		uint32_t const size_errors = XAXIVDMA_SR_ERR_FSZ_LESS_MASK | XAXIVDMA_SR_ERR_LSZ_LESS_MASK |
+				XAXIVDMA_SR_ERR_FSZ_MORE_MASK;
+		while (s.frames < cfg_.frames)
+		{
+			if (!vdma_.waitWriteFrames(1, cfg_.timeout_us))
+				break;
+			++s.frames;
+			if (vdma_.writeStatus() & size_errors)
+			{
+				++s.vdma_errors;
+				vdma_.clearWriteErrors();
+			}
+			if (hash() != ref_hash_)
+				++s.hash_changes;
+		}
+
+		FrameMonitor::counters_t const c1 = mon_.counters();
+		s.bad_lines = (c1.mismatches - c0.mismatches) + (c1.frame_err - c0.frame_err);
+		FrameMonitor::timing_t const t = mon_.timing();
+		if (t.periods)
+			s.period_us = (uint32_t)(t.period_sum / t.periods / (COUNTS_PER_SECOND / 1000000));
+		s.stable = s.frames == cfg_.frames && !s.bad_lines && !s.vdma_errors && !s.hash_changes;
+		return s;
+	}
+
+private:
+	uint32_t hash()
+	{
+		frame_view_t const f = lastWriteFrame(vdma_);
+		Xil_DCacheInvalidateRange((INTPTR)f.data, f.size());
+		return TimingSweep::frameHash(f);
+	}
+
+private:
+	OV5640& cam_;
+	VDMA& vdma_;
+	MON& mon_;
+	TimingSweep::config_t const& cfg_;
+	uint32_t ref_hash_ = 0;
+};
+
+/*!
+ * \brief Characterises the blanking of the running sensor mode. Bisects VTS
+ * between the nominal and height + vblank_min at the nominal HTS, then HTS
+ * between the nominal and the width at the smallest stable VTS, to vts_step
+ * and hts_step, and finally re-checks the pair found. The nominal timing and test
+ * pattern are restored afterwards. A failing step may leave the S2MM channel
+ * halted; the caller restarts the pipeline if so.
+ */
+template <typename VDMA, typename MON>
+TimingSweep::result_t runTimingSweep(OV5640& cam, VDMA& vdma, MON& mon, OV5640_cfg::mode_t mode,
+		TimingSweep::config_t const& cfg = TimingSweep::defaults)
+{
+	TimingSweep::result_t res = {};
+	res.mode = mode;
+	OV5640_cfg::mode_info_t const& info = OV5640_cfg::mode_info[mode];
+
+	uint8_t prev_test;
+	cam.readReg(OV5640_cfg::OV5640_REG_PRE_ISP_TEST_SET1, prev_test);
+	cam.set_test(OV5640_cfg::TEST_EIGHT_COLOR_BAR);
+	cam.get_timing(res.hts_nominal, res.vts_nominal);
+	res.fps_nominal_x100 = info.fps * 100;
+
+	TimingProbe<VDMA, MON> probe(cam, vdma, mon, cfg);
+	auto record = [&res](TimingSweep::step_t const& s) {
+		if (res.step_count < TimingSweep::step_max)
+			res.steps[res.step_count++] = s;
+		++res.steps_run;
+		return s.stable;
+	};
+
+	probe.reference();
+	if (!record(probe.run(res.hts_nominal, res.vts_nominal)))
+	{
+		res.errc = TimingSweep::result_t::ERR_NOMINAL;
+	}
+	else
+	{
+		res.vts_min = (uint16_t)TimingSweep::bisect(info.height + cfg.vblank_min, res.vts_nominal, cfg.vts_step,
+				[&](int32_t vts) { return record(probe.run(res.hts_nominal, (uint16_t)vts)); });
+		res.hts_min = (uint16_t)TimingSweep::bisect(info.width, res.hts_nominal, cfg.hts_step,
+				[&](int32_t hts) { return record(probe.run((uint16_t)hts, res.vts_min)); });
+
+		//The two minima were found separately, confirm them together
+		TimingSweep::step_t const s = probe.run(res.hts_min, res.vts_min);
+		if (!record(s))
+		{
+			res.hts_min = res.hts_nominal;
+			res.vts_min = res.vts_nominal;
+		}
+		else if (s.period_us)
+		{
+			res.fps_measured_x100 = 100000000u / s.period_us;
+		}
+		res.fps_max_x100 = TimingSweep::scaleFps(res.fps_nominal_x100,
+				res.hts_nominal, res.vts_nominal, res.hts_min, res.vts_min);
+	}
+
+	cam.set_timing(res.hts_nominal, res.vts_nominal);
+	mon.expect(mon.expected());
+	vdma.waitWriteFrames(cfg.settle_frames, cfg.timeout_us * cfg.settle_frames);
+	vdma.clearWriteErrors();
+	cam.writeReg(OV5640_cfg::OV5640_REG_PRE_ISP_TEST_SET1, prev_test);
+	return res;
+}
+
+} /* namespace digilent */
+
+#endif /* TIMINGSWEEP_H_ */
@@ -0,0 +1,241 @@
+/*
+ * VdmaRecovery.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VDMARECOVERY_H_
+#define VDMARECOVERY_H_
+
+#include <stdint.h>
+#include <stdexcept>
+
+#include "PipelineController.h"
+#include "../ov5640/OV5640.h"
+#include "../util/Log.h"
+#include "../util/Timer.h"
+
+#include "xaxivdma.h"
+
+namespace digilent {
+
+namespace Recovery {
+	using channel_t = enum { CH_S2MM = 0, CH_MM2S, CH_END };
+	char const* const channel_names[CH_END] = {"S2MM", "MM2S"};
+
+	// Escalation levels, cheapest first
+	using level_t = enum { LVL_CHANNEL = 0, LVL_CSI, LVL_PIPELINE, LVL_END };
+	char const* const level_names[LVL_END] = {"channel restart", "CSI-2 reset", "pipeline restart"};
+
+	using class_t = enum { CLS_SIZE = 0, CLS_BUS, CLS_INTERNAL, CLS_END };
+	char const* const class_names[CLS_END] = {"size", "bus", "internal"};
+
+	inline class_t classify(uint32_t mask)
+	{
+		if (mask & (XAXIVDMA_SR_ERR_SLAVE_MASK | XAXIVDMA_SR_ERR_DECODE_MASK |
+				XAXIVDMA_SR_ERR_SG_SLV_MASK | XAXIVDMA_SR_ERR_SG_DEC_MASK))
+			return CLS_BUS;
+		if (mask & (XAXIVDMA_SR_ERR_FSZ_LESS_MASK | XAXIVDMA_SR_ERR_LSZ_LESS_MASK |
+				XAXIVDMA_SR_ERR_FSZ_MORE_MASK))
+			return CLS_SIZE;
+		return CLS_INTERNAL;
+	}
+
+	/*!
+	 * \brief An error within stable_frames of the previous recovery counts as
+	 * that recovery having failed. After channel_tries failed channel
+	 * restarts, S2MM size errors get csi_tries CSI-2 resets; anything still
+	 * failing gets a full pipeline restart.
+	 */
+	using policy_t = struct
+	{
+		uint8_t channel_tries;
+		uint8_t csi_tries;
+		uint16_t stable_frames;
+	};
+	policy_t const default_policy = {2, 1, 60};
+
+	using metrics_t = struct
+	{
+		uint32_t errors[CLS_END];
+		uint32_t recoveries[LVL_END];
+		uint32_t failed;			// recovery actions that threw
+		uint32_t last_mask;
+		uint32_t downtime_last;		// sensor frames from error to first frame after recovery
+		uint32_t downtime_max;
+		uint32_t downtime_total;
+	};
+
+	//! \brief Level for the nth consecutive attempt (from 1) on a channel
+	inline level_t level(policy_t const& p, channel_t ch, class_t cls, uint32_t attempt)
+	{
+		if (attempt <= p.channel_tries)
+			return LVL_CHANNEL;
+		//CSI-2 reset only helps if the stream delivered to S2MM was malformed
+		if (ch == CH_S2MM && cls == CLS_SIZE && attempt <= (uint32_t)p.channel_tries + p.csi_tries)
+			return LVL_CSI;
+		return LVL_PIPELINE;
+	}
+
+	inline Pipeline::plan_t plan(channel_t ch, level_t lvl)
+	{
+		if (ch == CH_S2MM && lvl == LVL_CSI)
+			return (1U << Pipeline::ACT_S2MM_STOP) | (1U << Pipeline::ACT_CSI_RESET) |
+					(1U << Pipeline::ACT_S2MM_CONFIG) | (1U << Pipeline::ACT_S2MM_START) |
+					(1U << Pipeline::ACT_CSI_ENABLE);
+		if (ch == CH_S2MM)
+			return (1U << Pipeline::ACT_S2MM_STOP) | (1U << Pipeline::ACT_S2MM_CONFIG) |
+					(1U << Pipeline::ACT_S2MM_START);
+		return (1U << Pipeline::ACT_MM2S_STOP) | (1U << Pipeline::ACT_MM2S_CONFIG) |
+				(1U << Pipeline::ACT_MM2S_START);
+	}
+}
+
+/*!
+ * \brief VDMA error recovery. The error interrupt (onError, installed as the
+ * AXI_VDMA error hook) only records the error; poll(), from the main loop,
+ * clears the channel's DMASR error bits and restarts the affected channel,
+ * which resumes at the next frame sync. Repeated failures escalate to a
+ * CSI-2 RX soft reset and then to a full restart including the sensor.
+ *
+ * Errors raised while the pipeline is deliberately reconfigured are not
+ * faults; call quiet() afterwards to drop them.
+ */
+template <typename PIPE, typename VDMA, typename MON>
+class VdmaRecovery
+{
+public:
+	VdmaRecovery(PIPE& pipeline, VDMA& vdma, MON& mon,
+			Recovery::policy_t const& policy = Recovery::default_policy) :
+		pipeline_(pipeline), vdma_(vdma), mon_(mon), policy_(policy)
+	{
+		vdma_.setErrorHook(&VdmaRecovery::onError, this);
+	}
+
+	~VdmaRecovery()
+	{
+		vdma_.setErrorHook(NULL, NULL);
+	}
+
+	//! \brief AXI_VDMA error hook, interrupt context
+	static void onError(void* ctx, uint16_t direction, uint32_t mask)
+	{
+		VdmaRecovery& self = *static_cast<VdmaRecovery*>(ctx);
+		Recovery::channel_t const ch = direction == XAXIVDMA_WRITE ? Recovery::CH_S2MM : Recovery::CH_MM2S;
+		if (!self.pending_[ch])
+			self.error_us_[ch] = time_us();
+		__atomic_fetch_or(&self.pending_[ch], mask ? mask : XAXIVDMA_SR_ERR_INTERNAL_MASK, __ATOMIC_RELEASE);
+	}
+
+	//! \brief Drops errors recorded so far, e.g. after a mode change
+	void quiet()
+	{
+		for (int ch = 0; ch < Recovery::CH_END; ++ch)
+			__atomic_store_n(&pending_[ch], 0, __ATOMIC_RELEASE);
+		vdma_.clearWriteErrors();
+		vdma_.clearReadErrors();
+	}
+
+	void setEnabled(bool enabled) { enabled_ = enabled; }
+	bool enabled() const { return enabled_; }
+
+	/*!
+	 * \brief Handles at most one pending error per channel. Blocks for the
+	 * restart and its first frame. Returns true if anything was done.
+	 */
+	bool poll()
+	{
+		bool acted = false;
+		for (int ch = 0; ch < Recovery::CH_END; ++ch)
+			acted |= recover(static_cast<Recovery::channel_t>(ch));
+		return acted;
+	}
+
+	Recovery::metrics_t const& metrics(Recovery::channel_t ch) const { return metrics_[ch]; }
+	uint32_t attempts(Recovery::channel_t ch) const { return attempts_[ch]; }
+	//! \brief Pipeline restarts tried so far; each one reprograms the sensor from its init table
+	uint32_t restarts() const { return restarts_; }
+
+private:
+	bool recover(Recovery::channel_t ch)
+	{
+		uint32_t const mask = __atomic_exchange_n(&pending_[ch], 0, __ATOMIC_ACQ_REL);
+		if (!mask || !enabled_)
+			return false;
+
+		Recovery::metrics_t& m = metrics_[ch];
+		Recovery::class_t const cls = Recovery::classify(mask);
+		++m.errors[cls];
+		m.last_mask = mask;
+
+		uint32_t const frame_us = frameUs();
+		if (attempts_[ch] && error_us_[ch] - done_us_[ch] >= (uint64_t)policy_.stable_frames * frame_us)
+			attempts_[ch] = 0;
+		++attempts_[ch];
+		Recovery::level_t const lvl = Recovery::level(policy_, ch, cls, attempts_[ch]);
+
+		try
+		{
+			if (ch == Recovery::CH_S2MM)
+				vdma_.clearWriteErrors();
+			else
+				vdma_.clearReadErrors();
+
+			if (lvl == Recovery::LVL_PIPELINE)
+			{
+				++restarts_;
+				pipeline_.restart(pipeline_.target());
+				attempts_[ch] = 0;
+			}
+			else
+			{
+				pipeline_.rerun(Recovery::plan(ch, lvl));
+			}
+			//Re-arms the CSI-2 interrupts after a soft reset, restarts its settle count
+			mon_.expect(mon_.expected());
+			++m.recoveries[lvl];
+		}
+		catch (std::runtime_error const&)
+		{
+			++m.failed;
+		}
+		//Errors from the restart itself; a persisting fault shows up again
+		for (int c = 0; c < Recovery::CH_END; ++c)
+			__atomic_store_n(&pending_[c], 0, __ATOMIC_RELEASE);
+
+		done_us_[ch] = time_us();
+		uint32_t const down = (uint32_t)((done_us_[ch] - error_us_[ch] + frame_us - 1) / frame_us);
+		m.downtime_last = down;
+		if (down > m.downtime_max)
+			m.downtime_max = down;
+		m.downtime_total += down;
+		LOG_WARN("VDMA %s error 0x%x (%s): %s, down %u frames\r\n", Recovery::channel_names[ch],
+		         mask, Recovery::class_names[cls], Recovery::level_names[lvl], down);
+		return true;
+	}
+
+	//! Nominal sensor frame period
+	uint32_t frameUs() const
+	{
+		uint8_t const fps = OV5640_cfg::mode_info[pipeline_.target().mode].fps;
+		return 1000000u / (fps ? fps : 1);
+	}
+
+private:
+	PIPE& pipeline_;
+	VDMA& vdma_;
+	MON& mon_;
+	Recovery::policy_t const policy_;
+	bool enabled_ = true;
+
+	uint32_t pending_[Recovery::CH_END] = {};	// DMASR error bits, written by the interrupt
+	uint64_t error_us_[Recovery::CH_END] = {};	// first error since the last poll
+	uint64_t done_us_[Recovery::CH_END] = {};	// end of the last recovery
+	uint32_t attempts_[Recovery::CH_END] = {};
+	uint32_t restarts_ = 0;
+	Recovery::metrics_t metrics_[Recovery::CH_END] = {};
+};
+
+} /* namespace digilent */
+
+#endif /* VDMARECOVERY_H_ */
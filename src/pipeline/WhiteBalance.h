@@ -0,0 +1,250 @@
+/*
+ * WhiteBalance.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WHITEBALANCE_H_
+#define WHITEBALANCE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameStats.h"
+#include "../ov5640/OV5640.h"
+#include "../util/Profile.h"
+
+namespace digilent {
+
+namespace WhiteBalance {
+	//! \brief Sensor AWB gains in 1/1024, 12 bits
+	uint16_t const unity = 0x400;
+	uint16_t const gain_max = 0xFFF;
+	using gains_t = struct { uint16_t r, g, b; };
+
+	using Method = enum { GRAY_WORLD = 0, WHITE_PATCH, METHOD_END };
+	char const* const method_names[] = { "gray world", "white patch" };
+
+	// OmniVision light mode settings for 0x3400-0x3405
+	using preset_t = struct { char const* name; gains_t gains; };
+	preset_t const presets[] =
+	{
+		{"daylight",    {0x61C, 0x400, 0x4F3}},
+		{"cloudy",      {0x648, 0x400, 0x4D3}},
+		{"fluorescent", {0x548, 0x400, 0x7CF}},
+		{"tungsten",    {0x410, 0x400, 0x8B6}},
+	};
+	size_t const preset_count = sizeof(presets)/sizeof(presets[0]);
+
+	using config_t = struct
+	{
+		Method method;
+		uint8_t grid;			// statistics sample every grid-th pixel and line
+		uint8_t smooth_pct;		// share of the way to the new estimate taken per update
+		uint8_t deadband_pm;	// no write while every gain is within this many per mille of the estimate
+		uint8_t settle_frames;	// frames skipped after a write, still carrying the old gains
+		uint8_t white_pct;		// white patch: brightest share of the samples averaged
+	};
+	config_t const defaults = {GRAY_WORLD, 16, 50, 8, 2, 2};
+
+	using stats_t = struct
+	{
+		uint32_t frames;		// new S2MM frames seen since start
+		uint32_t updates;		// gain writes
+		uint32_t converged;		// frame at which the estimate last came within the deadband, 0 outside it
+		uint32_t samples;		// samples the last estimate used
+		uint8_t r, g, b;		// their means
+		uint32_t measure_us;	// last frame statistics pass
+	};
+
+	/*!
+	 * \brief Mean colour of the unclipped samples the method looks at: all
+	 * but the darkest luma bin for gray world, the brightest white_pct of
+	 * them for white patch. Returns the sample count, 0 if there is nothing
+	 * to go on.
+	 */
+	inline uint32_t estimate(FrameStats::sums_t const& s, Method method, uint8_t white_pct, uint8_t& r, uint8_t& g, uint8_t& b)
+	{
+		size_t const bins = FrameStats::bins;
+		uint32_t total = 0;
+		for (size_t i = 1; i < bins; ++i)
+			total += s.n[i];
+		uint32_t const want = method == WHITE_PATCH ? (total * white_pct + 99) / 100 : total;
+		uint32_t sr = 0, sg = 0, sb = 0, n = 0;
+		for (size_t i = bins - 1; i > 0 && (n < want || !n); --i)
+		{
+			sr += s.r[i];
+			sg += s.g[i];
+			sb += s.b[i];
+			n += s.n[i];
+		}
+		if (!n)
+			return 0;
+		r = (uint8_t)(sr / n);
+		g = (uint8_t)(sg / n);
+		b = (uint8_t)(sb / n);
+		return n;
+	}
+
+	/*!
+	 * \brief Gains that would make the measured mean neutral, from the gains
+	 * it was measured with. Normalised so the lowest is 1x: a gain below 1x
+	 * would leave that channel short of full scale in the highlights.
+	 */
+	inline gains_t correct(gains_t const& cur, uint8_t r, uint8_t g, uint8_t b)
+	{
+		uint32_t gr = r ? (uint32_t)cur.r * g / r : gain_max;
+		uint32_t gg = cur.g;
+		uint32_t gb = b ? (uint32_t)cur.b * g / b : gain_max;
+		uint32_t lo = gr < gg ? gr : gg;
+		lo = gb < lo ? gb : lo;
+		if (!lo)
+			return cur;
+		gr = gr * unity / lo;
+		gg = gg * unity / lo;
+		gb = gb * unity / lo;
+		return gains_t{(uint16_t)(gr > gain_max ? gain_max : gr), (uint16_t)(gg > gain_max ? gain_max : gg),
+				(uint16_t)(gb > gain_max ? gain_max : gb)};
+	}
+}
+
+/*!
+ * \brief Software white balance over the OV5640's manual AWB gains. Presets
+ * and manual gains go in under group hold, so they switch at a frame
+ * boundary without the power down set_awb() uses.
+ *
+ * The loop runs from the main loop on the frames its FrameGate lets
+ * through. Gray world or white patch picks the mean colour from the luma
+ * bins of the frame statistics, and the gains move part of the way to the
+ * ones that make it neutral. At the default grid a 1080p frame is about
+ * 8000 samples.
+ */
+template <typename VDMA>
+class AutoWhiteBalance
+{
+public:
+	AutoWhiteBalance(OV5640& cam, FrameSampler<VDMA>& sampler) :
+		cam_(cam), sampler_(sampler), cfg_(WhiteBalance::defaults),
+		gains_{WhiteBalance::unity, WhiteBalance::unity, WhiteBalance::unity}, stats_{},
+		running_(false), manual_(false)
+	{
+	}
+
+	//! \brief Fixed gains, stops the loop
+	void setManual(WhiteBalance::gains_t const& gains)
+	{
+		running_ = false;
+		gains_ = gains;
+		apply();
+	}
+
+	bool setPreset(size_t preset)
+	{
+		if (preset >= WhiteBalance::preset_count)
+			return false;
+		setManual(WhiteBalance::presets[preset].gains);
+		return true;
+	}
+
+	/*!
+	 * \brief Starts the loop from the current manual gains, or from unity
+	 * when the sensor's AWB had them
+	 */
+	void start(WhiteBalance::config_t const& cfg = WhiteBalance::defaults)
+	{
+		cfg_ = cfg;
+		if (!manual_)
+			gains_ = WhiteBalance::gains_t{WhiteBalance::unity, WhiteBalance::unity, WhiteBalance::unity};
+		apply();
+		stats_ = WhiteBalance::stats_t{};
+		gate_.restart(sampler_.sequence(), cfg_.settle_frames);
+		running_ = true;
+	}
+
+	//! \brief Stops the loop and hands the gains back to the sensor's AWB
+	void stop()
+	{
+		running_ = false;
+		manual_ = false;
+		cam_.set_auto_wb();
+	}
+
+	//! \brief Writes the manual gains again, for after a sensor restart
+	void restore()
+	{
+		if (manual_)
+			apply();
+	}
+
+	//! \brief Main loop hook, returns true when the gains were changed
+	bool poll()
+	{
+		if (!running_ || !gate_.pass(sampler_.sequence(), stats_.frames))
+			return false;
+
+		PROFILE_ZONE("AutoWhiteBalance::poll");
+		FrameStats::sums_t const& sums = sampler_.sums(cfg_.grid);
+		stats_.measure_us = sampler_.measureUs();
+		stats_.samples = WhiteBalance::estimate(sums, cfg_.method, cfg_.white_pct, stats_.r, stats_.g, stats_.b);
+		if (!stats_.samples)
+			return false;
+
+		WhiteBalance::gains_t const want = WhiteBalance::correct(gains_, stats_.r, stats_.g, stats_.b);
+		if (near(want.r, gains_.r) && near(want.g, gains_.g) && near(want.b, gains_.b))
+		{
+			if (!stats_.converged)
+				stats_.converged = stats_.frames;
+			return false;
+		}
+		stats_.converged = 0;
+		gains_.r = smooth(gains_.r, want.r);
+		gains_.g = smooth(gains_.g, want.g);
+		gains_.b = smooth(gains_.b, want.b);
+		apply();
+		++stats_.updates;
+		gate_.settle(cfg_.settle_frames);
+		return true;
+	}
+
+	bool running() const { return running_; }
+	bool manual() const { return manual_; }
+	WhiteBalance::gains_t const& gains() const { return gains_; }
+	WhiteBalance::stats_t const& stats() const { return stats_; }
+	WhiteBalance::config_t const& config() const { return cfg_; }
+
+private:
+	void apply()
+	{
+		cam_.set_wb_gains(gains_.r, gains_.g, gains_.b);
+		manual_ = true;
+	}
+
+	bool near(uint16_t want, uint16_t cur) const
+	{
+		uint32_t const diff = want > cur ? want - cur : cur - want;
+		return diff * 1000 <= (uint32_t)cur * cfg_.deadband_pm;
+	}
+
+	//! \brief Part of the way to want, at least one step so small errors still close
+	uint16_t smooth(uint16_t cur, uint16_t want) const
+	{
+		int32_t step = ((int32_t)want - cur) * cfg_.smooth_pct / 100;
+		if (!step)
+			step = want > cur ? 1 : want < cur ? -1 : 0;
+		return (uint16_t)(cur + step);
+	}
+
+private:
+	OV5640& cam_;
+	FrameSampler<VDMA>& sampler_;
+	FrameGate gate_;
+	WhiteBalance::config_t cfg_;
+	WhiteBalance::gains_t gains_;
+	WhiteBalance::stats_t stats_;
+	bool running_;
+	bool manual_;
+};
+
+} /* namespace digilent */
+
+#endif /* WHITEBALANCE_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Cobs.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace digilent {
+
+namespace Cobs {
+	//! \brief Worst-case encoded size of len bytes, without delimiters
+	inline size_t max_encoded(size_t len) { return len + len / 254 + 1; }
+
+	/*!
+	 * \brief Consistent Overhead Byte Stuffing. The output contains no zero
+	 * bytes, so 0x00 can delimit frames on the wire. dst must hold
+	 * max_encoded(len) bytes. Returns the encoded length.
+	 */
+	inline size_t encode(uint8_t const* src, size_t len, uint8_t* dst)
+	{
+		size_t code_idx = 0, out = 1;
+		uint8_t code = 1;
+		for (size_t i = 0; i < len; ++i)
+		{
+			if (src[i])
+			{
+				dst[out++] = src[i];
+				++code;
+			}
+			if (!src[i] || code == 0xFF)
+			{
+				dst[code_idx] = code;
+				code_idx = out++;
+				code = 1;
+			}
+		}
+		dst[code_idx] = code;
+		return out;
+	}
+
+	/*!
+	 * \brief Inverse of encode(). dst may alias src. Returns the decoded
+	 * length, or 0 if the input is malformed (contains a zero or overruns).
+	 */
+	inline size_t decode(uint8_t const* src, size_t len, uint8_t* dst)
+	{
+		size_t in = 0, out = 0;
+		while (in < len)
+		{
+			uint8_t const code = src[in++];
+			if (!code || in + code - 1 > len)
+				return 0;
+			for (uint8_t i = 1; i < code; ++i)
+			{
+				if (!src[in])
+					return 0;
+				dst[out++] = src[in++];
+			}
+			if (code != 0xFF && in < len)
+				dst[out++] = 0;
+		}
+		return out;
+	}
+}
+
+} /* namespace digilent */
+
+#endif /* COBS_H_ */
@@ -0,0 +1,544 @@
+/*
+ * Csi2.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CSI2_H_
+#define CSI2_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdexcept>
+#include <vector>
+
+#include "../util/Crc16.h"
+
+#define STRINGIZE(x) STRINGIZE2(x)
+#define STRINGIZE2(x) #x
+#define LINE_STRING STRINGIZE(__LINE__)
+
+namespace digilent {
+
+/*!
+ * MIPI CSI-2 packet layer in software, for producing and checking the byte
+ * stream the sensor puts on the lanes (after lane merging) without the
+ * hardware: short packets for frame and line start/end, RAW10 long packets,
+ * header ECC and payload CRC-16. The CRC goes through crc16_fast(), so
+ * streams of several GB validate at memory speed on the host.
+ */
+namespace Csi2 {
+	using DataType = enum
+	{
+		DT_FS = 0x00,		// frame start, WC = frame number
+		DT_FE = 0x01,		// frame end, WC = frame number
+		DT_LS = 0x02,		// line start, WC = line number
+		DT_LE = 0x03,		// line end, WC = line number
+		DT_RAW10 = 0x2B
+	};
+
+	size_t const header_bytes = 4;
+	size_t const footer_bytes = 2;
+
+	//! \brief Data types up to 0x0F are short packets (no payload)
+	inline bool is_short(uint8_t dt) { return dt < 0x10; }
+
+	/*!
+	 * \brief Header ECC over the 24 bits DI | WC << 8: a Hamming code that
+	 * corrects one bit error and detects two. Bits 7:6 are zero.
+	 */
+	inline uint8_t ecc(uint32_t h24)
+	{
+		static uint32_t const parity[6] = { 0xF12CB7, 0xF2555B, 0x749A6D, 0xB8E38E, 0xDF03F0, 0xEFFC00 };
+		uint8_t e = 0;
+		for (int p = 0; p < 6; ++p)
+			e |= (__builtin_parity(h24 & parity[p]) & 1) << p;
+		return e;
+	}
+
+	using header_t = struct
+	{
+		uint8_t vc;			// virtual channel 0-3
+		uint8_t dt;			// DataType
+		uint16_t wc;		// payload bytes, or the short packet data field
+	};
+
+	using EccResult = enum { ECC_OK, ECC_CORRECTED, ECC_UNCORRECTABLE };
+
+	//! \brief Writes the four header bytes DI, WC low, WC high, ECC
+	inline void put_header(header_t const& h, uint8_t* dst)
+	{
+		uint32_t const h24 = (uint32_t)((h.vc & 3) << 6 | (h.dt & 0x3F)) | (uint32_t)h.wc << 8;
+		dst[0] = h24 & 0xFF;
+		dst[1] = (h24 >> 8) & 0xFF;
+		dst[2] = (h24 >> 16) & 0xFF;
+		dst[3] = ecc(h24);
+	}
+
+	/*!
+	 * \brief Decodes a header, correcting a single flipped bit. h is only
+	 * valid unless ECC_UNCORRECTABLE is returned.
+	 */
+	inline EccResult get_header(uint8_t const* src, header_t& h)
+	{
+		uint32_t h24 = src[0] | (uint32_t)src[1] << 8 | (uint32_t)src[2] << 16;
+		uint8_t const syndrome = (ecc(h24) ^ src[3]) & 0x3F;
+		EccResult r = ECC_OK;
+		if (syndrome)
+		{
+			r = ECC_UNCORRECTABLE;
+			//A flipped parity bit gives a single bit syndrome, a flipped data bit its column
+			if (!(syndrome & (syndrome - 1)))
+				r = ECC_CORRECTED;
+			for (int i = 0; i < 24 && r == ECC_UNCORRECTABLE; ++i)
+			{
+				if (ecc(1u << i) == syndrome)
+				{
+					h24 ^= 1u << i;
+					r = ECC_CORRECTED;
+				}
+			}
+			if (r == ECC_UNCORRECTABLE)
+				return r;
+		}
+		h.vc = (h24 >> 6) & 3;
+		h.dt = h24 & 0x3F;
+		h.wc = (h24 >> 8) & 0xFFFF;
+		return r;
+	}
+
+	//! \brief RAW10 long packet payload of one line; width must be a multiple of 4
+	inline size_t raw10_line_bytes(uint32_t width) { return (size_t)width * 5 / 4; }
+
+	/*!
+	 * \brief Packs 10-bit pixels: four pixels' bits 9:2 in four bytes, then
+	 * one byte with their bits 1:0, first pixel in the LSBs.
+	 */
+	inline void pack_raw10(uint16_t const* src, uint32_t width, uint8_t* dst)
+	{
+		for (uint32_t x = 0; x < width; x += 4, src += 4, dst += 5)
+		{
+			dst[0] = src[0] >> 2;
+			dst[1] = src[1] >> 2;
+			dst[2] = src[2] >> 2;
+			dst[3] = src[3] >> 2;
+			dst[4] = (src[0] & 3) | (src[1] & 3) << 2 | (src[2] & 3) << 4 | (src[3] & 3) << 6;
+		}
+	}
+
+	inline void unpack_raw10(uint8_t const* src, uint32_t width, uint16_t* dst)
+	{
+		for (uint32_t x = 0; x < width; x += 4, src += 5, dst += 4)
+		{
+			dst[0] = (uint16_t)(src[0] << 2 | (src[4] & 3));
+			dst[1] = (uint16_t)(src[1] << 2 | ((src[4] >> 2) & 3));
+			dst[2] = (uint16_t)(src[2] << 2 | ((src[4] >> 4) & 3));
+			dst[3] = (uint16_t)(src[3] << 2 | (src[4] >> 6));
+		}
+	}
+
+	/*!
+	 * \brief Faults to put in a generated frame. Line numbers count from 1,
+	 * zero disables the fault.
+	 *
+	 * truncate_at reproduces the OV5640 running out of vertical blanking (see
+	 * the binning notes in OV5640.h): FE goes out after that many lines. With
+	 * spill the remaining lines are not lost but sent after the next frame's
+	 * FS, as a sensor whose internal readout overran the frame boundary does.
+	 * At 640x480, truncate_at 401 then gives a 401 line frame followed by a
+	 * 79 + 480 = 559 line frame.
+	 */
+	using inject_t = struct
+	{
+		uint32_t truncate_at;
+		bool spill;
+		uint32_t ecc_line;		// long packet whose header gets ecc_bits flipped
+		uint32_t ecc_bits;		// header bits to flip, DI in bits 7:0 ... ECC in 31:24
+		uint32_t crc_line;		// long packet sent with a wrong CRC
+	};
+
+	/*!
+	 * \brief Turns RAW10 frames into a CSI-2 packet stream on one virtual
+	 * channel: FS, one long packet per line (optionally between LS and LE),
+	 * FE. Frame numbers count 1 to 0xFFFF and wrap to 1.
+	 */
+	class Generator
+	{
+	public:
+		Generator(uint32_t width, uint32_t height, uint8_t vc = 0, bool line_sync = false) :
+			width_(width), height_(height), vc_(vc), line_sync_(line_sync)
+		{
+			if (!width_ || width_ % 4 || !height_ || raw10_line_bytes(width_) > 0xFFFF)
+				throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+
+		//! \brief Bytes of one long packet, header and CRC included
+		size_t lineBytes() const
+		{
+			return header_bytes + raw10_line_bytes(width_) + footer_bytes + (line_sync_ ? 2 * header_bytes : 0);
+		}
+
+		//! \brief Output buffer size frame() needs, room for a spilled frame included
+		size_t maxFrameBytes() const { return 2 * header_bytes + 2 * (size_t)height_ * lineBytes(); }
+
+		/*!
+		 * \brief Writes one frame of width * height pixels to out, which must
+		 * hold maxFrameBytes(). Returns the bytes written.
+		 */
+		size_t frame(uint16_t const* pixels, uint8_t* out, inject_t const& inj = inject_t())
+		{
+			uint8_t* p = out;
+			uint16_t const frame_no = frame_no_;
+			frame_no_ = frame_no_ == 0xFFFF ? 1 : frame_no_ + 1;
+
+			p = shortPacket(p, DT_FS, frame_no);
+			if (!spill_.empty())
+			{
+				memcpy(p, spill_.data(), spill_.size());
+				p += spill_.size();
+				spill_.clear();
+			}
+
+			uint32_t const lines = inj.truncate_at && inj.truncate_at < height_ ? inj.truncate_at : height_;
+			for (uint32_t y = 0; y < lines; ++y)
+			{
+				uint32_t const ecc_bits = inj.ecc_line == y + 1 ? inj.ecc_bits : 0;
+				p = line(p, pixels + (size_t)y * width_, y, ecc_bits, inj.crc_line == y + 1);
+			}
+			if (inj.spill && lines < height_)
+			{
+				spill_.resize((height_ - lines) * lineBytes());
+				uint8_t* s = spill_.data();
+				for (uint32_t y = lines; y < height_; ++y)
+					s = line(s, pixels + (size_t)y * width_, y, 0, false);
+			}
+			p = shortPacket(p, DT_FE, frame_no);
+			return p - out;
+		}
+
+	private:
+		uint8_t* shortPacket(uint8_t* p, uint8_t dt, uint16_t data)
+		{
+			put_header({vc_, dt, data}, p);
+			return p + header_bytes;
+		}
+
+		uint8_t* line(uint8_t* p, uint16_t const* pixels, uint32_t y, uint32_t ecc_bits, bool bad_crc)
+		{
+			size_t const payload = raw10_line_bytes(width_);
+			if (line_sync_)
+				p = shortPacket(p, DT_LS, (uint16_t)(y + 1));
+			put_header({vc_, DT_RAW10, (uint16_t)payload}, p);
+			for (int i = 0; i < 4; ++i)
+				p[i] ^= (ecc_bits >> (8 * i)) & 0xFF;
+			p += header_bytes;
+			pack_raw10(pixels, width_, p);
+			uint16_t crc = crc16_fast(p, payload);
+			if (bad_crc)
+				crc ^= 0x0001;
+			p += payload;
+			*p++ = crc & 0xFF;
+			*p++ = crc >> 8;
+			if (line_sync_)
+				p = shortPacket(p, DT_LE, (uint16_t)(y + 1));
+			return p;
+		}
+
+		uint32_t const width_, height_;
+		uint8_t const vc_;
+		bool const line_sync_;
+		uint16_t frame_no_ = 1;
+		std::vector<uint8_t> spill_;
+	};
+
+	//! \brief Error classes of a received frame, as bits
+	using Error = enum
+	{
+		ERR_ECC_CORRECTED = 0x001,	// a header had one bit flipped, corrected
+		ERR_ECC = 0x002,			// a header could not be corrected, bytes skipped to resync
+		ERR_CRC = 0x004,			// a long packet's payload CRC did not match
+		ERR_SHORT = 0x008,			// fewer lines than the frame height
+		ERR_LONG = 0x010,			// more lines than the frame height
+		ERR_LINE_SIZE = 0x020,		// a long packet's word count is not one RAW10 line
+		ERR_NO_FS = 0x040,			// FE, or lines, without a preceding FS
+		ERR_NO_FE = 0x080,			// next FS, or end of stream, before FE
+		ERR_FRAME_NO = 0x100,		// FE number differs from FS, or frame numbers skipped
+		ERR_DATA_TYPE = 0x200		// long packet of a data type other than RAW10
+	};
+
+	//! \brief One received frame, handed over at its FE (or where it ended)
+	struct frame_info_t
+	{
+		uint16_t frame_no;		// from FS, 0 without one
+		uint32_t lines;			// RAW10 long packets, those beyond the height included
+		uint32_t ecc_corrected, ecc_errors, crc_errors;
+		uint32_t errors;		// Error bits
+	};
+
+	//! \brief Cumulative counts over the whole stream
+	struct stats_t
+	{
+		uint64_t bytes;
+		uint64_t packets;		// headers decoded, short and long
+		uint32_t frames;		// frames handed to the handler
+		uint32_t bad_frames;	// ... with any Error bit but ERR_ECC_CORRECTED
+		uint32_t ecc_corrected, ecc_errors, crc_errors;
+		uint64_t skipped;		// bytes dropped while resynchronising
+	};
+
+	/*!
+	 * \brief Receives a CSI-2 byte stream in pieces of any size and hands
+	 * every frame of the configured virtual channel to the handler, pixels
+	 * unpacked into the caller's width * height buffer (lines beyond the
+	 * height are counted, not stored). Without a pixel buffer only the
+	 * packets are checked, which is the fast path for long captures.
+	 *
+	 * A header that ECC cannot correct is dropped one byte at a time until a
+	 * header lines up again; the word count cannot be trusted, so the payload
+	 * it announced is scanned too. While resynchronising only headers with a
+	 * clean ECC and a data type this parser knows are accepted, as random
+	 * bytes pass single bit correction almost half of the time.
+	 */
+	class Parser
+	{
+	public:
+		typedef void (*FrameHandler)(void* ctx, frame_info_t const& info, uint16_t const* pixels);
+
+		Parser(uint32_t width, uint32_t height, FrameHandler handler, void* ctx,
+				uint16_t* pixels = NULL, uint8_t vc = 0) :
+			width_(width), height_(height), vc_(vc), handler_(handler), ctx_(ctx), pixels_(pixels)
+		{
+			if (!width_ || width_ % 4 || !height_)
+				throw std::runtime_error(__FILE__ ":" LINE_STRING);
+		}
+
+		void feed(uint8_t const* data, size_t len)
+		{
+			stats_.bytes += len;
+			while (len)
+			{
+				size_t n = 0;
+				switch (state_)
+				{
+				case S_HEADER: n = header(data, len); break;
+				case S_PAYLOAD: n = payload(data, len); break;
+				case S_CRC: n = footer(data, len); break;
+				}
+				data += n;
+				len -= n;
+			}
+		}
+
+		//! \brief End of stream: a frame still open is handed over without its FE
+		void finish()
+		{
+			if (in_frame_ || info_.lines)
+				deliver(ERR_NO_FE);
+			state_ = S_HEADER;
+			hdr_len_ = 0;
+		}
+
+		stats_t const& stats() const { return stats_; }
+
+	private:
+		using State = enum { S_HEADER, S_PAYLOAD, S_CRC };
+
+		size_t header(uint8_t const* data, size_t len)
+		{
+			size_t const n = len < header_bytes - hdr_len_ ? len : header_bytes - hdr_len_;
+			memcpy(hdr_ + hdr_len_, data, n);
+			hdr_len_ += n;
+			if (hdr_len_ < header_bytes)
+				return n;
+
+			header_t h;
+			EccResult const r = get_header(hdr_, h);
+			if (r == ECC_UNCORRECTABLE || (resyncing_ && (r != ECC_OK || !known(h))))
+			{
+				if (!resyncing_)
+				{
+					++stats_.ecc_errors;
+					++info_.ecc_errors;
+					info_.errors |= ERR_ECC;
+				}
+				resyncing_ = true;
+				++stats_.skipped;
+				memmove(hdr_, hdr_ + 1, --hdr_len_);
+				return n;
+			}
+			resyncing_ = false;
+			hdr_len_ = 0;
+			++stats_.packets;
+			if (r == ECC_CORRECTED)
+			{
+				++stats_.ecc_corrected;
+				++info_.ecc_corrected;
+				info_.errors |= ERR_ECC_CORRECTED;
+			}
+
+			if (is_short(h.dt))
+			{
+				if (h.vc == vc_)
+					shortPacket(h);
+				return n;
+			}
+			hdr_dt_ = h.dt;
+			mine_ = h.vc == vc_;
+			remaining_ = h.wc;
+			crc_ = 0xFFFF;
+			x_ = 0;
+			group_len_ = 0;
+			if (mine_ && h.dt != DT_RAW10)
+				info_.errors |= ERR_DATA_TYPE;
+			if (mine_ && h.dt == DT_RAW10 && h.wc != raw10_line_bytes(width_))
+				info_.errors |= ERR_LINE_SIZE;
+			state_ = remaining_ ? S_PAYLOAD : S_CRC;
+			return n;
+		}
+
+		bool known(header_t const& h) const
+		{
+			return h.dt <= DT_LE || (h.dt == DT_RAW10 && h.wc == raw10_line_bytes(width_));
+		}
+
+		void shortPacket(header_t const& h)
+		{
+			switch (h.dt)
+			{
+			case DT_FS:
+				if (in_frame_ || info_.lines)
+					deliver(in_frame_ ? ERR_NO_FE : ERR_NO_FS);
+				if (last_frame_no_ && h.wc != (last_frame_no_ == 0xFFFF ? 1 : last_frame_no_ + 1))
+					info_.errors |= ERR_FRAME_NO;
+				in_frame_ = true;
+				info_.frame_no = h.wc;
+				last_frame_no_ = h.wc;
+				break;
+			case DT_FE:
+				if (!in_frame_)
+					info_.errors |= ERR_NO_FS;
+				else if (h.wc != info_.frame_no)
+					info_.errors |= ERR_FRAME_NO;
+				deliver(0);
+				break;
+			default:
+				//Line start/end and generic short packets carry nothing to check here
+				break;
+			}
+		}
+
+		size_t payload(uint8_t const* data, size_t len)
+		{
+			size_t const n = len < remaining_ ? len : remaining_;
+			crc_ = crc16_fast(data, n, crc_);
+			if (mine_ && hdr_dt_ == DT_RAW10 && pixels_ && info_.lines < height_)
+				unpack(data, n);
+			remaining_ -= n;
+			if (!remaining_)
+				state_ = S_CRC;
+			return n;
+		}
+
+		void unpack(uint8_t const* data, size_t n)
+		{
+			uint16_t* row = pixels_ + (size_t)info_.lines * width_;
+			while (n)
+			{
+				if (!group_len_ && n >= 5 && x_ + 4 <= width_)
+				{
+					//Whole groups straight from the input
+					uint32_t const groups = (uint32_t)(n / 5) < (width_ - x_) / 4 ? (uint32_t)(n / 5) : (width_ - x_) / 4;
+					unpack_raw10(data, groups * 4, row + x_);
+					x_ += groups * 4;
+					data += groups * 5;
+					n -= groups * 5;
+					if (x_ >= width_)
+						return;
+					continue;
+				}
+				group_[group_len_++] = *data++;
+				--n;
+				if (group_len_ == 5)
+				{
+					group_len_ = 0;
+					if (x_ + 4 > width_)
+						return;
+					unpack_raw10(group_, 4, row + x_);
+					x_ += 4;
+				}
+			}
+		}
+
+		size_t footer(uint8_t const* data, size_t len)
+		{
+			size_t const n = len < footer_bytes - crc_len_ ? len : footer_bytes - crc_len_;
+			memcpy(crc_rx_ + crc_len_, data, n);
+			crc_len_ += n;
+			if (crc_len_ < footer_bytes)
+				return n;
+			crc_len_ = 0;
+			state_ = S_HEADER;
+			if (!mine_)
+				return n;
+			if ((crc_rx_[0] | crc_rx_[1] << 8) != crc_)
+			{
+				++stats_.crc_errors;
+				++info_.crc_errors;
+				info_.errors |= ERR_CRC;
+			}
+			if (hdr_dt_ == DT_RAW10)
+			{
+				if (!in_frame_)
+					info_.errors |= ERR_NO_FS;
+				++info_.lines;
+			}
+			return n;
+		}
+
+		void deliver(uint32_t errors)
+		{
+			info_.errors |= errors;
+			if (info_.lines < height_)
+				info_.errors |= ERR_SHORT;
+			else if (info_.lines > height_)
+				info_.errors |= ERR_LONG;
+			++stats_.frames;
+			if (info_.errors & ~(uint32_t)ERR_ECC_CORRECTED)
+				++stats_.bad_frames;
+			if (handler_)
+				handler_(ctx_, info_, pixels_);
+			info_ = frame_info_t();
+			in_frame_ = false;
+		}
+
+		uint32_t const width_, height_;
+		uint8_t const vc_;
+		FrameHandler const handler_;
+		void* const ctx_;
+		uint16_t* const pixels_;
+
+		State state_ = S_HEADER;
+		uint8_t hdr_[header_bytes];
+		size_t hdr_len_ = 0;
+		bool resyncing_ = false;
+		uint8_t hdr_dt_ = 0;
+		bool mine_ = false;
+		size_t remaining_ = 0;
+		uint16_t crc_ = 0xFFFF;
+		uint8_t crc_rx_[footer_bytes];
+		size_t crc_len_ = 0;
+		uint8_t group_[5];
+		size_t group_len_ = 0;
+		uint32_t x_ = 0;
+
+		bool in_frame_ = false;
+		uint16_t last_frame_no_ = 0;
+		frame_info_t info_ = frame_info_t();
+		stats_t stats_ = stats_t();
+	};
+}
+
+} /* namespace digilent */
+
+#endif /* CSI2_H_ */
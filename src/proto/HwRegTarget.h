@@ -0,0 +1,91 @@
+/*
+ * HwRegTarget.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef HWREGTARGET_H_
+#define HWREGTARGET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdexcept>
+
+#include "RegProtocol.h"
+#include "../ov5640/OV5640.h"
+#include "../ov5640/RegSnapshot.h"
+#include "../util/MmioTrace.h"
+
+#include "xil_io.h"
+
+namespace digilent {
+
+/*!
+ * \brief Register protocol target on the board: the OV5640 over I2C and a
+ * fixed set of AXI-Lite register windows through Xil_In32/Xil_Out32.
+ * Accesses outside the windows are refused rather than risking a bus hang.
+ */
+class HwRegTarget : public RegProto::RegTarget
+{
+public:
+	using window_t = struct { uint32_t base; uint32_t size; };
+
+	HwRegTarget(OV5640& cam, window_t const* windows, size_t window_count) :
+		cam_(cam), windows_(windows), window_count_(window_count)
+	{
+	}
+
+	virtual bool i2cRead(uint16_t addr, uint8_t* buf, size_t count)
+	{
+		try
+		{
+			//Sequential reads, split to keep each I2C transaction short
+			size_t const chunk = 256;
+			for (size_t i = 0; i < count; i += chunk)
+				cam_.readRegs(addr + i, buf + i, count - i < chunk ? count - i : chunk);
+		}
+		catch (std::runtime_error const&)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	virtual bool i2cWrite(uint16_t addr, uint8_t val)
+	{
+		try
+		{
+			cam_.writeReg(addr, val);
+			RegSnapshot::touch(addr);
+		}
+		catch (std::runtime_error const&)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	virtual bool mmioAllowed(uint32_t addr)
+	{
+		if (addr & 3)
+			return false;
+		for (size_t i = 0; i < window_count_; ++i)
+		{
+			if (addr >= windows_[i].base && addr - windows_[i].base < windows_[i].size)
+				return true;
+		}
+		return false;
+	}
+
+	virtual uint32_t mmioRead(uint32_t addr) { return Mmio::read32(addr); }
+	virtual void mmioWrite(uint32_t addr, uint32_t val) { Mmio::write32(addr, val); }
+
+private:
+	OV5640& cam_;
+	window_t const* const windows_;
+	size_t const window_count_;
+};
+
+} /* namespace digilent */
+
+#endif /* HWREGTARGET_H_ */
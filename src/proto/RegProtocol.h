@@ -0,0 +1,239 @@
+/*
+ * RegProtocol.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef REGPROTOCOL_H_
+#define REGPROTOCOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Cobs.h"
+#include "../util/Crc16.h"
+
+namespace digilent {
+
+/*!
+ * Binary register access protocol, carried on the console UART next to the
+ * text CLI. Every frame is COBS encoded and delimited by 0x00 on both sides;
+ * text input never contains 0x00, so the console can tell the two apart.
+ *
+ * Decoded request:  seq, op, payload..., crc16 (LE)
+ * Decoded response: seq, op, status, payload..., crc16 (LE)
+ *
+ * All multi-byte fields are little endian. The CRC covers everything before
+ * it. One request carries many accesses, so a table upload or a block dump
+ * costs one round trip instead of one typed command per register.
+ */
+namespace RegProto {
+	uint8_t const version = 1;
+	size_t const payload_max = 1024;
+	size_t const frame_max = payload_max + 5;			// seq, op, status, crc16
+	size_t const wire_max = frame_max + frame_max / 254 + 3;	// COBS and delimiters
+
+	using Op = enum {
+		OP_PING = 0x00,				// -> version u8, payload_max u16
+		OP_I2C_READ = 0x10,			// n x addr u16 -> n x u8
+		OP_I2C_WRITE = 0x11,		// n x {addr u16, val u8}
+		OP_I2C_READ_BLOCK = 0x12,	// addr u16, count u16 -> count x u8
+		OP_MMIO_READ = 0x20,		// n x addr u32 -> n x u32
+		OP_MMIO_WRITE = 0x21,		// n x {addr u32, val u32}
+		OP_MMIO_READ_BLOCK = 0x22	// addr u32, count u16 -> count x u32
+	};
+	using Status = enum {
+		ST_OK = 0, ST_ERR_CRC, ST_ERR_LENGTH, ST_ERR_OP, ST_ERR_ADDR, ST_ERR_BUS
+	};
+
+	/*!
+	 * \brief What the protocol reads and writes. Implemented over the real
+	 * sensor and MMIO on the target and over simulated registers on the host.
+	 */
+	class RegTarget
+	{
+	public:
+		virtual bool i2cRead(uint16_t addr, uint8_t* buf, size_t count) = 0;
+		virtual bool i2cWrite(uint16_t addr, uint8_t val) = 0;
+		//! \brief True if addr lies inside a register window open to the protocol
+		virtual bool mmioAllowed(uint32_t addr) = 0;
+		virtual uint32_t mmioRead(uint32_t addr) = 0;
+		virtual void mmioWrite(uint32_t addr, uint32_t val) = 0;
+		virtual ~RegTarget() = default;
+	};
+
+	inline uint16_t get16(uint8_t const* p) { return p[0] | (p[1] << 8); }
+	inline uint32_t get32(uint8_t const* p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+	inline void put16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+	inline void put32(uint8_t* p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+	//! \brief Appends the CRC to a decoded frame of len bytes, returns the new length
+	inline size_t seal(uint8_t* frame, size_t len)
+	{
+		put16(frame + len, crc16(frame, len));
+		return len + 2;
+	}
+	//! \brief Checks and strips the CRC, returns the length without it or 0
+	inline size_t unseal(uint8_t const* frame, size_t len)
+	{
+		if (len < 3 || crc16(frame, len - 2) != get16(frame + len - 2))
+			return 0;
+		return len - 2;
+	}
+
+	/*!
+	 * \brief Executes one decoded, CRC-checked request (seq, op, payload) and
+	 * builds the response (seq, op, status, payload) into rsp, which must hold
+	 * frame_max bytes. Returns the response length before the CRC.
+	 */
+	inline size_t handle(uint8_t const* req, size_t len, uint8_t* rsp, RegTarget& tgt)
+	{
+		uint8_t const* in = req + 2;
+		size_t const in_len = len - 2;
+		uint8_t* out = rsp + 3;
+		size_t out_len = 0;
+		uint8_t status = ST_OK;
+		rsp[0] = req[0];
+		rsp[1] = req[1];
+
+		switch (req[1])
+		{
+		case OP_PING:
+			out[0] = version;
+			put16(out + 1, payload_max);
+			out_len = 3;
+			break;
+		case OP_I2C_READ:
+			if (in_len % 2 || in_len / 2 > payload_max) { status = ST_ERR_LENGTH; break; }
+			for (size_t i = 0; i < in_len / 2 && status == ST_OK; ++i)
+			{
+				if (!tgt.i2cRead(get16(in + 2 * i), out + i, 1)) status = ST_ERR_BUS;
+				else out_len = i + 1;
+			}
+			break;
+		case OP_I2C_WRITE:
+			if (in_len % 3) { status = ST_ERR_LENGTH; break; }
+			for (size_t i = 0; i < in_len / 3 && status == ST_OK; ++i)
+			{
+				if (!tgt.i2cWrite(get16(in + 3 * i), in[3 * i + 2])) status = ST_ERR_BUS;
+			}
+			break;
+		case OP_I2C_READ_BLOCK:
+		{
+			if (in_len != 4 || get16(in + 2) > payload_max) { status = ST_ERR_LENGTH; break; }
+			uint16_t const count = get16(in + 2);
+			if (!tgt.i2cRead(get16(in), out, count)) status = ST_ERR_BUS;
+			else out_len = count;
+			break;
+		}
+		case OP_MMIO_READ:
+			if (in_len % 4 || in_len > payload_max) { status = ST_ERR_LENGTH; break; }
+			for (size_t i = 0; i < in_len / 4; ++i)
+			{
+				if (!tgt.mmioAllowed(get32(in + 4 * i))) { status = ST_ERR_ADDR; break; }
+			}
+			for (size_t i = 0; i < in_len / 4 && status == ST_OK; ++i)
+				put32(out + 4 * i, tgt.mmioRead(get32(in + 4 * i)));
+			if (status == ST_OK) out_len = in_len;
+			break;
+		case OP_MMIO_WRITE:
+			if (in_len % 8) { status = ST_ERR_LENGTH; break; }
+			for (size_t i = 0; i < in_len / 8; ++i)
+			{
+				if (!tgt.mmioAllowed(get32(in + 8 * i))) { status = ST_ERR_ADDR; break; }
+			}
+			for (size_t i = 0; i < in_len / 8 && status == ST_OK; ++i)
+				tgt.mmioWrite(get32(in + 8 * i), get32(in + 8 * i + 4));
+			break;
+		case OP_MMIO_READ_BLOCK:
+		{
+			if (in_len != 6 || get16(in + 4) * 4U > payload_max) { status = ST_ERR_LENGTH; break; }
+			uint32_t const addr = get32(in);
+			uint16_t const count = get16(in + 4);
+			//Every word, so a block spanning two windows cannot read the gap between them
+			if (count && addr + 4ULL * (count - 1) > 0xFFFFFFFFULL) { status = ST_ERR_ADDR; break; }
+			for (uint16_t i = 0; i < count; ++i)
+			{
+				if (!tgt.mmioAllowed(addr + 4 * i)) { status = ST_ERR_ADDR; break; }
+			}
+			if (status != ST_OK) break;
+			for (uint16_t i = 0; i < count; ++i)
+				put32(out + 4 * i, tgt.mmioRead(addr + 4 * i));
+			out_len = 4 * count;
+			break;
+		}
+		default:
+			status = ST_ERR_OP;
+			break;
+		}
+		rsp[2] = status;
+		return 3 + out_len;
+	}
+
+	/*!
+	 * \brief Target side of the protocol. Takes one COBS frame as received
+	 * between delimiters, executes it and sends the response through out.
+	 */
+	class Server
+	{
+	public:
+		typedef void (*Output)(void* ctx, uint8_t const* buf, size_t len);
+
+		Server(RegTarget& tgt, Output out, void* out_ctx) :
+			tgt_(tgt), out_(out), out_ctx_(out_ctx)
+		{
+		}
+
+		//! \brief Console frame hook, ctx is the Server
+		static void onFrame(void* ctx, uint8_t* buf, size_t len)
+		{
+			static_cast<Server*>(ctx)->process(buf, len);
+		}
+
+		void process(uint8_t* buf, size_t len)
+		{
+			++requests_;
+			//Decode in place, COBS output is never longer than its input
+			size_t n = Cobs::decode(buf, len, buf);
+			size_t rsp_len;
+			if (n < 2 || n > frame_max)
+			{
+				++errors_;
+				return; //Not even a header to answer to
+			}
+			n = unseal(buf, n);
+			if (n < 2)
+			{
+				++errors_;
+				rsp_[0] = buf[0]; rsp_[1] = buf[1]; rsp_[2] = ST_ERR_CRC;
+				rsp_len = 3;
+			}
+			else
+			{
+				rsp_len = handle(buf, n, rsp_, tgt_);
+				if (rsp_[2] != ST_OK) ++errors_;
+			}
+			rsp_len = seal(rsp_, rsp_len);
+
+			wire_[0] = 0;
+			size_t const w = Cobs::encode(rsp_, rsp_len, wire_ + 1);
+			wire_[w + 1] = 0;
+			out_(out_ctx_, wire_, w + 2);
+		}
+
+		uint32_t requests() const { return requests_; }
+		uint32_t errors() const { return errors_; }
+
+	private:
+		RegTarget& tgt_;
+		Output const out_;
+		void* const out_ctx_;
+		uint8_t rsp_[frame_max];
+		uint8_t wire_[wire_max];
+		uint32_t requests_ = 0, errors_ = 0;
+	};
+}
+
+} /* namespace digilent */
+
+#endif /* REGPROTOCOL_H_ */
@@ -0,0 +1,186 @@
+/*
+ * Crc16.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC16_CLMUL 1
+#else
+#define CRC16_CLMUL 0
+#endif
+
+namespace digilent {
+
+/*!
+ * \brief CRC-16 with polynomial x^16+x^12+x^5+1, LSB first, initial value
+ * 0xFFFF, no final XOR. This is the MIPI CSI-2 packet footer checksum; the
+ * binary register protocol uses it as well. Nibble table, no hardware access.
+ */
+inline uint16_t crc16(uint8_t const* data, size_t len, uint16_t crc = 0xFFFF)
+{
+	static uint16_t const table[16] = {
+		0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+		0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F };
+	for (size_t i = 0; i < len; ++i)
+	{
+		crc = (crc >> 4) ^ table[(crc ^ data[i]) & 0xF];
+		crc = (crc >> 4) ^ table[(crc ^ (data[i] >> 4)) & 0xF];
+	}
+	return crc;
+}
+
+namespace Crc16 {
+	//! \brief x^n mod P, MSB first (bit d = coefficient of x^d)
+	constexpr uint16_t xpow(unsigned n)
+	{
+		uint32_t r = 1;
+		for (unsigned i = 0; i < n; ++i)
+		{
+			r <<= 1;
+			if (r & 0x10000) r ^= 0x11021;
+		}
+		return (uint16_t)r;
+	}
+
+	//! \brief Folding constant: coefficient of x^d in bit 63-d of a qword
+	constexpr uint64_t fold_const(unsigned n)
+	{
+		uint16_t const p = xpow(n);
+		uint64_t k = 0;
+		for (unsigned d = 0; d < 16; ++d)
+			if (p & (1u << d)) k |= 1ull << (63 - d);
+		return k;
+	}
+
+	//! \brief Slice-by-8 tables: t[k][b] advances byte b through k more zero bytes
+	struct tables_t
+	{
+		uint16_t t[8][256];
+
+		constexpr tables_t() : t()
+		{
+			for (unsigned b = 0; b < 256; ++b)
+			{
+				uint16_t c = (uint16_t)b;
+				for (int i = 0; i < 8; ++i)
+					c = (c & 1) ? (uint16_t)((c >> 1) ^ 0x8408) : (uint16_t)(c >> 1);
+				t[0][b] = c;
+			}
+			for (unsigned k = 1; k < 8; ++k)
+				for (unsigned b = 0; b < 256; ++b)
+					t[k][b] = (uint16_t)((t[k - 1][b] >> 8) ^ t[0][t[k - 1][b] & 0xFF]);
+		}
+	};
+	inline constexpr tables_t tables{};
+}
+
+/*!
+ * \brief Same CRC as crc16(), eight bytes per step with 4 KiB of tables.
+ * For bulk data such as CSI-2 line payloads.
+ */
+inline uint16_t crc16_slice8(uint8_t const* data, size_t len, uint16_t crc = 0xFFFF)
+{
+	auto const& t = Crc16::tables.t;
+	while (len >= 8)
+	{
+		crc = t[7][(data[0] ^ crc) & 0xFF] ^ t[6][data[1] ^ (crc >> 8)] ^
+				t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]] ^ t[2][data[5]] ^
+				t[1][data[6]] ^ t[0][data[7]];
+		data += 8;
+		len -= 8;
+	}
+	while (len--)
+		crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+	return crc;
+}
+
+#if CRC16_CLMUL
+namespace Crc16 {
+	/*
+	 * Bytes load little endian, so bit i of a 128-bit block is the
+	 * coefficient of x^(127-i) and the low qword is the high half. A block A
+	 * moved D bits later is A_hi x^(D+64) + A_lo x^D; reducing both factors
+	 * mod P keeps the products below 80 bits. The reflected product lands one
+	 * bit low, hence the -1 in the exponents.
+	 */
+	__attribute__((target("pclmul,sse2")))
+	inline __m128i fold(__m128i a, __m128i k)
+	{
+		return _mm_xor_si128(_mm_clmulepi64_si128(a, k, 0x00), _mm_clmulepi64_si128(a, k, 0x11));
+	}
+}
+
+/*!
+ * \brief Same CRC as crc16(), carry-less multiply folding of four 128-bit
+ * lanes (PCLMULQDQ), finished with slice-by-8 on the folded remainder. The
+ * CPU must support PCLMULQDQ, see crc16_fast().
+ */
+__attribute__((target("pclmul,sse2")))
+inline uint16_t crc16_clmul(uint8_t const* data, size_t len, uint16_t crc = 0xFFFF)
+{
+	if (len < 128)
+		return crc16_slice8(data, len, crc);
+
+	__m128i const k512 = _mm_set_epi64x((long long)Crc16::fold_const(511), (long long)Crc16::fold_const(575));
+	__m128i const k128 = _mm_set_epi64x((long long)Crc16::fold_const(127), (long long)Crc16::fold_const(191));
+	__m128i const* p = reinterpret_cast<__m128i const*>(data);
+
+	//The initial value is the same as XORing it into the first two bytes
+	__m128i a0 = _mm_xor_si128(_mm_loadu_si128(p), _mm_cvtsi32_si128(crc));
+	__m128i a1 = _mm_loadu_si128(p + 1);
+	__m128i a2 = _mm_loadu_si128(p + 2);
+	__m128i a3 = _mm_loadu_si128(p + 3);
+	p += 4;
+	len -= 64;
+	while (len >= 64)
+	{
+		a0 = _mm_xor_si128(Crc16::fold(a0, k512), _mm_loadu_si128(p));
+		a1 = _mm_xor_si128(Crc16::fold(a1, k512), _mm_loadu_si128(p + 1));
+		a2 = _mm_xor_si128(Crc16::fold(a2, k512), _mm_loadu_si128(p + 2));
+		a3 = _mm_xor_si128(Crc16::fold(a3, k512), _mm_loadu_si128(p + 3));
+		p += 4;
+		len -= 64;
+	}
+	a1 = _mm_xor_si128(Crc16::fold(a0, k128), a1);
+	a2 = _mm_xor_si128(Crc16::fold(a1, k128), a2);
+	a3 = _mm_xor_si128(Crc16::fold(a2, k128), a3);
+	while (len >= 16)
+	{
+		a3 = _mm_xor_si128(Crc16::fold(a3, k128), _mm_loadu_si128(p++));
+		len -= 16;
+	}
+
+	uint8_t rem[16];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(rem), a3);
+	crc = crc16_slice8(rem, sizeof(rem), 0);
+	return crc16_slice8(reinterpret_cast<uint8_t const*>(p), len, crc);
+}
+#endif
+
+/*!
+ * \brief Fastest CRC-16 path available: carry-less multiply on x86 hosts
+ * that have it, slice-by-8 otherwise (the Cortex-A9 has no 64-bit
+ * polynomial multiply).
+ */
+inline uint16_t crc16_fast(uint8_t const* data, size_t len, uint16_t crc = 0xFFFF)
+{
+#if CRC16_CLMUL
+	static bool const clmul = __builtin_cpu_supports("pclmul");
+	if (clmul)
+		return crc16_clmul(data, len, crc);
+#endif
+	return crc16_slice8(data, len, crc);
+}
+
+} /* namespace digilent */
+
+#endif /* CRC16_H_ */
@@ -0,0 +1,216 @@
+/*
+ * Log.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "xil_printf.h"
+#include "xtime_l.h"
+
+/*
+ * Deferred logging. A log call stores the format string address, a timestamp
+ * and up to Log::arg_max integer arguments in a RAM ring; formatting and the
+ * UART happen later in Log::drain(), called from the main loop when idle.
+ * Calls are lock-free and safe from interrupt handlers. When the ring is full
+ * new entries are dropped and counted.
+ *
+ * Arguments are stored as pointer-sized words: integers and pointers only,
+ * and %s only with strings that outlive the entry (literals, tables).
+ *
+ * Levels below LOG_LEVEL compile to nothing, arguments are not evaluated but
+ * still checked against the format and count as used.
+ * The ring (digilent::Log::ring) can also be dumped over JTAG and decoded on
+ * the host with host/logdecode.cc, e.g. in xsct:
+ *   mrd -bin -file log.bin <address of _ZN8digilent3Log4ringE> <sizeof ring_t / 4>
+ */
+#define LOG_LEVEL_DEBUG	0
+#define LOG_LEVEL_INFO	1
+#define LOG_LEVEL_WARN	2
+#define LOG_LEVEL_ERROR	3
+#define LOG_LEVEL_NONE	4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_DISCARD(...) do { if (0) xil_printf(__VA_ARGS__); } while (0)
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) ::digilent::Log::record(::digilent::Log::LVL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) ::digilent::Log::record(::digilent::Log::LVL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) ::digilent::Log::record(::digilent::Log::LVL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) ::digilent::Log::record(::digilent::Log::LVL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+
+namespace digilent {
+
+namespace Log {
+	using level_t = enum { LVL_DEBUG = 0, LVL_INFO, LVL_WARN, LVL_ERROR };
+	char const* const level_names[] = {"DBG", "INF", "WRN", "ERR"};
+
+	size_t const arg_max = 6;
+	size_t const ring_size = 256;	// entries, power of two
+	uint32_t const magic = 0x31474F4C;	// "LOG1"
+
+	/*!
+	 * \brief One record. seq is written last: it equals the entry's ring index
+	 * plus one once the producer has finished filling it in.
+	 */
+	struct entry_t
+	{
+		uint32_t seq;
+		uintptr_t fmt;		// format string address, 32 bits on the target
+		uint64_t ticks;		// XTime at the call
+		uint8_t level;
+		uint8_t nargs;
+		uint16_t reserved;
+		uintptr_t args[arg_max];
+	};
+
+	//! \brief Ring layout, fixed so that a raw memory dump decodes on the host
+	struct ring_t
+	{
+		uint32_t magic;
+		uint32_t size;
+		uint32_t entry_size;
+		uint32_t ticks_per_us;
+		uint32_t head;		// next index to reserve
+		uint32_t tail;		// next index to drain
+		uint32_t dropped;
+		uint32_t reserved;
+		entry_t entries[ring_size];
+	};
+
+	inline ring_t ring = {magic, ring_size, sizeof(entry_t),
+			(uint32_t)(COUNTS_PER_SECOND / 1000000), 0, 0, 0, 0, {}};
+
+	template <typename T>
+	inline uintptr_t to_word(T v) { return (uintptr_t)v; }
+	template <typename T>
+	inline uintptr_t to_word(T* p) { return (uintptr_t)p; }
+
+	//! \brief Claims a slot, false (and counted) if the ring is full
+	inline bool reserve(uint32_t& idx)
+	{
+		uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_RELAXED);
+		do
+		{
+			if (head - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE) >= ring_size)
+			{
+				__atomic_fetch_add(&ring.dropped, 1, __ATOMIC_RELAXED);
+				return false;
+			}
+		} while (!__atomic_compare_exchange_n(&ring.head, &head, head + 1, true,
+				__ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+		idx = head;
+		return true;
+	}
+
+	template <typename ...Args>
+	inline void record(level_t level, char const* fmt, Args... args)
+	{
+		static_assert(sizeof...(Args) <= arg_max, "too many log arguments");
+		uint32_t idx;
+		if (!reserve(idx))
+			return;
+		entry_t& e = ring.entries[idx & (ring_size - 1)];
+		XTime t;
+		XTime_GetTime(&t);
+		e.ticks = t;
+		e.fmt = (uintptr_t)fmt;
+		e.level = level;
+		e.nargs = sizeof...(Args);
+		uintptr_t const words[arg_max + 1] = {to_word(args)...};
+		for (size_t i = 0; i < sizeof...(Args); ++i)
+			e.args[i] = words[i];
+		__atomic_store_n(&e.seq, idx + 1, __ATOMIC_RELEASE);
+	}
+
+	/*!
+	 * \brief Formats and prints up to max pending entries. Main loop only.
+	 * Returns the number printed.
+	 */
+	inline size_t drain(size_t max = ring_size)
+	{
+		size_t n = 0;
+		uint32_t dropped = __atomic_exchange_n(&ring.dropped, 0, __ATOMIC_RELAXED);
+		if (dropped)
+			xil_printf("[log] %u entries dropped\r\n", dropped);
+		while (n < max)
+		{
+			uint32_t const tail = ring.tail;
+			if (tail == __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE))
+				break;
+			entry_t const& e = ring.entries[tail & (ring_size - 1)];
+			if (__atomic_load_n(&e.seq, __ATOMIC_ACQUIRE) != tail + 1)
+				break; //Reserved but still being written
+			uint64_t const us = e.ticks / ring.ticks_per_us;
+			xil_printf("[%5u.%06u %s] ", (uint32_t)(us / 1000000), (uint32_t)(us % 1000000),
+					level_names[e.level & 3]);
+			xil_printf(reinterpret_cast<char const*>(e.fmt),
+					e.args[0], e.args[1], e.args[2], e.args[3], e.args[4], e.args[5]);
+			__atomic_store_n(&ring.tail, tail + 1, __ATOMIC_RELEASE);
+			++n;
+		}
+		return n;
+	}
+
+	inline size_t pending()
+	{
+		return __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE) - ring.tail;
+	}
+
+	/*!
+	 * \brief Cost of a log call in timer ticks, averaged over n calls (n at
+	 * most half the ring), for zero and for arg_max arguments. Pending
+	 * entries are printed first; the benchmark entries are discarded.
+	 */
+	using bench_t = struct { uint32_t calls; uint32_t ticks_0args, ticks_6args, ticks_per_us; };
+	inline bench_t benchmark(uint32_t n = ring_size / 2)
+	{
+		bench_t b = {n, 0, 0, ring.ticks_per_us};
+		if (n > ring_size / 2)
+			b.calls = n = ring_size / 2;
+		drain();
+
+		XTime t0, t1;
+		XTime_GetTime(&t0);
+		for (uint32_t i = 0; i < n; ++i)
+			record(LVL_DEBUG, "bench\r\n");
+		XTime_GetTime(&t1);
+		b.ticks_0args = (t1 - t0) / n;
+
+		XTime_GetTime(&t0);
+		for (uint32_t i = 0; i < n; ++i)
+			record(LVL_DEBUG, "bench %u %u %u %u %u %u\r\n", i, i, i, i, i, i);
+		XTime_GetTime(&t1);
+		b.ticks_6args = (t1 - t0) / n;
+
+		__atomic_store_n(&ring.tail, __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+		return b;
+	}
+}
+
+} /* namespace digilent */
+
+#endif /* LOG_H_ */
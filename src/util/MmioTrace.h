@@ -0,0 +1,137 @@
+/*
+ * MmioTrace.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MMIOTRACE_H_
+#define MMIOTRACE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Profile.h"
+
+#include "xil_io.h"
+
+/*
+ * Register access tracing. Firmware code that programs the PL goes through
+ * Mmio::read32()/write32() instead of Xil_In32()/Xil_Out32(); while a trace
+ * is running, every access is recorded as (timestamp, address, value, R/W)
+ * into a fixed ring, for dumping over the console ("mt") and analysing or
+ * replaying on the host (host/sim/mmio_trace).
+ *
+ * Consecutive reads of the same address returning the same value, such as
+ * a lock or reset poll, are folded into one record with a repeat count, so
+ * polling loops do not flush the ring.
+ *
+ * Main loop context only. Accesses from interrupt handlers (frame monitor,
+ * telemetry tick, UART) stay on Xil_In32/Xil_Out32 and are not traced, and
+ * neither are the accesses inside the Xilinx drivers; the host simulation
+ * traces those as well. Building with MMIO_TRACE=0 reduces read32/write32
+ * to the plain accesses.
+ */
+#ifndef MMIO_TRACE
+#define MMIO_TRACE 1
+#endif
+
+#ifndef MMIO_TRACE_SIZE
+#define MMIO_TRACE_SIZE 2048
+#endif
+
+namespace digilent {
+
+namespace Mmio {
+	using Flags = enum { F_WRITE = 1 };
+
+	/*!
+	 * \brief One access, 16 bytes. Addresses are word aligned, so bit 0 of
+	 * addr holds the Flags. ticks is Profile::now() at the access.
+	 */
+	struct record_t
+	{
+		uint32_t ticks;
+		uint32_t addr;
+		uint32_t value;
+		uint32_t repeat;	// further identical reads folded into this one
+	};
+	static_assert(sizeof(record_t) == 16, "record_t is the dump format");
+
+	struct trace_t
+	{
+		record_t ring[MMIO_TRACE_SIZE];
+		uint32_t head;		// next slot
+		uint32_t count;		// valid records, at most MMIO_TRACE_SIZE
+		uint32_t dropped;	// records lost to a full ring
+		bool on;
+		bool wrap;			// overwrite the oldest records when full, else stop
+	};
+
+	inline trace_t trace = {};
+
+	//! \brief Clears the ring and starts recording
+	inline void start(bool wrap = false)
+	{
+		trace.head = trace.count = trace.dropped = 0;
+		trace.wrap = wrap;
+		trace.on = true;
+	}
+
+	inline void stop() { trace.on = false; }
+
+	//! \brief ith oldest record, i < trace.count
+	inline record_t const& at(uint32_t i)
+	{
+		uint32_t const first = trace.head + MMIO_TRACE_SIZE - trace.count;
+		return trace.ring[(first + i) % MMIO_TRACE_SIZE];
+	}
+
+	inline void record(uint32_t addr, uint32_t value, uint32_t flags)
+	{
+		if (!trace.on)
+			return;
+		if (trace.count && !flags)
+		{
+			record_t& last = trace.ring[(trace.head + MMIO_TRACE_SIZE - 1) % MMIO_TRACE_SIZE];
+			if (last.addr == addr && last.value == value)
+			{
+				++last.repeat;
+				return;
+			}
+		}
+		if (trace.count == MMIO_TRACE_SIZE)
+		{
+			++trace.dropped;
+			if (!trace.wrap)
+				return;
+		}
+		else
+		{
+			++trace.count;
+		}
+		trace.ring[trace.head] = {Profile::now(), addr | flags, value, 0};
+		trace.head = (trace.head + 1) % MMIO_TRACE_SIZE;
+	}
+
+#if MMIO_TRACE
+	inline uint32_t read32(UINTPTR addr)
+	{
+		uint32_t const v = Xil_In32(addr);
+		record((uint32_t)addr, v, 0);
+		return v;
+	}
+
+	inline void write32(UINTPTR addr, uint32_t value)
+	{
+		Xil_Out32(addr, value);
+		record((uint32_t)addr, value, F_WRITE);
+	}
+#else
+	inline uint32_t read32(UINTPTR addr) { return Xil_In32(addr); }
+	inline void write32(UINTPTR addr, uint32_t value) { Xil_Out32(addr, value); }
+#endif
+}
+
+} /* namespace digilent */
+
+#endif /* MMIOTRACE_H_ */
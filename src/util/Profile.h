@@ -0,0 +1,170 @@
+/*
+ * Profile.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__arm__)
+#include "xparameters.h"
+#else
+#include <chrono>
+#endif
+
+/*
+ * Scoped profiling zones on the Cortex-A9 PMU cycle counter (steady_clock
+ * nanoseconds on the host). A zone is declared where it is timed:
+ *
+ *   void configure(Resolution res)
+ *   {
+ *     PROFILE_ZONE("VideoOutput::configure");
+ *     ...
+ *
+ * and records call count, total, min/max and a log2 histogram of its
+ * durations. Zones are statically initialised and link themselves into
+ * Profile::zones on their first call. Main loop context only; zones are not
+ * safe from interrupt handlers.
+ *
+ * The cycle counter is 32 bits, so a single zone must stay below ~6.4 s at
+ * 667 MHz. Building with PROFILE=0 removes the zones entirely.
+ */
+#ifndef PROFILE
+#define PROFILE 1
+#endif
+
+#define PROFILE_CAT2(a, b) a##b
+#define PROFILE_CAT(a, b) PROFILE_CAT2(a, b)
+
+#if PROFILE
+#define PROFILE_ZONE(name) \
+	static ::digilent::Profile::zone_t PROFILE_CAT(prof_zone_, __LINE__)(name); \
+	::digilent::Profile::Scope PROFILE_CAT(prof_scope_, __LINE__)(PROFILE_CAT(prof_zone_, __LINE__))
+#else
+#define PROFILE_ZONE(name) do {} while (0)
+#endif
+
+namespace digilent {
+
+namespace Profile {
+	using ticks_t = uint32_t;
+	size_t const hist_size = 32;	// bucket b counts durations in [2^b, 2^(b+1)) ticks
+
+#if defined(__arm__)
+	uint32_t const ticks_per_us = XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 1000000;
+
+	//! \brief Enables and resets the PMU cycle counter, without the /64 divider
+	inline void init()
+	{
+		uint32_t pmcr;
+		asm volatile("mrc p15, 0, %0, c9, c12, 0" : "=r"(pmcr));
+		pmcr = (pmcr | 0x5) & ~0x8u;	// E, C (reset), not D
+		asm volatile("mcr p15, 0, %0, c9, c12, 0" :: "r"(pmcr));
+		asm volatile("mcr p15, 0, %0, c9, c12, 1" :: "r"(1u << 31));	// PMCNTENSET.C
+	}
+
+	inline ticks_t now()
+	{
+		uint32_t c;
+		asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(c));
+		return c;
+	}
+#else
+	uint32_t const ticks_per_us = 1000;
+
+	inline void init() {}
+
+	inline ticks_t now()
+	{
+		return (ticks_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+#endif
+
+	struct zone_t
+	{
+		constexpr zone_t(char const* n) : name(n) {}
+
+		char const* const name;
+		zone_t* next = nullptr;
+		bool linked = false;
+		uint32_t calls = 0;
+		uint64_t total = 0;
+		ticks_t min = UINT32_MAX;
+		ticks_t max = 0;
+		uint32_t hist[hist_size] = {};
+	};
+
+	//! \brief Zones that have been entered at least once, most recent first
+	inline zone_t* zones = nullptr;
+
+	inline void record(zone_t& z, ticks_t d)
+	{
+		if (!z.linked)
+		{
+			z.linked = true;
+			z.next = zones;
+			zones = &z;
+		}
+		++z.calls;
+		z.total += d;
+		if (d < z.min) z.min = d;
+		if (d > z.max) z.max = d;
+		++z.hist[d ? 31 - __builtin_clz(d) : 0];
+	}
+
+	/*!
+	 * \brief Upper bound of the log2 bucket holding the pth percentile (p in
+	 * 1/100), clamped to the largest duration seen
+	 */
+	inline ticks_t percentile(zone_t const& z, uint32_t p)
+	{
+		uint64_t const rank = ((uint64_t)z.calls * p + 99) / 100;
+		uint64_t seen = 0;
+		for (size_t b = 0; b < hist_size; ++b)
+		{
+			seen += z.hist[b];
+			if (seen >= rank && seen)
+			{
+				ticks_t const upper = b == hist_size - 1 ? UINT32_MAX : (ticks_t)((2ull << b) - 1);
+				return upper < z.max ? upper : z.max;
+			}
+		}
+		return z.max;
+	}
+
+	inline void reset()
+	{
+		for (zone_t* z = zones; z; z = z->next)
+		{
+			z->calls = 0;
+			z->total = 0;
+			z->min = UINT32_MAX;
+			z->max = 0;
+			for (size_t b = 0; b < hist_size; ++b)
+				z->hist[b] = 0;
+		}
+	}
+
+	class Scope
+	{
+	public:
+		explicit Scope(zone_t& z) : zone_(z), t0_(now()) {}
+		~Scope() { record(zone_, now() - t0_); }
+
+		Scope(Scope const&) = delete;
+		Scope& operator=(Scope const&) = delete;
+
+	private:
+		zone_t& zone_;
+		ticks_t const t0_;
+	};
+}
+
+} /* namespace digilent */
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,68 @@
+/*
+ * RingBuffer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace digilent {
+
+/*!
+ * \brief Lock-free single-producer single-consumer ring, for handing data
+ * from an interrupt handler to the main loop. The producer only writes head_,
+ * the consumer only writes tail_; both are free-running and published with
+ * release/acquire ordering. N must be a power of two. No hardware access.
+ */
+template <typename T, size_t N>
+class RingBuffer
+{
+	static_assert(N && (N & (N - 1)) == 0, "N must be a power of two");
+public:
+	//! \brief Producer side. Returns false and counts a drop when full.
+	bool push(T const& v)
+	{
+		uint32_t const head = head_;
+		if (head - __atomic_load_n(&tail_, __ATOMIC_ACQUIRE) >= N)
+		{
+			++dropped_;
+			return false;
+		}
+		buf_[head & (N - 1)] = v;
+		__atomic_store_n(&head_, head + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	//! \brief Consumer side. Returns false when empty.
+	bool pop(T& v)
+	{
+		uint32_t const tail = tail_;
+		if (__atomic_load_n(&head_, __ATOMIC_ACQUIRE) == tail)
+			return false;
+		v = buf_[tail & (N - 1)];
+		__atomic_store_n(&tail_, tail + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	size_t size() const
+	{
+		return __atomic_load_n(&head_, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+	}
+	bool empty() const { return size() == 0; }
+	static constexpr size_t capacity() { return N; }
+	//! \brief Elements lost to a full ring since construction
+	uint32_t dropped() const { return __atomic_load_n(&dropped_, __ATOMIC_RELAXED); }
+
+private:
+	T buf_[N];
+	uint32_t head_ = 0, tail_ = 0;
+	uint32_t dropped_ = 0;
+};
+
+} /* namespace digilent */
+
+#endif /* RINGBUFFER_H_ */
@@ -0,0 +1,29 @@
+/*
+ * Timer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <stdint.h>
+
+#include "xtime_l.h"
+
+namespace digilent {
+
+/*!
+ * \brief Microseconds since boot from the Cortex-A9 global timer. Wraps after
+ * ~584000 years, so differences can be taken without care.
+ */
+inline uint64_t time_us()
+{
+	XTime t;
+	XTime_GetTime(&t);
+	return t / (COUNTS_PER_SECOND / 1000000);
+}
+
+} /* namespace digilent */
+
+#endif /* TIMER_H_ */